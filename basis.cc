@@ -58,37 +58,13 @@ namespace psi{ namespace v2rdm_casscf{
 
 void v2RDMSolver::BuildBasis() {
 
-    // product table:
-    table = (int*)malloc(64*sizeof(int));
-    memset((void*)table,'\0',64*sizeof(int));
-    table[0*8+1] = table[1*8+0] = 1;
-    table[0*8+2] = table[2*8+0] = 2;
-    table[0*8+3] = table[3*8+0] = 3;
-    table[0*8+4] = table[4*8+0] = 4;
-    table[0*8+5] = table[5*8+0] = 5;
-    table[0*8+6] = table[6*8+0] = 6;
-    table[0*8+7] = table[7*8+0] = 7;
-    table[1*8+2] = table[2*8+1] = 3;
-    table[1*8+3] = table[3*8+1] = 2;
-    table[1*8+4] = table[4*8+1] = 5;
-    table[1*8+5] = table[5*8+1] = 4;
-    table[1*8+6] = table[6*8+1] = 7;
-    table[1*8+7] = table[7*8+1] = 6;
-    table[2*8+3] = table[3*8+2] = 1;
-    table[2*8+4] = table[4*8+2] = 6;
-    table[2*8+5] = table[5*8+2] = 7;
-    table[2*8+6] = table[6*8+2] = 4;
-    table[2*8+7] = table[7*8+2] = 5;
-    table[3*8+4] = table[4*8+3] = 7;
-    table[3*8+5] = table[5*8+3] = 6;
-    table[3*8+6] = table[6*8+3] = 5;
-    table[3*8+7] = table[7*8+3] = 4;
-    table[4*8+5] = table[5*8+4] = 1;
-    table[4*8+6] = table[6*8+4] = 2;
-    table[4*8+7] = table[7*8+4] = 3;
-    table[5*8+6] = table[6*8+5] = 3;
-    table[5*8+7] = table[7*8+5] = 2;
-    table[6*8+7] = table[7*8+6] = 1;
+    // the states of a multistate computation (and a continuation stage)
+    // have the same orbitals as their integral donor, and the index maps are
+    // never modified once built, so they point at the donor's maps
+    if ( integral_donor_ ) {
+        ShareBasis(integral_donor_);
+        return;
+    }
 
     // orbitals are in pitzer order:
     symmetry               = (int*)malloc(nmo_*sizeof(int));
@@ -612,111 +588,163 @@ void v2RDMSolver::BuildBasis() {
         }
     }
 
+    free(gems_really_full);
+
     if ( constrain_t1_ || constrain_t2_ || constrain_d3_ ) {
-        // make all triplets
-        for (int h = 0; h < nirrep_; h++) {
-            std::vector < boost::tuple<int,int,int> > mytrip;
-            for (int i = 0; i < amo_; i++) {
-                for (int j = 0; j < amo_; j++) {
-                    int s1 = SymmetryPair(symmetry[i],symmetry[j]);
-                    for (int k = 0; k < amo_; k++) {
-                        int s2 = SymmetryPair(s1,symmetry[k]);
-                        if (h==s2) {
-                            mytrip.push_back(boost::make_tuple(i,j,k));
-                        }
-                    }
+        BuildTripletBasis();
+    }
+}
 
-                }
-            }
-            triplets.push_back(mytrip);
-        }
-        bas_aaa_sym  = (int***)malloc(nirrep_*sizeof(int**));
-        bas_aab_sym  = (int***)malloc(nirrep_*sizeof(int**));
-        bas_aba_sym  = (int***)malloc(nirrep_*sizeof(int**));
-        ibas_aaa_sym = (int****)malloc(nirrep_*sizeof(int***));
-        ibas_aab_sym = (int****)malloc(nirrep_*sizeof(int***));
-        ibas_aba_sym = (int****)malloc(nirrep_*sizeof(int***));
-        trip_aaa    = (int*)malloc(nirrep_*sizeof(int));
-        trip_aab    = (int*)malloc(nirrep_*sizeof(int));
-        trip_aba    = (int*)malloc(nirrep_*sizeof(int));
-        for (int h = 0; h < nirrep_; h++) {
-            ibas_aaa_sym[h] = (int***)malloc(amo_*sizeof(int**));
-            ibas_aab_sym[h] = (int***)malloc(amo_*sizeof(int**));
-            ibas_aba_sym[h] = (int***)malloc(amo_*sizeof(int**));
-            bas_aaa_sym[h]  = (int**)malloc(amo_*amo_*amo_*sizeof(int*));
-            bas_aab_sym[h]  = (int**)malloc(amo_*amo_*amo_*sizeof(int*));
-            bas_aba_sym[h]  = (int**)malloc(amo_*amo_*amo_*sizeof(int*));
-            for (int i = 0; i < amo_; i++) {
-                ibas_aaa_sym[h][i] = (int**)malloc(amo_*sizeof(int*));
-                ibas_aab_sym[h][i] = (int**)malloc(amo_*sizeof(int*));
-                ibas_aba_sym[h][i] = (int**)malloc(amo_*sizeof(int*));
-                for (int j = 0; j < amo_; j++) {
-                    ibas_aaa_sym[h][i][j] = (int*)malloc(amo_*sizeof(int));
-                    ibas_aab_sym[h][i][j] = (int*)malloc(amo_*sizeof(int));
-                    ibas_aba_sym[h][i][j] = (int*)malloc(amo_*sizeof(int));
-                    for (int k = 0; k < amo_; k++) {
-                        ibas_aaa_sym[h][i][j][k] = -999;
-                        ibas_aab_sym[h][i][j][k] = -999;
-                        ibas_aba_sym[h][i][j][k] = -999;
+void v2RDMSolver::ShareBasis(boost::shared_ptr<v2RDMSolver> donor) {
+
+    symmetry                           = donor->symmetry;
+    symmetry_full                      = donor->symmetry_full;
+    symmetry_really_full               = donor->symmetry_really_full;
+    symmetry_energy_order              = donor->symmetry_energy_order;
+    energy_to_pitzer_order             = donor->energy_to_pitzer_order;
+    energy_to_pitzer_order_really_full = donor->energy_to_pitzer_order_really_full;
+    full_basis                         = donor->full_basis;
+    pitzer_offset                      = donor->pitzer_offset;
+    pitzer_offset_full                 = donor->pitzer_offset_full;
+
+    gems                = donor->gems;
+    gems_ab             = donor->gems_ab;
+    gems_aa             = donor->gems_aa;
+    gems_00             = donor->gems_00;
+    gems_full           = donor->gems_full;
+    gems_plus_core      = donor->gems_plus_core;
+    bas_ab_sym          = donor->bas_ab_sym;
+    bas_aa_sym          = donor->bas_aa_sym;
+    bas_00_sym          = donor->bas_00_sym;
+    bas_full_sym        = donor->bas_full_sym;
+    bas_really_full_sym = donor->bas_really_full_sym;
+    ibas_ab_sym         = donor->ibas_ab_sym;
+    ibas_aa_sym         = donor->ibas_aa_sym;
+    ibas_00_sym         = donor->ibas_00_sym;
+    ibas_full_sym       = donor->ibas_full_sym;
+
+    if ( !constrain_t1_ && !constrain_t2_ && !constrain_d3_ ) return;
+
+    // a DQG donor has no triplet maps
+    if ( !donor->constrain_t1_ && !donor->constrain_t2_ && !donor->constrain_d3_ ) {
+        BuildTripletBasis();
+        return;
+    }
+    triplets     = donor->triplets;
+    trip_aaa     = donor->trip_aaa;
+    trip_aab     = donor->trip_aab;
+    trip_aba     = donor->trip_aba;
+    bas_aaa_sym  = donor->bas_aaa_sym;
+    bas_aab_sym  = donor->bas_aab_sym;
+    bas_aba_sym  = donor->bas_aba_sym;
+    ibas_aaa_sym = donor->ibas_aaa_sym;
+    ibas_aab_sym = donor->ibas_aab_sym;
+    ibas_aba_sym = donor->ibas_aba_sym;
+}
+
+void v2RDMSolver::BuildTripletBasis() {
+
+    // make all triplets
+    for (int h = 0; h < nirrep_; h++) {
+        std::vector < boost::tuple<int,int,int> > mytrip;
+        for (int i = 0; i < amo_; i++) {
+            for (int j = 0; j < amo_; j++) {
+                int s1 = SymmetryPair(symmetry[i],symmetry[j]);
+                for (int k = 0; k < amo_; k++) {
+                    int s2 = SymmetryPair(s1,symmetry[k]);
+                    if (h==s2) {
+                        mytrip.push_back(boost::make_tuple(i,j,k));
                     }
                 }
+
             }
-            for (int i = 0; i < amo_*amo_*amo_; i++) {
-                bas_aaa_sym[h][i] = (int*)malloc(3*sizeof(int));
-                bas_aab_sym[h][i] = (int*)malloc(3*sizeof(int));
-                bas_aba_sym[h][i] = (int*)malloc(3*sizeof(int));
-                for (int j = 0; j < 3; j++) {
-                    bas_aaa_sym[h][i][j] = -999;
-                    bas_aab_sym[h][i][j] = -999;
-                    bas_aba_sym[h][i][j] = -999;
+        }
+        triplets.push_back(mytrip);
+    }
+    bas_aaa_sym  = (int***)malloc(nirrep_*sizeof(int**));
+    bas_aab_sym  = (int***)malloc(nirrep_*sizeof(int**));
+    bas_aba_sym  = (int***)malloc(nirrep_*sizeof(int**));
+    ibas_aaa_sym = (int****)malloc(nirrep_*sizeof(int***));
+    ibas_aab_sym = (int****)malloc(nirrep_*sizeof(int***));
+    ibas_aba_sym = (int****)malloc(nirrep_*sizeof(int***));
+    trip_aaa    = (int*)malloc(nirrep_*sizeof(int));
+    trip_aab    = (int*)malloc(nirrep_*sizeof(int));
+    trip_aba    = (int*)malloc(nirrep_*sizeof(int));
+    for (int h = 0; h < nirrep_; h++) {
+        ibas_aaa_sym[h] = (int***)malloc(amo_*sizeof(int**));
+        ibas_aab_sym[h] = (int***)malloc(amo_*sizeof(int**));
+        ibas_aba_sym[h] = (int***)malloc(amo_*sizeof(int**));
+        bas_aaa_sym[h]  = (int**)malloc(amo_*amo_*amo_*sizeof(int*));
+        bas_aab_sym[h]  = (int**)malloc(amo_*amo_*amo_*sizeof(int*));
+        bas_aba_sym[h]  = (int**)malloc(amo_*amo_*amo_*sizeof(int*));
+        for (int i = 0; i < amo_; i++) {
+            ibas_aaa_sym[h][i] = (int**)malloc(amo_*sizeof(int*));
+            ibas_aab_sym[h][i] = (int**)malloc(amo_*sizeof(int*));
+            ibas_aba_sym[h][i] = (int**)malloc(amo_*sizeof(int*));
+            for (int j = 0; j < amo_; j++) {
+                ibas_aaa_sym[h][i][j] = (int*)malloc(amo_*sizeof(int));
+                ibas_aab_sym[h][i][j] = (int*)malloc(amo_*sizeof(int));
+                ibas_aba_sym[h][i][j] = (int*)malloc(amo_*sizeof(int));
+                for (int k = 0; k < amo_; k++) {
+                    ibas_aaa_sym[h][i][j][k] = -999;
+                    ibas_aab_sym[h][i][j][k] = -999;
+                    ibas_aba_sym[h][i][j][k] = -999;
                 }
             }
+        }
+        for (int i = 0; i < amo_*amo_*amo_; i++) {
+            bas_aaa_sym[h][i] = (int*)malloc(3*sizeof(int));
+            bas_aab_sym[h][i] = (int*)malloc(3*sizeof(int));
+            bas_aba_sym[h][i] = (int*)malloc(3*sizeof(int));
+            for (int j = 0; j < 3; j++) {
+                bas_aaa_sym[h][i][j] = -999;
+                bas_aab_sym[h][i][j] = -999;
+                bas_aba_sym[h][i][j] = -999;
+            }
+        }
 
-            // mappings:
-            int count_aaa = 0;
-            int count_aab = 0;
-            int count_aba = 0;
-            for (int n = 0; n < triplets[h].size(); n++) {
-                int i = get<0>(triplets[h][n]);
-                int j = get<1>(triplets[h][n]);
-                int k = get<2>(triplets[h][n]);
-
-                ibas_aba_sym[h][i][j][k] = count_aba;
-                bas_aba_sym[h][count_aba][0]  = i;
-                bas_aba_sym[h][count_aba][1]  = j;
-                bas_aba_sym[h][count_aba][2]  = k;
-                count_aba++;
-
-                if ( i >= j ) continue;
-
-                ibas_aab_sym[h][i][j][k] = count_aab;
-                ibas_aab_sym[h][j][i][k] = count_aab;
-                bas_aab_sym[h][count_aab][0]  = i;
-                bas_aab_sym[h][count_aab][1]  = j;
-                bas_aab_sym[h][count_aab][2]  = k;
-                count_aab++;
-
-                if ( j >= k ) continue;
-
-                ibas_aaa_sym[h][i][j][k] = count_aaa;
-                ibas_aaa_sym[h][i][k][j] = count_aaa;
-                ibas_aaa_sym[h][j][i][k] = count_aaa;
-                ibas_aaa_sym[h][j][k][i] = count_aaa;
-                ibas_aaa_sym[h][k][i][j] = count_aaa;
-                ibas_aaa_sym[h][k][j][i] = count_aaa;
-                bas_aaa_sym[h][count_aaa][0]  = i;
-                bas_aaa_sym[h][count_aaa][1]  = j;
-                bas_aaa_sym[h][count_aaa][2]  = k;
-                count_aaa++;
+        // mappings:
+        int count_aaa = 0;
+        int count_aab = 0;
+        int count_aba = 0;
+        for (int n = 0; n < triplets[h].size(); n++) {
+            int i = get<0>(triplets[h][n]);
+            int j = get<1>(triplets[h][n]);
+            int k = get<2>(triplets[h][n]);
+
+            ibas_aba_sym[h][i][j][k] = count_aba;
+            bas_aba_sym[h][count_aba][0]  = i;
+            bas_aba_sym[h][count_aba][1]  = j;
+            bas_aba_sym[h][count_aba][2]  = k;
+            count_aba++;
+
+            if ( i >= j ) continue;
+
+            ibas_aab_sym[h][i][j][k] = count_aab;
+            ibas_aab_sym[h][j][i][k] = count_aab;
+            bas_aab_sym[h][count_aab][0]  = i;
+            bas_aab_sym[h][count_aab][1]  = j;
+            bas_aab_sym[h][count_aab][2]  = k;
+            count_aab++;
+
+            if ( j >= k ) continue;
+
+            ibas_aaa_sym[h][i][j][k] = count_aaa;
+            ibas_aaa_sym[h][i][k][j] = count_aaa;
+            ibas_aaa_sym[h][j][i][k] = count_aaa;
+            ibas_aaa_sym[h][j][k][i] = count_aaa;
+            ibas_aaa_sym[h][k][i][j] = count_aaa;
+            ibas_aaa_sym[h][k][j][i] = count_aaa;
+            bas_aaa_sym[h][count_aaa][0]  = i;
+            bas_aaa_sym[h][count_aaa][1]  = j;
+            bas_aaa_sym[h][count_aaa][2]  = k;
+            count_aaa++;
 
-            }
-            trip_aaa[h] = count_aaa;
-            trip_aab[h] = count_aab;
-            trip_aba[h] = count_aba;
         }
+        trip_aaa[h] = count_aaa;
+        trip_aab[h] = count_aab;
+        trip_aba[h] = count_aba;
     }
-
-    free(gems_really_full);
 }
 
 
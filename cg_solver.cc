@@ -38,19 +38,31 @@
 #include <../bin/fnocc/blas.h>
 #include <libqt/qt.h>
 #include "cg_solver.h"
+#include "distributed.h"
 
 using namespace boost;
 
 namespace psi{ 
 
+// with MPI, each rank holds only its slice of the vectors, so dot products
+// are summed over the ranks
+static double cg_dot(long int n, double * a, double * b) {
+    double dum = C_DDOT(n,a,1,b,1);
+    v2rdm_casscf::DistributedSum(&dum,1);
+    return dum;
+}
+
 CGSolver::CGSolver(long int n) {
     n_              = n;
     iter_           = 0;
     cg_max_iter_    = 10000;
     cg_convergence_ = 1e-6;
-    p = boost::shared_ptr<Vector>(new Vector(n));
-    r = boost::shared_ptr<Vector>(new Vector(n));
-    //z = boost::shared_ptr<Vector>(new Vector(n));
+    recycle_dim_    = 0;
+    nrecycle_       = 0;
+    ncollect_       = 0;
+    p = boost::shared_ptr<SolverVector>(new SolverVector(n));
+    r = boost::shared_ptr<SolverVector>(new SolverVector(n));
+    //z = boost::shared_ptr<SolverVector>(new SolverVector(n));
 }
 CGSolver::~CGSolver(){
 }
@@ -60,18 +72,123 @@ void CGSolver::set_max_iter(int iter) {
 void CGSolver::set_convergence(double conv) {
     cg_convergence_ = conv;
 }
+void CGSolver::set_recycle_dimension(int dim) {
+    recycle_dim_ = dim;
+    w_.clear();
+    Aw_.clear();
+    p_collect_.clear();
+    Ap_collect_.clear();
+    for (int i = 0; i < dim; i++) {
+        w_.push_back(boost::shared_ptr<SolverVector>(new SolverVector(n_)));
+        Aw_.push_back(boost::shared_ptr<SolverVector>(new SolverVector(n_)));
+        p_collect_.push_back(boost::shared_ptr<SolverVector>(new SolverVector(n_)));
+        Ap_collect_.push_back(boost::shared_ptr<SolverVector>(new SolverVector(n_)));
+    }
+    wAw_inv_.clear();
+    pAp_collect_.assign(dim,0.0);
+    nrecycle_ = 0;
+    ncollect_ = 0;
+}
+void CGSolver::reset_recycle() {
+    nrecycle_ = 0;
+    ncollect_ = 0;
+}
+
+// x += W (W^T A W)^+ W^T r and r -= A W (W^T A W)^+ W^T r
+void CGSolver::deflate_guess(double * x_p, double * r_p) {
+    if ( nrecycle_ == 0 ) return;
+    std::vector<double> coef = galerkin_coefficients(w_,r_p);
+    for (int i = 0; i < nrecycle_; i++) {
+        C_DAXPY(n_,coef[i],w_[i]->pointer(),1,x_p,1);
+        C_DAXPY(n_,-coef[i],Aw_[i]->pointer(),1,r_p,1);
+    }
+}
+
+// p -= W (W^T A W)^+ (A W)^T r, which keeps p A-orthogonal to W
+void CGSolver::deflate_direction(double * r_p, double * p_p) {
+    if ( nrecycle_ == 0 ) return;
+    std::vector<double> coef = galerkin_coefficients(Aw_,r_p);
+    for (int i = 0; i < nrecycle_; i++) {
+        C_DAXPY(n_,-coef[i],w_[i]->pointer(),1,p_p,1);
+    }
+}
+
+// (W^T A W)^+ V^T r
+std::vector<double> CGSolver::galerkin_coefficients(std::vector<boost::shared_ptr<SolverVector> > & V, double * r_p) {
+    std::vector<double> t(nrecycle_);
+    for (int i = 0; i < nrecycle_; i++) {
+        t[i] = cg_dot(n_,V[i]->pointer(),r_p);
+    }
+    std::vector<double> coef(nrecycle_,0.0);
+    for (int i = 0; i < nrecycle_; i++) {
+        for (int j = 0; j < nrecycle_; j++) {
+            coef[i] += wAw_inv_[i*nrecycle_+j] * t[j];
+        }
+    }
+    return coef;
+}
+
+void CGSolver::collect_direction(double * p_p, double * Ap_p, double pap) {
+    if ( ncollect_ >= recycle_dim_ || pap <= 0.0 ) return;
+    C_DCOPY(n_,p_p,1,p_collect_[ncollect_]->pointer(),1);
+    C_DCOPY(n_,Ap_p,1,Ap_collect_[ncollect_]->pointer(),1);
+    pAp_collect_[ncollect_] = pap;
+    ncollect_++;
+}
+
+void CGSolver::finalize_recycle() {
+    if ( ncollect_ == 0 ) return;
+    w_.swap(p_collect_);
+    Aw_.swap(Ap_collect_);
+    nrecycle_ = ncollect_;
+    ncollect_ = 0;
+
+    // W^T A W, symmetrized, and its pseudo-inverse.  directions that are
+    // (numerically) linear combinations of the others are dropped
+    int k = nrecycle_;
+    std::vector<double> G(k*k);
+    for (int i = 0; i < k; i++) {
+        for (int j = i; j < k; j++) {
+            double dum = 0.5 * ( cg_dot(n_,w_[i]->pointer(),Aw_[j]->pointer())
+                               + cg_dot(n_,w_[j]->pointer(),Aw_[i]->pointer()) );
+            G[i*k+j] = G[j*k+i] = dum;
+        }
+    }
+    std::vector<double> eval(k);
+    std::vector<double> work(3*k);
+    int info = C_DSYEV('V','U',k,&G[0],k,&eval[0],&work[0],3*k);
+    wAw_inv_.assign(k*k,0.0);
+    if ( info != 0 ) {
+        nrecycle_ = 0;
+        return;
+    }
+    double emax = eval[k-1];
+    for (int m = 0; m < k; m++) {
+        if ( eval[m] <= 1e-10 * emax ) continue;
+        // row m of G is the eigenvector for eval[m]
+        for (int i = 0; i < k; i++) {
+            for (int j = 0; j < k; j++) {
+                wAw_inv_[i*k+j] += G[m*k+i] * G[m*k+j] / eval[m];
+            }
+        }
+    }
+}
 
 void CGSolver::preconditioned_solve(long int n,
-                    boost::shared_ptr<Vector> Ap, 
-                    boost::shared_ptr<Vector>  x, 
-                    boost::shared_ptr<Vector>  b, 
-                    boost::shared_ptr<Vector>  precon, 
+                    boost::shared_ptr<SolverVector> Ap, 
+                    boost::shared_ptr<SolverVector>  x, 
+                    boost::shared_ptr<SolverVector>  b, 
+                    boost::shared_ptr<SolverVector>  precon, 
                     CallbackType function, void * data) {
 
     if ( n != n_ ) {
         throw PsiException("Warning: dimension does not match dimension from initialization",__FILE__,__LINE__);
     }
 
+    if ( !z ) {
+        z = boost::shared_ptr<SolverVector>(new SolverVector(n));
+    }
+
     double * p_p = p->pointer();
     double * r_p = r->pointer();
     double * z_p = z->pointer();
@@ -89,9 +206,16 @@ void CGSolver::preconditioned_solve(long int n,
 
     for (int i = 0; i < n; i++) {
         r_p[i] = b_p[i] - Ap_p[i];
+    }
+
+    // project the guess onto the subspace recycled from the last solve
+    deflate_guess(x_p,r_p);
+
+    for (int i = 0; i < n; i++) {
         z_p[i] = precon_p[i] * r_p[i];
     }
     C_DCOPY(n,z_p,1,p_p,1);
+    deflate_direction(z_p,p_p);
 
     iter_ = 0;
     do {
@@ -99,35 +223,40 @@ void CGSolver::preconditioned_solve(long int n,
         // call some function to evaluate A.p.  Result in Ap
         function(n,Ap,p,data);
 
-        double rz  = C_DDOT(n_,r_p,1,z_p,1);
-        double pap = C_DDOT(n_,p_p,1,Ap_p,1);
+        double rz  = cg_dot(n_,r_p,z_p);
+        double pap = cg_dot(n_,p_p,Ap_p);
         double alpha = rz / pap;
         C_DAXPY(n_,alpha,p_p,1,x_p,1);
         C_DAXPY(n_,-alpha,Ap_p,1,r_p,1);
 
+        collect_direction(p_p,Ap_p,pap);
+
         // if r is sufficiently small, then exit loop
-        double rrnew = C_DDOT(n_,r_p,1,r_p,1);
+        double rrnew = cg_dot(n_,r_p,r_p);
         double nrm = sqrt(rrnew);
         if ( nrm < cg_convergence_ ) break;
 
         for (int i = 0; i < n; i++) {
             z_p[i] = precon_p[i] * r_p[i];
         }
-        double rznew  = C_DDOT(n_,r_p,1,z_p,1);
+        double rznew  = cg_dot(n_,r_p,z_p);
         double beta = rznew/rz;
 
         C_DSCAL(n_,beta,p_p,1);
         C_DAXPY(n_,1.0,z_p,1,p_p,1);
+        deflate_direction(z_p,p_p);
 
         iter_++;
 
     }while(iter_ < cg_max_iter_ );
+
+    finalize_recycle();
 }
 
 void CGSolver::solve(long int n,
-                    boost::shared_ptr<Vector> Ap, 
-                    boost::shared_ptr<Vector>  x, 
-                    boost::shared_ptr<Vector>  b, 
+                    boost::shared_ptr<SolverVector> Ap, 
+                    boost::shared_ptr<SolverVector>  x, 
+                    boost::shared_ptr<SolverVector>  b, 
                     CallbackType function, void * data) {
 
     if ( n != n_ ) {
@@ -150,7 +279,12 @@ void CGSolver::solve(long int n,
     for (int i = 0; i < n; i++) {
         r_p[i] = b_p[i] - Ap_p[i];
     }
+
+    // project the guess onto the subspace recycled from the last solve
+    deflate_guess(x_p,r_p);
+
     C_DCOPY(n,r_p,1,p_p,1);
+    deflate_direction(r_p,p_p);
 
     iter_ = 0;
     do {
@@ -158,24 +292,29 @@ void CGSolver::solve(long int n,
         // call some function to evaluate A.p.  Result in Ap
         function(n,Ap,p,data);
 
-        double rr  = C_DDOT(n_,r_p,1,r_p,1);
-        double pap = C_DDOT(n_,p_p,1,Ap_p,1);
+        double rr  = cg_dot(n_,r_p,r_p);
+        double pap = cg_dot(n_,p_p,Ap_p);
         double alpha = rr / pap;
         C_DAXPY(n_,alpha,p_p,1,x_p,1);
         C_DAXPY(n_,-alpha,Ap_p,1,r_p,1);
 
+        collect_direction(p_p,Ap_p,pap);
+
         // if r is sufficiently small, then exit loop
-        double rrnew = C_DDOT(n_,r_p,1,r_p,1);
+        double rrnew = cg_dot(n_,r_p,r_p);
         double nrm = sqrt(rrnew);
         double beta = rrnew/rr;
         if ( nrm < cg_convergence_ ) break;
 
         C_DSCAL(n_,beta,p_p,1);
         C_DAXPY(n_,1.0,r_p,1,p_p,1);
+        deflate_direction(r_p,p_p);
 
         iter_++;
 
     }while(iter_ < cg_max_iter_ );
+
+    finalize_recycle();
 }
 
 int CGSolver::total_iterations() {
@@ -28,13 +28,18 @@
 #ifndef CG_SOLVER_H
 #define CG_SOLVER_H
 
-#include<libmints/vector.h>
+#include<vector>
+#include"placement.h"
 
 using namespace boost;
 
 namespace psi{ 
 
-typedef void (*CallbackType)(long int,SharedVector,SharedVector,void *);  
+// the cg vectors are the solver's own (page-aligned) vectors
+using v2rdm_casscf::SolverVector;
+using v2rdm_casscf::SharedSolverVector;
+
+typedef void (*CallbackType)(long int,SharedSolverVector,SharedSolverVector,void *);  
 
 class CGSolver {
 public:
@@ -42,30 +47,76 @@ public:
     CGSolver(long int n);
     ~CGSolver();
     void preconditioned_solve(long int n,
-               boost::shared_ptr<Vector> Ap,
-               boost::shared_ptr<Vector>  x,
-               boost::shared_ptr<Vector>  b,
-               boost::shared_ptr<Vector>  precon,
+               boost::shared_ptr<SolverVector> Ap,
+               boost::shared_ptr<SolverVector>  x,
+               boost::shared_ptr<SolverVector>  b,
+               boost::shared_ptr<SolverVector>  precon,
                CallbackType function, void * data);
     void solve(long int n,
-               boost::shared_ptr<Vector> Ap,
-               boost::shared_ptr<Vector>  x,
-               boost::shared_ptr<Vector>  b,
+               boost::shared_ptr<SolverVector> Ap,
+               boost::shared_ptr<SolverVector>  x,
+               boost::shared_ptr<SolverVector>  b,
                CallbackType function, void * data);
 
     int total_iterations();
     void set_max_iter(int iter);
     void set_convergence(double conv);
 
+    /// keep up to dim search directions from one solve to deflate the next
+    void set_recycle_dimension(int dim);
+
+    /// discard the recycled subspace (e.g., when the operator changes)
+    void reset_recycle();
+
 private:
 
     int    n_;
     int    iter_;
     int    cg_max_iter_;
     double cg_convergence_;
-    boost::shared_ptr<Vector> p;
-    boost::shared_ptr<Vector> r;
-    boost::shared_ptr<Vector> z;
+    boost::shared_ptr<SolverVector> p;
+    boost::shared_ptr<SolverVector> r;
+    boost::shared_ptr<SolverVector> z;
+
+    /// maximum number of recycled search directions
+    int recycle_dim_;
+
+    /// number of recycled directions available from the previous solve
+    int nrecycle_;
+
+    /// number of directions collected during the current solve
+    int ncollect_;
+
+    /// recycled (mutually A-conjugate) search directions, w
+    std::vector<boost::shared_ptr<SolverVector> > w_;
+
+    /// A.w for the recycled directions
+    std::vector<boost::shared_ptr<SolverVector> > Aw_;
+
+    /// pseudo-inverse of W^T A W for the recycled directions.  the
+    /// directions are A-conjugate only up to round-off, so the full
+    /// (nrecycle_ x nrecycle_) Galerkin matrix is used, not its diagonal
+    std::vector<double> wAw_inv_;
+
+    /// directions (and A.p, p.A.p) collected during the current solve
+    std::vector<boost::shared_ptr<SolverVector> > p_collect_;
+    std::vector<boost::shared_ptr<SolverVector> > Ap_collect_;
+    std::vector<double> pAp_collect_;
+
+    /// Galerkin projection of the initial guess onto the recycled subspace
+    void deflate_guess(double * x_p, double * r_p);
+
+    /// A-orthogonalize a new search direction against the recycled subspace
+    void deflate_direction(double * r_p, double * p_p);
+
+    /// (W^T A W)^+ V^T r, with V = W or A W
+    std::vector<double> galerkin_coefficients(std::vector<boost::shared_ptr<SolverVector> > & V, double * r_p);
+
+    /// store p and A.p as candidates for recycling
+    void collect_direction(double * p_p, double * Ap_p, double pap);
+
+    /// promote collected directions to the recycled subspace
+    void finalize_recycle();
 
 };
 
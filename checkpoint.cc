@@ -76,8 +76,9 @@ void v2RDMSolver::InitializeCheckpointFile() {
     // x
     psio->write_entry(PSIF_V2RDM_CHECKPOINT,"PRIMAL",(char*)x->pointer(),dimx_*sizeof(double));
 
-    // y
-    psio->write_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 1",(char*)y->pointer(),nconstraints_*sizeof(double));
+    // y (all of the rows, not just this rank's)
+    SharedSolverVector yfull = GatherRows(y);
+    psio->write_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 1",(char*)yfull->pointer(),nconstraints_*sizeof(double));
 
     // z
     psio->write_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 2",(char*)z->pointer(),dimx_*sizeof(double));
@@ -108,6 +109,9 @@ void v2RDMSolver::InitializeCheckpointFile() {
 }
 void v2RDMSolver::WriteCheckpointFile() {
 
+    // all of x and z, not just the blocks this rank has kept up to date
+    BroadcastBlocksFromOwners();
+
     boost::shared_ptr<PSIO> psio ( new PSIO() );
     psio->open(PSIF_V2RDM_CHECKPOINT,PSIO_OPEN_OLD);
 
@@ -117,8 +121,9 @@ void v2RDMSolver::WriteCheckpointFile() {
     // x
     psio->write_entry(PSIF_V2RDM_CHECKPOINT,"PRIMAL",(char*)x->pointer(),dimx_*sizeof(double));
 
-    // y
-    psio->write_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 1",(char*)y->pointer(),nconstraints_*sizeof(double));
+    // y (all of the rows, not just this rank's)
+    SharedSolverVector yfull = GatherRows(y);
+    psio->write_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 1",(char*)yfull->pointer(),nconstraints_*sizeof(double));
 
     // z
     psio->write_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 2",(char*)z->pointer(),dimx_*sizeof(double));
@@ -168,9 +173,14 @@ void v2RDMSolver::ReadFromCheckpointFile() {
 
     // x
     psio->read_entry(PSIF_V2RDM_CHECKPOINT,"PRIMAL",(char*)x->pointer(),dimx_*sizeof(double));
+    if ( spin_adapt_d2_ ) {
+        UnpackSpinAdaptedD2(x);
+    }
 
-    // y
-    psio->read_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 1",(char*)y->pointer(),nconstraints_*sizeof(double));
+    // y (all of the rows, then keep this rank's)
+    SharedSolverVector yfull (new SolverVector("dual solution (all rows)",nconstraints_));
+    psio->read_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 1",(char*)yfull->pointer(),nconstraints_*sizeof(double));
+    KeepLocalRows(yfull,y);
 
     // z
     psio->read_entry(PSIF_V2RDM_CHECKPOINT,"DUAL 2",(char*)z->pointer(),dimx_*sizeof(double));
@@ -0,0 +1,133 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include <psi4-dec.h>
+#include <libmints/vector.h>
+#include <libqt/qt.h>
+
+#include"v2rdm_solver.h"
+
+#ifdef _OPENMP
+    #include<omp.h>
+#else
+    #define omp_get_wtime() ( (double)clock() / CLOCKS_PER_SEC )
+#endif
+
+using namespace psi;
+
+namespace psi{ namespace v2rdm_casscf{
+
+bool v2RDMSolver::ContinuationUseful() {
+    if ( !constrain_t1_ && !constrain_t2_ && !constrain_d3_ ) return false;
+    if ( options_["RESTART_FROM_CHECKPOINT_FILE"].has_changed() ) return false;
+    if ( scan_warm_start_ ) return false;
+    return true;
+}
+
+// the stage keeps the D, Q, and G conditions of the target, so that its
+// blocks are a leading section of the target's
+std::string v2RDMSolver::ContinuationPositivity() {
+    std::string positivity = "D";
+    if ( constrain_q2_ ) positivity += "Q";
+    if ( constrain_g2_ ) positivity += "G";
+    return positivity;
+}
+
+void v2RDMSolver::SetContinuationSource(boost::shared_ptr<v2RDMSolver> source) {
+    continuation_source_ = source;
+}
+
+// the stage problem is a leading section of the full one: the D2, Q2, and G2
+// blocks come first in x/z (in the same order), and their constraints are
+// the first rows of y.  copy those, and build the T1/T2 blocks from the
+// lifted D2 as Guess() does from the Hartree-Fock D2.  D3 blocks start at
+// zero, as they do after Guess().
+void v2RDMSolver::ReadContinuationSolution() {
+
+    if ( !continuation_source_ ) return;
+
+    // let the stage go once it has been copied
+    boost::shared_ptr<v2RDMSolver> source = continuation_source_;
+    continuation_source_.reset();
+
+    continuation_oiter_ = source->oiter_total_;
+    continuation_iiter_ = source->iiter_total_;
+    continuation_time_  = omp_get_wtime() - source->start_total_time_;
+
+    outfile->Printf("\n");
+    outfile->Printf("    ==> Warm start from %s solution <==\n",source->ContinuationPositivity().c_str());
+    outfile->Printf("\n");
+    outfile->Printf("        Stage energy:               %20.12lf\n",source->energy_primal_ + enuc_ + efzc_);
+    outfile->Printf("        Stage macroiterations:      %12li\n",continuation_oiter_);
+    outfile->Printf("        Stage microiterations:      %12li\n",continuation_iiter_);
+    outfile->Printf("        Stage wall time:            %12.2lf s\n",continuation_time_);
+
+    bool fits = ( source->dimensions_.size() <= dimensions_.size() );
+    for (int i = 0; fits && i < source->dimensions_.size(); i++) {
+        if ( source->dimensions_[i] != dimensions_[i] ) fits = false;
+    }
+    if ( !fits ) {
+        outfile->Printf("\n");
+        outfile->Printf("        Stage blocks do not match this problem.  Starting from the guess.\n");
+        return;
+    }
+
+    double * x_p = x->pointer();
+    double * z_p = z->pointer();
+    long int ndqg = source->dimx_;
+    C_DCOPY(ndqg,source->x->pointer(),1,x_p,1);
+    C_DCOPY(ndqg,source->z->pointer(),1,z_p,1);
+    memset((void*)(x_p+ndqg),'\0',(dimx_-ndqg)*sizeof(double));
+    memset((void*)(z_p+ndqg),'\0',(dimx_-ndqg)*sizeof(double));
+    if ( spin_adapt_d2_ ) {
+        UnpackSpinAdaptedD2(x);
+    }
+
+    if ( constrain_t1_ ) {
+        T1_constraints_guess(x);
+    }
+    if ( constrain_t2_ ) {
+        T2_constraints_guess(x);
+    }
+
+    // keep the dual solution only if the stage rows are a leading section of ours
+    // (the two solvers split their rows over the ranks differently)
+    y->zero();
+    if ( source->nconstraints_ == constraint_offset_[FAMILY_T1] ) {
+        SharedSolverVector ysource = source->GatherRows(source->y);
+        long int end = ( row_end_ < source->nconstraints_ ) ? row_end_ : source->nconstraints_;
+        if ( end > row_begin_ ) {
+            C_DCOPY(end - row_begin_,ysource->pointer()+row_begin_,1,y->pointer(),1);
+        }
+    }
+
+    mu = source->mu;
+
+    outfile->Printf("        Lifted into the full problem (mu = %7.3lf)\n",mu);
+}
+
+}}
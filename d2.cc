@@ -57,19 +57,29 @@ namespace psi{ namespace v2rdm_casscf{
 
 
 // D2 portion of A^T.y ( and D1 / Q1 )
-void v2RDMSolver::D2_constraints_ATu(SharedVector A,SharedVector u){
-    double* A_p = A->pointer();
-    double* u_p = u->pointer();
+void v2RDMSolver::D2_constraints_ATu(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u,std::vector<v2RDMSolver*> & states){
+
+    int offset = constraint_offset_[FAMILY_D2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = A[v]->pointer();
+        u_p[v] = RowPointer(u[v]);
+    }
 
     if ( constrain_spin_ ) {
         // spin
-        for (int i = 0; i < amo_; i++){
-            for (int j = 0; j < amo_; j++){
-                int h = SymmetryPair(symmetry[i],symmetry[j]);
-                if ( gems_ab[h] == 0 ) continue;
-                int ij = ibas_ab_sym[h][i][j];
-                int ji = ibas_ab_sym[h][j][i];
-                A_p[d2aboff[h] + ij*gems_ab[h]+ji] += u_p[offset];
+        if ( RowsAreLocal(offset,1) ) {
+            for (int i = 0; i < amo_; i++){
+                for (int j = 0; j < amo_; j++){
+                    int h = SymmetryPair(symmetry[i],symmetry[j]);
+                    if ( gems_ab[h] == 0 ) continue;
+                    int ij = ibas_ab_sym[h][i][j];
+                    int ji = ibas_ab_sym[h][j][i];
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h] + ij*gems_ab[h]+ji] += u_p[v][offset];
+                }
             }
         }
         offset++;
@@ -77,301 +87,391 @@ void v2RDMSolver::D2_constraints_ATu(SharedVector A,SharedVector u){
 
     // Traces
     // Tr(D2ab)
-    for (int i = 0; i < amo_; i++){
-        for (int j = 0; j < amo_; j++){
-            int h = SymmetryPair(symmetry[i],symmetry[j]);
-            int ij = ibas_ab_sym[h][i][j];
-            if ( gems_ab[h] == 0 ) continue;
-            A_p[d2aboff[h] + ij*gems_ab[h]+ij] += u_p[offset];
+    if ( RowsAreLocal(offset,1) ) {
+        for (int i = 0; i < amo_; i++){
+            for (int j = 0; j < amo_; j++){
+                int h = SymmetryPair(symmetry[i],symmetry[j]);
+                int ij = ibas_ab_sym[h][i][j];
+                if ( gems_ab[h] == 0 ) continue;
+                for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h] + ij*gems_ab[h]+ij] += u_p[v][offset];
+            }
         }
     }
     offset++;
 
     // Tr(D2aa)
-    for (int i = 0; i < amo_; i++){
-        for (int j = 0; j < amo_; j++){
-            if ( i==j ) continue;
-            int h = SymmetryPair(symmetry[i],symmetry[j]);
-            if ( gems_aa[h] == 0 ) continue;
-            int ij = ibas_aa_sym[h][i][j];
-            A_p[d2aaoff[h]+ij*gems_aa[h]+ij] += u_p[offset];
+    if ( constrain_trace_aa_ ) {
+        if ( RowsAreLocal(offset,1) ) {
+            for (int i = 0; i < amo_; i++){
+                for (int j = 0; j < amo_; j++){
+                    if ( i==j ) continue;
+                    int h = SymmetryPair(symmetry[i],symmetry[j]);
+                    if ( gems_aa[h] == 0 ) continue;
+                    int ij = ibas_aa_sym[h][i][j];
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aaoff[h]+ij*gems_aa[h]+ij] += u_p[v][offset];
+                }
+            }
         }
+        offset++;
     }
-    offset++;
     // Tr(D2bb)
-    for (int i = 0; i < amo_; i++){
-        for (int j = 0; j < amo_; j++){
-            if ( i==j ) continue;
-            int h = SymmetryPair(symmetry[i],symmetry[j]);
-            if ( gems_aa[h] == 0 ) continue;
-            int ij = ibas_aa_sym[h][i][j];
-            A_p[d2bboff[h]+ij*gems_aa[h]+ij] += u_p[offset];
+    if ( constrain_trace_bb_ ) {
+        if ( RowsAreLocal(offset,1) ) {
+            for (int i = 0; i < amo_; i++){
+                for (int j = 0; j < amo_; j++){
+                    if ( i==j ) continue;
+                    int h = SymmetryPair(symmetry[i],symmetry[j]);
+                    if ( gems_aa[h] == 0 ) continue;
+                    int ij = ibas_aa_sym[h][i][j];
+                    for (int v = 0; v < nvec; v++) A_p[v][d2bboff[h]+ij*gems_aa[h]+ij] += u_p[v][offset];
+                }
+            }
         }
+        offset++;
     }
-    offset++;
 
     // d1 / q1 a
     for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                double dum = u_p[offset + i*amopi_[h]+j];
-                A_p[d1aoff[h] + j*amopi_[h]+i] += dum;
-                A_p[q1aoff[h] + i*amopi_[h]+j] += dum;
+        if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+            for(int i = 0; i < amopi_[h]; i++){
+                for(int j = 0; j < amopi_[h]; j++){
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v] = u_p[v][offset + i*amopi_[h]+j];
+                        A_p[v][d1aoff[h] + j*amopi_[h]+i] += dum[v];
+                        A_p[v][q1aoff[h] + i*amopi_[h]+j] += dum[v];
+                    }
+                }
             }
         }
         offset += amopi_[h]*amopi_[h];
     }
 
-    // d1 / q1 b
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                double dum = u_p[offset + i*amopi_[h]+j];
-                A_p[d1boff[h] + j*amopi_[h]+i] += dum;
-                A_p[q1boff[h] + i*amopi_[h]+j] += dum;
+    if ( !alias_beta_blocks_ ) {
+        // d1 / q1 b
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+                for(int i = 0; i < amopi_[h]; i++){
+                    for(int j = 0; j < amopi_[h]; j++){
+                        double dum[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v] = u_p[v][offset + i*amopi_[h]+j];
+                            A_p[v][d1boff[h] + j*amopi_[h]+i] += dum[v];
+                            A_p[v][q1boff[h] + i*amopi_[h]+j] += dum[v];
+                        }
+                    }
+                }
             }
+            offset += amopi_[h]*amopi_[h];
         }
-        offset += amopi_[h]*amopi_[h];
     }
 
-    int na = nalpha_ - nrstc_ - nfrzc_;
-    int nb = nbeta_ - nrstc_ - nfrzc_;
+    int na[MAX_BLOCK_VECTORS];
+    int nb[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        na[v] = states[v]->nalpha_ - nrstc_ - nfrzc_;
+        nb[v] = states[v]->nbeta_ - nrstc_ - nfrzc_;
+    }
 
     int poff = 0;
 
     // contraction: D2ab -> D1 a
     poff = 0;
     for (int h = 0; h < nirrep_; h++) {
-        for (int i = 0; i < amopi_[h]; i++){
-            for (int j = 0; j < amopi_[h]; j++){
-                A_p[d1aoff[h] + i*amopi_[h]+j] += nb * u_p[offset + i*amopi_[h]+j];
-                int ii = i + poff;
-                int jj = j + poff;
-                for (int k = 0; k < amo_; k++){
-                    int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik = ibas_ab_sym[h2][ii][k];
-                    int jk = ibas_ab_sym[h2][jj][k];
-                    A_p[d2aboff[h2] + ik*gems_ab[h2]+jk] -= u_p[offset + i*amopi_[h]+j];
+        if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+            for (int i = 0; i < amopi_[h]; i++){
+                for (int j = 0; j < amopi_[h]; j++){
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v] = D1ConstraintScale(i,j) * u_p[v][offset + D1ConstraintRow(h,i,j)];
+                        A_p[v][d1aoff[h] + i*amopi_[h]+j] += nb[v] * dum[v];
+                    }
+                    int ii = i + poff;
+                    int jj = j + poff;
+                    for (int k = 0; k < amo_; k++){
+                        int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
+                        int ik = ibas_ab_sym[h2][ii][k];
+                        int jk = ibas_ab_sym[h2][jj][k];
+                        for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ik*gems_ab[h2]+jk] -= dum[v];
+                    }
                 }
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        offset += D1ConstraintRows(h);
         poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
     // contraction: D2ab -> D1 b
     poff = 0;
     for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                A_p[d1boff[h] + i*amopi_[h]+j] += na * u_p[offset + i*amopi_[h]+j];
-                int ii = i + poff;
-                int jj = j + poff;
-                for(int k = 0; k < amo_; k++){
-                    int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik = ibas_ab_sym[h2][k][ii];
-                    int jk = ibas_ab_sym[h2][k][jj];
-                    A_p[d2aboff[h2] + ik*gems_ab[h2]+jk] -= u_p[offset + i*amopi_[h]+j];
+        if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+            for(int i = 0; i < amopi_[h]; i++){
+                for(int j = 0; j < amopi_[h]; j++){
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v] = D1ConstraintScale(i,j) * u_p[v][offset + D1ConstraintRow(h,i,j)];
+                        A_p[v][d1boff[h] + i*amopi_[h]+j] += na[v] * dum[v];
+                    }
+                    int ii = i + poff;
+                    int jj = j + poff;
+                    for(int k = 0; k < amo_; k++){
+                        int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
+                        int ik = ibas_ab_sym[h2][k][ii];
+                        int jk = ibas_ab_sym[h2][k][jj];
+                        for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ik*gems_ab[h2]+jk] -= dum[v];
+                    }
                 }
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        offset += D1ConstraintRows(h);
         poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
     //contract D2aa -> D1 a
     poff = 0;
     for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                A_p[d1aoff[h] + i*amopi_[h]+j] += (na - 1.0) * u_p[offset + i*amopi_[h]+j];
-                int ii = i + poff;
-                int jj = j + poff;
-                for(int k =0; k < amo_; k++){
-                    if( ii==k || jj==k )continue;
-                    int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik = ibas_aa_sym[h2][ii][k];
-                    int jk = ibas_aa_sym[h2][jj][k];
-                    int sik = ( ii < k ? 1 : -1);
-                    int sjk = ( jj < k ? 1 : -1);
-                    A_p[d2aaoff[h2] + ik*gems_aa[h2]+jk] -= sik*sjk*u_p[offset + i*amopi_[h]+j];
+        if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+            for(int i = 0; i < amopi_[h]; i++){
+                for(int j = 0; j < amopi_[h]; j++){
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v] = D1ConstraintScale(i,j) * u_p[v][offset + D1ConstraintRow(h,i,j)];
+                        A_p[v][d1aoff[h] + i*amopi_[h]+j] += (na[v] - 1.0) * dum[v];
+                    }
+                    int ii = i + poff;
+                    int jj = j + poff;
+                    for(int k =0; k < amo_; k++){
+                        if( ii==k || jj==k )continue;
+                        int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
+                        int ik = ibas_aa_sym[h2][ii][k];
+                        int jk = ibas_aa_sym[h2][jj][k];
+                        int sik = ( ii < k ? 1 : -1);
+                        int sjk = ( jj < k ? 1 : -1);
+                        for (int v = 0; v < nvec; v++) A_p[v][d2aaoff[h2] + ik*gems_aa[h2]+jk] -= sik*sjk*dum[v];
+                    }
                 }
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        offset += D1ConstraintRows(h);
         poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
-    //contract D2bb -> D1 b
-    poff = 0;
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                A_p[d1boff[h] + i*amopi_[h]+j] += (nb - 1.0) * u_p[offset + i*amopi_[h]+j];
-                int ii = i + poff;
-                int jj = j + poff;
-                for(int k =0; k < amo_; k++){
-                    if( ii==k || jj==k )continue;
-                    int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik = ibas_aa_sym[h2][ii][k];
-                    int jk = ibas_aa_sym[h2][jj][k];
-                    int sik = ( ii < k ? 1 : -1);
-                    int sjk = ( jj < k ? 1 : -1);
-                    A_p[d2bboff[h2] + ik*gems_aa[h2]+jk] -= sik*sjk*u_p[offset + i*amopi_[h]+j];
+    if ( !alias_beta_blocks_ ) {
+        //contract D2bb -> D1 b
+        poff = 0;
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+                for(int i = 0; i < amopi_[h]; i++){
+                    for(int j = 0; j < amopi_[h]; j++){
+                        double dum[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v] = D1ConstraintScale(i,j) * u_p[v][offset + D1ConstraintRow(h,i,j)];
+                            A_p[v][d1boff[h] + i*amopi_[h]+j] += (nb[v] - 1.0) * dum[v];
+                        }
+                        int ii = i + poff;
+                        int jj = j + poff;
+                        for(int k =0; k < amo_; k++){
+                            if( ii==k || jj==k )continue;
+                            int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
+                            int ik = ibas_aa_sym[h2][ii][k];
+                            int jk = ibas_aa_sym[h2][jj][k];
+                            int sik = ( ii < k ? 1 : -1);
+                            int sjk = ( jj < k ? 1 : -1);
+                            for (int v = 0; v < nvec; v++) A_p[v][d2bboff[h2] + ik*gems_aa[h2]+jk] -= sik*sjk*dum[v];
+                        }
+                    }
                 }
             }
+            offset += D1ConstraintRows(h);
+            poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
         }
-        offset += amopi_[h]*amopi_[h];
-        poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
 
     // additional spin constraints for singlets:
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        // D1a = D1b
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(amopi_[h]*amopi_[h], 1.0, u_p + offset, 1, A_p + d1aoff[h],1);
-            C_DAXPY(amopi_[h]*amopi_[h],-1.0, u_p + offset, 1, A_p + d1boff[h],1);
-            offset += amopi_[h]*amopi_[h];
-        }
-        // D2aa = D2bb
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(gems_aa[h]*gems_aa[h], 1.0, u_p + offset, 1, A_p + d2aaoff[h],1);
-            C_DAXPY(gems_aa[h]*gems_aa[h],-1.0, u_p + offset, 1, A_p + d2bboff[h],1);
-            offset += gems_aa[h]*gems_aa[h];
+        if ( !alias_beta_blocks_ ) {
+            // D1a = D1b
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+                    for (int v = 0; v < nvec; v++) {
+                        C_DAXPY(amopi_[h]*amopi_[h], 1.0, u_p[v] + offset, 1, A_p[v] + d1aoff[h],1);
+                        C_DAXPY(amopi_[h]*amopi_[h],-1.0, u_p[v] + offset, 1, A_p[v] + d1boff[h],1);
+                    }
+                }
+                offset += amopi_[h]*amopi_[h];
+            }
+            // D2aa = D2bb
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                    for (int v = 0; v < nvec; v++) {
+                        C_DAXPY(gems_aa[h]*gems_aa[h], 1.0, u_p[v] + offset, 1, A_p[v] + d2aaoff[h],1);
+                        C_DAXPY(gems_aa[h]*gems_aa[h],-1.0, u_p[v] + offset, 1, A_p[v] + d2bboff[h],1);
+                    }
+                }
+                offset += gems_aa[h]*gems_aa[h];
+            }
         }
-        // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(gems_aa[h]*gems_aa[h],1.0,u_p + offset,1,A_p + d2aaoff[h],1);
-            for (int ij = 0; ij < gems_aa[h]; ij++) {
-                int i = bas_aa_sym[h][ij][0]; 
-                int j = bas_aa_sym[h][ij][1];
-                int ijb = ibas_ab_sym[h][i][j];
-                int jib = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_aa[h]; kl++) {
-                    int k = bas_aa_sym[h][kl][0]; 
-                    int l = bas_aa_sym[h][kl][1];
-                    int klb = ibas_ab_sym[h][k][l];
-                    int lkb = ibas_ab_sym[h][l][k];
-                    A_p[d2aboff[h] + ijb*gems_ab[h] + klb] -= 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aboff[h] + jib*gems_ab[h] + klb] += 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aboff[h] + ijb*gems_ab[h] + lkb] += 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aboff[h] + jib*gems_ab[h] + lkb] -= 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                }   
+        if ( !spin_adapt_d2_ ) {
+            // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                    for (int v = 0; v < nvec; v++) C_DAXPY(gems_aa[h]*gems_aa[h],1.0,u_p[v] + offset,1,A_p[v] + d2aaoff[h],1);
+                    for (int ij = 0; ij < gems_aa[h]; ij++) {
+                        int i = bas_aa_sym[h][ij][0]; 
+                        int j = bas_aa_sym[h][ij][1];
+                        int ijb = ibas_ab_sym[h][i][j];
+                        int jib = ibas_ab_sym[h][j][i];
+                        for (int kl = 0; kl < gems_aa[h]; kl++) {
+                            int k = bas_aa_sym[h][kl][0]; 
+                            int l = bas_aa_sym[h][kl][1];
+                            int klb = ibas_ab_sym[h][k][l];
+                            int lkb = ibas_ab_sym[h][l][k];
+                            for (int v = 0; v < nvec; v++) {
+                                A_p[v][d2aboff[h] + ijb*gems_ab[h] + klb] -= 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                                A_p[v][d2aboff[h] + jib*gems_ab[h] + klb] += 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                                A_p[v][d2aboff[h] + ijb*gems_ab[h] + lkb] += 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                                A_p[v][d2aboff[h] + jib*gems_ab[h] + lkb] -= 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                            }
+                        }   
+                    }   
+                }
+                offset += gems_aa[h]*gems_aa[h];
             }   
-            offset += gems_aa[h]*gems_aa[h];
-        }   
-        // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(gems_aa[h]*gems_aa[h],1.0,u_p + offset,1,A_p + d2bboff[h],1);
-            for (int ij = 0; ij < gems_aa[h]; ij++) {
-                int i = bas_aa_sym[h][ij][0];
-                int j = bas_aa_sym[h][ij][1];
-                int ijb = ibas_ab_sym[h][i][j];
-                int jib = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_aa[h]; kl++) {
-                    int k = bas_aa_sym[h][kl][0];
-                    int l = bas_aa_sym[h][kl][1];
-                    int klb = ibas_ab_sym[h][k][l];
-                    int lkb = ibas_ab_sym[h][l][k];
-                    A_p[d2aboff[h] + ijb*gems_ab[h] + klb] -= 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aboff[h] + jib*gems_ab[h] + klb] += 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aboff[h] + ijb*gems_ab[h] + lkb] += 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aboff[h] + jib*gems_ab[h] + lkb] -= 0.5 * u_p[offset + ij*gems_aa[h] + kl];
-                }
-            }
-            offset += gems_aa[h]*gems_aa[h];
-        }
-        // D200 = 1/(2 sqrt(1+dpq)sqrt(1+drs)) ( D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr] )
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(gems_ab[h]*gems_ab[h],1.0,u_p + offset,1,A_p + d200off[h],1);
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                double dij = ( i == j ) ? sqrt(2.0) : 1.0;
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*gems_ab[h] + kl];
-                }
-            }
-            offset += gems_ab[h]*gems_ab[h];
+        }
+        if ( !alias_beta_blocks_ ) {
+            // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                    for (int v = 0; v < nvec; v++) C_DAXPY(gems_aa[h]*gems_aa[h],1.0,u_p[v] + offset,1,A_p[v] + d2bboff[h],1);
+                    for (int ij = 0; ij < gems_aa[h]; ij++) {
+                        int i = bas_aa_sym[h][ij][0];
+                        int j = bas_aa_sym[h][ij][1];
+                        int ijb = ibas_ab_sym[h][i][j];
+                        int jib = ibas_ab_sym[h][j][i];
+                        for (int kl = 0; kl < gems_aa[h]; kl++) {
+                            int k = bas_aa_sym[h][kl][0];
+                            int l = bas_aa_sym[h][kl][1];
+                            int klb = ibas_ab_sym[h][k][l];
+                            int lkb = ibas_ab_sym[h][l][k];
+                            for (int v = 0; v < nvec; v++) {
+                                A_p[v][d2aboff[h] + ijb*gems_ab[h] + klb] -= 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                                A_p[v][d2aboff[h] + jib*gems_ab[h] + klb] += 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                                A_p[v][d2aboff[h] + ijb*gems_ab[h] + lkb] += 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                                A_p[v][d2aboff[h] + jib*gems_ab[h] + lkb] -= 0.5 * u_p[v][offset + ij*gems_aa[h] + kl];
+                            }
+                        }
+                    }
+                }
+                offset += gems_aa[h]*gems_aa[h];
+            }
+        }
+        if ( !spin_adapt_d2_ ) {
+            // D200 = 1/(2 sqrt(1+dpq)sqrt(1+drs)) ( D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr] )
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+                    for (int v = 0; v < nvec; v++) C_DAXPY(gems_ab[h]*gems_ab[h],1.0,u_p[v] + offset,1,A_p[v] + d200off[h],1);
+                    for (int ij = 0; ij < gems_ab[h]; ij++) {
+                        int i = bas_ab_sym[h][ij][0];
+                        int j = bas_ab_sym[h][ij][1];
+                        int ji = ibas_ab_sym[h][j][i];
+                        double dij = ( i == j ) ? sqrt(2.0) : 1.0;
+                        for (int kl = 0; kl < gems_ab[h]; kl++) {
+                            int k = bas_ab_sym[h][kl][0];
+                            int l = bas_ab_sym[h][kl][1];
+                            int lk = ibas_ab_sym[h][l][k];
+                            double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
+                            for (int v = 0; v < nvec; v++) {
+                                A_p[v][d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*gems_ab[h] + kl];
+                                A_p[v][d2aboff[h] + ji*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*gems_ab[h] + kl];
+                                A_p[v][d2aboff[h] + ij*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*gems_ab[h] + kl];
+                                A_p[v][d2aboff[h] + ji*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*gems_ab[h] + kl];
+                            }
+                        }
+                    }
+                }
+                offset += gems_ab[h]*gems_ab[h];
+            }
         }
     }else if ( constrain_spin_ ) { // nonsinglets ... big block
 
         for ( int h = 0; h < nirrep_; h++) {
             // D200
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                double dij = ( i == j ) ? sqrt(2.0) : 1.0;
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
-                    A_p[d200off[h] + ij*2*gems_ab[h] + kl] += u_p[offset + ij*2*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*2*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*2*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*2*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[offset + ij*2*gems_ab[h] + kl];
-                }
-            }
-            // D201
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                double dij = ( i == j ) ? sqrt(2.0) : 1.0;
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    A_p[d200off[h] + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / dij * u_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + lk] += 0.5 / dij * u_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + kl] -= 0.5 / dij * u_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + lk] += 0.5 / dij * u_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
-                }
-            }
-            // D210
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
-                    A_p[d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / dkl * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + lk] -= 0.5 / dkl * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + kl] += 0.5 / dkl * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + lk] += 0.5 / dkl * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
-                }
-            }
-            // D211
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    A_p[d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + kl] += 0.5 * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + lk] += 0.5 * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[d2aboff[h] + ji*gems_ab[h] + lk] -= 0.5 * u_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+            if ( RowsAreLocal(offset,4*gems_ab[h]*gems_ab[h]) ) {
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    double dij = ( i == j ) ? sqrt(2.0) : 1.0;
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d200off[h] + ij*2*gems_ab[h] + kl] += u_p[v][offset + ij*2*gems_ab[h] + kl];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*2*gems_ab[h] + kl];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*2*gems_ab[h] + kl];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*2*gems_ab[h] + kl];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + lk] -= 0.5 / ( dij * dkl ) * u_p[v][offset + ij*2*gems_ab[h] + kl];
+                        }
+                    }
+                }
+                // D201
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    double dij = ( i == j ) ? sqrt(2.0) : 1.0;
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d200off[h] + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / dij * u_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + lk] += 0.5 / dij * u_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + kl] -= 0.5 / dij * u_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + lk] += 0.5 / dij * u_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
+                        }
+                    }
+                }
+                // D210
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 / dkl * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + lk] -= 0.5 / dkl * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + kl] += 0.5 / dkl * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + lk] += 0.5 / dkl * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
+                        }
+                    }
+                }
+                // D211
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + kl] -= 0.5 * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + kl] += 0.5 * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ij*gems_ab[h] + lk] += 0.5 * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][d2aboff[h] + ji*gems_ab[h] + lk] -= 0.5 * u_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+                        }
+                    }
                 }
             }
             offset += 4*gems_ab[h]*gems_ab[h];
@@ -381,94 +481,126 @@ void v2RDMSolver::D2_constraints_ATu(SharedVector A,SharedVector u){
 }
 
 // D2 portion of A.x (and D1/Q1)
-void v2RDMSolver::D2_constraints_Au(SharedVector A,SharedVector u){
+void v2RDMSolver::D2_constraints_Au(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u,std::vector<v2RDMSolver*> & states){
 
-    double* A_p = A->pointer();
-    double* u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_D2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = RowPointer(A[v]);
+        u_p[v] = u[v]->pointer();
+    }
 
     if ( constrain_spin_ ) {
         // spin
-        double s2 = 0.0;
-        for (int i = 0; i < amo_; i++){
-            for (int j = 0; j < amo_; j++){
-                int h = SymmetryPair(symmetry[i],symmetry[j]);
-                if ( gems_ab[h] == 0 ) continue;
-                int ij = ibas_ab_sym[h][i][j];
-                int ji = ibas_ab_sym[h][j][i];
-                s2 += u_p[d2aboff[h] + ij*gems_ab[h]+ji];
+        double s2[MAX_BLOCK_VECTORS];
+        for (int v = 0; v < nvec; v++) s2[v] = 0.0;
+        if ( RowsAreLocal(offset,1) ) {
+            for (int i = 0; i < amo_; i++){
+                for (int j = 0; j < amo_; j++){
+                    int h = SymmetryPair(symmetry[i],symmetry[j]);
+                    if ( gems_ab[h] == 0 ) continue;
+                    int ij = ibas_ab_sym[h][i][j];
+                    int ji = ibas_ab_sym[h][j][i];
+                    for (int v = 0; v < nvec; v++) s2[v] += u_p[v][d2aboff[h] + ij*gems_ab[h]+ji];
+                }
             }
+            for (int v = 0; v < nvec; v++) A_p[v][offset] = s2[v];
         }
-        A_p[offset] = s2;
         offset++;
     }
 
     // Traces
     // Tr(D2ab)
-    double sumab =0.0;
-    for (int i = 0; i < amo_; i++){
-        for (int j = 0; j < amo_; j++){
-            int h = SymmetryPair(symmetry[i],symmetry[j]);
-            if ( gems_ab[h] == 0 ) continue;
-            int ij = ibas_ab_sym[h][i][j];
-            sumab += u_p[d2aboff[h] + ij*gems_ab[h]+ij];
+    double sumab[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) sumab[v] =0.0;
+    if ( RowsAreLocal(offset,1) ) {
+        for (int i = 0; i < amo_; i++){
+            for (int j = 0; j < amo_; j++){
+                int h = SymmetryPair(symmetry[i],symmetry[j]);
+                if ( gems_ab[h] == 0 ) continue;
+                int ij = ibas_ab_sym[h][i][j];
+                for (int v = 0; v < nvec; v++) sumab[v] += u_p[v][d2aboff[h] + ij*gems_ab[h]+ij];
+            }
         }
+        for (int v = 0; v < nvec; v++) A_p[v][offset] = sumab[v];
     }
-    A_p[offset] = sumab;
     offset++;
 
     // Tr(D2aa)
-    double sumaa =0.0;
-    for (int i = 0; i < amo_; i++){
-        for (int j = 0; j < amo_; j++){
-            if ( i==j ) continue;
-            int h = SymmetryPair(symmetry[i],symmetry[j]);
-            if ( gems_aa[h] == 0 ) continue;
-            int ij = ibas_aa_sym[h][i][j];
-            sumaa += u_p[d2aaoff[h] + ij*gems_aa[h]+ij];
-        }
+    if ( constrain_trace_aa_ ) {
+        double sumaa[MAX_BLOCK_VECTORS];
+        for (int v = 0; v < nvec; v++) sumaa[v] =0.0;
+        if ( RowsAreLocal(offset,1) ) {
+            for (int i = 0; i < amo_; i++){
+                for (int j = 0; j < amo_; j++){
+                    if ( i==j ) continue;
+                    int h = SymmetryPair(symmetry[i],symmetry[j]);
+                    if ( gems_aa[h] == 0 ) continue;
+                    int ij = ibas_aa_sym[h][i][j];
+                    for (int v = 0; v < nvec; v++) sumaa[v] += u_p[v][d2aaoff[h] + ij*gems_aa[h]+ij];
+                }
 
+            }
+            for (int v = 0; v < nvec; v++) A_p[v][offset] = sumaa[v];
+        }
+        offset++;
     }
-    A_p[offset] = sumaa;
-    offset++;
 
     // Tr(D2bb)
-    double sumbb =0.0;
-    for (int i = 0; i < amo_; i++){
-        for (int j = 0; j < amo_; j++){
-            if ( i==j ) continue;
-            int h = SymmetryPair(symmetry[i],symmetry[j]);
-            if ( gems_aa[h] == 0 ) continue;
-            int ij = ibas_aa_sym[h][i][j];
-            sumbb += u_p[d2bboff[h] + ij*gems_aa[h]+ij];
-        }
+    if ( constrain_trace_bb_ ) {
+        double sumbb[MAX_BLOCK_VECTORS];
+        for (int v = 0; v < nvec; v++) sumbb[v] =0.0;
+        if ( RowsAreLocal(offset,1) ) {
+            for (int i = 0; i < amo_; i++){
+                for (int j = 0; j < amo_; j++){
+                    if ( i==j ) continue;
+                    int h = SymmetryPair(symmetry[i],symmetry[j]);
+                    if ( gems_aa[h] == 0 ) continue;
+                    int ij = ibas_aa_sym[h][i][j];
+                    for (int v = 0; v < nvec; v++) sumbb[v] += u_p[v][d2bboff[h] + ij*gems_aa[h]+ij];
+                }
 
+            }
+            for (int v = 0; v < nvec; v++) A_p[v][offset] = sumbb[v];
+        }
+        offset++;
     }
-    A_p[offset] = sumbb;
-    offset++;
 
     // d1 / q1 a
     for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                A_p[offset+i*amopi_[h]+j] = u_p[d1aoff[h]+j*amopi_[h]+i] + u_p[q1aoff[h]+i*amopi_[h]+j];
+        if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+            for(int i = 0; i < amopi_[h]; i++){
+                for(int j = 0; j < amopi_[h]; j++){
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + i*amopi_[h]+j] = u_p[v][d1aoff[h]+j*amopi_[h]+i] + u_p[v][q1aoff[h]+i*amopi_[h]+j];
+                }
             }
         }
         offset += amopi_[h]*amopi_[h];
     }
 
-    // d1 / q1 b
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                A_p[offset+i*amopi_[h]+j] = u_p[d1boff[h]+j*amopi_[h]+i] + u_p[q1boff[h]+i*amopi_[h]+j];
+    if ( !alias_beta_blocks_ ) {
+        // d1 / q1 b
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+                for(int i = 0; i < amopi_[h]; i++){
+                    for(int j = 0; j < amopi_[h]; j++){
+                        for (int v = 0; v < nvec; v++) A_p[v][offset + i*amopi_[h]+j] = u_p[v][d1boff[h]+j*amopi_[h]+i] + u_p[v][q1boff[h]+i*amopi_[h]+j];
+                    }
+                }
             }
+            offset += amopi_[h]*amopi_[h];
         }
-        offset += amopi_[h]*amopi_[h];
     }
 
-    int na = nalpha_ - nrstc_ - nfrzc_;
-    int nb = nbeta_ - nrstc_ - nfrzc_;
-    double n = na + nb;
+    int na[MAX_BLOCK_VECTORS];
+    int nb[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        na[v] = states[v]->nalpha_ - nrstc_ - nfrzc_;
+        nb[v] = states[v]->nbeta_ - nrstc_ - nfrzc_;
+    }
 
     // contraction: D2aa + D2ab -> D1 a
     int poff = 0;
@@ -476,239 +608,295 @@ void v2RDMSolver::D2_constraints_Au(SharedVector A,SharedVector u){
     // contraction: D2ab -> D1 a
     poff = 0;
     for (int h = 0; h < nirrep_; h++) {
-        for (int i = 0; i < amopi_[h]; i++){
-            for (int j = 0; j < amopi_[h]; j++){
-                double sum = nb * u_p[d1aoff[h] + i*amopi_[h]+j];
-                int ii  = i + poff;
-                int jj  = j + poff;
-                for(int k = 0; k < amo_; k++){
-                    int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik = ibas_ab_sym[h2][ii][k];
-                    int jk = ibas_ab_sym[h2][jj][k];
-                    sum -= u_p[d2aboff[h2] + ik*gems_ab[h2]+jk];
+        if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+            for (int v = 0; v < nvec; v++) memset((void*)(A_p[v]+offset),'\0',D1ConstraintRows(h)*sizeof(double));
+            for (int i = 0; i < amopi_[h]; i++){
+                for (int j = 0; j < amopi_[h]; j++){
+                    double sum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) sum[v] = nb[v] * u_p[v][d1aoff[h] + i*amopi_[h]+j];
+                    int ii  = i + poff;
+                    int jj  = j + poff;
+                    for(int k = 0; k < amo_; k++){
+                        int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
+                        int ik = ibas_ab_sym[h2][ii][k];
+                        int jk = ibas_ab_sym[h2][jj][k];
+                        for (int v = 0; v < nvec; v++) sum[v] -= u_p[v][d2aboff[h2] + ik*gems_ab[h2]+jk];
+                    }
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + D1ConstraintRow(h,i,j)] += D1ConstraintScale(i,j) * sum[v];
                 }
-                A_p[offset + i*amopi_[h]+j] = sum;
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        offset += D1ConstraintRows(h);
         poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
     // contraction: D2ab -> D1 b
     poff = 0;
     for (int h = 0; h < nirrep_; h++) {
-        for (int i = 0; i < amopi_[h]; i++){
-            for (int j = 0; j < amopi_[h]; j++){
-                double sum = na * u_p[d1boff[h] + i*amopi_[h]+j];
-                int ii  = i + poff;
-                int jj  = j + poff;
-                for(int k = 0; k < amo_; k++){
-                    int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik = ibas_ab_sym[h2][k][ii];
-                    int jk = ibas_ab_sym[h2][k][jj];
-                    sum -= u_p[d2aboff[h2] + ik*gems_ab[h2]+jk];
+        if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+            for (int v = 0; v < nvec; v++) memset((void*)(A_p[v]+offset),'\0',D1ConstraintRows(h)*sizeof(double));
+            for (int i = 0; i < amopi_[h]; i++){
+                for (int j = 0; j < amopi_[h]; j++){
+                    double sum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) sum[v] = na[v] * u_p[v][d1boff[h] + i*amopi_[h]+j];
+                    int ii  = i + poff;
+                    int jj  = j + poff;
+                    for(int k = 0; k < amo_; k++){
+                        int h2  = SymmetryPair(symmetry[ii],symmetry[k]);
+                        int ik = ibas_ab_sym[h2][k][ii];
+                        int jk = ibas_ab_sym[h2][k][jj];
+                        for (int v = 0; v < nvec; v++) sum[v] -= u_p[v][d2aboff[h2] + ik*gems_ab[h2]+jk];
+                    }
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + D1ConstraintRow(h,i,j)] += D1ConstraintScale(i,j) * sum[v];
                 }
-                A_p[offset + i*amopi_[h]+j] = sum;
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        offset += D1ConstraintRows(h);
         poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
     //contract D2aa -> D1 a
     poff = 0;
     for (int h = 0; h < nirrep_; h++) {
-        for (int i = 0; i < amopi_[h]; i++){
-            for (int j = 0; j < amopi_[h]; j++){
-                double sum = (na - 1.0) * u_p[d1aoff[h] + i*amopi_[h]+j];
-                int ii  = i + poff;
-                int jj  = j + poff;
-                for(int k = 0; k < amo_; k++){
-                    if( ii==k || jj==k ) continue;
-                    int h2   = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik  = ibas_aa_sym[h2][ii][k];
-                    int jk  = ibas_aa_sym[h2][jj][k];
-                    int sik = ( ii < k ) ? 1 : -1;
-                    int sjk = ( jj < k ) ? 1 : -1;
-                    sum -= sik*sjk*u_p[d2aaoff[h2] + ik*gems_aa[h2]+jk];
-                }
-                A_p[offset+i*amopi_[h]+j] = sum;
+        if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+            for (int v = 0; v < nvec; v++) memset((void*)(A_p[v]+offset),'\0',D1ConstraintRows(h)*sizeof(double));
+            for (int i = 0; i < amopi_[h]; i++){
+                for (int j = 0; j < amopi_[h]; j++){
+                    double sum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) sum[v] = (na[v] - 1.0) * u_p[v][d1aoff[h] + i*amopi_[h]+j];
+                    int ii  = i + poff;
+                    int jj  = j + poff;
+                    for(int k = 0; k < amo_; k++){
+                        if( ii==k || jj==k ) continue;
+                        int h2   = SymmetryPair(symmetry[ii],symmetry[k]);
+                        int ik  = ibas_aa_sym[h2][ii][k];
+                        int jk  = ibas_aa_sym[h2][jj][k];
+                        int sik = ( ii < k ) ? 1 : -1;
+                        int sjk = ( jj < k ) ? 1 : -1;
+                        for (int v = 0; v < nvec; v++) sum[v] -= sik*sjk*u_p[v][d2aaoff[h2] + ik*gems_aa[h2]+jk];
+                    }
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + D1ConstraintRow(h,i,j)] += D1ConstraintScale(i,j) * sum[v];
+                }
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        offset += D1ConstraintRows(h);
         poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
-    //contract D2bb -> D1 b
-    poff = 0;
-    for (int h = 0; h < nirrep_; h++) {
-        for (int i = 0; i < amopi_[h]; i++){
-            for (int j = 0; j < amopi_[h]; j++){
-                double sum = (nb - 1.0) * u_p[d1boff[h] + i*amopi_[h]+j];
-                int ii  = i + poff;
-                int jj  = j + poff;
-                for(int k = 0; k < amo_; k++){
-                    if( ii==k || jj==k ) continue;
-                    int h2   = SymmetryPair(symmetry[ii],symmetry[k]);
-                    int ik  = ibas_aa_sym[h2][ii][k];
-                    int jk  = ibas_aa_sym[h2][jj][k];
-                    int sik = ( ii < k ) ? 1 : -1;
-                    int sjk = ( jj < k ) ? 1 : -1;
-                    sum -= sik*sjk*u_p[d2bboff[h2] + ik*gems_aa[h2]+jk];
-                }
-                A_p[offset+i*amopi_[h]+j] = sum;
+    if ( !alias_beta_blocks_ ) {
+        //contract D2bb -> D1 b
+        poff = 0;
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,D1ConstraintRows(h)) ) {
+                for (int v = 0; v < nvec; v++) memset((void*)(A_p[v]+offset),'\0',D1ConstraintRows(h)*sizeof(double));
+                for (int i = 0; i < amopi_[h]; i++){
+                    for (int j = 0; j < amopi_[h]; j++){
+                        double sum[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) sum[v] = (nb[v] - 1.0) * u_p[v][d1boff[h] + i*amopi_[h]+j];
+                        int ii  = i + poff;
+                        int jj  = j + poff;
+                        for(int k = 0; k < amo_; k++){
+                            if( ii==k || jj==k ) continue;
+                            int h2   = SymmetryPair(symmetry[ii],symmetry[k]);
+                            int ik  = ibas_aa_sym[h2][ii][k];
+                            int jk  = ibas_aa_sym[h2][jj][k];
+                            int sik = ( ii < k ) ? 1 : -1;
+                            int sjk = ( jj < k ) ? 1 : -1;
+                            for (int v = 0; v < nvec; v++) sum[v] -= sik*sjk*u_p[v][d2bboff[h2] + ik*gems_aa[h2]+jk];
+                        }
+                        for (int v = 0; v < nvec; v++) A_p[v][offset + D1ConstraintRow(h,i,j)] += D1ConstraintScale(i,j) * sum[v];
+                    }
+                }
             }
+            offset += D1ConstraintRows(h);
+            poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
         }
-        offset += amopi_[h]*amopi_[h];
-        poff   += nmopi_[h] - rstcpi_[h] - frzcpi_[h] - rstvpi_[h] - frzvpi_[h];
     }
 
     // additional spin constraints for singlets:
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        // D1a = D1b
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(amopi_[h]*amopi_[h],     u_p + d1aoff[h],1,A_p + offset,1);
-            C_DAXPY(amopi_[h]*amopi_[h],-1.0,u_p + d1boff[h],1,A_p + offset,1);
-            offset += amopi_[h]*amopi_[h]; 
+        if ( !alias_beta_blocks_ ) {
+            // D1a = D1b
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+                    for (int v = 0; v < nvec; v++) {
+                        C_DCOPY(amopi_[h]*amopi_[h],     u_p[v] + d1aoff[h],1,A_p[v] + offset,1);
+                        C_DAXPY(amopi_[h]*amopi_[h],-1.0,u_p[v] + d1boff[h],1,A_p[v] + offset,1);
+                    }
+                }
+                offset += amopi_[h]*amopi_[h]; 
+            }
+            // D2aa = D2bb
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                    for (int v = 0; v < nvec; v++) {
+                        C_DCOPY(gems_aa[h]*gems_aa[h],     u_p[v] + d2aaoff[h],1,A_p[v] + offset,1);
+                        C_DAXPY(gems_aa[h]*gems_aa[h],-1.0,u_p[v] + d2bboff[h],1,A_p[v] + offset,1);
+                    }
+                }
+                offset += gems_aa[h]*gems_aa[h];
+            }
         }
-        // D2aa = D2bb
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(gems_aa[h]*gems_aa[h],     u_p + d2aaoff[h],1,A_p + offset,1);
-            C_DAXPY(gems_aa[h]*gems_aa[h],-1.0,u_p + d2bboff[h],1,A_p + offset,1);
-            offset += gems_aa[h]*gems_aa[h];
+        if ( !spin_adapt_d2_ ) {
+            // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                    for (int v = 0; v < nvec; v++) C_DCOPY(gems_aa[h]*gems_aa[h],u_p[v] + d2aaoff[h],1,A_p[v] + offset,1);
+                    for (int ij = 0; ij < gems_aa[h]; ij++) {
+                        int i = bas_aa_sym[h][ij][0];
+                        int j = bas_aa_sym[h][ij][1];
+                        int ijb = ibas_ab_sym[h][i][j];
+                        int jib = ibas_ab_sym[h][j][i];
+                        for (int kl = 0; kl < gems_aa[h]; kl++) {
+                            int k = bas_aa_sym[h][kl][0];
+                            int l = bas_aa_sym[h][kl][1];
+                            int klb = ibas_ab_sym[h][k][l];
+                            int lkb = ibas_ab_sym[h][l][k];
+                            for (int v = 0; v < nvec; v++) {
+                                A_p[v][offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[v][d2aboff[h] + ijb*gems_ab[h] + klb];
+                                A_p[v][offset + ij*gems_aa[h] + kl] += 0.5 * u_p[v][d2aboff[h] + jib*gems_ab[h] + klb];
+                                A_p[v][offset + ij*gems_aa[h] + kl] += 0.5 * u_p[v][d2aboff[h] + ijb*gems_ab[h] + lkb];
+                                A_p[v][offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[v][d2aboff[h] + jib*gems_ab[h] + lkb];
+                            }
+                        }
+                    }
+                }
+                offset += gems_aa[h]*gems_aa[h];
+            }
         }
-        // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(gems_aa[h]*gems_aa[h],u_p + d2aaoff[h],1,A_p + offset,1);
-            for (int ij = 0; ij < gems_aa[h]; ij++) {
-                int i = bas_aa_sym[h][ij][0];
-                int j = bas_aa_sym[h][ij][1];
-                int ijb = ibas_ab_sym[h][i][j];
-                int jib = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_aa[h]; kl++) {
-                    int k = bas_aa_sym[h][kl][0];
-                    int l = bas_aa_sym[h][kl][1];
-                    int klb = ibas_ab_sym[h][k][l];
-                    int lkb = ibas_ab_sym[h][l][k];
-                    A_p[offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[d2aboff[h] + ijb*gems_ab[h] + klb];
-                    A_p[offset + ij*gems_aa[h] + kl] += 0.5 * u_p[d2aboff[h] + jib*gems_ab[h] + klb];
-                    A_p[offset + ij*gems_aa[h] + kl] += 0.5 * u_p[d2aboff[h] + ijb*gems_ab[h] + lkb];
-                    A_p[offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[d2aboff[h] + jib*gems_ab[h] + lkb];
-                }
-            }
-            offset += gems_aa[h]*gems_aa[h];
-        }
-        // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(gems_aa[h]*gems_aa[h],u_p + d2bboff[h],1,A_p + offset,1);
-            for (int ij = 0; ij < gems_aa[h]; ij++) {
-                int i = bas_aa_sym[h][ij][0];
-                int j = bas_aa_sym[h][ij][1];
-                int ijb = ibas_ab_sym[h][i][j];
-                int jib = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_aa[h]; kl++) {
-                    int k = bas_aa_sym[h][kl][0];
-                    int l = bas_aa_sym[h][kl][1];
-                    int klb = ibas_ab_sym[h][k][l];
-                    int lkb = ibas_ab_sym[h][l][k];
-                    A_p[offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[d2aboff[h] + ijb*gems_ab[h] + klb];
-                    A_p[offset + ij*gems_aa[h] + kl] += 0.5 * u_p[d2aboff[h] + jib*gems_ab[h] + klb];
-                    A_p[offset + ij*gems_aa[h] + kl] += 0.5 * u_p[d2aboff[h] + ijb*gems_ab[h] + lkb];
-                    A_p[offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[d2aboff[h] + jib*gems_ab[h] + lkb];
-                }
-            }
-            offset += gems_aa[h]*gems_aa[h];
-        }
-        // D200 = 1/(2 sqrt(1+dpq)sqrt(1+drs)) ( D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr] )
-        for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(gems_ab[h]*gems_ab[h],u_p + d200off[h],1,A_p + offset,1);
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                double dij = ( i == j ) ? sqrt(2.0) : 1.0;
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
-                    A_p[offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    A_p[offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ji*gems_ab[h] + kl];
-                    A_p[offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ij*gems_ab[h] + lk];
-                    A_p[offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ji*gems_ab[h] + lk];
-                }
-            }
-            offset += gems_ab[h]*gems_ab[h];
+        if ( !alias_beta_blocks_ ) {
+            // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                    for (int v = 0; v < nvec; v++) C_DCOPY(gems_aa[h]*gems_aa[h],u_p[v] + d2bboff[h],1,A_p[v] + offset,1);
+                    for (int ij = 0; ij < gems_aa[h]; ij++) {
+                        int i = bas_aa_sym[h][ij][0];
+                        int j = bas_aa_sym[h][ij][1];
+                        int ijb = ibas_ab_sym[h][i][j];
+                        int jib = ibas_ab_sym[h][j][i];
+                        for (int kl = 0; kl < gems_aa[h]; kl++) {
+                            int k = bas_aa_sym[h][kl][0];
+                            int l = bas_aa_sym[h][kl][1];
+                            int klb = ibas_ab_sym[h][k][l];
+                            int lkb = ibas_ab_sym[h][l][k];
+                            for (int v = 0; v < nvec; v++) {
+                                A_p[v][offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[v][d2aboff[h] + ijb*gems_ab[h] + klb];
+                                A_p[v][offset + ij*gems_aa[h] + kl] += 0.5 * u_p[v][d2aboff[h] + jib*gems_ab[h] + klb];
+                                A_p[v][offset + ij*gems_aa[h] + kl] += 0.5 * u_p[v][d2aboff[h] + ijb*gems_ab[h] + lkb];
+                                A_p[v][offset + ij*gems_aa[h] + kl] -= 0.5 * u_p[v][d2aboff[h] + jib*gems_ab[h] + lkb];
+                            }
+                        }
+                    }
+                }
+                offset += gems_aa[h]*gems_aa[h];
+            }
+        }
+        if ( !spin_adapt_d2_ ) {
+            // D200 = 1/(2 sqrt(1+dpq)sqrt(1+drs)) ( D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr] )
+            for ( int h = 0; h < nirrep_; h++) {
+                if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+                    for (int v = 0; v < nvec; v++) C_DCOPY(gems_ab[h]*gems_ab[h],u_p[v] + d200off[h],1,A_p[v] + offset,1);
+                    for (int ij = 0; ij < gems_ab[h]; ij++) {
+                        int i = bas_ab_sym[h][ij][0];
+                        int j = bas_ab_sym[h][ij][1];
+                        int ji = ibas_ab_sym[h][j][i];
+                        double dij = ( i == j ) ? sqrt(2.0) : 1.0;
+                        for (int kl = 0; kl < gems_ab[h]; kl++) {
+                            int k = bas_ab_sym[h][kl][0];
+                            int l = bas_ab_sym[h][kl][1];
+                            int lk = ibas_ab_sym[h][l][k];
+                            double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
+                            for (int v = 0; v < nvec; v++) {
+                                A_p[v][offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ij*gems_ab[h] + kl];
+                                A_p[v][offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ji*gems_ab[h] + kl];
+                                A_p[v][offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ij*gems_ab[h] + lk];
+                                A_p[v][offset + ij*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ji*gems_ab[h] + lk];
+                            }
+                        }
+                    }
+                }
+                offset += gems_ab[h]*gems_ab[h];
+            }
         }
     }else if ( constrain_spin_ ) { // nonsinglets ... big block
 
         for ( int h = 0; h < nirrep_; h++) {
             // D200
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                double dij = ( i == j ) ? sqrt(2.0) : 1.0;
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
-                    A_p[offset + ij*2*gems_ab[h] + kl] += u_p[d200off[h] + ij*2*gems_ab[h] + kl];
-                    A_p[offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    A_p[offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ji*gems_ab[h] + kl];
-                    A_p[offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ij*gems_ab[h] + lk];
-                    A_p[offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[d2aboff[h] + ji*gems_ab[h] + lk];
-                }
-            }
-            // D201
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                double dij = ( i == j ) ? sqrt(2.0) : 1.0;
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    A_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[d200off[h] + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 / dij * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    A_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 / dij * u_p[d2aboff[h] + ij*gems_ab[h] + lk];
-                    A_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 / dij * u_p[d2aboff[h] + ji*gems_ab[h] + kl];
-                    A_p[offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 / dij * u_p[d2aboff[h] + ji*gems_ab[h] + lk];
-                }
-            }
-            // D210
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += u_p[d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] -= 0.5 / dkl * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] -= 0.5 / dkl * u_p[d2aboff[h] + ij*gems_ab[h] + lk];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += 0.5 / dkl * u_p[d2aboff[h] + ji*gems_ab[h] + kl];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += 0.5 / dkl * u_p[d2aboff[h] + ji*gems_ab[h] + lk];
-                }
-            }
-            // D211
-            for (int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                int ji = ibas_ab_sym[h][j][i];
-                for (int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    int lk = ibas_ab_sym[h][l][k];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 * u_p[d2aboff[h] + ji*gems_ab[h] + kl];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 * u_p[d2aboff[h] + ij*gems_ab[h] + lk];
-                    A_p[offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 * u_p[d2aboff[h] + ji*gems_ab[h] + lk];
+            if ( RowsAreLocal(offset,4*gems_ab[h]*gems_ab[h]) ) {
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    double dij = ( i == j ) ? sqrt(2.0) : 1.0;
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][offset + ij*2*gems_ab[h] + kl] += u_p[v][d200off[h] + ij*2*gems_ab[h] + kl];
+                            A_p[v][offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ij*gems_ab[h] + kl];
+                            A_p[v][offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ji*gems_ab[h] + kl];
+                            A_p[v][offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ij*gems_ab[h] + lk];
+                            A_p[v][offset + ij*2*gems_ab[h] + kl] -= 0.5 / ( dij * dkl ) * u_p[v][d2aboff[h] + ji*gems_ab[h] + lk];
+                        }
+                    }
+                }
+                // D201
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    double dij = ( i == j ) ? sqrt(2.0) : 1.0;
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[v][d200off[h] + (ij)*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 / dij * u_p[v][d2aboff[h] + ij*gems_ab[h] + kl];
+                            A_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 / dij * u_p[v][d2aboff[h] + ij*gems_ab[h] + lk];
+                            A_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 / dij * u_p[v][d2aboff[h] + ji*gems_ab[h] + kl];
+                            A_p[v][offset + (ij)*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 / dij * u_p[v][d2aboff[h] + ji*gems_ab[h] + lk];
+                        }
+                    }
+                }
+                // D210
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        double dkl = ( k == l ) ? sqrt(2.0) : 1.0;
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += u_p[v][d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl)];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] -= 0.5 / dkl * u_p[v][d2aboff[h] + ij*gems_ab[h] + kl];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] -= 0.5 / dkl * u_p[v][d2aboff[h] + ij*gems_ab[h] + lk];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += 0.5 / dkl * u_p[v][d2aboff[h] + ji*gems_ab[h] + kl];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl)] += 0.5 / dkl * u_p[v][d2aboff[h] + ji*gems_ab[h] + lk];
+                        }
+                    }
+                }
+                // D211
+                for (int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    int ji = ibas_ab_sym[h][j][i];
+                    for (int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        int lk = ibas_ab_sym[h][l][k];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += u_p[v][d200off[h] + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 * u_p[v][d2aboff[h] + ij*gems_ab[h] + kl];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 * u_p[v][d2aboff[h] + ji*gems_ab[h] + kl];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] += 0.5 * u_p[v][d2aboff[h] + ij*gems_ab[h] + lk];
+                            A_p[v][offset + (ij+gems_ab[h])*2*gems_ab[h] + (kl+gems_ab[h])] -= 0.5 * u_p[v][d2aboff[h] + ji*gems_ab[h] + lk];
+                        }
+                    }
                 }
             }
             offset += 4*gems_ab[h]*gems_ab[h];
@@ -717,4 +905,108 @@ void v2RDMSolver::D2_constraints_Au(SharedVector A,SharedVector u){
 
 }
 
+// coefficients of the ab geminal |ij> in the singlet and triplet geminals
+// built from i and j (bas_00: i >= j, bas_aa: i > j)
+static double SingletCoefficient(int i, int j) {
+    return ( i == j ) ? 1.0 : 1.0 / sqrt(2.0);
+}
+static double TripletCoefficient(int i, int j) {
+    if ( i == j ) return 0.0;
+    return ( i > j ) ? 1.0 / sqrt(2.0) : -1.0 / sqrt(2.0);
+}
+
+// D2ab[ij][kl] = s(ij) s(kl) D2s[ij][kl] + t(ij) t(kl) D2t[ij][kl], D2aa = D2t
+void v2RDMSolver::UnpackSpinAdaptedD2(SharedSolverVector u){
+
+    double * u_p = u->pointer();
+
+    for ( int h = 0; h < nirrep_; h++) {
+        #pragma omp parallel for schedule (static)
+        for (int ij = 0; ij < gems_ab[h]; ij++) {
+            int i = bas_ab_sym[h][ij][0];
+            int j = bas_ab_sym[h][ij][1];
+            int ijs = ibas_00_sym[h][i][j];
+            int ijt = ibas_aa_sym[h][i][j];
+            double sij = SingletCoefficient(i,j);
+            double tij = TripletCoefficient(i,j);
+            for (int kl = 0; kl < gems_ab[h]; kl++) {
+                int k = bas_ab_sym[h][kl][0];
+                int l = bas_ab_sym[h][kl][1];
+                int kls = ibas_00_sym[h][k][l];
+                double dum = sij * SingletCoefficient(k,l) * u_p[d2soff[h] + ijs*gems_00[h] + kls];
+                if ( i != j && k != l ) {
+                    int klt = ibas_aa_sym[h][k][l];
+                    dum += tij * TripletCoefficient(k,l) * u_p[d2toff[h] + ijt*gems_aa[h] + klt];
+                }
+                u_p[d2aboff[h] + ij*gems_ab[h] + kl] = dum;
+            }
+        }
+        C_DCOPY(gems_aa[h]*gems_aa[h],u_p + d2toff[h],1,u_p + d2aaoff[h],1);
+    }
+}
+
+// D2s[ij][kl] = s * sum s(ij) s(kl) D2ab[ij][kl], and
+// D2t[ij][kl] = t * sum t(ij) t(kl) D2ab[ij][kl] + aa * D2aa[ij][kl],
+// where the sums run over both orderings of i,j and of k,l
+static void PackD2(double * A_p, int nab, int n00, int naa,
+                   int d2aboff, int d2aaoff, int d2soff, int d2toff,
+                   int ** ibas_ab, int ** bas_00, int ** bas_aa,
+                   double s, double t, double aa) {
+
+    #pragma omp parallel for schedule (static)
+    for (int ij = 0; ij < n00; ij++) {
+        int i = bas_00[ij][0];
+        int j = bas_00[ij][1];
+        for (int kl = 0; kl < n00; kl++) {
+            int k = bas_00[kl][0];
+            int l = bas_00[kl][1];
+            double dum = A_p[d2aboff + ibas_ab[i][j]*nab + ibas_ab[k][l]];
+            if ( i != j ) dum += A_p[d2aboff + ibas_ab[j][i]*nab + ibas_ab[k][l]];
+            if ( k != l ) dum += A_p[d2aboff + ibas_ab[i][j]*nab + ibas_ab[l][k]];
+            if ( i != j && k != l ) dum += A_p[d2aboff + ibas_ab[j][i]*nab + ibas_ab[l][k]];
+            A_p[d2soff + ij*n00 + kl] = s * SingletCoefficient(i,j) * SingletCoefficient(k,l) * dum;
+        }
+    }
+    #pragma omp parallel for schedule (static)
+    for (int ij = 0; ij < naa; ij++) {
+        int i = bas_aa[ij][0];
+        int j = bas_aa[ij][1];
+        for (int kl = 0; kl < naa; kl++) {
+            int k = bas_aa[kl][0];
+            int l = bas_aa[kl][1];
+            // t(ij) t(kl) = 1/2 for i > j and k > l, and the sign flips with each swap
+            double dum = A_p[d2aboff + ibas_ab[i][j]*nab + ibas_ab[k][l]]
+                       - A_p[d2aboff + ibas_ab[j][i]*nab + ibas_ab[k][l]]
+                       - A_p[d2aboff + ibas_ab[i][j]*nab + ibas_ab[l][k]]
+                       + A_p[d2aboff + ibas_ab[j][i]*nab + ibas_ab[l][k]];
+            A_p[d2toff + ij*naa + kl] = 0.5 * t * dum + aa * A_p[d2aaoff + ij*naa + kl];
+        }
+    }
+}
+
+// the kernels add to D2ab and D2aa (and D2bb, which is D2aa) only, so D2s and
+// D2t of A are assigned here
+void v2RDMSolver::PackSpinAdaptedD2(SharedSolverVector A){
+
+    double * A_p = A->pointer();
+
+    for ( int h = 0; h < nirrep_; h++) {
+        PackD2(A_p,gems_ab[h],gems_00[h],gems_aa[h],d2aboff[h],d2aaoff[h],d2soff[h],d2toff[h],
+               ibas_ab_sym[h],bas_00_sym[h],bas_aa_sym[h],1.0,1.0,1.0);
+    }
+}
+
+// least-squares D2s and D2t for a D2ab and D2aa that need not be consistent:
+// D2s is the singlet part of D2ab, and D2t averages the triplet part of D2ab
+// and D2aa
+void v2RDMSolver::FitSpinAdaptedD2(SharedSolverVector x){
+
+    double * x_p = x->pointer();
+
+    for ( int h = 0; h < nirrep_; h++) {
+        PackD2(x_p,gems_ab[h],gems_00[h],gems_aa[h],d2aboff[h],d2aaoff[h],d2soff[h],d2toff[h],
+               ibas_ab_sym[h],bas_00_sym[h],bas_aa_sym[h],1.0,0.5,0.5);
+    }
+}
+
 }}
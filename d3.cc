@@ -56,9 +56,11 @@ using namespace fnocc;
 namespace psi{ namespace v2rdm_casscf{
 
 // D3 portion of A.u 
-void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
+void v2RDMSolver::D3_constraints_Au(SharedSolverVector A,SharedSolverVector u){
 
-    double * A_p = A->pointer();
+    int offset = constraint_offset_[FAMILY_D3];
+
+    double * A_p = RowPointer(A);
     double * u_p = u->pointer();
 
     int na = nalpha_ - nrstc_ - nfrzc_;
@@ -67,28 +69,30 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
     // D3aaa -> D2aa
     if ( na > 2 ) {
         for ( int h = 0; h < nirrep_; h++) {
-            #pragma omp parallel for schedule (static)
-            for ( int ij = 0; ij < gems_aa[h]; ij++) {
-                int i = bas_aa_sym[h][ij][0];
-                int j = bas_aa_sym[h][ij][1];
-                for ( int kl = 0; kl < gems_aa[h]; kl++) {
-                    int k = bas_aa_sym[h][kl][0];
-                    int l = bas_aa_sym[h][kl][1];
-                    double dum = (na - 2.0) * u_p[d2aaoff[h] + ij*gems_aa[h] + kl];
-                    for ( int p = 0; p < amo_; p++) {
-                        if ( i == p || j == p ) continue;
-                        if ( k == p || l == p ) continue;
-                        int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aaa_sym[h2][i][j][p];
-                        int klp = ibas_aaa_sym[h2][k][l][p];
-                        int s = 1;
-                        if ( p < i ) s = -s;
-                        if ( p < j ) s = -s;
-                        if ( p < k ) s = -s;
-                        if ( p < l ) s = -s;
-                        dum -= s * u_p[d3aaaoff[h2] + ijp*trip_aaa[h2]+klp];
+            if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
+                #pragma omp parallel for schedule (static)
+                for ( int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double dum = (na - 2.0) * u_p[d2aaoff[h] + ij*gems_aa[h] + kl];
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( i == p || j == p ) continue;
+                            if ( k == p || l == p ) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aaa_sym[h2][i][j][p];
+                            int klp = ibas_aaa_sym[h2][k][l][p];
+                            int s = 1;
+                            if ( p < i ) s = -s;
+                            if ( p < j ) s = -s;
+                            if ( p < k ) s = -s;
+                            if ( p < l ) s = -s;
+                            dum -= s * u_p[d3aaaoff[h2] + ijp*trip_aaa[h2]+klp];
+                        }
+                        A_p[offset + ij*gems_aa[h]+kl] = dum;
                     }
-                    A_p[offset + ij*gems_aa[h]+kl] = dum;
                 }
             }
             offset += gems_aa[h] * gems_aa[h];
@@ -97,6 +101,38 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
     if ( nb > 2 ) {
         // D3bbb -> D2bb
         for ( int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
+                #pragma omp parallel for schedule (static)
+                for ( int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double dum = (nb - 2.0) * u_p[d2bboff[h] + ij*gems_aa[h] + kl];
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( i == p || j == p ) continue;
+                            if ( k == p || l == p ) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aaa_sym[h2][i][j][p];
+                            int klp = ibas_aaa_sym[h2][k][l][p];
+                            int s = 1;
+                            if ( p < i ) s = -s;
+                            if ( p < j ) s = -s;
+                            if ( p < k ) s = -s;
+                            if ( p < l ) s = -s;
+                            dum -= s * u_p[d3bbboff[h2] + ijp*trip_aaa[h2]+klp];
+                        }
+                        A_p[offset + ij*gems_aa[h]+kl] = dum;
+                    }
+                }
+            }
+            offset += gems_aa[h] * gems_aa[h];
+        }
+    }
+    // D3aab -> D2aa
+    for ( int h = 0; h < nirrep_; h++) {
+        if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
             #pragma omp parallel for schedule (static)
             for ( int ij = 0; ij < gems_aa[h]; ij++) {
                 int i = bas_aa_sym[h][ij][0];
@@ -104,64 +140,38 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
                 for ( int kl = 0; kl < gems_aa[h]; kl++) {
                     int k = bas_aa_sym[h][kl][0];
                     int l = bas_aa_sym[h][kl][1];
-                    double dum = (nb - 2.0) * u_p[d2bboff[h] + ij*gems_aa[h] + kl];
+                    double dum = nb * u_p[d2aaoff[h] + ij*gems_aa[h] + kl];
                     for ( int p = 0; p < amo_; p++) {
-                        if ( i == p || j == p ) continue;
-                        if ( k == p || l == p ) continue;
                         int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aaa_sym[h2][i][j][p];
-                        int klp = ibas_aaa_sym[h2][k][l][p];
-                        int s = 1;
-                        if ( p < i ) s = -s;
-                        if ( p < j ) s = -s;
-                        if ( p < k ) s = -s;
-                        if ( p < l ) s = -s;
-                        dum -= s * u_p[d3bbboff[h2] + ijp*trip_aaa[h2]+klp];
+                        int ijp = ibas_aab_sym[h2][i][j][p];
+                        int klp = ibas_aab_sym[h2][k][l][p];
+                        dum -= u_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp];
                     }
                     A_p[offset + ij*gems_aa[h]+kl] = dum;
                 }
             }
-            offset += gems_aa[h] * gems_aa[h];
-        }
-    }
-    // D3aab -> D2aa
-    for ( int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for ( int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for ( int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum = nb * u_p[d2aaoff[h] + ij*gems_aa[h] + kl];
-                for ( int p = 0; p < amo_; p++) {
-                    int h2 = SymmetryPair(h,symmetry[p]);
-                    int ijp = ibas_aab_sym[h2][i][j][p];
-                    int klp = ibas_aab_sym[h2][k][l][p];
-                    dum -= u_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp];
-                }
-                A_p[offset + ij*gems_aa[h]+kl] = dum;
-            }
         }
         offset += gems_aa[h] * gems_aa[h];
     }
     // D3bba -> D2bb
     for ( int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for ( int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for ( int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum = na * u_p[d2bboff[h] + ij*gems_aa[h] + kl];
-                for ( int p = 0; p < amo_; p++) {
-                    int h2 = SymmetryPair(h,symmetry[p]);
-                    int ijp = ibas_aab_sym[h2][i][j][p];
-                    int klp = ibas_aab_sym[h2][k][l][p];
-                    dum -= u_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp];
+        if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for ( int ij = 0; ij < gems_aa[h]; ij++) {
+                int i = bas_aa_sym[h][ij][0];
+                int j = bas_aa_sym[h][ij][1];
+                for ( int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k = bas_aa_sym[h][kl][0];
+                    int l = bas_aa_sym[h][kl][1];
+                    double dum = na * u_p[d2bboff[h] + ij*gems_aa[h] + kl];
+                    for ( int p = 0; p < amo_; p++) {
+                        int h2 = SymmetryPair(h,symmetry[p]);
+                        int ijp = ibas_aab_sym[h2][i][j][p];
+                        int klp = ibas_aab_sym[h2][k][l][p];
+                        dum -= u_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp];
+                    }
+                    A_p[offset + ij*gems_aa[h]+kl] = dum;
                 }
-                A_p[offset + ij*gems_aa[h]+kl] = dum;
             }
         }
         offset += gems_aa[h] * gems_aa[h];
@@ -169,26 +179,28 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
     if ( na > 1 ) {
         // D3aab -> D2ab
         for ( int h = 0; h < nirrep_; h++) {
-            #pragma omp parallel for schedule (static)
-            for ( int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                for ( int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    double dum = (na - 1.0) * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    for ( int p = 0; p < amo_; p++) {
-                        if ( i == p) continue;
-                        if ( k == p) continue;
-                        int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aab_sym[h2][i][p][j];
-                        int klp = ibas_aab_sym[h2][k][p][l];
-                        int s = 1;
-                        if ( p < i ) s = -s;
-                        if ( p < k ) s = -s;
-                        dum -= s * u_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp];
+            if ( RowsAreLocal(offset,gems_ab[h] * gems_ab[h]) ) {
+                #pragma omp parallel for schedule (static)
+                for ( int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        double dum = (na - 1.0) * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( i == p) continue;
+                            if ( k == p) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aab_sym[h2][i][p][j];
+                            int klp = ibas_aab_sym[h2][k][p][l];
+                            int s = 1;
+                            if ( p < i ) s = -s;
+                            if ( p < k ) s = -s;
+                            dum -= s * u_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp];
+                        }
+                        A_p[offset + ij*gems_ab[h]+kl] = dum;
                     }
-                    A_p[offset + ij*gems_ab[h]+kl] = dum;
                 }
             }
             offset += gems_ab[h] * gems_ab[h];
@@ -197,26 +209,28 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
     if ( nb > 1 ) {
         // D3bba -> D2ab
         for ( int h = 0; h < nirrep_; h++) {
-            #pragma omp parallel for schedule (static)
-            for ( int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                for ( int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    double dum = (nb - 1.0) * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
-                    for ( int p = 0; p < amo_; p++) {
-                        if ( j == p) continue;
-                        if ( l == p) continue;
-                        int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aab_sym[h2][j][p][i];
-                        int klp = ibas_aab_sym[h2][l][p][k];
-                        int s = 1;
-                        if ( p < j ) s = -s;
-                        if ( p < l ) s = -s;
-                        dum -= s * u_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp];
+            if ( RowsAreLocal(offset,gems_ab[h] * gems_ab[h]) ) {
+                #pragma omp parallel for schedule (static)
+                for ( int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        double dum = (nb - 1.0) * u_p[d2aboff[h] + ij*gems_ab[h] + kl];
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( j == p) continue;
+                            if ( l == p) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aab_sym[h2][j][p][i];
+                            int klp = ibas_aab_sym[h2][l][p][k];
+                            int s = 1;
+                            if ( p < j ) s = -s;
+                            if ( p < l ) s = -s;
+                            dum -= s * u_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp];
+                        }
+                        A_p[offset + ij*gems_ab[h]+kl] = dum;
                     }
-                    A_p[offset + ij*gems_ab[h]+kl] = dum;
                 }
             }
             offset += gems_ab[h] * gems_ab[h];
@@ -227,70 +241,76 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
         // D3aab = D3bba
         for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(trip_aab[h]*trip_aab[h],u_p + d3aaboff[h],1,A_p + offset,1);
-            C_DAXPY(trip_aab[h]*trip_aab[h],-1.0,u_p + d3bbaoff[h],1,A_p + offset,1);
+            if ( RowsAreLocal(offset,trip_aab[h]*trip_aab[h]) ) {
+                C_DCOPY(trip_aab[h]*trip_aab[h],u_p + d3aaboff[h],1,A_p + offset,1);
+                C_DAXPY(trip_aab[h]*trip_aab[h],-1.0,u_p + d3bbaoff[h],1,A_p + offset,1);
+            }
             offset += trip_aab[h]*trip_aab[h];
         }
         // D3aaa <- D3aab
         for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(trip_aaa[h]*trip_aaa[h],u_p + d3aaaoff[h],1,A_p + offset,1);
-            for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
-                int p = bas_aaa_sym[h][pqr][0];
-                int q = bas_aaa_sym[h][pqr][1];
-                int r = bas_aaa_sym[h][pqr][2];
-                int pqr_b = ibas_aab_sym[h][p][q][r];
-                int prq_b = ibas_aab_sym[h][p][r][q];
-                int qrp_b = ibas_aab_sym[h][q][r][p];
-                for (int stu = 0; stu < trip_aaa[h]; stu++) {
-                    int s = bas_aaa_sym[h][stu][0];
-                    int t = bas_aaa_sym[h][stu][1];
-                    int u = bas_aaa_sym[h][stu][2];
-                    int stu_b = ibas_aab_sym[h][s][t][u];
-                    int sut_b = ibas_aab_sym[h][s][u][t];
-                    int tus_b = ibas_aab_sym[h][t][u][s];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + pqr_b * trip_aab[h] + stu_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + pqr_b * trip_aab[h] + sut_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + pqr_b * trip_aab[h] + tus_b];
+            if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+                C_DCOPY(trip_aaa[h]*trip_aaa[h],u_p + d3aaaoff[h],1,A_p + offset,1);
+                for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
+                    int p = bas_aaa_sym[h][pqr][0];
+                    int q = bas_aaa_sym[h][pqr][1];
+                    int r = bas_aaa_sym[h][pqr][2];
+                    int pqr_b = ibas_aab_sym[h][p][q][r];
+                    int prq_b = ibas_aab_sym[h][p][r][q];
+                    int qrp_b = ibas_aab_sym[h][q][r][p];
+                    for (int stu = 0; stu < trip_aaa[h]; stu++) {
+                        int s = bas_aaa_sym[h][stu][0];
+                        int t = bas_aaa_sym[h][stu][1];
+                        int u = bas_aaa_sym[h][stu][2];
+                        int stu_b = ibas_aab_sym[h][s][t][u];
+                        int sut_b = ibas_aab_sym[h][s][u][t];
+                        int tus_b = ibas_aab_sym[h][t][u][s];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + pqr_b * trip_aab[h] + stu_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + pqr_b * trip_aab[h] + sut_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + pqr_b * trip_aab[h] + tus_b];
 
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + prq_b * trip_aab[h] + stu_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + prq_b * trip_aab[h] + sut_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + prq_b * trip_aab[h] + tus_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + prq_b * trip_aab[h] + stu_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + prq_b * trip_aab[h] + sut_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + prq_b * trip_aab[h] + tus_b];
 
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + qrp_b * trip_aab[h] + stu_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + qrp_b * trip_aab[h] + sut_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + qrp_b * trip_aab[h] + tus_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + qrp_b * trip_aab[h] + stu_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3aaboff[h] + qrp_b * trip_aab[h] + sut_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3aaboff[h] + qrp_b * trip_aab[h] + tus_b];
+                    }
                 }
             }
             offset += trip_aaa[h]*trip_aaa[h];
         }
         // D3bbb <- D3bba
         for ( int h = 0; h < nirrep_; h++) {
-            C_DCOPY(trip_aaa[h]*trip_aaa[h],u_p + d3bbboff[h],1,A_p + offset,1);
-            for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
-                int p = bas_aaa_sym[h][pqr][0];
-                int q = bas_aaa_sym[h][pqr][1];
-                int r = bas_aaa_sym[h][pqr][2];
-                int pqr_b = ibas_aab_sym[h][p][q][r];
-                int prq_b = ibas_aab_sym[h][p][r][q];
-                int qrp_b = ibas_aab_sym[h][q][r][p];
-                for (int stu = 0; stu < trip_aaa[h]; stu++) {
-                    int s = bas_aaa_sym[h][stu][0];
-                    int t = bas_aaa_sym[h][stu][1];
-                    int u = bas_aaa_sym[h][stu][2];
-                    int stu_b = ibas_aab_sym[h][s][t][u];
-                    int sut_b = ibas_aab_sym[h][s][u][t];
-                    int tus_b = ibas_aab_sym[h][t][u][s];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + pqr_b * trip_aab[h] + stu_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + pqr_b * trip_aab[h] + sut_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + pqr_b * trip_aab[h] + tus_b];
+            if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+                C_DCOPY(trip_aaa[h]*trip_aaa[h],u_p + d3bbboff[h],1,A_p + offset,1);
+                for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
+                    int p = bas_aaa_sym[h][pqr][0];
+                    int q = bas_aaa_sym[h][pqr][1];
+                    int r = bas_aaa_sym[h][pqr][2];
+                    int pqr_b = ibas_aab_sym[h][p][q][r];
+                    int prq_b = ibas_aab_sym[h][p][r][q];
+                    int qrp_b = ibas_aab_sym[h][q][r][p];
+                    for (int stu = 0; stu < trip_aaa[h]; stu++) {
+                        int s = bas_aaa_sym[h][stu][0];
+                        int t = bas_aaa_sym[h][stu][1];
+                        int u = bas_aaa_sym[h][stu][2];
+                        int stu_b = ibas_aab_sym[h][s][t][u];
+                        int sut_b = ibas_aab_sym[h][s][u][t];
+                        int tus_b = ibas_aab_sym[h][t][u][s];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + pqr_b * trip_aab[h] + stu_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + pqr_b * trip_aab[h] + sut_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + pqr_b * trip_aab[h] + tus_b];
 
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + prq_b * trip_aab[h] + stu_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + prq_b * trip_aab[h] + sut_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + prq_b * trip_aab[h] + tus_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + prq_b * trip_aab[h] + stu_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + prq_b * trip_aab[h] + sut_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + prq_b * trip_aab[h] + tus_b];
 
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + qrp_b * trip_aab[h] + stu_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + qrp_b * trip_aab[h] + sut_b];
-                    A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + qrp_b * trip_aab[h] + tus_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + qrp_b * trip_aab[h] + stu_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] += 1.0/3.0 * u_p[d3bbaoff[h] + qrp_b * trip_aab[h] + sut_b];
+                        A_p[offset + pqr*trip_aaa[h] + stu] -= 1.0/3.0 * u_p[d3bbaoff[h] + qrp_b * trip_aab[h] + tus_b];
+                    }
                 }
             }
             offset += trip_aaa[h]*trip_aaa[h];
@@ -300,10 +320,12 @@ void v2RDMSolver::D3_constraints_Au(SharedVector A,SharedVector u){
 }
 
 // D3 portion of A^T.y 
-void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
+void v2RDMSolver::D3_constraints_ATu(SharedSolverVector A,SharedSolverVector u){
+
+    int offset = constraint_offset_[FAMILY_D3];
 
     double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    double * u_p = RowPointer(u);
 
     int na = nalpha_ - nrstc_ - nfrzc_;
     int nb = nbeta_ - nrstc_ - nfrzc_;
@@ -311,26 +333,28 @@ void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
     if ( na > 2 ) {
         // D3aaa -> D2aa
         for ( int h = 0; h < nirrep_; h++) {
-            for ( int ij = 0; ij < gems_aa[h]; ij++) {
-                int i = bas_aa_sym[h][ij][0];
-                int j = bas_aa_sym[h][ij][1];
-                for ( int kl = 0; kl < gems_aa[h]; kl++) {
-                    int k = bas_aa_sym[h][kl][0];
-                    int l = bas_aa_sym[h][kl][1];
-                    double dum = u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2aaoff[h] + ij*gems_aa[h] + kl] += (na - 2.0) * dum;
-                    for ( int p = 0; p < amo_; p++) {
-                        if ( i == p || j == p ) continue;
-                        if ( k == p || l == p ) continue;
-                        int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aaa_sym[h2][i][j][p];
-                        int klp = ibas_aaa_sym[h2][k][l][p];
-                        int s = 1;
-                        if ( p < i ) s = -s;
-                        if ( p < j ) s = -s;
-                        if ( p < k ) s = -s;
-                        if ( p < l ) s = -s;
-                        A_p[d3aaaoff[h2] + ijp*trip_aaa[h2]+klp] -= s * dum;
+            if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
+                for ( int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double dum = u_p[offset + ij*gems_aa[h] + kl];
+                        A_p[d2aaoff[h] + ij*gems_aa[h] + kl] += (na - 2.0) * dum;
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( i == p || j == p ) continue;
+                            if ( k == p || l == p ) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aaa_sym[h2][i][j][p];
+                            int klp = ibas_aaa_sym[h2][k][l][p];
+                            int s = 1;
+                            if ( p < i ) s = -s;
+                            if ( p < j ) s = -s;
+                            if ( p < k ) s = -s;
+                            if ( p < l ) s = -s;
+                            A_p[d3aaaoff[h2] + ijp*trip_aaa[h2]+klp] -= s * dum;
+                        }
                     }
                 }
             }
@@ -340,6 +364,37 @@ void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
     if ( nb > 2 ) {
         // D3bbb -> D2bb
         for ( int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
+                for ( int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double dum = u_p[offset + ij*gems_aa[h] + kl];
+                        A_p[d2bboff[h] + ij*gems_aa[h] + kl] += (nb - 2.0) * dum;
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( i == p || j == p ) continue;
+                            if ( k == p || l == p ) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aaa_sym[h2][i][j][p];
+                            int klp = ibas_aaa_sym[h2][k][l][p];
+                            int s = 1;
+                            if ( p < i ) s = -s;
+                            if ( p < j ) s = -s;
+                            if ( p < k ) s = -s;
+                            if ( p < l ) s = -s;
+                            A_p[d3bbboff[h2] + ijp*trip_aaa[h2]+klp] -= s * dum;
+                        }
+                    }
+                }
+            }
+            offset += gems_aa[h] * gems_aa[h];
+        }
+    }
+    // D3aab -> D2aa
+    for ( int h = 0; h < nirrep_; h++) {
+        if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
             for ( int ij = 0; ij < gems_aa[h]; ij++) {
                 int i = bas_aa_sym[h][ij][0];
                 int j = bas_aa_sym[h][ij][1];
@@ -347,60 +402,35 @@ void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
                     int k = bas_aa_sym[h][kl][0];
                     int l = bas_aa_sym[h][kl][1];
                     double dum = u_p[offset + ij*gems_aa[h] + kl];
-                    A_p[d2bboff[h] + ij*gems_aa[h] + kl] += (nb - 2.0) * dum;
+                    A_p[d2aaoff[h] + ij*gems_aa[h] + kl] += nb * dum;
                     for ( int p = 0; p < amo_; p++) {
-                        if ( i == p || j == p ) continue;
-                        if ( k == p || l == p ) continue;
                         int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aaa_sym[h2][i][j][p];
-                        int klp = ibas_aaa_sym[h2][k][l][p];
-                        int s = 1;
-                        if ( p < i ) s = -s;
-                        if ( p < j ) s = -s;
-                        if ( p < k ) s = -s;
-                        if ( p < l ) s = -s;
-                        A_p[d3bbboff[h2] + ijp*trip_aaa[h2]+klp] -= s * dum;
+                        int ijp = ibas_aab_sym[h2][i][j][p];
+                        int klp = ibas_aab_sym[h2][k][l][p];
+                        A_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp] -= dum;
                     }
                 }
             }
-            offset += gems_aa[h] * gems_aa[h];
-        }
-    }
-    // D3aab -> D2aa
-    for ( int h = 0; h < nirrep_; h++) {
-        for ( int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for ( int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum = u_p[offset + ij*gems_aa[h] + kl];
-                A_p[d2aaoff[h] + ij*gems_aa[h] + kl] += nb * dum;
-                for ( int p = 0; p < amo_; p++) {
-                    int h2 = SymmetryPair(h,symmetry[p]);
-                    int ijp = ibas_aab_sym[h2][i][j][p];
-                    int klp = ibas_aab_sym[h2][k][l][p];
-                    A_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp] -= dum;
-                }
-            }
         }
         offset += gems_aa[h] * gems_aa[h];
     }
     // D3bba -> D2bb
     for ( int h = 0; h < nirrep_; h++) {
-        for ( int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for ( int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum = u_p[offset + ij*gems_aa[h] + kl];
-                A_p[d2bboff[h] + ij*gems_aa[h] + kl] += na * dum;
-                for ( int p = 0; p < amo_; p++) {
-                    int h2 = SymmetryPair(h,symmetry[p]);
-                    int ijp = ibas_aab_sym[h2][i][j][p];
-                    int klp = ibas_aab_sym[h2][k][l][p];
-                    A_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp] -= dum;
+        if ( RowsAreLocal(offset,gems_aa[h] * gems_aa[h]) ) {
+            for ( int ij = 0; ij < gems_aa[h]; ij++) {
+                int i = bas_aa_sym[h][ij][0];
+                int j = bas_aa_sym[h][ij][1];
+                for ( int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k = bas_aa_sym[h][kl][0];
+                    int l = bas_aa_sym[h][kl][1];
+                    double dum = u_p[offset + ij*gems_aa[h] + kl];
+                    A_p[d2bboff[h] + ij*gems_aa[h] + kl] += na * dum;
+                    for ( int p = 0; p < amo_; p++) {
+                        int h2 = SymmetryPair(h,symmetry[p]);
+                        int ijp = ibas_aab_sym[h2][i][j][p];
+                        int klp = ibas_aab_sym[h2][k][l][p];
+                        A_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp] -= dum;
+                    }
                 }
             }
         }
@@ -409,24 +439,26 @@ void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
     if ( na > 1 ) {
         // D3aab -> D2ab
         for ( int h = 0; h < nirrep_; h++) {
-            for ( int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                for ( int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    double dum = u_p[offset + ij*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] += (na - 1.0) * dum;
-                    for ( int p = 0; p < amo_; p++) {
-                        if ( i == p) continue;
-                        if ( k == p) continue;
-                        int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aab_sym[h2][i][p][j];
-                        int klp = ibas_aab_sym[h2][k][p][l];
-                        int s = 1;
-                        if ( p < i ) s = -s;
-                        if ( p < k ) s = -s;
-                        A_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp] -= s * dum;
+            if ( RowsAreLocal(offset,gems_ab[h] * gems_ab[h]) ) {
+                for ( int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        double dum = u_p[offset + ij*gems_ab[h] + kl];
+                        A_p[d2aboff[h] + ij*gems_ab[h] + kl] += (na - 1.0) * dum;
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( i == p) continue;
+                            if ( k == p) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aab_sym[h2][i][p][j];
+                            int klp = ibas_aab_sym[h2][k][p][l];
+                            int s = 1;
+                            if ( p < i ) s = -s;
+                            if ( p < k ) s = -s;
+                            A_p[d3aaboff[h2] + ijp*trip_aab[h2]+klp] -= s * dum;
+                        }
                     }
                 }
             }
@@ -436,24 +468,26 @@ void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
     if ( nb > 1 ) {
         // D3bba -> D2ab
         for ( int h = 0; h < nirrep_; h++) {
-            for ( int ij = 0; ij < gems_ab[h]; ij++) {
-                int i = bas_ab_sym[h][ij][0];
-                int j = bas_ab_sym[h][ij][1];
-                for ( int kl = 0; kl < gems_ab[h]; kl++) {
-                    int k = bas_ab_sym[h][kl][0];
-                    int l = bas_ab_sym[h][kl][1];
-                    double dum = u_p[offset + ij*gems_ab[h] + kl];
-                    A_p[d2aboff[h] + ij*gems_ab[h] + kl] += (nb - 1.0) * dum;
-                    for ( int p = 0; p < amo_; p++) {
-                        if ( j == p) continue;
-                        if ( l == p) continue;
-                        int h2 = SymmetryPair(h,symmetry[p]);
-                        int ijp = ibas_aab_sym[h2][j][p][i];
-                        int klp = ibas_aab_sym[h2][l][p][k];
-                        int s = 1;
-                        if ( p < j ) s = -s;
-                        if ( p < l ) s = -s;
-                        A_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp] -= s * dum;
+            if ( RowsAreLocal(offset,gems_ab[h] * gems_ab[h]) ) {
+                for ( int ij = 0; ij < gems_ab[h]; ij++) {
+                    int i = bas_ab_sym[h][ij][0];
+                    int j = bas_ab_sym[h][ij][1];
+                    for ( int kl = 0; kl < gems_ab[h]; kl++) {
+                        int k = bas_ab_sym[h][kl][0];
+                        int l = bas_ab_sym[h][kl][1];
+                        double dum = u_p[offset + ij*gems_ab[h] + kl];
+                        A_p[d2aboff[h] + ij*gems_ab[h] + kl] += (nb - 1.0) * dum;
+                        for ( int p = 0; p < amo_; p++) {
+                            if ( j == p) continue;
+                            if ( l == p) continue;
+                            int h2 = SymmetryPair(h,symmetry[p]);
+                            int ijp = ibas_aab_sym[h2][j][p][i];
+                            int klp = ibas_aab_sym[h2][l][p][k];
+                            int s = 1;
+                            if ( p < j ) s = -s;
+                            if ( p < l ) s = -s;
+                            A_p[d3bbaoff[h2] + ijp*trip_aab[h2]+klp] -= s * dum;
+                        }
                     }
                 }
             }
@@ -465,70 +499,76 @@ void v2RDMSolver::D3_constraints_ATu(SharedVector A,SharedVector u){
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
         // D3aab = D3bba
         for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(trip_aab[h]*trip_aab[h], 1.0,u_p + offset,1,A_p + d3aaboff[h],1);
-            C_DAXPY(trip_aab[h]*trip_aab[h],-1.0,u_p + offset,1,A_p + d3bbaoff[h],1);
+            if ( RowsAreLocal(offset,trip_aab[h]*trip_aab[h]) ) {
+                C_DAXPY(trip_aab[h]*trip_aab[h], 1.0,u_p + offset,1,A_p + d3aaboff[h],1);
+                C_DAXPY(trip_aab[h]*trip_aab[h],-1.0,u_p + offset,1,A_p + d3bbaoff[h],1);
+            }
             offset += trip_aab[h]*trip_aab[h];
         }
         // D3aaa <- D3aab
         for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(trip_aaa[h]*trip_aaa[h],1.0,u_p + offset,1,A_p+d3aaaoff[h],1);
-            for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
-                int p = bas_aaa_sym[h][pqr][0];
-                int q = bas_aaa_sym[h][pqr][1];
-                int r = bas_aaa_sym[h][pqr][2];
-                int pqr_b = ibas_aab_sym[h][p][q][r];
-                int prq_b = ibas_aab_sym[h][p][r][q];
-                int qrp_b = ibas_aab_sym[h][q][r][p];
-                for (int stu = 0; stu < trip_aaa[h]; stu++) {
-                    int s = bas_aaa_sym[h][stu][0];
-                    int t = bas_aaa_sym[h][stu][1];
-                    int u = bas_aaa_sym[h][stu][2];
-                    int stu_b = ibas_aab_sym[h][s][t][u];
-                    int sut_b = ibas_aab_sym[h][s][u][t];
-                    int tus_b = ibas_aab_sym[h][t][u][s];
-                    A_p[d3aaboff[h] + pqr_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3aaboff[h] + pqr_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3aaboff[h] + pqr_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+            if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+                C_DAXPY(trip_aaa[h]*trip_aaa[h],1.0,u_p + offset,1,A_p+d3aaaoff[h],1);
+                for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
+                    int p = bas_aaa_sym[h][pqr][0];
+                    int q = bas_aaa_sym[h][pqr][1];
+                    int r = bas_aaa_sym[h][pqr][2];
+                    int pqr_b = ibas_aab_sym[h][p][q][r];
+                    int prq_b = ibas_aab_sym[h][p][r][q];
+                    int qrp_b = ibas_aab_sym[h][q][r][p];
+                    for (int stu = 0; stu < trip_aaa[h]; stu++) {
+                        int s = bas_aaa_sym[h][stu][0];
+                        int t = bas_aaa_sym[h][stu][1];
+                        int u = bas_aaa_sym[h][stu][2];
+                        int stu_b = ibas_aab_sym[h][s][t][u];
+                        int sut_b = ibas_aab_sym[h][s][u][t];
+                        int tus_b = ibas_aab_sym[h][t][u][s];
+                        A_p[d3aaboff[h] + pqr_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + pqr_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + pqr_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
                                                                                                                    
-                    A_p[d3aaboff[h] + prq_b * trip_aab[h] + stu_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3aaboff[h] + prq_b * trip_aab[h] + sut_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3aaboff[h] + prq_b * trip_aab[h] + tus_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + prq_b * trip_aab[h] + stu_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + prq_b * trip_aab[h] + sut_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + prq_b * trip_aab[h] + tus_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
                                                                                                                    
-                    A_p[d3aaboff[h] + qrp_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3aaboff[h] + qrp_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3aaboff[h] + qrp_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + qrp_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + qrp_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3aaboff[h] + qrp_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                    }
                 }
             }
             offset += trip_aaa[h]*trip_aaa[h];
         }
         // D3bbb <- D3bba
         for ( int h = 0; h < nirrep_; h++) {
-            C_DAXPY(trip_aaa[h]*trip_aaa[h],1.0,u_p + offset,1,A_p+d3bbboff[h],1);
-            for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
-                int p = bas_aaa_sym[h][pqr][0];
-                int q = bas_aaa_sym[h][pqr][1];
-                int r = bas_aaa_sym[h][pqr][2];
-                int pqr_b = ibas_aab_sym[h][p][q][r];
-                int prq_b = ibas_aab_sym[h][p][r][q];
-                int qrp_b = ibas_aab_sym[h][q][r][p];
-                for (int stu = 0; stu < trip_aaa[h]; stu++) {
-                    int s = bas_aaa_sym[h][stu][0];
-                    int t = bas_aaa_sym[h][stu][1];
-                    int u = bas_aaa_sym[h][stu][2];
-                    int stu_b = ibas_aab_sym[h][s][t][u];
-                    int sut_b = ibas_aab_sym[h][s][u][t];
-                    int tus_b = ibas_aab_sym[h][t][u][s];
-                    A_p[d3bbaoff[h] + pqr_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3bbaoff[h] + pqr_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3bbaoff[h] + pqr_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+            if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+                C_DAXPY(trip_aaa[h]*trip_aaa[h],1.0,u_p + offset,1,A_p+d3bbboff[h],1);
+                for (int pqr = 0; pqr < trip_aaa[h]; pqr++) {
+                    int p = bas_aaa_sym[h][pqr][0];
+                    int q = bas_aaa_sym[h][pqr][1];
+                    int r = bas_aaa_sym[h][pqr][2];
+                    int pqr_b = ibas_aab_sym[h][p][q][r];
+                    int prq_b = ibas_aab_sym[h][p][r][q];
+                    int qrp_b = ibas_aab_sym[h][q][r][p];
+                    for (int stu = 0; stu < trip_aaa[h]; stu++) {
+                        int s = bas_aaa_sym[h][stu][0];
+                        int t = bas_aaa_sym[h][stu][1];
+                        int u = bas_aaa_sym[h][stu][2];
+                        int stu_b = ibas_aab_sym[h][s][t][u];
+                        int sut_b = ibas_aab_sym[h][s][u][t];
+                        int tus_b = ibas_aab_sym[h][t][u][s];
+                        A_p[d3bbaoff[h] + pqr_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + pqr_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + pqr_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
                                                                                                                    
-                    A_p[d3bbaoff[h] + prq_b * trip_aab[h] + stu_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3bbaoff[h] + prq_b * trip_aab[h] + sut_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3bbaoff[h] + prq_b * trip_aab[h] + tus_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + prq_b * trip_aab[h] + stu_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + prq_b * trip_aab[h] + sut_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + prq_b * trip_aab[h] + tus_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
                                                                                                                    
-                    A_p[d3bbaoff[h] + qrp_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3bbaoff[h] + qrp_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
-                    A_p[d3bbaoff[h] + qrp_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + qrp_b * trip_aab[h] + stu_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + qrp_b * trip_aab[h] + sut_b] += 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                        A_p[d3bbaoff[h] + qrp_b * trip_aab[h] + tus_b] -= 1.0/3.0 * u_p[offset + pqr*trip_aaa[h] + stu];
+                    }
                 }
             }
             offset += trip_aaa[h]*trip_aaa[h];
@@ -45,15 +45,15 @@ namespace psi{ namespace v2rdm_casscf{
 // TODO: replace junk1/junk2
 void v2RDMSolver::DIIS(double*c,long int nvec,int replace_diis_iter){
     long int nvar      = nvec+1;
-    long int * ipiv    = (long int*)malloc(nvar*sizeof(long int));
-    double * temp      = (double*)malloc(sizeof(double)*maxdiis_*maxdiis_);
-    double * A         = (double*)malloc(sizeof(double)*nvar*nvar);
-    double * B         = (double*)malloc(sizeof(double)*nvar);
+    long int * ipiv    = workspace_.longs(WS_DIIS_IPIV,nvar);
+    double * temp      = workspace_.doubles(WS_DIIS_TEMP,maxdiis_*maxdiis_);
+    double * A         = workspace_.doubles(WS_DIIS_A,nvar*nvar);
+    double * B         = workspace_.doubles(WS_DIIS_B,nvar);
     memset((void*)A,'\0',nvar*nvar*sizeof(double));
     memset((void*)B,'\0',nvar*sizeof(double));
     B[nvec] = -1.;
 
-    char*evector=(char*)malloc(1000*sizeof(char));
+    char evector[1000];
 
     boost::shared_ptr<PSIO> psio(new PSIO());
     psio->open(PSIF_DCC_EVEC,PSIO_OPEN_OLD);
@@ -111,9 +111,7 @@ void v2RDMSolver::DIIS(double*c,long int nvec,int replace_diis_iter){
         }
     }
     psio->write_entry(PSIF_DCC_EVEC,"error matrix",(char*)&temp[0],maxdiis_*maxdiis_*sizeof(double));
-    free(temp);
     psio->close(PSIF_DCC_EVEC,1);
-    free(evector);
 
     long int nrhs,lda,ldb,info;
     nrhs = 1;
@@ -122,15 +120,12 @@ void v2RDMSolver::DIIS(double*c,long int nvec,int replace_diis_iter){
     DGESV(nvar,nrhs,A,lda,ipiv,B,ldb,info);
     C_DCOPY(nvec,B,1,c,1);
 
-    free(A);
-    free(B);
-    free(ipiv);
     psio.reset();
 }
 
 void v2RDMSolver::DIIS_WriteOldVector(long int iter,int diis_iter,int replace_diis_iter){
 
-    char*oldvector=(char*)malloc(1000*sizeof(char));
+    char oldvector[1000];
 
     if (diis_iter<=maxdiis_ && iter<=maxdiis_){
        sprintf(oldvector,"oldvector%i",diis_iter);
@@ -153,12 +148,10 @@ void v2RDMSolver::DIIS_WriteOldVector(long int iter,int diis_iter,int replace_di
     psio->write(PSIF_DCC_OVEC,oldvector,(char*)&rz->pointer()[0],dimdiis_*sizeof(double),addr,&addr);
     psio->close(PSIF_DCC_OVEC,1);
     psio.reset();
-
-    free(oldvector);
 }
 void v2RDMSolver::DIIS_WriteErrorVector(int diis_iter,int replace_diis_iter,int iter){
 
-    char*evector   = (char*)malloc(1000*sizeof(char));
+    char evector[1000];
     if (diis_iter<=maxdiis_ && iter<=maxdiis_){
        sprintf(evector,"evector%i",diis_iter);
     }
@@ -169,10 +162,9 @@ void v2RDMSolver::DIIS_WriteErrorVector(int diis_iter,int replace_diis_iter,int
     boost::shared_ptr<PSIO> psio(new PSIO());
     if (diis_iter==0) {
        psio->open(PSIF_DCC_EVEC,PSIO_OPEN_NEW);
-       double * temp = (double*)malloc(maxdiis_*maxdiis_*sizeof(double));
+       double * temp = workspace_.doubles(WS_DIIS_TEMP,maxdiis_*maxdiis_);
        memset((void*)temp,'\0',maxdiis_*maxdiis_*sizeof(double));
        psio->write_entry(PSIF_DCC_EVEC,"error matrix",(char*)&temp[0],maxdiis_*maxdiis_*sizeof(double));
-       free(temp);
     }
     else {
        psio->open(PSIF_DCC_EVEC,PSIO_OPEN_OLD);
@@ -186,13 +178,10 @@ void v2RDMSolver::DIIS_WriteErrorVector(int diis_iter,int replace_diis_iter,int
 
     psio->close(PSIF_DCC_EVEC,1);
     psio.reset();
-
-    free(evector);
 }
 void v2RDMSolver::DIIS_Extrapolate(int diis_iter,int&replace_diis_iter){
 
-    char*oldvector;
-    oldvector=(char*)malloc(1000*sizeof(char));
+    char oldvector[1000];
 
     boost::shared_ptr<PSIO> psio(new PSIO());
     psio->open(PSIF_DCC_OVEC,PSIO_OPEN_OLD);
@@ -222,7 +211,6 @@ void v2RDMSolver::DIIS_Extrapolate(int diis_iter,int&replace_diis_iter){
         //}
     }
     psio->close(PSIF_DCC_OVEC,1);
-    free(oldvector);
 
     // now, build x = rx^2, z = rz^2
     double * x_p  = x->pointer();
@@ -0,0 +1,215 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include<stdlib.h>
+#include<algorithm>
+
+#ifdef HAVE_MPI
+    #include<mpi.h>
+#endif
+
+#include"distributed.h"
+
+namespace psi{ namespace v2rdm_casscf{
+
+#ifdef HAVE_MPI
+// largest message passed to one MPI call; counts are ints
+#define DISTRIBUTED_CHUNK 268435456L
+
+static void DistributedFinalize() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if ( !finalized ) MPI_Finalize();
+}
+#endif
+
+void DistributedInit() {
+#ifdef HAVE_MPI
+    int initialized;
+    MPI_Initialized(&initialized);
+    if ( !initialized ) {
+        MPI_Init(NULL,NULL);
+        atexit(DistributedFinalize);
+    }
+#endif
+}
+
+int DistributedRank() {
+#ifdef HAVE_MPI
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD,&rank);
+    return rank;
+#else
+    return 0;
+#endif
+}
+
+int DistributedSize() {
+#ifdef HAVE_MPI
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD,&size);
+    return size;
+#else
+    return 1;
+#endif
+}
+
+void DistributedSum(double * v, long int n) {
+#ifdef HAVE_MPI
+    if ( DistributedSize() == 1 ) return;
+    // reduce + broadcast rather than allreduce: allreduce may add the
+    // contributions in a different order on each rank
+    DistributedReduce(v,n,0);
+    DistributedBroadcast(v,n,0);
+#endif
+}
+
+void DistributedReduce(double * v, long int n, int root) {
+#ifdef HAVE_MPI
+    if ( DistributedSize() == 1 ) return;
+    bool mine = ( DistributedRank() == root );
+    for (long int start = 0; start < n; start += DISTRIBUTED_CHUNK) {
+        int count = (int)std::min(DISTRIBUTED_CHUNK,n - start);
+        if ( mine ) {
+            MPI_Reduce(MPI_IN_PLACE,v + start,count,MPI_DOUBLE,MPI_SUM,root,MPI_COMM_WORLD);
+        }else {
+            MPI_Reduce(v + start,NULL,count,MPI_DOUBLE,MPI_SUM,root,MPI_COMM_WORLD);
+        }
+    }
+#endif
+}
+
+void DistributedBroadcast(double * v, long int n, int root) {
+#ifdef HAVE_MPI
+    if ( DistributedSize() == 1 ) return;
+    for (long int start = 0; start < n; start += DISTRIBUTED_CHUNK) {
+        int count = (int)std::min(DISTRIBUTED_CHUNK,n - start);
+        MPI_Bcast(v + start,count,MPI_DOUBLE,root,MPI_COMM_WORLD);
+    }
+#endif
+}
+
+#ifdef HAVE_MPI
+// receive buffer for the sums over a subset of the ranks
+static std::vector<double> receive_buffer;
+#endif
+
+void DistributedSumAmong(double * v, long int n, const std::vector<int> & ranks) {
+#ifdef HAVE_MPI
+    if ( ranks.size() < 2 ) return;
+    int me     = DistributedRank();
+    int leader = ranks[0];
+    for (long int start = 0; start < n; start += DISTRIBUTED_CHUNK) {
+        int count = (int)std::min(DISTRIBUTED_CHUNK,n - start);
+        if ( me == leader ) {
+            receive_buffer.resize(count);
+            for (int k = 1; k < ranks.size(); k++) {
+                MPI_Recv(&receive_buffer[0],count,MPI_DOUBLE,ranks[k],0,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+                for (int i = 0; i < count; i++) {
+                    v[start + i] += receive_buffer[i];
+                }
+            }
+            for (int k = 1; k < ranks.size(); k++) {
+                MPI_Send(v + start,count,MPI_DOUBLE,ranks[k],0,MPI_COMM_WORLD);
+            }
+        }else {
+            MPI_Send(v + start,count,MPI_DOUBLE,leader,0,MPI_COMM_WORLD);
+            MPI_Recv(v + start,count,MPI_DOUBLE,leader,0,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+        }
+    }
+#endif
+}
+
+void DistributedReduceAmong(double * v, long int n, const std::vector<int> & ranks, int root) {
+#ifdef HAVE_MPI
+    int me = DistributedRank();
+    for (long int start = 0; start < n; start += DISTRIBUTED_CHUNK) {
+        int count = (int)std::min(DISTRIBUTED_CHUNK,n - start);
+        if ( me == root ) {
+            receive_buffer.resize(count);
+            for (int k = 0; k < ranks.size(); k++) {
+                if ( ranks[k] == root ) continue;
+                MPI_Recv(&receive_buffer[0],count,MPI_DOUBLE,ranks[k],0,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+                for (int i = 0; i < count; i++) {
+                    v[start + i] += receive_buffer[i];
+                }
+            }
+        }else {
+            MPI_Send(v + start,count,MPI_DOUBLE,root,0,MPI_COMM_WORLD);
+        }
+    }
+#endif
+}
+
+void DistributedBroadcastAmong(double * v, long int n, const std::vector<int> & ranks, int root) {
+#ifdef HAVE_MPI
+    int me = DistributedRank();
+    for (long int start = 0; start < n; start += DISTRIBUTED_CHUNK) {
+        int count = (int)std::min(DISTRIBUTED_CHUNK,n - start);
+        if ( me == root ) {
+            for (int k = 0; k < ranks.size(); k++) {
+                if ( ranks[k] == root ) continue;
+                MPI_Send(v + start,count,MPI_DOUBLE,ranks[k],0,MPI_COMM_WORLD);
+            }
+        }else {
+            MPI_Recv(v + start,count,MPI_DOUBLE,root,0,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+        }
+    }
+#endif
+}
+
+bool DistributedAgree(int n) {
+#ifdef HAVE_MPI
+    int nmin, nmax;
+    MPI_Allreduce(&n,&nmin,1,MPI_INT,MPI_MIN,MPI_COMM_WORLD);
+    MPI_Allreduce(&n,&nmax,1,MPI_INT,MPI_MAX,MPI_COMM_WORLD);
+    return nmin == nmax;
+#else
+    return true;
+#endif
+}
+
+std::vector<int> DistributeByCost(const std::vector<double> & cost, int nproc) {
+
+    std::vector< std::pair<double,int> > order;
+    for (int i = 0; i < cost.size(); i++) {
+        order.push_back(std::make_pair(-cost[i],i));
+    }
+    // stable, so equal costs keep their order and every rank gets the same answer
+    std::stable_sort(order.begin(),order.end());
+
+    std::vector<double> load(nproc,0.0);
+    std::vector<int> owner(cost.size(),0);
+    for (int k = 0; k < order.size(); k++) {
+        int p = std::min_element(load.begin(),load.end()) - load.begin();
+        owner[order[k].second] = p;
+        load[p] -= order[k].first;
+    }
+    return owner;
+}
+
+}}
@@ -0,0 +1,94 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include<vector>
+
+namespace psi{ namespace v2rdm_casscf{
+
+/// thin wrappers around the few MPI calls the solver makes.  without
+/// HAVE_MPI there is one rank and every call is a no-op, so the solver
+/// never needs its own #ifdefs.
+///
+/// in the distributed mode, each rank holds a contiguous range of the
+/// constraint rows and only its slice of the row-space vectors.  the
+/// eigensolves of the primal blocks are shared out, and a block is only
+/// exchanged between the ranks whose rows read it.  scalars are summed over
+/// the ranks, so all ranks make identical decisions from identical data.
+///
+/// the primal-space vectors (x, z, c, A^T.y) are still held at full length
+/// on every rank, so distributing the rows does not cut the memory for them.
+/// the blocks a rank neither reads nor diagonalizes are left out of date in
+/// the iterations and are only brought up to date where all of x is needed
+/// (orbital steps, checkpoints, and the final analysis).
+///
+/// each eigensolve runs on one rank with LAPACK.  there is no ScaLAPACK path
+/// for a block too large for one rank.
+
+/// start MPI if the host program has not.  safe to call more than once
+void DistributedInit();
+
+/// rank of this process and number of processes
+int DistributedRank();
+int DistributedSize();
+
+/// sum v over all ranks, in place.  the sum is formed on rank 0 and then
+/// broadcast, so every rank holds the same bits afterward
+void DistributedSum(double * v, long int n);
+
+/// sum v over all ranks, in place, on rank root only.  v is left
+/// unchanged on the other ranks
+void DistributedReduce(double * v, long int n, int root);
+
+/// copy v from rank root to all other ranks
+void DistributedBroadcast(double * v, long int n, int root);
+
+/// sum v over the listed ranks only, in place.  the list is in increasing
+/// order, and only the listed ranks make the call.  the sum is formed on the
+/// first of them and sent back, so they all hold the same bits afterward
+void DistributedSumAmong(double * v, long int n, const std::vector<int> & ranks);
+
+/// sum v over the listed ranks, in place, on rank root only.  root need not
+/// be listed; it and the listed ranks make the call
+void DistributedReduceAmong(double * v, long int n, const std::vector<int> & ranks, int root);
+
+/// copy v from rank root to the listed ranks.  root and the listed ranks
+/// make the call
+void DistributedBroadcastAmong(double * v, long int n, const std::vector<int> & ranks, int root);
+
+/// false if the ranks disagree on n
+bool DistributedAgree(int n);
+
+/// assign tasks of the given cost to nproc ranks, largest first, each to the
+/// least-loaded rank.  returns the rank of each task
+std::vector<int> DistributeByCost(const std::vector<double> & cost, int nproc);
+
+}}
+
+#endif
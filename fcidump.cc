@@ -0,0 +1,335 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<ctype.h>
+#include<sstream>
+
+#include <psi4-dec.h>
+#include <libmints/matrix.h>
+#include <libmints/vector.h>
+
+#include"v2rdm_solver.h"
+#include"fcidump.h"
+
+using namespace psi;
+
+namespace psi{ namespace v2rdm_casscf{
+
+FCIDUMP::FCIDUMP(const std::string & filename) {
+
+    FILE * fp = fopen(filename.c_str(),"r");
+    if ( fp == NULL ) {
+        throw PsiException("could not open FCIDUMP file " + filename,__FILE__,__LINE__);
+    }
+
+    // the &FCI namelist, which may span several lines
+    std::string header;
+    char line[1024];
+    while ( fgets(line,sizeof(line),fp) != NULL ) {
+        std::string str(line);
+        for (int i = 0; i < str.size(); i++) str[i] = toupper(str[i]);
+        size_t end = str.find("&END");
+        if ( end == std::string::npos ) end = str.find("/");
+        if ( end != std::string::npos ) {
+            header += str.substr(0,end);
+            break;
+        }
+        header += str;
+    }
+    for (int i = 0; i < header.size(); i++) {
+        if ( header[i] == ',' || header[i] == '=' ) header[i] = ' ';
+    }
+
+    // KEY value value ...
+    norb_  = 0;
+    nelec_ = 0;
+    ms2_   = 0;
+    std::string key;
+    std::stringstream ss(header);
+    std::string token;
+    while ( ss >> token ) {
+        if ( token == "&FCI" ) continue;
+        if ( isalpha(token[0]) ) {
+            key = token;
+            continue;
+        }
+        int value = atoi(token.c_str());
+        if ( key == "NORB" )        norb_  = value;
+        else if ( key == "NELEC" )  nelec_ = value;
+        else if ( key == "MS2" )    ms2_   = value;
+        else if ( key == "ORBSYM" ) orbsym_.push_back(value - 1);
+    }
+    if ( norb_ <= 0 || nelec_ <= 0 ) {
+        throw PsiException("FCIDUMP header must give NORB and NELEC",__FILE__,__LINE__);
+    }
+
+    // the hamiltonian is spin free, so MS2 and -MS2 have the same levels.
+    // keep the component with more alpha than beta electrons
+    if ( ms2_ < 0 ) {
+        ms2_ = -ms2_;
+    }
+    if ( ms2_ > nelec_ || ( nelec_ + ms2_ ) % 2 != 0 ) {
+        throw PsiException("FCIDUMP NELEC and MS2 are inconsistent",__FILE__,__LINE__);
+    }
+    if ( orbsym_.size() == 0 ) {
+        orbsym_.assign(norb_,0);
+    }
+    if ( orbsym_.size() != norb_ ) {
+        throw PsiException("FCIDUMP ORBSYM does not have NORB entries",__FILE__,__LINE__);
+    }
+
+    // the smallest point group (1, 2, 4, or 8 irreps) that holds ORBSYM
+    int maxsym = 0;
+    for (int p = 0; p < norb_; p++) {
+        if ( orbsym_[p] < 0 || orbsym_[p] > 7 ) {
+            throw PsiException("FCIDUMP ORBSYM entries must be between 1 and 8",__FILE__,__LINE__);
+        }
+        if ( orbsym_[p] > maxsym ) maxsym = orbsym_[p];
+    }
+    nirrep_ = 1;
+    while ( nirrep_ <= maxsym ) nirrep_ *= 2;
+
+    // Pitzer order: by irrep, then by position in the file
+    orbpi_.assign(nirrep_,0);
+    for (int p = 0; p < norb_; p++) {
+        orbpi_[orbsym_[p]]++;
+    }
+    std::vector<int> next(nirrep_,0);
+    for (int h = 1; h < nirrep_; h++) {
+        next[h] = next[h-1] + orbpi_[h-1];
+    }
+    pitzer_.resize(norb_);
+    for (int p = 0; p < norb_; p++) {
+        pitzer_[p] = next[orbsym_[p]]++;
+    }
+
+    long int n2 = (long int)norb_ * ( norb_ + 1 ) / 2;
+    ecore_ = 0.0;
+    oei_.assign((long int)norb_*norb_,0.0);
+    tei_.assign(n2 * ( n2 + 1 ) / 2,0.0);
+
+    // value i j k l, one per line.  orbital energies (i 0 0 0) are skipped
+    while ( fgets(line,sizeof(line),fp) != NULL ) {
+        for (char * c = line; *c != '\0'; c++) {
+            if ( *c == 'D' || *c == 'd' ) *c = 'E';
+        }
+        double val;
+        int i, j, k, l;
+        if ( sscanf(line,"%lf %d %d %d %d",&val,&i,&j,&k,&l) != 5 ) continue;
+        if ( i > norb_ || j > norb_ || k > norb_ || l > norb_ ) {
+            throw PsiException("FCIDUMP integral index exceeds NORB",__FILE__,__LINE__);
+        }
+        if ( i == 0 && j == 0 && k == 0 && l == 0 ) {
+            ecore_ = val;
+        }else if ( k == 0 && l == 0 ) {
+            if ( j == 0 ) continue;
+            int p = pitzer_[i-1];
+            int q = pitzer_[j-1];
+            oei_[(long int)p*norb_+q] = val;
+            oei_[(long int)q*norb_+p] = val;
+        }else {
+            long int pq = INDEX(pitzer_[i-1],pitzer_[j-1]);
+            long int rs = INDEX(pitzer_[k-1],pitzer_[l-1]);
+            tei_[INDEX(pq,rs)] = val;
+        }
+    }
+    fclose(fp);
+}
+
+double FCIDUMP::tei(int p, int q, int r, int s) {
+    long int pq = INDEX(p,q);
+    long int rs = INDEX(r,s);
+    return tei_[INDEX(pq,rs)];
+}
+
+// orbital spaces, occupations, and reference energy from the FCIDUMP file.
+// the orbitals are their own basis (Ca = 1), so nso = nmo.
+void v2RDMSolver::InitializeFromFCIDUMP() {
+
+    if ( options_.get_bool("OPTIMIZE_ORBITALS") ) {
+        throw PsiException("FCIDUMP_FILE gives a fixed hamiltonian: set OPTIMIZE_ORBITALS false",__FILE__,__LINE__);
+    }
+    if ( options_.get_bool("MOLDEN_WRITE") ) {
+        throw PsiException("MOLDEN_WRITE needs a basis set, which FCIDUMP_FILE does not provide",__FILE__,__LINE__);
+    }
+    if ( options_["RESTART_FROM_CHECKPOINT_FILE"].has_changed() ) {
+        throw PsiException("restarting from a checkpoint file is not supported with FCIDUMP_FILE",__FILE__,__LINE__);
+    }
+
+    nirrep_ = fcidump_->nirrep();
+    nmo_    = fcidump_->norb();
+    nso_    = nmo_;
+    nmopi_  = Dimension(nirrep_);
+    for (int h = 0; h < nirrep_; h++) {
+        nmopi_[h] = fcidump_->orbitals_per_irrep()[h];
+    }
+    nsopi_  = nmopi_;
+    frzcpi_ = Dimension(nirrep_);
+    frzvpi_ = Dimension(nirrep_);
+
+    int nelec = fcidump_->nelec();
+    nalpha_   = ( nelec + fcidump_->ms2() ) / 2;
+    nbeta_    = nelec - nalpha_;
+    if ( nalpha_ - nbeta_ != fcidump_->ms2() ) {
+        throw PsiException("FCIDUMP NELEC and MS2 are inconsistent",__FILE__,__LINE__);
+    }
+
+    // reference determinant: DOCC/SOCC if given, otherwise the orbitals
+    // are filled in file order
+    doccpi_ = Dimension(nirrep_);
+    soccpi_ = Dimension(nirrep_);
+    if ( options_["DOCC"].has_changed() ) {
+        if ( options_["DOCC"].size() != nirrep_ ) {
+            throw PsiException("The DOCC array has the wrong dimensions_",__FILE__,__LINE__);
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            doccpi_[h] = options_["DOCC"][h].to_integer();
+        }
+        if ( options_["SOCC"].has_changed() ) {
+            if ( options_["SOCC"].size() != nirrep_ ) {
+                throw PsiException("The SOCC array has the wrong dimensions_",__FILE__,__LINE__);
+            }
+            for (int h = 0; h < nirrep_; h++) {
+                soccpi_[h] = options_["SOCC"][h].to_integer();
+            }
+        }
+        if ( doccpi_.sum() != nbeta_ || soccpi_.sum() != nalpha_ - nbeta_ ) {
+            throw PsiException("DOCC/SOCC are inconsistent with FCIDUMP NELEC and MS2",__FILE__,__LINE__);
+        }
+    }else {
+        const std::vector<int> & orbsym = fcidump_->orbital_symmetry();
+        for (int p = 0; p < nalpha_; p++) {
+            if ( p < nbeta_ ) doccpi_[orbsym[p]]++;
+            else              soccpi_[orbsym[p]]++;
+        }
+    }
+    nalphapi_ = Dimension(nirrep_);
+    nbetapi_  = Dimension(nirrep_);
+    for (int h = 0; h < nirrep_; h++) {
+        nalphapi_[h] = doccpi_[h] + soccpi_[h];
+        nbetapi_[h]  = doccpi_[h];
+    }
+
+    // the core energy takes the place of the nuclear repulsion energy
+    enuc_ = fcidump_->core_energy();
+
+    // energy of the reference determinant (orbitals occupied first in each irrep)
+    std::vector<int> occ_a, occ_b;
+    int off = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < doccpi_[h] + soccpi_[h]; i++) occ_a.push_back(off + i);
+        for (int i = 0; i < doccpi_[h]; i++)              occ_b.push_back(off + i);
+        off += nmopi_[h];
+    }
+    escf_ = enuc_;
+    for (int i = 0; i < occ_a.size(); i++) escf_ += fcidump_->oei(occ_a[i],occ_a[i]);
+    for (int i = 0; i < occ_b.size(); i++) escf_ += fcidump_->oei(occ_b[i],occ_b[i]);
+    for (int i = 0; i < occ_a.size(); i++) {
+        int p = occ_a[i];
+        for (int j = 0; j < occ_a.size(); j++) {
+            int q = occ_a[j];
+            escf_ += 0.5 * ( fcidump_->tei(p,p,q,q) - fcidump_->tei(p,q,q,p) );
+        }
+        for (int j = 0; j < occ_b.size(); j++) {
+            int q = occ_b[j];
+            escf_ += fcidump_->tei(p,p,q,q);
+        }
+    }
+    for (int i = 0; i < occ_b.size(); i++) {
+        int p = occ_b[i];
+        for (int j = 0; j < occ_b.size(); j++) {
+            int q = occ_b[j];
+            escf_ += 0.5 * ( fcidump_->tei(p,p,q,q) - fcidump_->tei(p,q,q,p) );
+        }
+    }
+}
+
+// orbitals, metric, and densities for the FCIDUMP orbital basis
+void v2RDMSolver::FCIDUMPOrbitals() {
+
+    Ca_ = SharedMatrix(new Matrix("C",nmopi_,nmopi_));
+    S_  = SharedMatrix(new Matrix("S",nmopi_,nmopi_));
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < nmopi_[h]; i++) {
+            Ca_->pointer(h)[i][i] = 1.0;
+            S_->pointer(h)[i][i]  = 1.0;
+        }
+    }
+    Cb_ = Ca_;
+    Fa_ = GetFCIDUMPOEI();
+    Fb_ = Fa_;
+    Da_ = SharedMatrix(new Matrix("Da",nmopi_,nmopi_));
+    Db_ = SharedMatrix(new Matrix("Db",nmopi_,nmopi_));
+
+    // diagonal of h stands in for the orbital energies
+    epsilon_a_ = boost::shared_ptr<Vector>(new Vector(nirrep_, nmopi_));
+    int off = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < nmopi_[h]; i++) {
+            epsilon_a_->pointer(h)[i] = fcidump_->oei(off + i,off + i);
+        }
+        off += nmopi_[h];
+    }
+    epsilon_b_ = epsilon_a_;
+}
+
+// h(pq) in the symmetry-blocked layout of GetOEI
+boost::shared_ptr<Matrix> v2RDMSolver::GetFCIDUMPOEI() {
+    boost::shared_ptr<Matrix> K1 (new Matrix(nirrep_,nmopi_,nmopi_));
+    int off = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < nmopi_[h]; i++) {
+            for (int j = 0; j < nmopi_[h]; j++) {
+                K1->pointer(h)[i][j] = fcidump_->oei(off + i,off + j);
+            }
+        }
+        off += nmopi_[h];
+    }
+    return K1;
+}
+
+// (pq|rs) into tei_full_sym_, in the layout of GetTEIFromDisk
+void v2RDMSolver::GetFCIDUMPTEI() {
+    long int offset = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (long int ij = 0; ij < gems_full[h]; ij++) {
+            int i = bas_really_full_sym[h][ij][0];
+            int j = bas_really_full_sym[h][ij][1];
+            for (long int kl = ij; kl < gems_full[h]; kl++) {
+                int k = bas_really_full_sym[h][kl][0];
+                int l = bas_really_full_sym[h][kl][1];
+                tei_full_sym_[offset + INDEX(ij,kl)] = fcidump_->tei(i,j,k,l);
+            }
+        }
+        offset += (long int)gems_full[h] * ( (long int)gems_full[h] + 1 ) / 2;
+    }
+}
+
+}}
@@ -0,0 +1,95 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#ifndef FCIDUMP_H
+#define FCIDUMP_H
+
+#include<string>
+#include<vector>
+
+namespace psi{ namespace v2rdm_casscf{
+
+/// the hamiltonian from an FCIDUMP file:
+///
+///     &FCI NORB=4,NELEC=4,MS2=0,
+///      ORBSYM=1,1,2,3,
+///      ISYM=1,
+///     &END
+///       0.6757  1  1  1  1      (pq|rs)
+///      -1.2527  1  1  0  0      h(pq)
+///       0.7137  0  0  0  0      core energy
+///
+/// ORBSYM numbers the irreps from 1, and their products must follow the
+/// XOR rule of D2h and its subgroups (as in Molpro, PySCF, and Psi4).
+/// orbitals are renumbered by irrep (Pitzer order), keeping the file order
+/// within each irrep.  all indices below are Pitzer indices.
+class FCIDUMP {
+public:
+
+    FCIDUMP(const std::string & filename);
+
+    int norb()  { return norb_; }
+    int nelec() { return nelec_; }
+    /// |MS2| (a negative MS2 describes the same levels)
+    int ms2()   { return ms2_; }
+    int nirrep() { return nirrep_; }
+
+    /// number of orbitals in each irrep
+    const std::vector<int> & orbitals_per_irrep() { return orbpi_; }
+
+    /// Pitzer index of each orbital, in file order
+    const std::vector<int> & pitzer_index() { return pitzer_; }
+
+    /// irrep of each orbital, in file order
+    const std::vector<int> & orbital_symmetry() { return orbsym_; }
+
+    /// nuclear repulsion plus any core energy
+    double core_energy() { return ecore_; }
+
+    /// h(pq) and (pq|rs)
+    double oei(int p, int q) { return oei_[(long int)p*norb_+q]; }
+    double tei(int p, int q, int r, int s);
+
+private:
+
+    int norb_;
+    int nelec_;
+    int ms2_;
+    int nirrep_;
+    double ecore_;
+    std::vector<int> orbsym_;
+    std::vector<int> orbpi_;
+    std::vector<int> pitzer_;
+    std::vector<double> oei_;
+
+    /// (pq|rs), packed over the 8-fold permutational symmetry
+    std::vector<double> tei_;
+};
+
+}}
+
+#endif
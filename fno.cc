@@ -0,0 +1,386 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include<algorithm>
+
+#include <psi4-dec.h>
+#include <psifiles.h>
+#include <libmints/mints.h>
+#include <libmints/sieve.h>
+#include <libpsio/psio.hpp>
+#include <../bin/fnocc/blas.h>
+
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+
+#include"v2rdm_solver.h"
+
+#ifdef _OPENMP
+    #include<omp.h>
+#else
+    #define omp_get_max_threads() 1
+    #define omp_get_thread_num() 0
+#endif
+
+using namespace psi;
+using namespace fnocc;
+
+namespace psi{ namespace v2rdm_casscf{
+
+// energy order, ties in pitzer order (as in CaSubsetAO)
+static bool LowerOrbitalEnergy(const boost::tuple<double,int,int> & a, const boost::tuple<double,int,int> & b) {
+    return boost::get<0>(a) < boost::get<0>(b);
+}
+
+/*
+ * replace the restricted virtuals of each irrep with their MP2 natural
+ * orbitals, and freeze those whose occupation falls below
+ * FNO_OCC_TOLERANCE.  the kept and the frozen natural orbitals are each
+ * semicanonicalized, so the orbital energies stay meaningful for the
+ * energy ordering used by the integral transformations.  the active
+ * orbitals are not touched.
+ */
+void v2RDMSolver::FrozenNaturalOrbitals() {
+
+    if ( !is_df_ ) {
+        throw PsiException("FROZEN_NATURAL_ORBITALS requires SCF_TYPE DF or CD",__FILE__,__LINE__);
+    }
+    if ( soccpi_.sum() > 0 ) {
+        throw PsiException("FROZEN_NATURAL_ORBITALS requires a closed-shell reference",__FILE__,__LINE__);
+    }
+    if ( options_.get_bool("SCAN_WARM_START") ) {
+        throw PsiException("FROZEN_NATURAL_ORBITALS cannot be combined with SCAN_WARM_START",__FILE__,__LINE__);
+    }
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Frozen natural orbitals <==\n");
+    outfile->Printf("\n");
+
+    int nrstv = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        nrstv += rstvpi_[h];
+    }
+    if ( nrstv == 0 ) {
+        outfile->Printf("        No restricted virtual orbitals to truncate.\n");
+        Process::environment.globals["v2RDM FNO FROZEN VIRTUALS"] = 0.0;
+        return;
+    }
+
+    double start = omp_get_wtime();
+
+    // the reference keeps its own orbitals.  the integral transformations
+    // use Ca_ and epsilon_a_ (see CaSubsetAO)
+    Ca_ = Ca_->clone();
+
+    // occupied and virtual orbitals in energy order (the order of CaSubsetAO)
+    std::vector< boost::tuple<double,int,int> > occ, vir;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int j = 0; j < nmopi_[h]; j++) {
+            if ( j < doccpi_[h] ) occ.push_back(boost::make_tuple(epsilon_a_->pointer(h)[j],j,h));
+            else                  vir.push_back(boost::make_tuple(epsilon_a_->pointer(h)[j],j,h));
+        }
+    }
+    std::stable_sort(occ.begin(),occ.end(),LowerOrbitalEnergy);
+    std::stable_sort(vir.begin(),vir.end(),LowerOrbitalEnergy);
+
+    long int nocc = occ.size();
+    long int nvir = vir.size();
+    long int nov  = nocc * nvir;
+
+    double * eps_o = (double*)malloc(nocc*sizeof(double));
+    double * eps_v = (double*)malloc(nvir*sizeof(double));
+    for (long int i = 0; i < nocc; i++) eps_o[i] = boost::get<0>(occ[i]);
+    for (long int a = 0; a < nvir; a++) eps_v[a] = boost::get<0>(vir[a]);
+
+    // position of each virtual (irrep h, index j) in energy order
+    std::vector< std::vector<long int> > vir_index(nirrep_);
+    for (int h = 0; h < nirrep_; h++) {
+        vir_index[h].assign(nmopi_[h],-1);
+    }
+    for (long int a = 0; a < nvir; a++) {
+        vir_index[boost::get<2>(vir[a])][boost::get<1>(vir[a])] = a;
+    }
+
+    // (Q|mn) from the scf
+    basisset_ = reference_wavefunction_->basisset();
+    boost::shared_ptr<ERISieve> sieve (new ERISieve(basisset_, options_.get_double("INTS_TOLERANCE")));
+    const std::vector<std::pair<int, int> >& function_pairs = sieve->function_pairs();
+    long int ntri = function_pairs.size();
+
+    nQ_ = Process::environment.globals["NAUX (SCF)"];
+    if ( options_.get_str("SCF_TYPE") == "DF" ) {
+        boost::shared_ptr<BasisSet> primary = BasisSet::pyconstruct_orbital(molecule_,
+            "BASIS", options_.get_str("BASIS"));
+
+        boost::shared_ptr<BasisSet> auxiliary = BasisSet::pyconstruct_auxiliary(molecule_,
+            "DF_BASIS_SCF", options_.get_str("DF_BASIS_SCF"), "JKFIT",
+            options_.get_str("BASIS"), primary->has_puream());
+
+        nQ_ = auxiliary->nbf();
+        Process::environment.globals["NAUX (SCF)"] = nQ_;
+    }
+
+    int nthread = omp_get_max_threads();
+    long int nso = nso_;
+
+    // (Q|ia), per-thread transformation and pair buffers, and D(ab).  the
+    // solution kept from the previous point of a scan is still held here
+    double need = (double)nQ_ * nov + (double)nthread * ( nso * nso + nocc * nso )
+                + (double)nthread * 4.0 * nvir * nvir + (double)nvir * nvir
+                + ScanStateDoubles();
+    long int ndoubles = memory_ / 8L - (long int)need;
+    if ( ndoubles < ntri ) {
+        outfile->Printf("        Increase the available memory by %7.2lf mb.\n",
+            ( need + ntri - memory_ / 8.0 ) * 8.0 / 1024.0 / 1024.0);
+        throw PsiException("not enough memory for the frozen natural orbital MP2 density",__FILE__,__LINE__);
+    }
+    long int rowsize = ndoubles / ntri;
+    if ( rowsize > nQ_ ) rowsize = nQ_;
+
+    // reported by PlanMemory
+    fno_peak_ = need + (double)rowsize * ntri;
+
+    boost::shared_ptr<Matrix> Cocc = CaSubsetAO("OCC");
+    boost::shared_ptr<Matrix> Cvir = CaSubsetAO("VIR");
+    double * co = Cocc->pointer()[0];
+    double * cv = Cvir->pointer()[0];
+
+    double * Qov  = (double*)malloc(nQ_*nov*sizeof(double));
+    double * Qso  = (double*)malloc(rowsize*ntri*sizeof(double));
+    double * tmp1 = (double*)malloc(nthread*nso*nso*sizeof(double));
+    double * tmp2 = (double*)malloc(nthread*nocc*nso*sizeof(double));
+
+    // (Q|mn) -> (Q|ia), one Q at a time
+    boost::shared_ptr<PSIO> psio(new PSIO());
+    psio->open(PSIF_DFSCF_BJ,PSIO_OPEN_OLD);
+    psio_address addr = PSIO_ZERO;
+    for (long int Q0 = 0; Q0 < nQ_; Q0 += rowsize) {
+        long int nrow = std::min(rowsize,nQ_-Q0);
+        psio->read(PSIF_DFSCF_BJ, "(Q|mn) Integrals", (char*) Qso, sizeof(double) * ntri * nrow,addr,&addr);
+
+        #pragma omp parallel for schedule (static)
+        for (long int Q = 0; Q < nrow; Q++) {
+            int thread = omp_get_thread_num();
+            double * A = tmp1 + thread * nso * nso;
+            double * X = tmp2 + thread * nocc * nso;
+            memset((void*)A,'\0',nso*nso*sizeof(double));
+            for (long int mn = 0; mn < ntri; mn++) {
+                long int m = function_pairs[mn].first;
+                long int n = function_pairs[mn].second;
+                A[m*nso+n] = Qso[Q*ntri+mn];
+                A[n*nso+m] = Qso[Q*ntri+mn];
+            }
+            // X(i,n) = C(m,i) A(m,n), then (Q|ia) = X(i,n) C(n,a)
+            F_DGEMM('n','t',nso,nocc,nso,1.0,A,nso,co,nocc,0.0,X,nso);
+            F_DGEMM('n','n',nvir,nocc,nso,1.0,cv,nvir,X,nso,0.0,Qov+(Q0+Q)*nov,nvir);
+        }
+    }
+    psio->close(PSIF_DFSCF_BJ,1);
+
+    free(tmp2);
+    free(tmp1);
+    free(Qso);
+
+    // D(ab) = 2 sum_ijc t(ij,ac) [ 2 t(ij,bc) - t(ij,cb) ].  I, T, and T~
+    // below are stored column-major: I[b*nvir+a] = (ia|jb)
+    double * I    = (double*)malloc(nthread*nvir*nvir*sizeof(double));
+    double * T    = (double*)malloc(nthread*nvir*nvir*sizeof(double));
+    double * Tt   = (double*)malloc(nthread*nvir*nvir*sizeof(double));
+    double * Dthr = (double*)malloc(nthread*nvir*nvir*sizeof(double));
+    double * emp2 = (double*)malloc(nthread*sizeof(double));
+    memset((void*)Dthr,'\0',nthread*nvir*nvir*sizeof(double));
+    memset((void*)emp2,'\0',nthread*sizeof(double));
+
+    #pragma omp parallel for schedule (dynamic)
+    for (long int ij = 0; ij < nocc*(nocc+1)/2; ij++) {
+        long int i = 0;
+        while ( (i+1)*(i+2)/2 <= ij ) i++;
+        long int j = ij - i*(i+1)/2;
+
+        int thread = omp_get_thread_num();
+        double * Iij = I    + thread * nvir * nvir;
+        double * Tij = T    + thread * nvir * nvir;
+        double * Uij = Tt   + thread * nvir * nvir;
+        double * Dij = Dthr + thread * nvir * nvir;
+
+        F_DGEMM('n','t',nvir,nvir,nQ_,1.0,Qov+i*nvir,nov,Qov+j*nvir,nov,0.0,Iij,nvir);
+
+        double e = 0.0;
+        for (long int b = 0; b < nvir; b++) {
+            for (long int a = 0; a < nvir; a++) {
+                Tij[b*nvir+a] = Iij[b*nvir+a] / ( eps_o[i] + eps_o[j] - eps_v[a] - eps_v[b] );
+            }
+        }
+        for (long int b = 0; b < nvir; b++) {
+            for (long int a = 0; a < nvir; a++) {
+                Uij[b*nvir+a] = 2.0 * Tij[b*nvir+a] - Tij[a*nvir+b];
+                e += Tij[b*nvir+a] * ( 2.0 * Iij[b*nvir+a] - Iij[a*nvir+b] );
+            }
+        }
+
+        // pair ij, and pair ji (whose amplitudes are the transpose)
+        F_DGEMM('n','t',nvir,nvir,nvir,2.0,Tij,nvir,Uij,nvir,1.0,Dij,nvir);
+        if ( i != j ) {
+            F_DGEMM('t','n',nvir,nvir,nvir,2.0,Tij,nvir,Uij,nvir,1.0,Dij,nvir);
+            e *= 2.0;
+        }
+        emp2[thread] += e;
+    }
+
+    double * D = Dthr;
+    double ecorr = emp2[0];
+    for (int thread = 1; thread < nthread; thread++) {
+        C_DAXPY(nvir*nvir,1.0,Dthr+thread*nvir*nvir,1,D,1);
+        ecorr += emp2[thread];
+    }
+
+    free(emp2);
+    free(Tt);
+    free(T);
+    free(I);
+    free(Qov);
+
+    // natural orbitals of the restricted virtuals in each irrep
+    double tol = options_.get_double("FNO_OCC_TOLERANCE");
+    int * nfrozen = (int*)malloc(nirrep_*sizeof(int));
+    memset((void*)nfrozen,'\0',nirrep_*sizeof(int));
+
+    for (int h = 0; h < nirrep_; h++) {
+
+        int nv = rstvpi_[h];
+        if ( nv == 0 ) continue;
+        int first = nmopi_[h] - frzvpi_[h] - nv;
+
+        boost::shared_ptr<Matrix> Dh (new Matrix("D",nv,nv));
+        for (int k = 0; k < nv; k++) {
+            long int a = vir_index[h][first+k];
+            for (int l = 0; l < nv; l++) {
+                long int b = vir_index[h][first+l];
+                Dh->pointer()[k][l] = 0.5 * ( D[b*nvir+a] + D[a*nvir+b] );
+            }
+        }
+        boost::shared_ptr<Matrix> U (new Matrix("U",nv,nv));
+        boost::shared_ptr<Vector> n (new Vector("n",nv));
+        Dh->diagonalize(U,n,descending);
+
+        int nkeep = 0;
+        while ( nkeep < nv && n->pointer()[nkeep] >= tol ) nkeep++;
+        nfrozen[h] = nv - nkeep;
+
+        // semicanonicalize the kept and the frozen natural orbitals
+        boost::shared_ptr<Matrix> V (new Matrix("V",nv,nv));
+        double * eps = epsilon_a_->pointer(h) + first;
+        double * neweps = (double*)malloc(nv*sizeof(double));
+        int block_start[2] = {0, nkeep};
+        int block_size[2]  = {nkeep, nv - nkeep};
+        for (int block = 0; block < 2; block++) {
+            int off = block_start[block];
+            int nb  = block_size[block];
+            if ( nb == 0 ) continue;
+            boost::shared_ptr<Matrix> F (new Matrix("F",nb,nb));
+            for (int k = 0; k < nb; k++) {
+                for (int l = 0; l < nb; l++) {
+                    double dum = 0.0;
+                    for (int m = 0; m < nv; m++) {
+                        dum += U->pointer()[m][off+k] * eps[m] * U->pointer()[m][off+l];
+                    }
+                    F->pointer()[k][l] = dum;
+                }
+            }
+            boost::shared_ptr<Matrix> W (new Matrix("W",nb,nb));
+            boost::shared_ptr<Vector> e (new Vector("e",nb));
+            F->diagonalize(W,e,ascending);
+            for (int m = 0; m < nv; m++) {
+                for (int k = 0; k < nb; k++) {
+                    double dum = 0.0;
+                    for (int l = 0; l < nb; l++) {
+                        dum += U->pointer()[m][off+l] * W->pointer()[l][k];
+                    }
+                    V->pointer()[m][off+k] = dum;
+                }
+            }
+            for (int k = 0; k < nb; k++) {
+                neweps[off+k] = e->pointer()[k];
+            }
+        }
+
+        // rotate the restricted virtual columns of C
+        double ** cp = Ca_->pointer(h);
+        double * row = (double*)malloc(nv*sizeof(double));
+        for (int mu = 0; mu < nsopi_[h]; mu++) {
+            for (int k = 0; k < nv; k++) {
+                double dum = 0.0;
+                for (int l = 0; l < nv; l++) {
+                    dum += cp[mu][first+l] * V->pointer()[l][k];
+                }
+                row[k] = dum;
+            }
+            for (int k = 0; k < nv; k++) {
+                cp[mu][first+k] = row[k];
+            }
+        }
+        free(row);
+
+        for (int k = 0; k < nv; k++) {
+            epsilon_a_->pointer(h)[first+k] = neweps[k];
+            epsilon_b_->pointer(h)[first+k] = neweps[k];
+        }
+        free(neweps);
+
+        rstvpi_[h] -= nfrozen[h];
+        frzvpi_[h] += nfrozen[h];
+    }
+
+    Cb_ = Ca_->clone();
+
+    free(Dthr);
+    free(eps_v);
+    free(eps_o);
+
+    double end = omp_get_wtime();
+
+    outfile->Printf("        MP2 correlation energy:          %20.12lf\n",ecorr);
+    outfile->Printf("        Occupation tolerance:            %20.2le\n",tol);
+    outfile->Printf("\n");
+    outfile->Printf("        Irrep    restricted virtuals    kept    frozen\n");
+    for (int h = 0; h < nirrep_; h++) {
+        outfile->Printf("        %5i    %19i  %6i    %6i\n",h,rstvpi_[h]+nfrozen[h],rstvpi_[h],nfrozen[h]);
+    }
+    outfile->Printf("\n");
+    outfile->Printf("        Time for frozen natural orbitals:  %7.2lf s\n",end-start);
+
+    int nfrozen_total = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        nfrozen_total += nfrozen[h];
+    }
+    Process::environment.globals["v2RDM FNO FROZEN VIRTUALS"] = (double)nfrozen_total;
+    Process::environment.globals["v2RDM FNO MP2 CORRELATION ENERGY"] = ecorr;
+
+    free(nfrozen);
+}
+
+}}
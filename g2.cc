@@ -55,7 +55,7 @@ using namespace fnocc;
 
 namespace psi{ namespace v2rdm_casscf{
 
-void v2RDMSolver::G2_constraints_guess_spin_adapted(SharedVector u){
+void v2RDMSolver::G2_constraints_guess_spin_adapted(SharedSolverVector u){
 
     double * u_p = u->pointer();
 
@@ -234,132 +234,153 @@ void v2RDMSolver::G2_constraints_guess_spin_adapted(SharedVector u){
         offset += gems_ab[h]*gems_ab[h];
     }
 }
-void v2RDMSolver::G2_constraints_Au_spin_adapted(SharedVector A,SharedVector u){
+void v2RDMSolver::G2_constraints_Au_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_G2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = RowPointer(A[v]);
+        u_p[v] = u[v]->pointer();
+    }
 
     // G200
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = -u_p[g2soff[h] + ijg*gems_ab[h]+klg];          // - G2s(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2soff[h] + ijg*gems_ab[h]+klg];          // - G2s(ij,kl)
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum       +=  u_p[d1aoff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
-                    dum       +=  u_p[d1boff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]       +=  u_p[v][d1aoff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
+                            dum[v]       +=  u_p[v][d1boff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
+                        }
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int jks = ibas_00_sym[h2][j][k];
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int jks = ibas_00_sym[h2][j][k];
 
-                //dum       +=  u_p[d2soff[h2] + INDEX(ils,jks)] * 0.5; //   D2s(li,kj)
+                    //dum       +=  u_p[d2soff[h2] + INDEX(ils,jks)] * 0.5; //   D2s(li,kj)
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
-                    dum       -=  u_p[d2aaoff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2aa(il,kj)
-                    dum       -=  u_p[d2bboff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2bb(il,kj)
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]       -=  u_p[v][d2aaoff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2aa(il,kj)
+                            dum[v]       -=  u_p[v][d2bboff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2bb(il,kj)
+                        }
 
-                    //int ilt = ibas_aa_sym[h2][i][l];
-                    //int kjt = ibas_aa_sym[h2][k][j];
-                    //dum       -=  u_p[d2toff[h2]    + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D210(il,kj)
-                    //dum       -=  u_p[d2toff_p1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
-                    //dum       -=  u_p[d2toff_m1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D21-1(il,kj)
+                        //int ilt = ibas_aa_sym[h2][i][l];
+                        //int kjt = ibas_aa_sym[h2][k][j];
+                        //dum       -=  u_p[d2toff[h2]    + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D210(il,kj)
+                        //dum       -=  u_p[d2toff_p1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
+                        //dum       -=  u_p[d2toff_m1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D21-1(il,kj)
 
-                }
+                    }
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                dum       +=  u_p[d2aboff[h2] + ild*gems_ab[h2]+jkd] * 0.5; // D2ab(il,jk)
+                    for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d2aboff[h2] + ild*gems_ab[h2]+jkd] * 0.5; // D2ab(il,jk)
 
-                int lid = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                dum       +=  u_p[d2aboff[h2] + lid*gems_ab[h2]+kjd] * 0.5; // D2ab(li,kj)
+                    for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d2aboff[h2] + lid*gems_ab[h2]+kjd] * 0.5; // D2ab(li,kj)
 
-                A_p[offset + ijg*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*gems_ab[h]+klg] = dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
     // G210
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = -u_p[g2toff[h] + ijg*gems_ab[h]+klg];          // - G2t(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2toff[h] + ijg*gems_ab[h]+klg];          // - G2t(ij,kl)
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum       +=  u_p[d1aoff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
-                    dum       +=  u_p[d1boff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]       +=  u_p[v][d1aoff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
+                            dum[v]       +=  u_p[v][d1boff[h3] + ii*amopi_[h3]+kk] * 0.5; //   D1(i,k) djl
+                        }
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int jks = ibas_00_sym[h2][j][k];
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int jks = ibas_00_sym[h2][j][k];
 
-                //dum       -=  u_p[d2soff[h2] + INDEX(ils,jks)] * 0.5; //   D2s(li,kj)
+                    //dum       -=  u_p[d2soff[h2] + INDEX(ils,jks)] * 0.5; //   D2s(li,kj)
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
-                    dum       -=  u_p[d2aaoff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2aa(il,kj)
-                    dum       -=  u_p[d2bboff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2bb(il,kj)
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]       -=  u_p[v][d2aaoff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2aa(il,kj)
+                            dum[v]       -=  u_p[v][d2bboff[h2] + ild*gems_aa[h2]+kjd] * sil * skj * 0.5; // -D2bb(il,kj)
+                        }
 
-                    //int ilt = ibas_aa_sym[h2][i][l];
-                    //int kjt = ibas_aa_sym[h2][k][j];
-                    //dum       +=  u_p[d2toff[h2]    + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D210(il,kj)
-                    //dum       -=  u_p[d2toff_p1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
-                    //dum       -=  u_p[d2toff_m1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D21-1(il,kj)
+                        //int ilt = ibas_aa_sym[h2][i][l];
+                        //int kjt = ibas_aa_sym[h2][k][j];
+                        //dum       +=  u_p[d2toff[h2]    + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D210(il,kj)
+                        //dum       -=  u_p[d2toff_p1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
+                        //dum       -=  u_p[d2toff_m1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D21-1(il,kj)
 
-                }
+                    }
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                dum       -=  u_p[d2aboff[h2] + ild*gems_ab[h2]+jkd] * 0.5; // D2ab(il,jk)
+                    for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2aboff[h2] + ild*gems_ab[h2]+jkd] * 0.5; // D2ab(il,jk)
 
-                int lid = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                dum       -=  u_p[d2aboff[h2] + lid*gems_ab[h2]+kjd] * 0.5; // D2ab(li,kj)
+                    for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2aboff[h2] + lid*gems_ab[h2]+kjd] * 0.5; // D2ab(li,kj)
 
-                A_p[offset + ijg*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*gems_ab[h]+klg] = dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
@@ -367,102 +388,108 @@ void v2RDMSolver::G2_constraints_Au_spin_adapted(SharedVector A,SharedVector u){
        
     // G211 constraints:
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = -u_p[g2toff_p1[h] + ijg*gems_ab[h]+klg];    // - G2ab(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2toff_p1[h] + ijg*gems_ab[h]+klg];    // - G2ab(ij,kl)
 
-                if ( j==l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum   +=  u_p[d1aoff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
-                }
+                    if ( j==l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) dum[v]   +=  u_p[v][d1aoff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                dum       -=  u_p[d2aboff[h2] + ild*gems_ab[h2]+kjd];   // - D2ab(il,kj)
+                    for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2aboff[h2] + ild*gems_ab[h2]+kjd];   // - D2ab(il,kj)
 
-                //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int kjs = ibas_00_sym[h2][k][j];
-                //dum       -=  u_p[d2soff[h2] + INDEX(ils,kjs)] * 0.5; //   D2s(li,kj)
+                    //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int kjs = ibas_00_sym[h2][k][j];
+                    //dum       -=  u_p[d2soff[h2] + INDEX(ils,kjs)] * 0.5; //   D2s(li,kj)
 
-                //if ( i != l && k != j ) {
+                    //if ( i != l && k != j ) {
 
-                //    int sil = ( i < l ? 1 : -1 );
-                //    int skj = ( k < j ? 1 : -1 );
+                    //    int sil = ( i < l ? 1 : -1 );
+                    //    int skj = ( k < j ? 1 : -1 );
 
-                //    int ilt = ibas_aa_sym[h2][i][l];
-                //    int kjt = ibas_aa_sym[h2][k][j];
+                    //    int ilt = ibas_aa_sym[h2][i][l];
+                    //    int kjt = ibas_aa_sym[h2][k][j];
 
-                //    dum       -=  u_p[d2toff_p1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
+                    //    dum       -=  u_p[d2toff_p1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
 
-                //}
+                    //}
 
-                A_p[offset + ijg*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*gems_ab[h]+klg] = dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
     // G21-1 constraints:
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = -u_p[g2toff_m1[h] + ijg*gems_ab[h]+klg];    // - G2ab(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2toff_m1[h] + ijg*gems_ab[h]+klg];    // - G2ab(ij,kl)
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum   +=  u_p[d1boff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) dum[v]   +=  u_p[v][d1boff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][j][k];
 
-                dum       -=  u_p[d2aboff[h2] + ild*gems_ab[h2]+kjd];   // - D2ab(il,kj)
+                    for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2aboff[h2] + ild*gems_ab[h2]+kjd];   // - D2ab(il,kj)
 
-                //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int kjs = ibas_00_sym[h2][k][j];
-                //dum       -=  u_p[d2soff[h2] + INDEX(ils,kjs)] * 0.5; //   D2s(li,kj)
+                    //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int kjs = ibas_00_sym[h2][k][j];
+                    //dum       -=  u_p[d2soff[h2] + INDEX(ils,kjs)] * 0.5; //   D2s(li,kj)
 
-                //if ( i != l && k != j ) {
+                    //if ( i != l && k != j ) {
 
-                //    int sil = ( i < l ? 1 : -1 );
-                //    int skj = ( k < j ? 1 : -1 );
+                    //    int sil = ( i < l ? 1 : -1 );
+                    //    int skj = ( k < j ? 1 : -1 );
 
-                //    int ilt = ibas_aa_sym[h2][i][l];
-                //    int kjt = ibas_aa_sym[h2][k][j];
+                    //    int ilt = ibas_aa_sym[h2][i][l];
+                    //    int kjt = ibas_aa_sym[h2][k][j];
 
-                //    dum       -=  u_p[d2toff_m1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
+                    //    dum       -=  u_p[d2toff_m1[h2] + INDEX(ilt,kjt)] * sil * skj * 0.5; //   D211(il,kj)
 
-                //}
+                    //}
 
-                A_p[offset + ijg*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*gems_ab[h]+klg] = dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
@@ -548,243 +575,268 @@ printf("%20.12lf\n",maxs);
 
 }
 // G2 portion of A^T.y (spin adapted)
-void v2RDMSolver::G2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u){
+void v2RDMSolver::G2_constraints_ATu_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_G2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = A[v]->pointer();
+        u_p[v] = RowPointer(u[v]);
+    }
 
     // G200
     for (int h = 0; h < nirrep_; h++) {
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*gems_ab[h]+klg];
 
-                A_p[g2soff[h] + ijg*gems_ab[h]+klg] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2soff[h] + ijg*gems_ab[h]+klg] -= dum[v];
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1aoff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum;
-                    A_p[d1boff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum;
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d1aoff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum[v];
+                            A_p[v][d1boff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum[v];
+                        }
+                    }
 
-                //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int jks = ibas_00_sym[h2][j][k];
-                //A_p[d2soff[h2] + INDEX(ils,jks)] += dum * 0.5;
+                    //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int jks = ibas_00_sym[h2][j][k];
+                    //A_p[d2soff[h2] + INDEX(ils,jks)] += dum * 0.5;
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                        int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
 
-                    A_p[d2aaoff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum * sil * skj;
-                    A_p[d2bboff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum * sil * skj;
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d2aaoff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum[v] * sil * skj;
+                            A_p[v][d2bboff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum[v] * sil * skj;
+                        }
 
-                    //int ilt = ibas_aa_sym[h2][i][l];
-                    //int kjt = ibas_aa_sym[h2][k][j];
-                    //A_p[d2toff[h2]    + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 10
-                    //A_p[d2toff_p1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 11
-                    //A_p[d2toff_m1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 1-1
-                }
+                        //int ilt = ibas_aa_sym[h2][i][l];
+                        //int kjt = ibas_aa_sym[h2][k][j];
+                        //A_p[d2toff[h2]    + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 10
+                        //A_p[d2toff_p1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 11
+                        //A_p[d2toff_m1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 1-1
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                A_p[d2aboff[h2] + ild*gems_ab[h2]+jkd] += 0.5 * dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ild*gems_ab[h2]+jkd] += 0.5 * dum[v];
 
-                int lid = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                A_p[d2aboff[h2] + lid*gems_ab[h2]+kjd] += 0.5 * dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + lid*gems_ab[h2]+kjd] += 0.5 * dum[v];
+                }
             }
         }
-
         offset += gems_ab[h]*gems_ab[h];
     }
     // G210
     for (int h = 0; h < nirrep_; h++) {
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*gems_ab[h]+klg];
 
-                A_p[g2toff[h] + ijg*gems_ab[h]+klg] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2toff[h] + ijg*gems_ab[h]+klg] -= dum[v];
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1aoff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum;
-                    A_p[d1boff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum;
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d1aoff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum[v];
+                            A_p[v][d1boff[h3] + ii*amopi_[h3]+kk]         += 0.5 * dum[v];
+                        }
+                    }
 
-                //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int jks = ibas_00_sym[h2][j][k];
+                    //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int jks = ibas_00_sym[h2][j][k];
 
-                //A_p[d2soff[h2] + INDEX(ils,jks)] -= dum * 0.5;
+                    //A_p[d2soff[h2] + INDEX(ils,jks)] -= dum * 0.5;
 
-                //if ( i != l && k != j ) {
+                    //if ( i != l && k != j ) {
 
-                //    int sil = ( i < l ? 1 : -1 );
-                //    int skj = ( k < j ? 1 : -1 );
+                    //    int sil = ( i < l ? 1 : -1 );
+                    //    int skj = ( k < j ? 1 : -1 );
 
-                //    int ilt = ibas_aa_sym[h2][i][l];
-                //    int kjt = ibas_aa_sym[h2][k][j];
+                    //    int ilt = ibas_aa_sym[h2][i][l];
+                    //    int kjt = ibas_aa_sym[h2][k][j];
 
-                //    A_p[d2toff[h2]    + INDEX(ilt,kjt)] += dum * sil * skj * 0.5; // 10
-                //    A_p[d2toff_p1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 11
-                //    A_p[d2toff_m1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 1-1
-                //}
+                    //    A_p[d2toff[h2]    + INDEX(ilt,kjt)] += dum * sil * skj * 0.5; // 10
+                    //    A_p[d2toff_p1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 11
+                    //    A_p[d2toff_m1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5; // 1-1
+                    //}
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                        int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
 
-                    A_p[d2aaoff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum * sil * skj;
-                    A_p[d2bboff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum * sil * skj;
-                }
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][d2aaoff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum[v] * sil * skj;
+                            A_p[v][d2bboff[h2] + ild*gems_aa[h2]+kjd] -= 0.5 * dum[v] * sil * skj;
+                        }
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                A_p[d2aboff[h2] + ild*gems_ab[h2]+jkd] -= 0.5 * dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ild*gems_ab[h2]+jkd] -= 0.5 * dum[v];
 
-                int lid = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                A_p[d2aboff[h2] + lid*gems_ab[h2]+kjd] -= 0.5 * dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + lid*gems_ab[h2]+kjd] -= 0.5 * dum[v];
+                }
             }
         }
-
         offset += gems_ab[h]*gems_ab[h];
     }
     // G211 constraints:
     for (int h = 0; h < nirrep_; h++) {
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*gems_ab[h]+klg];
 
-                A_p[g2toff_p1[h] + ijg*gems_ab[h]+klg] -= dum;    // - G2ab(ij,kl)
+                    for (int v = 0; v < nvec; v++) A_p[v][g2toff_p1[h] + ijg*gems_ab[h]+klg] -= dum[v];    // - G2ab(ij,kl)
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1aoff[h3] + ii*amopi_[h3]+kk] += dum;      //   D1(i,k) djl
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h3] + ii*amopi_[h3]+kk] += dum[v];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                A_p[d2aboff[h2] + ild*gems_ab[h2]+kjd] -= dum;   // - D2ab(il,kj)
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ild*gems_ab[h2]+kjd] -= dum[v];   // - D2ab(il,kj)
 
-                //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int kjs = ibas_00_sym[h2][k][j];
-                //A_p[d2soff[h2] + INDEX(ils,kjs)]             -= dum * 0.5;
+                    //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int kjs = ibas_00_sym[h2][k][j];
+                    //A_p[d2soff[h2] + INDEX(ils,kjs)]             -= dum * 0.5;
 
-                //if ( i != l && k != j ) {
+                    //if ( i != l && k != j ) {
 
-                //    int sil = ( i < l ? 1 : -1 );
-                //    int skj = ( k < j ? 1 : -1 );
+                    //    int sil = ( i < l ? 1 : -1 );
+                    //    int skj = ( k < j ? 1 : -1 );
 
-                //    int ilt = ibas_aa_sym[h2][i][l];
-                //    int kjt = ibas_aa_sym[h2][k][j];
+                    //    int ilt = ibas_aa_sym[h2][i][l];
+                    //    int kjt = ibas_aa_sym[h2][k][j];
 
-                //    A_p[d2toff_p1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5;
-                //}
+                    //    A_p[d2toff_p1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5;
+                    //}
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
     // G21-1 constraints:
     for (int h = 0; h < nirrep_; h++) {
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*gems_ab[h]+klg];
 
-                A_p[g2toff_m1[h] + ijg*gems_ab[h]+klg] -= dum;    // - G2ab(ij,kl)
+                    for (int v = 0; v < nvec; v++) A_p[v][g2toff_m1[h] + ijg*gems_ab[h]+klg] -= dum[v];    // - G2ab(ij,kl)
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1boff[h3] + ii*amopi_[h3]+kk] += dum;      //   D1(i,k) djl
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1boff[h3] + ii*amopi_[h3]+kk] += dum[v];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][j][k];
 
-                A_p[d2aboff[h2] + ild*gems_ab[h2]+kjd] -= dum;   // - D2ab(il,kj)
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ild*gems_ab[h2]+kjd] -= dum[v];   // - D2ab(il,kj)
 
-                //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                //int ils = ibas_00_sym[h2][i][l];
-                //int kjs = ibas_00_sym[h2][k][j];
-                //A_p[d2soff[h2] + INDEX(ils,kjs)]             -= dum * 0.5;
+                    //int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    //int ils = ibas_00_sym[h2][i][l];
+                    //int kjs = ibas_00_sym[h2][k][j];
+                    //A_p[d2soff[h2] + INDEX(ils,kjs)]             -= dum * 0.5;
 
-                //if ( i != l && k != j ) {
+                    //if ( i != l && k != j ) {
 
-                //    int sil = ( i < l ? 1 : -1 );
-                //    int skj = ( k < j ? 1 : -1 );
+                    //    int sil = ( i < l ? 1 : -1 );
+                    //    int skj = ( k < j ? 1 : -1 );
 
-                //    int ilt = ibas_aa_sym[h2][i][l];
-                //    int kjt = ibas_aa_sym[h2][k][j];
+                    //    int ilt = ibas_aa_sym[h2][i][l];
+                    //    int kjt = ibas_aa_sym[h2][k][j];
 
-                //    A_p[d2toff_m1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5;
-                //}
+                    //    A_p[d2toff_m1[h2] + INDEX(ilt,kjt)] -= dum * sil * skj * 0.5;
+                    //}
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
@@ -857,7 +909,7 @@ void v2RDMSolver::G2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u)
     offset += amo_*amo_;*/
 }
 
-void v2RDMSolver::G2_constraints_guess(SharedVector u){
+void v2RDMSolver::G2_constraints_guess(SharedSolverVector u){
 
     double* u_p = u->pointer();
 
@@ -1060,74 +1112,88 @@ void v2RDMSolver::G2_constraints_guess(SharedVector u){
 }
 
 // G2 portion of A.x (with symmetry)
-void v2RDMSolver::G2_constraints_Au(SharedVector A,SharedVector u){
-    double* A_p = A->pointer();
-    double* u_p = u->pointer();
+void v2RDMSolver::G2_constraints_Au(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
+
+    int offset = constraint_offset_[FAMILY_G2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = RowPointer(A[v]);
+        u_p[v] = u[v]->pointer();
+    }
 
     // G2ab constraints:
 // heyheyhey
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
 
-                double dum = -u_p[g2aboff[h] + ijg*gems_ab[h]+klg];    // - G2ab(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2aboff[h] + ijg*gems_ab[h]+klg];    // - G2ab(ij,kl)
 
-                if ( j==l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum   +=  u_p[d1aoff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
-                }
+                    if ( j==l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) dum[v]   +=  u_p[v][d1aoff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                int ild = ibas_ab_sym[h2][i][l];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                dum       -=  u_p[d2aboff[h2] + ild*gems_ab[h2]+kjd];   // - D2ab(il,kj)
+                    for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2aboff[h2] + ild*gems_ab[h2]+kjd];   // - D2ab(il,kj)
 
-                A_p[offset + ijg*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*gems_ab[h]+klg] = dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
     // G2ba constraints:
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = -u_p[g2baoff[h] + ijg*gems_ab[h]+klg];        // - G2ba(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2baoff[h] + ijg*gems_ab[h]+klg];        // - G2ba(ij,kl)
 
-                if ( j==l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum       +=  u_p[d1boff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
-                }
+                    if ( j==l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d1boff[h3] + ii*amopi_[h3]+kk];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                int lid = ibas_ab_sym[h2][l][i];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                dum    -=  u_p[d2aboff[h2] + lid*gems_ab[h2]+jkd];       //   -D2ab(li,jk)
+                    for (int v = 0; v < nvec; v++) dum[v]    -=  u_p[v][d2aboff[h2] + lid*gems_ab[h2]+jkd];       //   -D2ab(li,jk)
 
-                A_p[offset + ijg*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*gems_ab[h]+klg] = dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
@@ -1135,125 +1201,131 @@ void v2RDMSolver::G2_constraints_Au(SharedVector A,SharedVector u){
     // G2aaaa / G2aabb / G2bbaa / G2bbbb
     for (int h = 0; h < nirrep_; h++) {
         // G2aaaa
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,2*gems_ab[h]*2*gems_ab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                double dum = -u_p[g2aaoff[h] + ijg*2*gems_ab[h]+klg];       // - G2aaaa(ij,kl)
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum       +=  u_p[d1aoff[h3] + ii*amopi_[h3]+kk];    //   D1(i,k) djl
-                }
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2aaoff[h] + ijg*2*gems_ab[h]+klg];       // - G2aaaa(ij,kl)
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d1aoff[h3] + ii*amopi_[h3]+kk];    //   D1(i,k) djl
+                    }
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
 
-                    dum       -=  u_p[d2aaoff[h2] + ild*gems_aa[h2]+kjd] * sil * skj; // -D2aa(il,kj)
+                        for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2aaoff[h2] + ild*gems_aa[h2]+kjd] * sil * skj; // -D2aa(il,kj)
 
-                }
+                    }
 
-                A_p[offset + ijg*2*gems_ab[h]+klg] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ijg*2*gems_ab[h]+klg] = dum[v];
+                }
             }
-        }
-        // G2bbbb
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+            // G2bbbb
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                double dum = -u_p[g2aaoff[h] + (gems_ab[h] + ijg)*2*gems_ab[h] + (gems_ab[h] + klg)]; // - G2bbbb(ij,kl)
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    dum       +=  u_p[d1boff[h3] + ii*amopi_[h3]+kk];    //   D1(i,k) djl
-                }
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2aaoff[h] + (gems_ab[h] + ijg)*2*gems_ab[h] + (gems_ab[h] + klg)]; // - G2bbbb(ij,kl)
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d1boff[h3] + ii*amopi_[h3]+kk];    //   D1(i,k) djl
+                    }
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
 
-                    dum       -=  u_p[d2bboff[h2] + ild*gems_aa[h2]+kjd] * sil * skj; // -D2bb(il,kj)
+                        for (int v = 0; v < nvec; v++) dum[v]       -=  u_p[v][d2bboff[h2] + ild*gems_aa[h2]+kjd] * sil * skj; // -D2bb(il,kj)
 
-                }
+                    }
 
-                A_p[offset + (gems_ab[h] + ijg)*2*gems_ab[h] + (gems_ab[h] + klg)] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + (gems_ab[h] + ijg)*2*gems_ab[h] + (gems_ab[h] + klg)] = dum[v];
+                }
             }
-        }
-        // G2aabb
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+            // G2aabb
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                double dum = -u_p[g2aaoff[h] + (ijg)*2*gems_ab[h] + (gems_ab[h] + klg)];       // - G2aabb(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2aaoff[h] + (ijg)*2*gems_ab[h] + (gems_ab[h] + klg)];       // - G2aabb(ij,kl)
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                dum       +=  u_p[d2aboff[h2] + ild*gems_ab[h2]+jkd]; // D2ab(il,jk)
+                    for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d2aboff[h2] + ild*gems_ab[h2]+jkd]; // D2ab(il,jk)
 
-                A_p[offset + (ijg)*2*gems_ab[h] + (gems_ab[h] + klg)] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + (ijg)*2*gems_ab[h] + (gems_ab[h] + klg)] = dum[v];
+                }
             }
-        }
-        // G2bbaa
-        #pragma omp parallel for schedule (static)
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+            // G2bbaa
+            #pragma omp parallel for schedule (static)
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                double dum = -u_p[g2aaoff[h] + (gems_ab[h] + ijg)*2*gems_ab[h] + (klg)];       // - G2bbaa(ij,kl)
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][g2aaoff[h] + (gems_ab[h] + ijg)*2*gems_ab[h] + (klg)];       // - G2bbaa(ij,kl)
 
-                int lid = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                dum       +=  u_p[d2aboff[h2] + lid*gems_ab[h2]+kjd]; // D2ab(li,kj)
+                    for (int v = 0; v < nvec; v++) dum[v]       +=  u_p[v][d2aboff[h2] + lid*gems_ab[h2]+kjd]; // D2ab(li,kj)
 
-                A_p[offset + (gems_ab[h] + ijg)*2*gems_ab[h] + (klg)] = dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + (gems_ab[h] + ijg)*2*gems_ab[h] + (klg)] = dum[v];
+                }
             }
         }
         offset += 2*gems_ab[h]*2*gems_ab[h];
@@ -1280,72 +1352,85 @@ void v2RDMSolver::G2_constraints_Au(SharedVector A,SharedVector u){
 }
 
 // G2 portion of A^T.y (with symmetry)
-void v2RDMSolver::G2_constraints_ATu(SharedVector A,SharedVector u){
+void v2RDMSolver::G2_constraints_ATu(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    double* A_p = A->pointer();
-    double* u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_G2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = A[v]->pointer();
+        u_p[v] = RowPointer(u[v]);
+    }
 
     // G2ab constraints:
 // heyheyhey
     for (int h = 0; h < nirrep_; h++) {
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*gems_ab[h]+klg];
 
-                A_p[g2aboff[h] + ijg*gems_ab[h]+klg] -= dum;    // - G2ab(ij,kl)
+                    for (int v = 0; v < nvec; v++) A_p[v][g2aboff[h] + ijg*gems_ab[h]+klg] -= dum[v];    // - G2ab(ij,kl)
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1aoff[h3] + ii*amopi_[h3]+kk] += dum;      //   D1(i,k) djl
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h3] + ii*amopi_[h3]+kk] += dum[v];      //   D1(i,k) djl
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                int ild = ibas_ab_sym[h2][i][l];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                A_p[d2aboff[h2] + ild*gems_ab[h2]+kjd] -= dum;   // - D2ab(il,kj)
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ild*gems_ab[h2]+kjd] -= dum[v];   // - D2ab(il,kj)
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
     // G2ba constraints:
     for (int h = 0; h < nirrep_; h++) {
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*gems_ab[h]+klg];
 
-                A_p[g2baoff[h] + ijg*gems_ab[h]+klg]  -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2baoff[h] + ijg*gems_ab[h]+klg]  -= dum[v];
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1boff[h3] + ii*amopi_[h3]+kk]      += dum;
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1boff[h3] + ii*amopi_[h3]+kk]      += dum[v];
+                    }
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
-                int lid = ibas_ab_sym[h2][l][i];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                A_p[d2aboff[h2] + lid*gems_ab[h2]+jkd] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + lid*gems_ab[h2]+jkd] -= dum[v];
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
@@ -1353,124 +1438,129 @@ void v2RDMSolver::G2_constraints_ATu(SharedVector A,SharedVector u){
     // G2aaaa / G2aabb / G2bbaa / G2bbbb constraints:
     for (int h = 0; h < nirrep_; h++) {
         // G2aaaa
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+        if ( RowsAreLocal(offset,2*gems_ab[h]*2*gems_ab[h]) ) {
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*2*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*2*gems_ab[h]+klg];
 
-                A_p[g2aaoff[h] + ijg*2*gems_ab[h]+klg] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2aaoff[h] + ijg*2*gems_ab[h]+klg] -= dum[v];
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1aoff[h3] + ii*amopi_[h3]+kk]         += dum;
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h3] + ii*amopi_[h3]+kk]         += dum[v];
+                    }
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                        int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
 
-                    A_p[d2aaoff[h2] + ild*gems_aa[h2]+kjd] -= dum * sil * skj;
-                }
-           }
-        }
-        // G2bbbb
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+                        for (int v = 0; v < nvec; v++) A_p[v][d2aaoff[h2] + ild*gems_aa[h2]+kjd] -= dum[v] * sil * skj;
+                    }
+               }
+            }
+            // G2bbbb
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + (gems_ab[h] + ijg)*2*gems_ab[h]+(gems_ab[h] + klg)];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + (gems_ab[h] + ijg)*2*gems_ab[h]+(gems_ab[h] + klg)];
 
-                A_p[g2aaoff[h] + (gems_ab[h] + ijg)*2*gems_ab[h]+(gems_ab[h] + klg)] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2aaoff[h] + (gems_ab[h] + ijg)*2*gems_ab[h]+(gems_ab[h] + klg)] -= dum[v];
 
-                if ( j == l ) {
-                    int h3 = symmetry[i];
-                    int ii = i - pitzer_offset[h3];
-                    int kk = k - pitzer_offset[h3];
-                    A_p[d1boff[h3] + ii*amopi_[h3]+kk]         += dum;
-                }
+                    if ( j == l ) {
+                        int h3 = symmetry[i];
+                        int ii = i - pitzer_offset[h3];
+                        int kk = k - pitzer_offset[h3];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1boff[h3] + ii*amopi_[h3]+kk]         += dum[v];
+                    }
 
-                if ( i != l && k != j ) {
+                    if ( i != l && k != j ) {
 
-                    int sil = ( i < l ? 1 : -1 );
-                    int skj = ( k < j ? 1 : -1 );
+                        int sil = ( i < l ? 1 : -1 );
+                        int skj = ( k < j ? 1 : -1 );
 
-                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                        int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                    int ild = ibas_aa_sym[h2][i][l];
-                    int kjd = ibas_aa_sym[h2][k][j];
+                        int ild = ibas_aa_sym[h2][i][l];
+                        int kjd = ibas_aa_sym[h2][k][j];
 
-                    A_p[d2bboff[h2] + ild*gems_aa[h2]+kjd] -= dum * sil * skj;
+                        for (int v = 0; v < nvec; v++) A_p[v][d2bboff[h2] + ild*gems_aa[h2]+kjd] -= dum[v] * sil * skj;
+                    }
                 }
             }
-        }
-        // G2aabb
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+            // G2aabb
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + ijg*2*gems_ab[h]+(klg + gems_ab[h])];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ijg*2*gems_ab[h]+(klg + gems_ab[h])];
 
-                A_p[g2aaoff[h] + ijg*2*gems_ab[h]+(klg + gems_ab[h])] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2aaoff[h] + ijg*2*gems_ab[h]+(klg + gems_ab[h])] -= dum[v];
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int ild = ibas_ab_sym[h2][i][l];
-                int jkd = ibas_ab_sym[h2][j][k];
+                    int ild = ibas_ab_sym[h2][i][l];
+                    int jkd = ibas_ab_sym[h2][j][k];
 
-                A_p[d2aboff[h2] + ild*gems_ab[h2]+jkd] += dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + ild*gems_ab[h2]+jkd] += dum[v];
+                }
             }
-        }
-        // G2bbaa
-        for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
+            // G2bbaa
+            for (int ijg = 0; ijg < gems_ab[h]; ijg++) {
 
-            int i = bas_ab_sym[h][ijg][0];
-            int j = bas_ab_sym[h][ijg][1];
+                int i = bas_ab_sym[h][ijg][0];
+                int j = bas_ab_sym[h][ijg][1];
 
-            for (int klg = 0; klg < gems_ab[h]; klg++) {
+                for (int klg = 0; klg < gems_ab[h]; klg++) {
 
-                int k = bas_ab_sym[h][klg][0];
-                int l = bas_ab_sym[h][klg][1];
+                    int k = bas_ab_sym[h][klg][0];
+                    int l = bas_ab_sym[h][klg][1];
 
-                double dum = u_p[offset + (ijg + gems_ab[h])*2*gems_ab[h]+klg];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + (ijg + gems_ab[h])*2*gems_ab[h]+klg];
 
-                A_p[g2aaoff[h] + (ijg + gems_ab[h])*2*gems_ab[h]+klg] -= dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][g2aaoff[h] + (ijg + gems_ab[h])*2*gems_ab[h]+klg] -= dum[v];
 
-                int h2 = SymmetryPair(symmetry[i],symmetry[l]);
+                    int h2 = SymmetryPair(symmetry[i],symmetry[l]);
 
-                int lid = ibas_ab_sym[h2][l][i];
-                int kjd = ibas_ab_sym[h2][k][j];
+                    int lid = ibas_ab_sym[h2][l][i];
+                    int kjd = ibas_ab_sym[h2][k][j];
 
-                A_p[d2aboff[h2] + lid*gems_ab[h2]+kjd] += dum;
+                    for (int v = 0; v < nvec; v++) A_p[v][d2aboff[h2] + lid*gems_ab[h2]+kjd] += dum[v];
+                }
             }
         }
-
         offset += 2*gems_ab[h]*2*gems_ab[h];
     }
 
@@ -0,0 +1,412 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include <algorithm>
+
+#include <psi4-dec.h>
+#include <libmints/mints.h>
+#include <liboptions/liboptions.h>
+
+#include"v2rdm_solver.h"
+
+using namespace psi;
+
+namespace psi{ namespace v2rdm_casscf{
+
+// one line of the memory table
+static void PrintMemoryLine(const char * label, double ndoubles) {
+    outfile->Printf("        %-40s %12.2lf mb\n",label,ndoubles * 8.0 / 1024.0 / 1024.0);
+}
+
+/*
+ * the footprint of each phase of the computation, worked out from the
+ * orbital partitioning before any large array is allocated.  where a
+ * structure can be built in core or in batches, the in-core algorithm
+ * is used only if the whole phase fits within the memory keyword.
+ */
+void v2RDMSolver::PlanMemory() {
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Memory requirements <==\n");
+    outfile->Printf("\n");
+    // the blocks of x, laid out as in the constructor
+    int nbeta = alias_beta_blocks_ ? 1 : 2;
+    int nd2   = 0;
+    int nq2   = 0;
+    int ng2   = 0;
+    int nd3   = 0;
+    int nt1   = 0;
+    int nt2   = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        if ( spin_adapt_d2_ ) {
+            nd2 +=         gems_00[h]*gems_00[h]; // D2s
+            nd2 +=         gems_aa[h]*gems_aa[h]; // D2t
+        }else {
+            nd2 +=         gems_ab[h]*gems_ab[h]; // D2ab
+            nd2 += nbeta * gems_aa[h]*gems_aa[h]; // D2aa, D2bb
+        }
+        if ( constrain_spin_ && nalpha_ == nbeta_ ) {
+            if ( !spin_adapt_d2_ ) {
+                nd2 += gems_ab[h]*gems_ab[h]; // D200
+            }
+        }else if ( constrain_spin_ ) {
+            nd2 += 4 * gems_ab[h]*gems_ab[h]; // D200_0,D210_0,D201_0,D211_0
+        }
+
+        if ( !spin_adapt_q2_ ) {
+            nq2 +=         gems_ab[h]*gems_ab[h]; // Q2ab
+            nq2 += nbeta * gems_aa[h]*gems_aa[h]; // Q2aa, Q2bb
+        }else {
+            nq2 +=                gems_00[h]*gems_00[h]; // Q2s
+            nq2 += ( 1 + nbeta ) * gems_aa[h]*gems_aa[h]; // Q2t, Q2t_p1, Q2t_m1
+        }
+
+        if ( !spin_adapt_g2_ ) {
+            ng2 +=     gems_ab[h] * gems_ab[h]; // G2ab
+            ng2 +=     gems_ab[h] * gems_ab[h]; // G2ba
+            ng2 += 4 * gems_ab[h] * gems_ab[h]; // G2aa
+        }else {
+            ng2 += 4 * gems_ab[h] * gems_ab[h]; // G2s, G2t, G2t_p1, G2t_m1
+        }
+
+        if ( constrain_d3_ ) {
+            nd3 += trip_aaa[h] * trip_aaa[h]; // D3aaa
+            nd3 += trip_aaa[h] * trip_aaa[h]; // D3bbb
+            nd3 += trip_aab[h] * trip_aab[h]; // D3aab
+            nd3 += trip_aab[h] * trip_aab[h]; // D3bba
+        }
+
+        if ( constrain_t1_ ) {
+            nt1 += trip_aaa[h] * trip_aaa[h]; // T1aaa
+            nt1 += trip_aaa[h] * trip_aaa[h]; // T1bbb
+            nt1 += trip_aab[h] * trip_aab[h]; // T1aab
+            nt1 += trip_aab[h] * trip_aab[h]; // T1bba
+        }
+
+        if ( constrain_t2_ ) {
+            nt2 += (trip_aab[h]+trip_aba[h]) * (trip_aab[h]+trip_aba[h]); // T2aaa
+            nt2 += (trip_aab[h]+trip_aba[h]) * (trip_aab[h]+trip_aba[h]); // T2bbb
+            nt2 += trip_aab[h] * trip_aab[h]; // T2aab
+            nt2 += trip_aab[h] * trip_aab[h]; // T2bba
+            nt2 += trip_aba[h] * trip_aba[h]; // T2aba
+            nt2 += trip_aba[h] * trip_aba[h]; // T2bab
+        }
+
+    }
+
+    outfile->Printf("        D2:                       %7.2lf mb\n",nd2 * 8.0 / 1024.0 / 1024.0);
+    if ( constrain_q2_ ) {
+        outfile->Printf("        Q2:                       %7.2lf mb\n",nq2 * 8.0 / 1024.0 / 1024.0);
+    }
+    if ( constrain_g2_ ) {
+        outfile->Printf("        G2:                       %7.2lf mb\n",ng2 * 8.0 / 1024.0 / 1024.0);
+    }
+    if ( constrain_d3_ ) {
+        outfile->Printf("        D3:                       %7.2lf mb\n",nd3 * 8.0 / 1024.0 / 1024.0);
+    }
+    if ( constrain_t1_ ) {
+        outfile->Printf("        T1:                       %7.2lf mb\n",nt1 * 8.0 / 1024.0 / 1024.0);
+    }
+    if ( constrain_t2_ ) {
+        outfile->Printf("        T2:                       %7.2lf mb\n",nt2 * 8.0 / 1024.0 / 1024.0);
+    }
+    outfile->Printf("\n");
+
+    // all sizes below are in doubles
+
+    long int nmo      = nmo_;
+    long int nmo_nofz = nmo_ - nfrzc_ - nfrzv_;
+    long int nn1fv    = (long int)(nmo_-nfrzv_)*(long int)(nmo_-nfrzv_+1)/2;
+
+    // x, z, c, A^T.y, and the cached A^T.y (with the unpacked D2ab and D2aa
+    // blocks when SPIN_ADAPT_D2)
+    double sdp_primal = 5.0 * dimx_unpacked_;
+
+    // y, b, A.x, the cached A.x, the compound right-hand side, and the cg
+    // search and residual vectors.  with MPI, these hold only this rank's rows
+    double sdp_dual   = 7.0 * nrow_local_;
+    if ( options_.get_bool("CONCURRENT_RESIDUALS") && nproc_ == 1 ) {
+        // A(c-z), evaluated alongside A.x
+        sdp_dual += nrow_local_;
+    }
+
+    // recycled cg search directions (and those collected for the next solve)
+    double cg_recycle = 4.0 * options_.get_int("CG_RECYCLE_DIMENSION") * nrow_local_;
+
+    // block eigensolver and diis scratch, already sized in common_init
+    double scratch    = (double)workspace_.current_bytes() / 8.0;
+
+    // 3- or 4-index integrals, kept for the orbital optimizer
+    double ints = 0.0;
+    if ( is_df_ ) {
+        nQ_ = Process::environment.globals["NAUX (SCF)"];
+        if ( options_.get_str("SCF_TYPE") == "DF" ) {
+            boost::shared_ptr<BasisSet> primary = BasisSet::pyconstruct_orbital(molecule_,
+                "BASIS", options_.get_str("BASIS"));
+
+            boost::shared_ptr<BasisSet> auxiliary = BasisSet::pyconstruct_auxiliary(molecule_,
+                "DF_BASIS_SCF", options_.get_str("DF_BASIS_SCF"), "JKFIT",
+                options_.get_str("BASIS"), primary->has_puream());
+
+            nQ_ = auxiliary->nbf();
+            Process::environment.globals["NAUX (SCF)"] = nQ_;
+        }
+        ints = (double)nQ_ * (double)nn1fv;
+    }else {
+        for (int h = 0; h < nirrep_; h++) {
+            ints += (double)gems_full[h] * ( (double)gems_full[h] + 1.0 ) / 2.0;
+        }
+    }
+
+    // densities, one-electron integrals, and the rotation handed to the
+    // orbital optimizer (see GetIntegrals)
+    double orbopt_den = 0.0;
+    if ( options_.get_bool("ORBOPT_DIRECT_DENSITY") ) {
+        std::vector<double> npairs(nirrep_,0.0);
+        for (int p = 0; p < amo_; p++) {
+            for (int q = 0; q <= p; q++) {
+                npairs[SymmetryPair(symmetry[p],symmetry[q])] += 1.0;
+            }
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            orbopt_den += npairs[h] * ( npairs[h] + 1.0 ) / 2.0;
+        }
+        orbopt_den += npairs[0];
+    }else {
+        for (int h = 0; h < nirrep_; h++) {
+            long int ncore = rstcpi_[h] + frzcpi_[h] + amopi_[h];
+            orbopt_den += (double)gems_plus_core[h] * ( (double)gems_plus_core[h] + 1.0 ) / 2.0;
+            orbopt_den += (double)ncore * ( ncore + 1 ) / 2.0;
+        }
+    }
+    for (int h = 0; h < nirrep_; h++) {
+        long int n = nmopi_[h] - frzvpi_[h];
+        orbopt_den += (double)n * ( n + 1 ) / 2.0;
+    }
+    orbopt_den += (double)nmo_nofz * nmo_nofz;
+
+    // background orbital optimization rotates its own copy of the integrals,
+    // densities, and transformation
+    double orbopt_async = 0.0;
+    if ( orbopt_async_ ) {
+        orbopt_async = ints + orbopt_den;
+    }
+
+    // the orbital optimizer's own arrays:  gradient, step, and diis history
+    // over (at most) nmo^2 rotations, q and z intermediates, fock matrices,
+    // and, with df integrals, (Q|tu) for the active pairs
+    double ndiis = options_.get_int("ORBOPT_NUM_DIIS_VECTORS");
+    double orbopt_internal = ( 2.0 + 2.0 * ndiis ) * (double)nmo_nofz * nmo_nofz
+                           + 2.0 * amo_ * nmo + 4.0 * nmo * nmo;
+    if ( is_df_ ) {
+        orbopt_internal += (double)nQ_ * amo_ * ( amo_ + 1 ) / 2.0;
+    }
+    // (a continuation stage keeps its orbitals fixed)
+    if ( continuation_stage_ ) {
+        orbopt_internal = 0.0;
+    }
+
+    // the states of a multistate computation read the integrals of the
+    // first state, and a continuation stage those of the full problem.  a
+    // state copies them the first time it rotates its orbitals, and the
+    // unrotated integrals stay around until every state has done so
+    bool shares_ints = integral_donor_ && !continuation_stage_;
+    bool rotates     = options_.get_bool("OPTIMIZE_ORBITALS") && !continuation_stage_;
+    double ints_copy = 0.0;
+    if ( shares_ints ) {
+        ints_copy = ints;
+        if ( integral_donor_->memory_states_ == integral_donor_->memory_resident_ ) {
+            // the first state to share them also accounts for the first
+            // state's own copy
+            ints_copy += ints;
+        }
+    }
+    double ints_held = integral_donor_ ? 0.0 : ints;
+
+    // only the solver that transforms the integrals needs the transient
+    // buffers:  the dense nmo^4 sort of the 4-index integrals
+    // (GetTEIFromDisk) or the (Q|mn) transformation (ThreeIndexIntegrals)
+    bool transforms = !integral_donor_ && !fcidump_;
+    double tei_sort = ( transforms && !is_df_ ) ? (double)nmo * nmo * nmo * nmo : 0.0;
+
+    // natural orbitals and the 1-RDMs built while writing the densities
+    double rdm_export = 2.0 * nmo * nmo;
+
+    // x, y, z, and the orbitals of the previous point of a scan are held
+    // until this point replaces them at the end of the run
+    double scan_prev = integral_donor_ ? 0.0 : ScanStateDoubles();
+    double scan_new  = 0.0;
+    if ( options_.get_bool("SCAN_WARM_START") && !integral_donor_ && !fcidump_ ) {
+        scan_new = 2.0 * dimx_unpacked_ + nrow_local_ + nmo + (double)nso_ * nmo;
+    }
+
+    // everything that lives from the start of the sdp to the end of the run
+    double resident = sdp_primal + sdp_dual + cg_recycle + scratch + ints_held + orbopt_den + orbopt_async + scan_prev;
+    double export_copy = 0.0;
+    if ( rotates ) {
+        resident += ints_copy;
+    }else if ( options_.get_bool("SEMICANONICALIZE_ORBITALS") && !fcidump_ ) {
+        // the orbitals are rotated once, when the densities are written
+        export_copy = ints_copy;
+    }
+
+    // a continuation stage runs while the full problem is already
+    // allocated, and each state of a multistate computation while the
+    // states set up before it are
+    double others = 0.0;
+    if ( integral_donor_ ) {
+        others = integral_donor_->memory_states_;
+    }
+
+    // pick the strategies.  the background orbital optimizer is dropped
+    // before the sort is batched, since it only buys overlap
+    double avail = (double)memory_ / 8.0 - others;
+    if ( orbopt_async_ && resident + orbopt_internal > avail && resident + orbopt_internal - orbopt_async <= avail ) {
+        outfile->Printf("        Not enough memory for ORBOPT_ASYNC; orbitals will be optimized synchronously.\n");
+        outfile->Printf("\n");
+        orbopt_async_ = false;
+        resident     -= orbopt_async;
+        orbopt_async  = 0.0;
+    }
+    tei_sort_incore_ = ( resident + tei_sort <= avail );
+
+    // ThreeIndexIntegrals holds two batches of (Q|mn), then the (Q|pq)
+    // result plus one more batch.  only the workspace and the previous
+    // point of a scan are resident while it runs, and it is handed the
+    // rest
+    df_transform_doubles_ = 0;
+    double df_pass1 = 0.0;
+    double df_pass2 = 0.0;
+    bool df_incore  = true;
+    if ( is_df_ && transforms ) {
+        df_transform_doubles_ = (long int)std::max(0.0,avail - scratch - scan_prev);
+        long int nso   = nso_;
+        long int rows1 = DFBatchRows(2L * nso * nso,df_transform_doubles_);
+        long int rows2 = DFBatchRows(nn1fv,df_transform_doubles_ - nn1fv * nQ_);
+        df_pass1  = 2.0 * rows1 * nso * nso;
+        df_pass2  = ints + (double)rows2 * nn1fv;
+        df_incore = ( rows1 == nQ_ && rows2 == nQ_ );
+    }
+
+    PrintMemoryLine("SDP primal vectors (x, z, c, A^T.y):",sdp_primal);
+    PrintMemoryLine("SDP dual vectors (y, b, A.x, CG):",sdp_dual);
+    if ( cg_recycle > 0.0 ) {
+        PrintMemoryLine("Recycled CG directions:",cg_recycle);
+    }
+    PrintMemoryLine("Eigensolver and DIIS scratch:",scratch);
+    if ( !integral_donor_ ) {
+        PrintMemoryLine(is_df_ ? "3-index integrals:" : "4-index integrals:",ints);
+    }else if ( shares_ints ) {
+        PrintMemoryLine(rotates ? "Rotated copies of the shared integrals:" : "Copies of the shared integrals (export):",ints_copy);
+    }
+    PrintMemoryLine("Orbital optimizer densities and OEIs:",orbopt_den);
+    if ( orbopt_async_ ) {
+        PrintMemoryLine("Background orbital optimizer copies:",orbopt_async);
+    }
+    PrintMemoryLine("Orbital optimizer (internal):",orbopt_internal);
+    if ( scan_prev > 0.0 ) {
+        PrintMemoryLine("Previous point of the scan:",scan_prev);
+    }
+    if ( scan_new > 0.0 ) {
+        PrintMemoryLine("Saved for the next point of the scan:",scan_new);
+    }
+    if ( others > 0.0 ) {
+        PrintMemoryLine(continuation_stage_ ? "Full problem (allocated during the stage):" : "Earlier states (allocated alongside):",others);
+    }
+    if ( transforms && is_df_ ) {
+        PrintMemoryLine(df_incore ? "(Q|mn) transformation (in core):" : "(Q|mn) transformation (batched):",
+            std::max(df_pass1,df_pass2 - ints));
+    }else if ( transforms ) {
+        PrintMemoryLine(tei_sort_incore_ ? "4-index integral sort (in core):" : "4-index integral sort (direct):",
+            tei_sort_incore_ ? tei_sort : 0.0);
+    }
+    outfile->Printf("\n");
+
+    // peak of each phase
+    double phase_ints = resident;
+    if ( transforms && is_df_ ) {
+        phase_ints = scratch + scan_prev + std::max(df_pass1,df_pass2);
+    }else if ( transforms ) {
+        phase_ints = resident + ( tei_sort_incore_ ? tei_sort : 0.0 );
+    }
+    double phase_sdp    = resident;
+    double phase_orbopt = resident + orbopt_internal;
+    double phase_export = resident + rdm_export + scan_new + export_copy;
+    memory_resident_    = resident;
+
+    phase_ints   += others;
+    phase_sdp    += others;
+    phase_orbopt += others;
+    phase_export += others;
+
+    // the states planned later run alongside this one
+    memory_states_ = resident;
+    if ( shares_ints ) {
+        integral_donor_->memory_states_ += resident + export_copy;
+    }
+
+    double tot = phase_ints;
+    if ( phase_sdp    > tot ) tot = phase_sdp;
+    if ( phase_orbopt > tot ) tot = phase_orbopt;
+    if ( phase_export > tot ) tot = phase_export;
+    if ( fno_peak_    > tot ) tot = fno_peak_;
+
+    if ( fno_peak_ > 0.0 ) {
+        PrintMemoryLine("Peak, frozen natural orbitals:",fno_peak_);
+    }
+    PrintMemoryLine("Peak, integral transformation:",phase_ints);
+    PrintMemoryLine("Peak, SDP iterations:",phase_sdp);
+    PrintMemoryLine("Peak, orbital optimization:",phase_orbopt);
+    PrintMemoryLine("Peak, RDM export:",phase_export);
+    outfile->Printf("\n");
+    
+    outfile->Printf("        Total number of variables:     %10i\n",dimx_);
+    outfile->Printf("        Total number of constraints:   %10i\n",nconstraints_);
+    if ( nproc_ > 1 ) {
+        outfile->Printf("        Constraints on this rank:      %10li\n",nrow_local_);
+    }
+    outfile->Printf("        Total memory requirements:     %7.2lf mb\n",tot * 8.0 / 1024.0 / 1024.0);
+    outfile->Printf("        (not counted:  the reference wavefunction, basis sets, and index maps)\n");
+    outfile->Printf("\n");
+
+    if ( tot * 8.0 > (double)memory_ ) {
+        outfile->Printf("\n");
+        outfile->Printf("        Not enough memory!\n");
+        outfile->Printf("\n");
+        if ( !is_df_ ) {
+            outfile->Printf("        Either increase the available memory by %7.2lf mb\n",(8.0 * tot - memory_)/1024.0/1024.0);
+            outfile->Printf("        or try scf_type = df or scf_type = cd\n");
+        
+        }else {
+            outfile->Printf("        Increase the available memory by %7.2lf mb.\n",(8.0 * tot - memory_)/1024.0/1024.0);
+        }
+        outfile->Printf("\n");
+        throw PsiException("Not enough memory",__FILE__,__LINE__);
+    }
+}
+
+}}
@@ -58,6 +58,9 @@ using namespace fnocc;
 namespace psi{ namespace v2rdm_casscf{
 
 boost::shared_ptr<Matrix> v2RDMSolver::GetOEI() {
+    if ( fcidump_ ) {
+        return GetFCIDUMPOEI();
+    }
     boost::shared_ptr<MintsHelper> mints(new MintsHelper(reference_wavefunction_));
     boost::shared_ptr<Matrix> K1 (new Matrix(mints->so_potential()));
     K1->add(mints->so_kinetic());
@@ -0,0 +1,227 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#ifdef __linux__
+    #include<unistd.h>
+    #include<sys/mman.h>
+    #include<sys/syscall.h>
+#endif
+
+#ifdef _OPENMP
+    #include<omp.h>
+#endif
+
+#include <psi4-dec.h>
+
+#include"placement.h"
+
+// from linux/mempolicy.h
+#define V2RDM_MPOL_INTERLEAVE 3
+#define V2RDM_MPOL_MF_MOVE    2
+
+namespace psi{ namespace v2rdm_casscf{
+
+VectorPlacement VectorPlacementFromString(const std::string & name) {
+    if ( name == "NONE" )        return PLACEMENT_NONE;
+    if ( name == "FIRST_TOUCH" ) return PLACEMENT_FIRST_TOUCH;
+    if ( name == "INTERLEAVE" )  return PLACEMENT_INTERLEAVE;
+    throw PsiException("unknown VECTOR_PLACEMENT",__FILE__,__LINE__);
+}
+
+#ifdef __linux__
+// mask of online NUMA nodes, from /sys/devices/system/node/online (e.g. "0-1,4")
+static unsigned long OnlineNodeMask() {
+    unsigned long mask = 0;
+    FILE * fp = fopen("/sys/devices/system/node/online","r");
+    if ( fp == NULL ) return 1;
+    char line[256];
+    if ( fgets(line,sizeof(line),fp) != NULL ) {
+        char * p = line;
+        while ( *p ) {
+            char * end;
+            long int lo = strtol(p,&end,10);
+            if ( end == p ) break;
+            long int hi = lo;
+            p = end;
+            if ( *p == '-' ) {
+                p++;
+                hi = strtol(p,&end,10);
+                p = end;
+            }
+            for (long int node = lo; node <= hi && node < 8 * (long int)sizeof(unsigned long); node++) {
+                mask |= 1UL << node;
+            }
+            if ( *p == ',' ) p++;
+            else break;
+        }
+    }
+    fclose(fp);
+    return ( mask != 0 ) ? mask : 1;
+}
+#endif
+
+SolverVector::SolverVector(long int n) {
+    allocate(n);
+}
+
+SolverVector::SolverVector(const std::string & name, long int n) {
+    name_ = name;
+    allocate(n);
+}
+
+// whole pages from the kernel (mmap), so no page is shared with other data
+// and none is touched before Place.  anonymous pages read back as zero
+void SolverVector::allocate(long int n) {
+    n_     = n;
+    v_     = NULL;
+    bytes_ = 0;
+    if ( n_ <= 0 ) return;
+#ifdef __linux__
+    long int page = sysconf(_SC_PAGESIZE);
+    bytes_ = ( ( n_ * sizeof(double) + page - 1 ) / page ) * page;
+    void * p = mmap(NULL,bytes_,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+    if ( p == MAP_FAILED ) {
+        throw PsiException("could not allocate solver vector " + name_,__FILE__,__LINE__);
+    }
+    v_ = (double*)p;
+#else
+    bytes_ = n_ * sizeof(double);
+    void * p = NULL;
+    if ( posix_memalign(&p,4096,bytes_) != 0 ) {
+        throw PsiException("could not allocate solver vector " + name_,__FILE__,__LINE__);
+    }
+    v_ = (double*)p;
+    memset((void*)v_,'\0',bytes_);
+#endif
+}
+
+SolverVector::~SolverVector() {
+    if ( v_ == NULL ) return;
+#ifdef __linux__
+    munmap((void*)v_,bytes_);
+#else
+    free(v_);
+#endif
+}
+
+void SolverVector::zero() {
+    #pragma omp parallel for schedule (static)
+    for (long int i = 0; i < n_; i++) {
+        v_[i] = 0.0;
+    }
+}
+
+void SolverVector::scale(double a) {
+    #pragma omp parallel for schedule (static)
+    for (long int i = 0; i < n_; i++) {
+        v_[i] *= a;
+    }
+}
+
+void SolverVector::add(const boost::shared_ptr<SolverVector> & other) {
+    double * o = other->pointer();
+    #pragma omp parallel for schedule (static)
+    for (long int i = 0; i < n_; i++) {
+        v_[i] += o[i];
+    }
+}
+
+void SolverVector::subtract(const boost::shared_ptr<SolverVector> & other) {
+    double * o = other->pointer();
+    #pragma omp parallel for schedule (static)
+    for (long int i = 0; i < n_; i++) {
+        v_[i] -= o[i];
+    }
+}
+
+void SolverVector::copy(const SolverVector * other) {
+    if ( other->n_ != n_ ) {
+        throw PsiException("solver vector dimensions do not match in copy",__FILE__,__LINE__);
+    }
+    double * o = other->v_;
+    #pragma omp parallel for schedule (static)
+    for (long int i = 0; i < n_; i++) {
+        v_[i] = o[i];
+    }
+}
+
+void SolverVector::Place(VectorPlacement placement, const std::vector<int> & blocks) {
+
+    if ( n_ <= 0 ) return;
+
+    if ( placement == PLACEMENT_NONE ) {
+        // one thread touches every page
+        memset((void*)v_,'\0',n_*sizeof(double));
+        return;
+    }
+
+#ifdef __linux__
+    if ( placement == PLACEMENT_INTERLEAVE ) {
+        unsigned long mask = OnlineNodeMask();
+        // failure (e.g. no NUMA support in the kernel) leaves the pages where they are
+        syscall(SYS_mbind,(void*)v_,bytes_,V2RDM_MPOL_INTERLEAVE,&mask,8 * sizeof(unsigned long),V2RDM_MPOL_MF_MOVE);
+    }else {
+        // release the pages (they read back as zero), so that they are
+        // faulted in on the node of whichever thread writes them first
+        madvise((void*)v_,bytes_,MADV_DONTNEED);
+    }
+#endif
+
+    long int covered = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        covered += (long int)blocks[i] * blocks[i];
+    }
+
+    if ( blocks.size() == 0 || covered != n_ ) {
+        #pragma omp parallel for schedule (static)
+        for (long int i = 0; i < n_; i++) {
+            v_[i] = 0.0;
+        }
+        return;
+    }
+
+    // the constraint kernels work on one block at a time, each thread on
+    // a static share of its rows
+    long int offset = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        long int n = blocks[i];
+        double * block = v_ + offset;
+        #pragma omp parallel for schedule (static)
+        for (long int p = 0; p < n; p++) {
+            for (long int q = 0; q < n; q++) {
+                block[p*n+q] = 0.0;
+            }
+        }
+        offset += n*n;
+    }
+}
+
+}}
@@ -0,0 +1,96 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include<string>
+#include<vector>
+#include<boost/shared_ptr.hpp>
+
+namespace psi{ namespace v2rdm_casscf{
+
+/// how the pages of the large solver vectors are spread over NUMA nodes
+enum VectorPlacement {
+    PLACEMENT_NONE,         ///< leave the pages where the allocator put them
+    PLACEMENT_FIRST_TOUCH,  ///< each page on the node of the thread that works on it
+    PLACEMENT_INTERLEAVE    ///< pages spread round-robin over all nodes
+};
+
+/// parse the VECTOR_PLACEMENT keyword
+VectorPlacement VectorPlacementFromString(const std::string & name);
+
+/// a vector of doubles for the solver (primal, dual, constraint, and cg
+/// vectors), with the part of psi::Vector's interface that the solver uses.
+/// the storage is page aligned and owned by the vector, so that whole pages
+/// can be placed on NUMA nodes (see Place).  the contents are zero on
+/// construction.
+class SolverVector {
+public:
+
+    SolverVector(long int n);
+    SolverVector(const std::string & name, long int n);
+    ~SolverVector();
+
+    double * pointer() { return v_; }
+    long int dim() { return n_; }
+    const std::string & name() { return name_; }
+
+    void zero();
+    void scale(double a);
+    void add(const boost::shared_ptr<SolverVector> & other);
+    void subtract(const boost::shared_ptr<SolverVector> & other);
+    void copy(const SolverVector * other);
+
+    /// zero the vector again, placing its pages.  blocks lists the
+    /// dimension n of each n x n block, in order, and should cover the
+    /// vector; each block is then first touched row by row with a static
+    /// schedule, as the constraint kernels loop over it.  with no blocks,
+    /// the vector is touched as one range with a static schedule, as the
+    /// vector kernels loop over it.  with PLACEMENT_INTERLEAVE, the pages
+    /// are bound round-robin to all online nodes.  outside of linux this
+    /// only zeroes the vector.
+    void Place(VectorPlacement placement, const std::vector<int> & blocks = std::vector<int>());
+
+private:
+
+    SolverVector(const SolverVector &) = delete;
+    SolverVector & operator=(const SolverVector &) = delete;
+
+    void allocate(long int n);
+
+    std::string name_;
+    long int n_;
+    double * v_;
+    size_t bytes_;
+};
+
+typedef boost::shared_ptr<SolverVector> SharedSolverVector;
+
+}}
+
+#endif
@@ -40,19 +40,32 @@ def run_v2rdm_casscf(name, **kwargs):
 
     >>> energy('v2rdm_casscf')
 
+    Several states over the same orbitals and integrals can be computed in
+    one call by giving their multiplicities and/or positivity conditions
+
+    >>> energy('v2rdm-casscf', multiplicities=[1,3], positivity=['DQG','DQG'])
+
     """
 
     lowername = name.lower()
     kwargs = p4util.kwargs_lower(kwargs)
 
     optstash = p4util.OptionsState(
-        ['SCF', 'DF_INTS_IO'])
+        ['SCF', 'DF_INTS_IO'],
+        ['V2RDM_CASSCF', 'STATE_MULTIPLICITIES'],
+        ['V2RDM_CASSCF', 'STATE_POSITIVITY'])
 
     psi4.set_local_option('SCF', 'DF_INTS_IO', 'SAVE')
 
+    if 'multiplicities' in kwargs:
+        psi4.set_local_option('V2RDM_CASSCF', 'STATE_MULTIPLICITIES', kwargs['multiplicities'])
+    if 'positivity' in kwargs:
+        psi4.set_local_option('V2RDM_CASSCF', 'STATE_POSITIVITY', kwargs['positivity'])
+
     # Your plugin's psi4 run sequence goes here
+    # an FCIDUMP file supplies the hamiltonian, so there is no SCF
     ref_wfn = kwargs.get('ref_wfn', None)
-    if ref_wfn is None:
+    if ref_wfn is None and psi4.get_option("V2RDM_CASSCF","FCIDUMP_FILE") == "":
         ref_wfn = driver.scf_helper(name, **kwargs)
 
     # if restarting from a checkpoint file, this file
@@ -60,12 +73,14 @@ def run_v2rdm_casscf(name, **kwargs):
     filename = psi4.get_option("V2RDM_CASSCF","RESTART_FROM_CHECKPOINT_FILE")
 
     # todo PSIF_V2RDM_CHECKPOINT should be definied in psifiles.h
-    if ( filename != "" ):
+    if ( filename != "" and ref_wfn is not None ):
         molname = ref_wfn.molecule().name()
         p4util.copy_file_to_scratch(filename,'psi',molname,269,False)
 
     returnvalue = psi4.plugin('v2rdm_casscf.so', ref_wfn)
 
+    optstash.restore()
+
     #psi4.set_variable('CURRENT ENERGY', returnvalue)
 
     #return psi4.get_variable('CURRENT ENERGY')
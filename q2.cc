@@ -55,7 +55,7 @@ using namespace fnocc;
 
 namespace psi{ namespace v2rdm_casscf{
 
-void v2RDMSolver::Q2_constraints_guess_spin_adapted(SharedVector u){
+void v2RDMSolver::Q2_constraints_guess_spin_adapted(SharedSolverVector u){
 
     double * u_p = u->pointer();
 
@@ -258,274 +258,339 @@ void v2RDMSolver::Q2_constraints_guess_spin_adapted(SharedVector u){
     }
 }
 
-void v2RDMSolver::Q2_constraints_Au_spin_adapted(SharedVector A,SharedVector u){
+void v2RDMSolver::Q2_constraints_Au_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_Q2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = RowPointer(A[v]);
+        u_p[v] = u[v]->pointer();
+    }
 
     // map D2ab to Q2s
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_00[h]; ij++) {
-            int i = bas_00_sym[h][ij][0];
-            int j = bas_00_sym[h][ij][1];
-            int ijd = ibas_ab_sym[h][i][j];
-            int jid = ibas_ab_sym[h][j][i];
-            for (int kl = 0; kl < gems_00[h]; kl++) {
-                int k = bas_00_sym[h][kl][0];
-                int l = bas_00_sym[h][kl][1];
-
-                double dum  = -u_p[q2soff[h] + ij*gems_00[h]+kl];          // -Q2(ij,kl)
-
-                // not spin adapted
-                int kld = ibas_ab_sym[h][k][l];
-                int lkd = ibas_ab_sym[h][l][k];
-                dum        +=  0.5 * u_p[d2aboff[h] + kld*gems_ab[h]+ijd];          // +D2(kl,ij)
-                dum        +=  0.5 * u_p[d2aboff[h] + lkd*gems_ab[h]+ijd];          // +D2(lk,ij)
-                dum        +=  0.5 * u_p[d2aboff[h] + kld*gems_ab[h]+jid];          // +D2(kl,ji)
-                dum        +=  0.5 * u_p[d2aboff[h] + lkd*gems_ab[h]+jid];          // +D2(lk,ji)
-
-                // spin adapted
-                //dum        +=  u_p[d2soff[h] + INDEX(kl,ij)];          // +D2(kl,ij)
-
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  0.5 * u_p[q1aoff[h2] + ii*amopi_[h2]+kk]; // +Q1(i,k) djl
-                    dum        -=  0.5 * u_p[d1boff[h2] + ii*amopi_[h2]+kk]; // -D1(i,k) djl
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  0.5 * u_p[q1aoff[h2] + ll*amopi_[h2]+jj]; // +Q1(l,j) dik
-                    dum        -=  0.5 * u_p[d1boff[h2] + ll*amopi_[h2]+jj]; // -D1(l,j) dik
+        if ( RowsAreLocal(offset,gems_00[h]*gems_00[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ij = 0; ij < gems_00[h]; ij++) {
+                int i = bas_00_sym[h][ij][0];
+                int j = bas_00_sym[h][ij][1];
+                int ijd = ibas_ab_sym[h][i][j];
+                int jid = ibas_ab_sym[h][j][i];
+                for (int kl = 0; kl < gems_00[h]; kl++) {
+                    int k = bas_00_sym[h][kl][0];
+                    int l = bas_00_sym[h][kl][1];
+
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][q2soff[h] + ij*gems_00[h]+kl];          // -Q2(ij,kl)
+
+                    // not spin adapted
+                    int kld = ibas_ab_sym[h][k][l];
+                    int lkd = ibas_ab_sym[h][l][k];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v]        +=  0.5 * u_p[v][d2aboff[h] + kld*gems_ab[h]+ijd];          // +D2(kl,ij)
+                        dum[v]        +=  0.5 * u_p[v][d2aboff[h] + lkd*gems_ab[h]+ijd];          // +D2(lk,ij)
+                        dum[v]        +=  0.5 * u_p[v][d2aboff[h] + kld*gems_ab[h]+jid];          // +D2(kl,ji)
+                        dum[v]        +=  0.5 * u_p[v][d2aboff[h] + lkd*gems_ab[h]+jid];          // +D2(lk,ji)
+                    }
+
+                    // spin adapted
+                    //dum        +=  u_p[d2soff[h] + INDEX(kl,ij)];          // +D2(kl,ij)
+
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        +=  0.5 * u_p[v][q1aoff[h2] + ii*amopi_[h2]+kk]; // +Q1(i,k) djl
+                            dum[v]        -=  0.5 * u_p[v][d1boff[h2] + ii*amopi_[h2]+kk]; // -D1(i,k) djl
+                        }
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        +=  0.5 * u_p[v][q1aoff[h2] + ll*amopi_[h2]+jj]; // +Q1(l,j) dik
+                            dum[v]        -=  0.5 * u_p[v][d1boff[h2] + ll*amopi_[h2]+jj]; // -D1(l,j) dik
+                        }
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        +=  0.5 * u_p[v][q1aoff[h2] + ll*amopi_[h2]+ii]; // +Q1(l,i) djk
+                            dum[v]        -=  0.5 * u_p[v][d1boff[h2] + ll*amopi_[h2]+ii]; // -D1(l,i) djk
+                        }
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        +=  0.5 * u_p[v][q1aoff[h2] + kk*amopi_[h2]+jj]; // +Q1(k,j) dil
+                            dum[v]        -=  0.5 * u_p[v][d1boff[h2] + kk*amopi_[h2]+jj]; // -D1(k,j) dil
+                        }
+                    }
+
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_00[h]+kl] = dum[v];
                 }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  0.5 * u_p[q1aoff[h2] + ll*amopi_[h2]+ii]; // +Q1(l,i) djk
-                    dum        -=  0.5 * u_p[d1boff[h2] + ll*amopi_[h2]+ii]; // -D1(l,i) djk
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  0.5 * u_p[q1aoff[h2] + kk*amopi_[h2]+jj]; // +Q1(k,j) dil
-                    dum        -=  0.5 * u_p[d1boff[h2] + kk*amopi_[h2]+jj]; // -D1(k,j) dil
-                }
-
-                A_p[offset + ij*gems_00[h]+kl] = dum;
             }
         }
         offset += gems_00[h]*gems_00[h];
     }
     // map D2ab to Q210
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i   =  bas_aa_sym[h][ij][0];
-            int j   =  bas_aa_sym[h][ij][1];
-            int ijd = ibas_ab_sym[h][i][j];
-            int jid = ibas_ab_sym[h][j][i];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int   k =  bas_aa_sym[h][kl][0];
-                int   l =  bas_aa_sym[h][kl][1];
-
-                double dum  = -u_p[q2toff[h] + ij*gems_aa[h]+kl];          // -Q2(ij,kl)
-
-                // not spin adapted
-                int kld = ibas_ab_sym[h][k][l];
-                int lkd = ibas_ab_sym[h][l][k];
-                dum        +=  0.5 * u_p[d2aboff[h] + kld*gems_ab[h]+ijd];          // +D2(kl,ij)
-                dum        -=  0.5 * u_p[d2aboff[h] + lkd*gems_ab[h]+ijd];          // -D2(lk,ij)
-                dum        -=  0.5 * u_p[d2aboff[h] + kld*gems_ab[h]+jid];          // -D2(kl,ji)
-                dum        +=  0.5 * u_p[d2aboff[h] + lkd*gems_ab[h]+jid];          // +D2(lk,ji)
-
-                // spin adapted
-                //dum        +=  u_p[d2toff[h] + INDEX(kl,ij)];          // +D2(kl,ij)
-
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  0.5 * u_p[q1aoff[h2] + ii*amopi_[h2]+kk]; // +Q1(i,k) djl
-                    dum        -=  0.5 * u_p[d1boff[h2] + ii*amopi_[h2]+kk]; // -D1(i,k) djl
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  0.5 * u_p[q1aoff[h2] + ll*amopi_[h2]+jj]; // +Q1(l,j) dik
-                    dum        -=  0.5 * u_p[d1boff[h2] + ll*amopi_[h2]+jj]; // -D1(l,j) dik
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        -=  0.5 * u_p[q1aoff[h2] + ll*amopi_[h2]+ii]; // -Q1(l,i) djk
-                    dum        +=  0.5 * u_p[d1boff[h2] + ll*amopi_[h2]+ii]; // +D1(l,i) djk
+        if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ij = 0; ij < gems_aa[h]; ij++) {
+                int i   =  bas_aa_sym[h][ij][0];
+                int j   =  bas_aa_sym[h][ij][1];
+                int ijd = ibas_ab_sym[h][i][j];
+                int jid = ibas_ab_sym[h][j][i];
+                for (int kl = 0; kl < gems_aa[h]; kl++) {
+                    int   k =  bas_aa_sym[h][kl][0];
+                    int   l =  bas_aa_sym[h][kl][1];
+
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = -u_p[v][q2toff[h] + ij*gems_aa[h]+kl];          // -Q2(ij,kl)
+
+                    // not spin adapted
+                    int kld = ibas_ab_sym[h][k][l];
+                    int lkd = ibas_ab_sym[h][l][k];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v]        +=  0.5 * u_p[v][d2aboff[h] + kld*gems_ab[h]+ijd];          // +D2(kl,ij)
+                        dum[v]        -=  0.5 * u_p[v][d2aboff[h] + lkd*gems_ab[h]+ijd];          // -D2(lk,ij)
+                        dum[v]        -=  0.5 * u_p[v][d2aboff[h] + kld*gems_ab[h]+jid];          // -D2(kl,ji)
+                        dum[v]        +=  0.5 * u_p[v][d2aboff[h] + lkd*gems_ab[h]+jid];          // +D2(lk,ji)
+                    }
+
+                    // spin adapted
+                    //dum        +=  u_p[d2toff[h] + INDEX(kl,ij)];          // +D2(kl,ij)
+
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        +=  0.5 * u_p[v][q1aoff[h2] + ii*amopi_[h2]+kk]; // +Q1(i,k) djl
+                            dum[v]        -=  0.5 * u_p[v][d1boff[h2] + ii*amopi_[h2]+kk]; // -D1(i,k) djl
+                        }
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        +=  0.5 * u_p[v][q1aoff[h2] + ll*amopi_[h2]+jj]; // +Q1(l,j) dik
+                            dum[v]        -=  0.5 * u_p[v][d1boff[h2] + ll*amopi_[h2]+jj]; // -D1(l,j) dik
+                        }
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        -=  0.5 * u_p[v][q1aoff[h2] + ll*amopi_[h2]+ii]; // -Q1(l,i) djk
+                            dum[v]        +=  0.5 * u_p[v][d1boff[h2] + ll*amopi_[h2]+ii]; // +D1(l,i) djk
+                        }
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v]        -=  0.5 * u_p[v][q1aoff[h2] + kk*amopi_[h2]+jj]; // -Q1(k,j) dil
+                            dum[v]        +=  0.5 * u_p[v][d1boff[h2] + kk*amopi_[h2]+jj]; // +D1(k,j) dil
+                        }
+                    }
+
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_aa[h]+kl] = dum[v];
                 }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        -=  0.5 * u_p[q1aoff[h2] + kk*amopi_[h2]+jj]; // -Q1(k,j) dil
-                    dum        +=  0.5 * u_p[d1boff[h2] + kk*amopi_[h2]+jj]; // +D1(k,j) dil
-                }
-
-                A_p[offset + ij*gems_aa[h]+kl] = dum;
             }
         }
         offset += gems_aa[h]*gems_aa[h];
     }
     // map D2aa to Q211
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum  = -u_p[q2toff_p1[h] + ij*gems_aa[h]+kl];    // -Q2(ij,kl)
-                dum        +=  u_p[d2aaoff[h] + kl*gems_aa[h]+ij];    // +D2(kl,ij)
-
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  u_p[q1aoff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  u_p[d1aoff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
+        if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ij = 0; ij < gems_aa[h]; ij++) {
+                int i = bas_aa_sym[h][ij][0];
+                int j = bas_aa_sym[h][ij][1];
+                for (int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k = bas_aa_sym[h][kl][0];
+                    int l = bas_aa_sym[h][kl][1];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) {
+                        dum[v] = -u_p[v][q2toff_p1[h] + ij*gems_aa[h]+kl];    // -Q2(ij,kl)
+                        dum[v]        +=  u_p[v][d2aaoff[h] + kl*gems_aa[h]+ij];    // +D2(kl,ij)
+                    }
+
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][q1aoff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][d1aoff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][q1aoff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][d1aoff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
+                    }
+
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_aa[h]+kl] = dum[v];
                 }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        -=  u_p[q1aoff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        -=  u_p[d1aoff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
-                }
-
-                A_p[offset + ij*gems_aa[h]+kl] = dum;
             }
         }
         offset += gems_aa[h]*gems_aa[h];
     }
-    // map D2bb to Q21-1
-    for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum  = -u_p[q2toff_m1[h] + ij*gems_aa[h]+kl];    // -Q2(ij,kl)
-                dum        +=  u_p[d2bboff[h] + kl*gems_aa[h]+ij];    // +D2(kl,ij)
-
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  u_p[q1boff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
+    if ( !alias_beta_blocks_ ) {
+        // map D2bb to Q21-1
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                #pragma omp parallel for schedule (static)
+                for (int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for (int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double dum[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) {
+                            dum[v] = -u_p[v][q2toff_m1[h] + ij*gems_aa[h]+kl];    // -Q2(ij,kl)
+                            dum[v]        +=  u_p[v][d2bboff[h] + kl*gems_aa[h]+ij];    // +D2(kl,ij)
+                        }
+
+                        if ( j==l ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][q1boff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
+                        }
+                        if ( j==k ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][d1boff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
+                        }
+                        if ( i==l ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][q1boff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
+                        }
+                        if ( i==k ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][d1boff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
+                        }
+
+                        for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_aa[h]+kl] = dum[v];
+                    }
                 }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  u_p[d1boff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        -=  u_p[q1boff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        -=  u_p[d1boff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
-                }
-
-                A_p[offset + ij*gems_aa[h]+kl] = dum;
             }
+            offset += gems_aa[h]*gems_aa[h];
         }
-        offset += gems_aa[h]*gems_aa[h];
     }
 }
 
 // Q2 portion of A^T.y (spin adapted)
-void v2RDMSolver::Q2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u){
+void v2RDMSolver::Q2_constraints_ATu_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_Q2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = A[v]->pointer();
+        u_p[v] = RowPointer(u[v]);
+    }
 
     // map D2ab to Q2s
     for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_00[h]; ij++) {
-            int i = bas_00_sym[h][ij][0];
-            int j = bas_00_sym[h][ij][1];
-            int ijd = ibas_ab_sym[h][i][j];
-            int jid = ibas_ab_sym[h][j][i];
-            for (int kl = 0; kl < gems_00[h]; kl++) {
-                int k = bas_00_sym[h][kl][0];
-                int l = bas_00_sym[h][kl][1];
-
-                double dum  = u_p[offset + ij*gems_00[h]+kl];
-
-                A_p[q2soff[h] + ij*gems_00[h]+kl]    -= dum;          // -Q2(ij,kl)
-
-                // not spin adapted
-                int kld = ibas_ab_sym[h][k][l];
-                int lkd = ibas_ab_sym[h][l][k];
-                A_p[d2aboff[h] + kld*gems_ab[h]+ijd] += 0.5 * dum;          // +D2(kl,ij)
-                A_p[d2aboff[h] + lkd*gems_ab[h]+ijd] += 0.5 * dum;          // +D2(lk,ij)
-                A_p[d2aboff[h] + kld*gems_ab[h]+jid] += 0.5 * dum;          // +D2(kl,ji)
-                A_p[d2aboff[h] + lkd*gems_ab[h]+jid] += 0.5 * dum;          // +D2(lk,ji)
-
-                // spin adapted
-                //A_p[d2soff[h] + INDEX(kl,ij)] += dum;          // +D2(kl,ij)
-
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + ii*amopi_[h2]+kk] += 0.5 * dum; // +Q1(i,k) djl
-                    A_p[d1boff[h2] + ii*amopi_[h2]+kk] -= 0.5 * dum; // -D1(i,k) djl
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + ll*amopi_[h2]+jj] += 0.5 * dum; // +Q1(l,j) dik
-                    A_p[d1boff[h2] + ll*amopi_[h2]+jj] -= 0.5 * dum; // -D1(l,j) dik
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + ll*amopi_[h2]+ii] += 0.5 * dum; // +Q1(l,i) djk
-                    A_p[d1boff[h2] + ll*amopi_[h2]+ii] -= 0.5 * dum; // -D1(l,i) djk
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + kk*amopi_[h2]+jj] += 0.5 * dum; // +Q1(k,j) dil
-                    A_p[d1boff[h2] + kk*amopi_[h2]+jj] -= 0.5 * dum; // -D1(k,j) dil
+        if ( RowsAreLocal(offset,gems_00[h]*gems_00[h]) ) {
+            for (int ij = 0; ij < gems_00[h]; ij++) {
+                int i = bas_00_sym[h][ij][0];
+                int j = bas_00_sym[h][ij][1];
+                int ijd = ibas_ab_sym[h][i][j];
+                int jid = ibas_ab_sym[h][j][i];
+                for (int kl = 0; kl < gems_00[h]; kl++) {
+                    int k = bas_00_sym[h][kl][0];
+                    int l = bas_00_sym[h][kl][1];
+
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ij*gems_00[h]+kl];
+
+                    for (int v = 0; v < nvec; v++) A_p[v][q2soff[h] + ij*gems_00[h]+kl]    -= dum[v];          // -Q2(ij,kl)
+
+                    // not spin adapted
+                    int kld = ibas_ab_sym[h][k][l];
+                    int lkd = ibas_ab_sym[h][l][k];
+                    for (int v = 0; v < nvec; v++) {
+                        A_p[v][d2aboff[h] + kld*gems_ab[h]+ijd] += 0.5 * dum[v];          // +D2(kl,ij)
+                        A_p[v][d2aboff[h] + lkd*gems_ab[h]+ijd] += 0.5 * dum[v];          // +D2(lk,ij)
+                        A_p[v][d2aboff[h] + kld*gems_ab[h]+jid] += 0.5 * dum[v];          // +D2(kl,ji)
+                        A_p[v][d2aboff[h] + lkd*gems_ab[h]+jid] += 0.5 * dum[v];          // +D2(lk,ji)
+                    }
+
+                    // spin adapted
+                    //A_p[d2soff[h] + INDEX(kl,ij)] += dum;          // +D2(kl,ij)
+
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + ii*amopi_[h2]+kk] += 0.5 * dum[v]; // +Q1(i,k) djl
+                            A_p[v][d1boff[h2] + ii*amopi_[h2]+kk] -= 0.5 * dum[v]; // -D1(i,k) djl
+                        }
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + ll*amopi_[h2]+jj] += 0.5 * dum[v]; // +Q1(l,j) dik
+                            A_p[v][d1boff[h2] + ll*amopi_[h2]+jj] -= 0.5 * dum[v]; // -D1(l,j) dik
+                        }
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + ll*amopi_[h2]+ii] += 0.5 * dum[v]; // +Q1(l,i) djk
+                            A_p[v][d1boff[h2] + ll*amopi_[h2]+ii] -= 0.5 * dum[v]; // -D1(l,i) djk
+                        }
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + kk*amopi_[h2]+jj] += 0.5 * dum[v]; // +Q1(k,j) dil
+                            A_p[v][d1boff[h2] + kk*amopi_[h2]+jj] -= 0.5 * dum[v]; // -D1(k,j) dil
+                        }
+                    }
                 }
             }
         }
@@ -533,57 +598,70 @@ void v2RDMSolver::Q2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u)
     }
     // map D2ab to Q210
     for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i   =  bas_aa_sym[h][ij][0];
-            int j   =  bas_aa_sym[h][ij][1];
-            int ijd = ibas_ab_sym[h][i][j];
-            int jid = ibas_ab_sym[h][j][i];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k   =  bas_aa_sym[h][kl][0];
-                int l   =  bas_aa_sym[h][kl][1];
-
-                double dum  = u_p[offset + ij*gems_aa[h]+kl];
-
-                A_p[q2toff[h] + ij*gems_aa[h]+kl]    -= dum;          // -Q2(ij,kl)
-
-                // not spin adapted
-                int kld = ibas_ab_sym[h][k][l];
-                int lkd = ibas_ab_sym[h][l][k];
-                A_p[d2aboff[h] + kld*gems_ab[h]+ijd] += 0.5 * dum;          // +D2(kl,ij)
-                A_p[d2aboff[h] + lkd*gems_ab[h]+ijd] -= 0.5 * dum;          // +D2(lk,ij)
-                A_p[d2aboff[h] + kld*gems_ab[h]+jid] -= 0.5 * dum;          // +D2(kl,ji)
-                A_p[d2aboff[h] + lkd*gems_ab[h]+jid] += 0.5 * dum;          // +D2(lk,ji)
-
-                // spin adapted
-                //A_p[d2toff[h] + INDEX(kl,ij)] += dum;          // +D2(kl,ij)
-
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + ii*amopi_[h2]+kk] += 0.5 * dum; // +Q1(i,k) djl
-                    A_p[d1boff[h2] + ii*amopi_[h2]+kk] -= 0.5 * dum; // -D1(i,k) djl
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + ll*amopi_[h2]+jj] += 0.5 * dum; // +Q1(l,j) dik
-                    A_p[d1boff[h2] + ll*amopi_[h2]+jj] -= 0.5 * dum; // -D1(l,j) dik
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + ll*amopi_[h2]+ii] -= 0.5 * dum; // +Q1(l,i) djk
-                    A_p[d1boff[h2] + ll*amopi_[h2]+ii] += 0.5 * dum; // -D1(l,i) djk
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2] + kk*amopi_[h2]+jj] -= 0.5 * dum; // +Q1(k,j) dil
-                    A_p[d1boff[h2] + kk*amopi_[h2]+jj] += 0.5 * dum; // -D1(k,j) dil
+        if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+            for (int ij = 0; ij < gems_aa[h]; ij++) {
+                int i   =  bas_aa_sym[h][ij][0];
+                int j   =  bas_aa_sym[h][ij][1];
+                int ijd = ibas_ab_sym[h][i][j];
+                int jid = ibas_ab_sym[h][j][i];
+                for (int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k   =  bas_aa_sym[h][kl][0];
+                    int l   =  bas_aa_sym[h][kl][1];
+
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = u_p[v][offset + ij*gems_aa[h]+kl];
+
+                    for (int v = 0; v < nvec; v++) A_p[v][q2toff[h] + ij*gems_aa[h]+kl]    -= dum[v];          // -Q2(ij,kl)
+
+                    // not spin adapted
+                    int kld = ibas_ab_sym[h][k][l];
+                    int lkd = ibas_ab_sym[h][l][k];
+                    for (int v = 0; v < nvec; v++) {
+                        A_p[v][d2aboff[h] + kld*gems_ab[h]+ijd] += 0.5 * dum[v];          // +D2(kl,ij)
+                        A_p[v][d2aboff[h] + lkd*gems_ab[h]+ijd] -= 0.5 * dum[v];          // +D2(lk,ij)
+                        A_p[v][d2aboff[h] + kld*gems_ab[h]+jid] -= 0.5 * dum[v];          // +D2(kl,ji)
+                        A_p[v][d2aboff[h] + lkd*gems_ab[h]+jid] += 0.5 * dum[v];          // +D2(lk,ji)
+                    }
+
+                    // spin adapted
+                    //A_p[d2toff[h] + INDEX(kl,ij)] += dum;          // +D2(kl,ij)
+
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + ii*amopi_[h2]+kk] += 0.5 * dum[v]; // +Q1(i,k) djl
+                            A_p[v][d1boff[h2] + ii*amopi_[h2]+kk] -= 0.5 * dum[v]; // -D1(i,k) djl
+                        }
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + ll*amopi_[h2]+jj] += 0.5 * dum[v]; // +Q1(l,j) dik
+                            A_p[v][d1boff[h2] + ll*amopi_[h2]+jj] -= 0.5 * dum[v]; // -D1(l,j) dik
+                        }
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + ll*amopi_[h2]+ii] -= 0.5 * dum[v]; // +Q1(l,i) djk
+                            A_p[v][d1boff[h2] + ll*amopi_[h2]+ii] += 0.5 * dum[v]; // -D1(l,i) djk
+                        }
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) {
+                            A_p[v][q1aoff[h2] + kk*amopi_[h2]+jj] -= 0.5 * dum[v]; // +Q1(k,j) dil
+                            A_p[v][d1boff[h2] + kk*amopi_[h2]+jj] += 0.5 * dum[v]; // -D1(k,j) dil
+                        }
+                    }
                 }
             }
         }
@@ -591,87 +669,99 @@ void v2RDMSolver::Q2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u)
     }
     // map D2aa to Q211
     for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double val = u_p[offset + ij*gems_aa[h]+kl];
-                A_p[q2toff_p1[h] + ij*gems_aa[h]+kl] -= val;
-                A_p[d2aaoff[h] + kl*gems_aa[h]+ij]   += val;
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2]  + ii*amopi_[h2]+kk]      += val;
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1aoff[h2]  + ll*amopi_[h2]+ii]      += val;
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2]  + jj*amopi_[h2]+kk]      -= val;
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1aoff[h2]  + ll*amopi_[h2]+jj]      -= val;
+        if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+            for (int ij = 0; ij < gems_aa[h]; ij++) {
+                int i = bas_aa_sym[h][ij][0];
+                int j = bas_aa_sym[h][ij][1];
+                for (int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k = bas_aa_sym[h][kl][0];
+                    int l = bas_aa_sym[h][kl][1];
+                    double val[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) {
+                        val[v] = u_p[v][offset + ij*gems_aa[h]+kl];
+                        A_p[v][q2toff_p1[h] + ij*gems_aa[h]+kl] -= val[v];
+                        A_p[v][d2aaoff[h] + kl*gems_aa[h]+ij]   += val[v];
+                    }
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][q1aoff[h2]  + ii*amopi_[h2]+kk]      += val[v];
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h2]  + ll*amopi_[h2]+ii]      += val[v];
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][q1aoff[h2]  + jj*amopi_[h2]+kk]      -= val[v];
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h2]  + ll*amopi_[h2]+jj]      -= val[v];
+                    }
                 }
             }
         }
         offset += gems_aa[h]*gems_aa[h];
     }
-    // map D2bb to Q21-1
-    for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double val = u_p[offset + ij*gems_aa[h]+kl];
-                A_p[q2toff_m1[h] + ij*gems_aa[h]+kl] -= val;
-                //A_p[d2toff_m1[h] + INDEX(kl,ij)] += u_p[offset + INDEX(ij,kl)];
-                A_p[d2bboff[h] + kl*gems_aa[h]+ij] += val;
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1boff[h2]  + ii*amopi_[h2]+kk]      += val;
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1boff[h2]  + ll*amopi_[h2]+ii]      += val;
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1boff[h2]  + jj*amopi_[h2]+kk]      -= val;
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1boff[h2]  + ll*amopi_[h2]+jj]      -= val;
+    if ( !alias_beta_blocks_ ) {
+        // map D2bb to Q21-1
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                for (int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for (int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double val[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) {
+                            val[v] = u_p[v][offset + ij*gems_aa[h]+kl];
+                            A_p[v][q2toff_m1[h] + ij*gems_aa[h]+kl] -= val[v];
+                        }
+                        //A_p[d2toff_m1[h] + INDEX(kl,ij)] += u_p[offset + INDEX(ij,kl)];
+                        for (int v = 0; v < nvec; v++) A_p[v][d2bboff[h] + kl*gems_aa[h]+ij] += val[v];
+                        if ( j==l ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][q1boff[h2]  + ii*amopi_[h2]+kk]      += val[v];
+                        }
+                        if ( j==k ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][d1boff[h2]  + ll*amopi_[h2]+ii]      += val[v];
+                        }
+                        if ( i==l ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][q1boff[h2]  + jj*amopi_[h2]+kk]      -= val[v];
+                        }
+                        if ( i==k ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][d1boff[h2]  + ll*amopi_[h2]+jj]      -= val[v];
+                        }
+                    }
                 }
             }
+            offset += gems_aa[h]*gems_aa[h];
         }
-        offset += gems_aa[h]*gems_aa[h];
     }
 }
 
 // Q2 guess
-void v2RDMSolver::Q2_constraints_guess(SharedVector u){
+void v2RDMSolver::Q2_constraints_guess(SharedSolverVector u){
 
     double * u_p = u->pointer();
 
@@ -799,209 +889,235 @@ void v2RDMSolver::Q2_constraints_guess(SharedVector u){
 }
 
 // Q2 portion of A.x (with symmetry)
-void v2RDMSolver::Q2_constraints_Au(SharedVector A,SharedVector u){
-    double * A_p = A->pointer();
-    double * u_p = u->pointer();
+void v2RDMSolver::Q2_constraints_Au(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    long int blocksize_ab = 0;
-    long int blocksize_aa = 0;
-    for (int h = 0; h < nirrep_; h++) {
-        blocksize_ab += gems_ab[h]*gems_ab[h];
-        blocksize_aa += gems_aa[h]*gems_aa[h];
+    int offset = constraint_offset_[FAMILY_Q2];
+
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = RowPointer(A[v]);
+        u_p[v] = u[v]->pointer();
     }
 
     // map D2ab to Q2ab
-    C_DCOPY(blocksize_ab,u_p + d2aboff[0],1,A_p + offset,1);      // + D2(kl,ij)
-    C_DAXPY(blocksize_ab,-1.0,u_p + q2aboff[0],1,A_p + offset,1); // - Q2(kl,ij)
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_ab[h]; ij++) {
-            int i = bas_ab_sym[h][ij][0];
-            int j = bas_ab_sym[h][ij][1];
-
-            // +Q1(i,k) djl
-            int hi = symmetry[i];
-            int ii = i - pitzer_offset[hi];
-            for (int kk = 0; kk < amopi_[hi]; kk++) {
-                int k  = kk + pitzer_offset[hi];
-                int kj = ibas_ab_sym[h][k][j];
-                A_p[offset + ij*gems_ab[h]+kj] += u_p[q1aoff[hi] + ii*amopi_[hi]+kk]; // +Q1(i,k) djl
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int v = 0; v < nvec; v++) {
+                C_DCOPY(gems_ab[h]*gems_ab[h],u_p[v] + d2aboff[h],1,A_p[v] + offset,1);      // + D2(kl,ij)
+                C_DAXPY(gems_ab[h]*gems_ab[h],-1.0,u_p[v] + q2aboff[h],1,A_p[v] + offset,1); // - Q2(kl,ij)
             }
-
-            // -D1(l,j) dik
-            int hj = symmetry[j];
-            int jj = j - pitzer_offset[hj];
-            for (int ll = 0; ll < amopi_[hj]; ll++) {
-                int l  = ll + pitzer_offset[hj];
-                int il = ibas_ab_sym[h][i][l];
-                A_p[offset + ij*gems_ab[h]+il] -= u_p[d1boff[hj] + jj*amopi_[hj]+ll]; // -D1(l,j) dik
+            #pragma omp parallel for schedule (static)
+            for (int ij = 0; ij < gems_ab[h]; ij++) {
+                int i = bas_ab_sym[h][ij][0];
+                int j = bas_ab_sym[h][ij][1];
+
+                // +Q1(i,k) djl
+                int hi = symmetry[i];
+                int ii = i - pitzer_offset[hi];
+                for (int kk = 0; kk < amopi_[hi]; kk++) {
+                    int k  = kk + pitzer_offset[hi];
+                    int kj = ibas_ab_sym[h][k][j];
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_ab[h]+kj] += u_p[v][q1aoff[hi] + ii*amopi_[hi]+kk]; // +Q1(i,k) djl
+                }
+
+                // -D1(l,j) dik
+                int hj = symmetry[j];
+                int jj = j - pitzer_offset[hj];
+                for (int ll = 0; ll < amopi_[hj]; ll++) {
+                    int l  = ll + pitzer_offset[hj];
+                    int il = ibas_ab_sym[h][i][l];
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_ab[h]+il] -= u_p[v][d1boff[hj] + jj*amopi_[hj]+ll]; // -D1(l,j) dik
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
 
     // map D2aa to Q2aa
-    C_DCOPY(blocksize_aa,u_p + d2aaoff[0],1,A_p + offset,1);      // + D2(kl,ij)
-    C_DAXPY(blocksize_aa,-1.0,u_p + q2aaoff[0],1,A_p + offset,1); // - Q2(kl,ij)
     for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum  = 0.0;
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  u_p[q1aoff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  u_p[d1aoff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        -=  u_p[q1aoff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        -=  u_p[d1aoff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
+        if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+            for (int v = 0; v < nvec; v++) {
+                C_DCOPY(gems_aa[h]*gems_aa[h],u_p[v] + d2aaoff[h],1,A_p[v] + offset,1);      // + D2(kl,ij)
+                C_DAXPY(gems_aa[h]*gems_aa[h],-1.0,u_p[v] + q2aaoff[h],1,A_p[v] + offset,1); // - Q2(kl,ij)
+            }
+            #pragma omp parallel for schedule (static)
+            for (int ij = 0; ij < gems_aa[h]; ij++) {
+                int i = bas_aa_sym[h][ij][0];
+                int j = bas_aa_sym[h][ij][1];
+                for (int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k = bas_aa_sym[h][kl][0];
+                    int l = bas_aa_sym[h][kl][1];
+                    double dum[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) dum[v] = 0.0;
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][q1aoff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][d1aoff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][q1aoff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][d1aoff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
+                    }
+                    for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_aa[h]+kl] += dum[v];
                 }
-                A_p[offset + ij*gems_aa[h]+kl] += dum;
             }
         }
         offset += gems_aa[h]*gems_aa[h];
     }
 
 
-    // map D2bb to Q2bb
-    C_DCOPY(blocksize_aa,u_p + d2bboff[0],1,A_p + offset,1);      // + D2(kl,ij)
-    C_DAXPY(blocksize_aa,-1.0,u_p + q2bboff[0],1,A_p + offset,1); // - Q2(kl,ij)
-    for (int h = 0; h < nirrep_; h++) {
-        #pragma omp parallel for schedule (static)
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double dum  = 0.0;
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        +=  u_p[q1boff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        +=  u_p[d1boff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    dum        -=  u_p[q1boff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
+    if ( !alias_beta_blocks_ ) {
+        // map D2bb to Q2bb
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                for (int v = 0; v < nvec; v++) {
+                    C_DCOPY(gems_aa[h]*gems_aa[h],u_p[v] + d2bboff[h],1,A_p[v] + offset,1);      // + D2(kl,ij)
+                    C_DAXPY(gems_aa[h]*gems_aa[h],-1.0,u_p[v] + q2bboff[h],1,A_p[v] + offset,1); // - Q2(kl,ij)
+                }
+                #pragma omp parallel for schedule (static)
+                for (int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for (int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double dum[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) dum[v] = 0.0;
+                        if ( j==l ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][q1boff[h2] + ii*amopi_[h2]+kk];  // +Q1(i,k) djl
+                        }
+                        if ( j==k ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        +=  u_p[v][d1boff[h2] + ll*amopi_[h2]+ii];  // +D1(l,i) djk
+                        }
+                        if ( i==l ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][q1boff[h2] + jj*amopi_[h2]+kk];  // -Q1(j,k) dil
+                        }
+                        if ( i==k ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) dum[v]        -=  u_p[v][d1boff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
+                        }
+                        for (int v = 0; v < nvec; v++) A_p[v][offset + ij*gems_aa[h]+kl] += dum[v];
+                    }
                 }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    dum        -=  u_p[d1boff[h2] + ll*amopi_[h2]+jj];  // -D1(l,j) dkl
-                }
-                A_p[offset + ij*gems_aa[h]+kl] += dum;
             }
+            offset += gems_aa[h]*gems_aa[h];
         }
-        offset += gems_aa[h]*gems_aa[h];
     }
 }
 
 // Q2 portion of A^T.y (with symmetry)
-void v2RDMSolver::Q2_constraints_ATu(SharedVector A,SharedVector u){
+void v2RDMSolver::Q2_constraints_ATu(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u){
 
-    double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    int offset = constraint_offset_[FAMILY_Q2];
 
-    long int blocksize_ab = 0;
-    long int blocksize_aa = 0;
-    for (int h = 0; h < nirrep_; h++) {
-        blocksize_ab += gems_ab[h]*gems_ab[h];
-        blocksize_aa += gems_aa[h]*gems_aa[h];
+    int nvec = u.size();
+    double * A_p[MAX_BLOCK_VECTORS];
+    double * u_p[MAX_BLOCK_VECTORS];
+    for (int v = 0; v < nvec; v++) {
+        A_p[v] = A[v]->pointer();
+        u_p[v] = RowPointer(u[v]);
     }
 
     // map D2ab to Q2ab
-    C_DAXPY(blocksize_ab, 1.0,u_p + offset,1,A_p + d2aboff[0],1); // + D2(kl,ij)
-    C_DAXPY(blocksize_ab,-1.0,u_p + offset,1,A_p + q2aboff[0],1); // - Q2(ij,kl)
     for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_ab[h]; ij++) {
-            int i = bas_ab_sym[h][ij][0];
-            int j = bas_ab_sym[h][ij][1];
-
-            // +Q1(i,k) djl
-            int hi = symmetry[i];
-            int ii = i - pitzer_offset[hi];
-            for (int kk = 0; kk < amopi_[hi]; kk++) {
-                int k  = kk + pitzer_offset[hi];
-                int kj = ibas_ab_sym[h][k][j];
-                A_p[q1aoff[hi] + ii*amopi_[hi]+kk] += u_p[offset + ij*gems_ab[h]+kj]; // +Q1(i,k) djl
+        if ( RowsAreLocal(offset,gems_ab[h]*gems_ab[h]) ) {
+            for (int v = 0; v < nvec; v++) {
+                C_DAXPY(gems_ab[h]*gems_ab[h], 1.0,u_p[v] + offset,1,A_p[v] + d2aboff[h],1); // + D2(kl,ij)
+                C_DAXPY(gems_ab[h]*gems_ab[h],-1.0,u_p[v] + offset,1,A_p[v] + q2aboff[h],1); // - Q2(ij,kl)
             }
-
-            // -D1(l,j) dik
-            int hj = symmetry[j];
-            int jj = j - pitzer_offset[hj];
-            for (int ll = 0; ll < amopi_[hj]; ll++) {
-                int l  = ll + pitzer_offset[hj];
-                int il = ibas_ab_sym[h][i][l];
-                A_p[d1boff[hj] + jj*amopi_[hj]+ll] -= u_p[offset + ij*gems_ab[h]+il]; // -D1(l,j) dik
+            for (int ij = 0; ij < gems_ab[h]; ij++) {
+                int i = bas_ab_sym[h][ij][0];
+                int j = bas_ab_sym[h][ij][1];
+
+                // +Q1(i,k) djl
+                int hi = symmetry[i];
+                int ii = i - pitzer_offset[hi];
+                for (int kk = 0; kk < amopi_[hi]; kk++) {
+                    int k  = kk + pitzer_offset[hi];
+                    int kj = ibas_ab_sym[h][k][j];
+                    for (int v = 0; v < nvec; v++) A_p[v][q1aoff[hi] + ii*amopi_[hi]+kk] += u_p[v][offset + ij*gems_ab[h]+kj]; // +Q1(i,k) djl
+                }
+
+                // -D1(l,j) dik
+                int hj = symmetry[j];
+                int jj = j - pitzer_offset[hj];
+                for (int ll = 0; ll < amopi_[hj]; ll++) {
+                    int l  = ll + pitzer_offset[hj];
+                    int il = ibas_ab_sym[h][i][l];
+                    for (int v = 0; v < nvec; v++) A_p[v][d1boff[hj] + jj*amopi_[hj]+ll] -= u_p[v][offset + ij*gems_ab[h]+il]; // -D1(l,j) dik
+                }
             }
         }
         offset += gems_ab[h]*gems_ab[h];
     }
 
     // map D2aa to Q2aa
-    C_DAXPY(blocksize_aa, 1.0,u_p + offset,1,A_p + d2aaoff[0],1); // + D2(kl,ij)
-    C_DAXPY(blocksize_aa,-1.0,u_p + offset,1,A_p + q2aaoff[0],1); // - Q2(ij,kl)
     for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double val = u_p[offset + ij*gems_aa[h]+kl];
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2]  + ii*amopi_[h2]+kk] += val;
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1aoff[h2]  + ll*amopi_[h2]+ii] += val;
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1aoff[h2]  + jj*amopi_[h2]+kk] -= val;
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1aoff[h2]  + ll*amopi_[h2]+jj] -= val;
+        if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+            for (int v = 0; v < nvec; v++) {
+                C_DAXPY(gems_aa[h]*gems_aa[h], 1.0,u_p[v] + offset,1,A_p[v] + d2aaoff[h],1); // + D2(kl,ij)
+                C_DAXPY(gems_aa[h]*gems_aa[h],-1.0,u_p[v] + offset,1,A_p[v] + q2aaoff[h],1); // - Q2(ij,kl)
+            }
+            for (int ij = 0; ij < gems_aa[h]; ij++) {
+                int i = bas_aa_sym[h][ij][0];
+                int j = bas_aa_sym[h][ij][1];
+                for (int kl = 0; kl < gems_aa[h]; kl++) {
+                    int k = bas_aa_sym[h][kl][0];
+                    int l = bas_aa_sym[h][kl][1];
+                    double val[MAX_BLOCK_VECTORS];
+                    for (int v = 0; v < nvec; v++) val[v] = u_p[v][offset + ij*gems_aa[h]+kl];
+                    if ( j==l ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][q1aoff[h2]  + ii*amopi_[h2]+kk] += val[v];
+                    }
+                    if ( j==k ) {
+                        int h2 = symmetry[i];
+                        int ii = i - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h2]  + ll*amopi_[h2]+ii] += val[v];
+                    }
+                    if ( i==l ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int kk = k - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][q1aoff[h2]  + jj*amopi_[h2]+kk] -= val[v];
+                    }
+                    if ( i==k ) {
+                        int h2 = symmetry[j];
+                        int jj = j - pitzer_offset[h2];
+                        int ll = l - pitzer_offset[h2];
+                        for (int v = 0; v < nvec; v++) A_p[v][d1aoff[h2]  + ll*amopi_[h2]+jj] -= val[v];
+                    }
                 }
             }
         }
@@ -1009,44 +1125,51 @@ void v2RDMSolver::Q2_constraints_ATu(SharedVector A,SharedVector u){
     }
 
 
-    // map D2bb to Q2bb
-    C_DAXPY(blocksize_aa, 1.0,u_p + offset,1,A_p + d2bboff[0],1); // + D2(kl,ij)
-    C_DAXPY(blocksize_aa,-1.0,u_p + offset,1,A_p + q2bboff[0],1); // - Q2(ij,kl)
-    for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_aa[h]; ij++) {
-            int i = bas_aa_sym[h][ij][0];
-            int j = bas_aa_sym[h][ij][1];
-            for (int kl = 0; kl < gems_aa[h]; kl++) {
-                int k = bas_aa_sym[h][kl][0];
-                int l = bas_aa_sym[h][kl][1];
-                double val = u_p[offset + ij*gems_aa[h]+kl];
-                if ( j==l ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1boff[h2]  + ii*amopi_[h2]+kk] += val;
-                }
-                if ( j==k ) {
-                    int h2 = symmetry[i];
-                    int ii = i - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1boff[h2]  + ll*amopi_[h2]+ii] += val;
-                }
-                if ( i==l ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int kk = k - pitzer_offset[h2];
-                    A_p[q1boff[h2]  + jj*amopi_[h2]+kk] -= val;
-                }
-                if ( i==k ) {
-                    int h2 = symmetry[j];
-                    int jj = j - pitzer_offset[h2];
-                    int ll = l - pitzer_offset[h2];
-                    A_p[d1boff[h2]  + ll*amopi_[h2]+jj] -= val;
+    if ( !alias_beta_blocks_ ) {
+        // map D2bb to Q2bb
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,gems_aa[h]*gems_aa[h]) ) {
+                for (int v = 0; v < nvec; v++) {
+                    C_DAXPY(gems_aa[h]*gems_aa[h], 1.0,u_p[v] + offset,1,A_p[v] + d2bboff[h],1); // + D2(kl,ij)
+                    C_DAXPY(gems_aa[h]*gems_aa[h],-1.0,u_p[v] + offset,1,A_p[v] + q2bboff[h],1); // - Q2(ij,kl)
+                }
+                for (int ij = 0; ij < gems_aa[h]; ij++) {
+                    int i = bas_aa_sym[h][ij][0];
+                    int j = bas_aa_sym[h][ij][1];
+                    for (int kl = 0; kl < gems_aa[h]; kl++) {
+                        int k = bas_aa_sym[h][kl][0];
+                        int l = bas_aa_sym[h][kl][1];
+                        double val[MAX_BLOCK_VECTORS];
+                        for (int v = 0; v < nvec; v++) val[v] = u_p[v][offset + ij*gems_aa[h]+kl];
+                        if ( j==l ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][q1boff[h2]  + ii*amopi_[h2]+kk] += val[v];
+                        }
+                        if ( j==k ) {
+                            int h2 = symmetry[i];
+                            int ii = i - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][d1boff[h2]  + ll*amopi_[h2]+ii] += val[v];
+                        }
+                        if ( i==l ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int kk = k - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][q1boff[h2]  + jj*amopi_[h2]+kk] -= val[v];
+                        }
+                        if ( i==k ) {
+                            int h2 = symmetry[j];
+                            int jj = j - pitzer_offset[h2];
+                            int ll = l - pitzer_offset[h2];
+                            for (int v = 0; v < nvec; v++) A_p[v][d1boff[h2]  + ll*amopi_[h2]+jj] -= val[v];
+                        }
+                    }
                 }
             }
+            offset += gems_aa[h]*gems_aa[h];
         }
-        offset += gems_aa[h]*gems_aa[h];
     }
 
 }
@@ -0,0 +1,237 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#ifndef RDM_STREAM_H
+#define RDM_STREAM_H
+
+#include<stdlib.h>
+#include<vector>
+#include<libpsio/psio.hpp>
+
+namespace psi{ namespace v2rdm_casscf{
+
+/// one element of a 2-RDM file
+struct tpdm {
+    int i;
+    int j;
+    int k;
+    int l;
+    double val;
+};
+
+/// one element of a 3-RDM file
+struct dm3 {
+    int i;
+    int j;
+    int k;
+    int l;
+    int m;
+    int n;
+    double val;
+};
+
+/// stream the records of a 2- or 3-RDM file in large chunks.  the file
+/// must already be open.  memory is one chunk, regardless of the number
+/// of records in the file:
+///
+///     RDMStream<tpdm> d2(psio,PSIF_V2RDM_D2AB,"D2ab");
+///     while ( long int n = d2.next() ) {
+///         tpdm * rec = d2.records();
+///         for (long int p = 0; p < n; p++) ...
+///     }
+template <class T>
+class RDMStream {
+public:
+
+    /// chunk_size is in records.  the default is 16 MB per chunk
+    RDMStream(boost::shared_ptr<PSIO> psio, int filenum, const char * label, long int chunk_size = 0) {
+        psio_    = psio;
+        filenum_ = filenum;
+        label_   = label;
+        psio_->read_entry(filenum_,"length",(char*)&length_,sizeof(long int));
+        chunk_   = ( chunk_size > 0 ) ? chunk_size : ( 16L * 1024L * 1024L ) / (long int)sizeof(T);
+        if ( chunk_ > length_ ) chunk_ = length_;
+        if ( chunk_ < 1 )       chunk_ = 1;
+        buffer_  = (T*)malloc(chunk_*sizeof(T));
+        addr_    = PSIO_ZERO;
+        nread_   = 0;
+    }
+    ~RDMStream() {
+        free(buffer_);
+    }
+
+    /// the stream owns its chunk buffer
+    RDMStream(const RDMStream &) = delete;
+    RDMStream & operator=(const RDMStream &) = delete;
+
+    /// total number of records in the file
+    long int length() { return length_; }
+
+    /// read the next chunk.  returns the number of records read (0 at the end)
+    long int next() {
+        long int n = length_ - nread_;
+        if ( n > chunk_ ) n = chunk_;
+        if ( n <= 0 ) return 0;
+        psio_->read(filenum_,label_,(char*)buffer_,n*sizeof(T),addr_,&addr_);
+        nread_ += n;
+        return n;
+    }
+
+    /// records from the last call to next()
+    T * records() { return buffer_; }
+
+private:
+
+    boost::shared_ptr<PSIO> psio_;
+    int filenum_;
+    const char * label_;
+    long int length_;
+    long int chunk_;
+    long int nread_;
+    psio_address addr_;
+    T * buffer_;
+};
+
+/// reader for the BLOCKED 2- and 3-RDM files (RDM_WRITE_FORMAT BLOCKED).
+/// the file must already be open.  the header and the index maps are read
+/// up front; the blocks are read one irrep at a time.  tuples of mixed spin
+/// (ab geminals, aab triplets) run over all orbital indices, and tuples of
+/// the same spin (aa, aaa) over ordered indices only:
+///
+///     BlockedRDM d2(psio,PSIF_V2RDM_D2_BLOCKED,2);
+///     for (int h = 0; h < d2.nirrep(); h++) {
+///         d2.read_mixed("D2ab",h,block);     // dim_mixed(h)^2 doubles
+///         const int * ij = d2.mixed(h,n);    // orbitals of geminal n
+///     }
+class BlockedRDM {
+public:
+
+    /// rank is 2 (file PSIF_V2RDM_D2_BLOCKED) or 3 (PSIF_V2RDM_D3_BLOCKED)
+    BlockedRDM(boost::shared_ptr<PSIO> psio, int filenum, int rank) {
+        psio_    = psio;
+        filenum_ = filenum;
+        rank_    = rank;
+
+        int header[4];
+        psio_->read_entry(filenum_,"header",(char*)header,4*sizeof(int));
+        version_ = header[0];
+        nirrep_  = header[1];
+        amo_     = header[2];
+        nmo_     = header[3];
+
+        amopi_.resize(nirrep_);
+        symmetry_.resize(amo_);
+        full_basis_.resize(amo_);
+        psio_->read_entry(filenum_,"amopi",(char*)&amopi_[0],nirrep_*sizeof(int));
+        psio_->read_entry(filenum_,"symmetry",(char*)&symmetry_[0],amo_*sizeof(int));
+        psio_->read_entry(filenum_,"full_basis",(char*)&full_basis_[0],amo_*sizeof(int));
+
+        dim_mixed_.resize(nirrep_);
+        dim_same_.resize(nirrep_);
+        psio_->read_entry(filenum_,rank_ == 2 ? "gems_ab" : "trip_aab",(char*)&dim_mixed_[0],nirrep_*sizeof(int));
+        psio_->read_entry(filenum_,rank_ == 2 ? "gems_aa" : "trip_aaa",(char*)&dim_same_[0],nirrep_*sizeof(int));
+
+        // offsets of each irrep's tuples in the maps and of its blocks in the file
+        long int nmixed = 0;
+        long int nsame  = 0;
+        long int bmixed = 0;
+        long int bsame  = 0;
+        for (int h = 0; h < nirrep_; h++) {
+            map_mixed_off_.push_back(nmixed);
+            map_same_off_.push_back(nsame);
+            block_mixed_off_.push_back(bmixed);
+            block_same_off_.push_back(bsame);
+            nmixed += dim_mixed_[h];
+            nsame  += dim_same_[h];
+            bmixed += (long int)dim_mixed_[h] * dim_mixed_[h];
+            bsame  += (long int)dim_same_[h] * dim_same_[h];
+        }
+        bas_mixed_.resize(rank_*nmixed+1);
+        bas_same_.resize(rank_*nsame+1);
+        psio_->read_entry(filenum_,rank_ == 2 ? "bas_ab" : "bas_aab",(char*)&bas_mixed_[0],rank_*nmixed*sizeof(int));
+        psio_->read_entry(filenum_,rank_ == 2 ? "bas_aa" : "bas_aaa",(char*)&bas_same_[0],rank_*nsame*sizeof(int));
+    }
+
+    int version() { return version_; }
+    int nirrep()  { return nirrep_; }
+    int amo()     { return amo_; }
+    int nmo()     { return nmo_; }
+
+    /// active orbitals per irrep, irrep of each active orbital, and the
+    /// pitzer index of each active orbital
+    const std::vector<int> & amopi()      { return amopi_; }
+    const std::vector<int> & symmetry()   { return symmetry_; }
+    const std::vector<int> & full_basis() { return full_basis_; }
+
+    /// number of mixed-spin and same-spin tuples in irrep h
+    int dim_mixed(int h) { return dim_mixed_[h]; }
+    int dim_same(int h)  { return dim_same_[h]; }
+
+    /// the rank active orbital indices of tuple n of irrep h
+    const int * mixed(int h, int n) { return &bas_mixed_[rank_*(map_mixed_off_[h]+n)]; }
+    const int * same(int h, int n)  { return &bas_same_[rank_*(map_same_off_[h]+n)]; }
+
+    /// read the block of irrep h of a mixed-spin ("D2ab", "D3aab", "D3bba")
+    /// or same-spin ("D2aa", "D2bb", "D3aaa", "D3bbb") entry
+    void read_mixed(const char * label, int h, double * block) {
+        read(label,block_mixed_off_[h],(long int)dim_mixed_[h]*dim_mixed_[h],block);
+    }
+    void read_same(const char * label, int h, double * block) {
+        read(label,block_same_off_[h],(long int)dim_same_[h]*dim_same_[h],block);
+    }
+
+private:
+
+    void read(const char * label, long int offset, long int n, double * block) {
+        if ( n == 0 ) return;
+        psio_address addr = psio_get_address(PSIO_ZERO,offset*sizeof(double));
+        psio_->read(filenum_,label,(char*)block,n*sizeof(double),addr,&addr);
+    }
+
+    boost::shared_ptr<PSIO> psio_;
+    int filenum_;
+    int rank_;
+    int version_;
+    int nirrep_;
+    int amo_;
+    int nmo_;
+    std::vector<int> amopi_;
+    std::vector<int> symmetry_;
+    std::vector<int> full_basis_;
+    std::vector<int> dim_mixed_;
+    std::vector<int> dim_same_;
+    std::vector<int> bas_mixed_;
+    std::vector<int> bas_same_;
+    std::vector<long int> map_mixed_off_;
+    std::vector<long int> map_same_off_;
+    std::vector<long int> block_mixed_off_;
+    std::vector<long int> block_same_off_;
+};
+
+}}
+
+#endif
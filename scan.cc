@@ -0,0 +1,220 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ * 
+ *@END LICENSE
+ *
+ */
+
+#include <sstream>
+
+#include <psi4-dec.h>
+#include <libmints/wavefunction.h>
+#include <libmints/matrix.h>
+#include <libmints/vector.h>
+
+#include"v2rdm_solver.h"
+
+using namespace psi;
+
+namespace psi{ namespace v2rdm_casscf{
+
+// solution and orbitals from the previous point of a scan.  the plugin
+// stays loaded between calls to energy(), so the last point is simply
+// kept in memory, labeled with the computation it belongs to.
+struct ScanState {
+    ScanState() : valid(false) {}
+    bool valid;
+    std::string key;
+    std::vector<int> spaces;
+    long int dimx;
+    long int nconstraints;
+    long int row_begin;
+    long int nrow_local;
+    double mu;
+    SharedSolverVector x;
+    SharedSolverVector y; // this rank's rows only
+    SharedSolverVector z;
+    SharedVector epsilon;
+    SharedMatrix C;
+};
+static ScanState scan_state;
+
+// number of so's and of mo's in each orbital space, per irrep.  two points
+// can only share a solution if these match.
+std::vector<int> v2RDMSolver::ScanSpaces() {
+    std::vector<int> spaces;
+    for (int h = 0; h < nirrep_; h++) {
+        spaces.push_back(nsopi_[h]);
+        spaces.push_back(nmopi_[h]);
+        spaces.push_back(frzcpi_[h]);
+        spaces.push_back(rstcpi_[h]);
+        spaces.push_back(amopi_[h]);
+        spaces.push_back(rstvpi_[h]);
+        spaces.push_back(frzvpi_[h]);
+    }
+    return spaces;
+}
+
+// the computation a point belongs to: the molecule (but not its geometry),
+// the basis, and the active space and constraints.  only points with the
+// same key are treated as one scan.
+std::string v2RDMSolver::ScanKey() {
+    std::stringstream key;
+    key << molecule_->name() << " " << options_.get_str("BASIS") << " "
+        << molecule_->molecular_charge() << " " << multiplicity_ << " "
+        << ( state_positivity_ != "" ? state_positivity_ : options_.get_str("POSITIVITY") );
+    for (int i = 0; i < molecule_->natom(); i++) {
+        key << " " << molecule_->Z(i);
+    }
+    return key.str();
+}
+
+// replace the scf orbitals with those of the previous point, projected onto
+// the current mo space and symmetrically orthonormalized in the current
+// metric.  each orbital keeps its position (and thus its space), so active
+// orbitals are matched to the previous active orbitals by overlap.
+void v2RDMSolver::ProjectScanOrbitals() {
+
+    scan_warm_start_ = false;
+
+    if ( !scan_state.valid ) return;
+
+    // the last point belongs to an unrelated computation
+    if ( scan_state.key != ScanKey() ) {
+        scan_state = ScanState();
+        return;
+    }
+
+    outfile->Printf("  ==> Warm start from previous geometry <==\n");
+    outfile->Printf("\n");
+
+    if ( scan_state.spaces != ScanSpaces() ) {
+        outfile->Printf("        Orbital spaces changed.  Starting from scratch.\n");
+        outfile->Printf("\n");
+        return;
+    }
+
+    // P = C(new)^T S C(old), U = P (P^T P)^(-1/2)
+    SharedMatrix P = Matrix::triplet(Ca_,S_,scan_state.C,true,false,false);
+    SharedMatrix M = Matrix::doublet(P,P,true,false);
+    M->power(-0.5);
+    SharedMatrix U = Matrix::doublet(P,M);
+    SharedMatrix C = Matrix::doublet(Ca_,U);
+
+    // overlap of each active orbital with its counterpart from the last point
+    SharedMatrix O = Matrix::triplet(C,S_,scan_state.C,true,false,false);
+    double min_overlap = 1.0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = frzcpi_[h] + rstcpi_[h]; i < frzcpi_[h] + rstcpi_[h] + amopi_[h]; i++) {
+            double dum = fabs(O->pointer(h)[i][i]);
+            if ( dum < min_overlap ) min_overlap = dum;
+        }
+    }
+    outfile->Printf("        Smallest active orbital overlap:    %10.6lf\n",min_overlap);
+    Process::environment.globals["v2RDM SCAN ACTIVE OVERLAP"] = min_overlap;
+
+    // the active space has changed character (no orbital of the previous
+    // point clearly maps onto it).  don't trust the old solution
+    if ( min_overlap < options_.get_double("SCAN_MIN_OVERLAP") ) {
+        outfile->Printf("        Active orbitals could not be matched.  Starting from scratch.\n");
+        outfile->Printf("\n");
+        return;
+    }
+    outfile->Printf("\n");
+
+    // the reference keeps its own orbitals.  the integral transformations
+    // use Ca_ (see CaSubsetAO)
+    Ca_ = C;
+    Cb_ = C->clone();
+
+    // keep the orbital ordering of the previous point so the primal and
+    // dual solutions map onto the same geminals.  epsilon_a_ orders the
+    // 3-index integral transformation.
+    epsilon_a_->copy(scan_state.epsilon.get());
+    epsilon_b_->copy(scan_state.epsilon.get());
+
+    scan_warm_start_ = true;
+}
+
+void v2RDMSolver::ReadScanSolution() {
+
+    if ( !scan_warm_start_ ) return;
+
+    if ( scan_state.dimx != dimx_ || scan_state.nconstraints != nconstraints_
+      || scan_state.row_begin != row_begin_ || scan_state.nrow_local != nrow_local_ ) {
+        outfile->Printf("\n");
+        outfile->Printf("    ==> Primal/dual solutions from the previous geometry do not fit this problem <==\n");
+        return;
+    }
+
+    x->copy(scan_state.x.get());
+    y->copy(scan_state.y.get());
+    z->copy(scan_state.z.get());
+    mu = scan_state.mu;
+
+    outfile->Printf("\n");
+    outfile->Printf("    ==> Restarting from previous geometry (mu = %7.3lf) <==\n",mu);
+
+    Process::environment.globals["v2RDM SCAN WARM START"] = 1.0;
+}
+
+// x, y, z, the orbital energies, and the orbitals kept in scan_state
+double v2RDMSolver::ScanStateDoubles() {
+
+    if ( !scan_state.valid ) return 0.0;
+
+    double ndoubles = 2.0 * scan_state.x->dim() + scan_state.nrow_local;
+    for (int h = 0; h < scan_state.C->nirrep(); h++) {
+        ndoubles += scan_state.C->coldim(h);
+        ndoubles += (double)scan_state.C->rowdim(h) * scan_state.C->coldim(h);
+    }
+    return ndoubles;
+}
+
+void v2RDMSolver::SaveScanState() {
+
+    scan_state.valid        = true;
+    scan_state.key          = ScanKey();
+    scan_state.spaces       = ScanSpaces();
+    scan_state.dimx         = dimx_;
+    scan_state.nconstraints = nconstraints_;
+    scan_state.row_begin    = row_begin_;
+    scan_state.nrow_local   = nrow_local_;
+    scan_state.mu           = mu;
+
+    scan_state.x = SharedSolverVector(new SolverVector("scan primal solution",dimx_unpacked_));
+    scan_state.y = SharedSolverVector(new SolverVector("scan dual solution",nrow_local_));
+    scan_state.z = SharedSolverVector(new SolverVector("scan dual solution 2",dimx_unpacked_));
+    scan_state.x->copy(x.get());
+    scan_state.y->copy(y.get());
+    scan_state.z->copy(z.get());
+
+    scan_state.epsilon = SharedVector(new Vector(nirrep_,nmopi_));
+    scan_state.epsilon->copy(epsilon_a_.get());
+
+    // optimized (not semicanonicalized) orbitals, in which x is expressed
+    scan_state.C = Ca_->clone();
+    TransformOrbitals(scan_state.C,scan_state.C);
+}
+
+}}
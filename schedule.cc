@@ -0,0 +1,151 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include <psi4-dec.h>
+
+#include"v2rdm_solver.h"
+
+using namespace psi;
+
+namespace psi{ namespace v2rdm_casscf{
+
+// with ADAPTIVE_SCHEDULE, the iterations are given ADAPTIVE_MIN_INTERVAL
+// iterations to respond to a mu update or orbital step before the
+// controller looks again.  a decision to wait is logged once per interval,
+// so the log shows why nothing happened without a line every iteration
+bool v2RDMSolver::LogHold(int since) {
+    return adaptive_schedule_ && since >= adaptive_min_interval_
+        && ( since - adaptive_min_interval_ ) % adaptive_min_interval_ == 0;
+}
+
+// mu = mu*ep/ed balances the primal and dual errors.  the fixed schedule
+// applies it every MU_UPDATE_FREQUENCY iterations.  the adaptive schedule
+// applies it as soon as the errors are more than ADAPTIVE_MU_RATIO apart,
+// and falls back to MU_UPDATE_FREQUENCY if they never are.
+bool v2RDMSolver::MuUpdateDue() {
+
+    if ( oiter_ == 0 ) return false;
+
+    if ( !adaptive_schedule_ ) {
+        if ( oiter_ % mu_update_frequency_ != 0 ) return false;
+        last_mu_update_ = oiter_;
+        return true;
+    }
+
+    int since = oiter_ - last_mu_update_;
+    if ( since < adaptive_min_interval_ ) return false;
+
+    if ( ed <= 0.0 ) {
+        if ( LogHold(since) ) {
+            outfile->Printf("      schedule: iter %5i  mu %9.3le kept  (no dual error yet)\n",oiter_,mu);
+        }
+        return false;
+    }
+
+    double ratio = ep / ed;
+    const char * reason = NULL;
+    if ( ratio > adaptive_mu_ratio_ || ratio * adaptive_mu_ratio_ < 1.0 ) {
+        reason = "eps(p)/eps(d) out of balance";
+    }else if ( since >= mu_update_frequency_ ) {
+        reason = "MU_UPDATE_FREQUENCY reached";
+    }
+    if ( reason == NULL ) {
+        if ( LogHold(since) ) {
+            outfile->Printf("      schedule: iter %5i  mu %9.3le kept  eps(p)/eps(d) = %9.3le  (balanced)\n",
+                oiter_,mu,ratio);
+        }
+        return false;
+    }
+
+    outfile->Printf("      schedule: iter %5i  mu %9.3le -> %9.3le  eps(p)/eps(d) = %9.3le  (%s)\n",
+        oiter_,mu,mu*ratio,ratio,reason);
+
+    last_mu_update_ = oiter_;
+    return true;
+}
+
+// an orbital step is only worthwhile once the sdp has resolved the density
+// better than the orbitals are converged for it.  the fixed schedule takes
+// a step every ORBOPT_FREQUENCY iterations.  the adaptive schedule takes one
+// as soon as the larger sdp error drops below ADAPTIVE_ORBOPT_FRACTION times
+// the orbital gradient norm left by the last step, and falls back to
+// ORBOPT_FREQUENCY (as it must for the first step, when there is no
+// gradient yet).  neither takes a step while the energy is above the
+// reference energy, or while a background step (ORBOPT_ASYNC) is still
+// running.  in the latter case the step is not counted as taken, so the
+// interval runs from the last step that actually started.
+bool v2RDMSolver::OrbitalStepDue(double energy) {
+
+    if ( oiter_ == 0 ) return false;
+
+    int since = oiter_ - last_orbopt_step_;
+    bool check = adaptive_schedule_ ? ( since >= adaptive_min_interval_ ) : ( oiter_ % orbopt_frequency_ == 0 );
+    if ( !check ) return false;
+
+    if ( orbopt_thread_ != NULL ) {
+        if ( !adaptive_schedule_ || LogHold(since) ) {
+            outfile->Printf("      schedule: iter %5i  no orbital step  (background step from iter %i still running)\n",
+                oiter_,last_orbopt_step_);
+        }
+        return false;
+    }
+    if ( energy + enuc_ + efzc_ >= escf_ ) {
+        if ( LogHold(since) ) {
+            outfile->Printf("      schedule: iter %5i  no orbital step  (energy above the reference energy)\n",oiter_);
+        }
+        return false;
+    }
+
+    if ( !adaptive_schedule_ ) {
+        last_orbopt_step_ = oiter_;
+        return true;
+    }
+
+    double residual = ( ep > ed ) ? ep : ed;
+    double gradient = orbopt_data_[11];
+    const char * reason = NULL;
+    if ( gradient > 0.0 && residual < adaptive_orbopt_fraction_ * gradient ) {
+        reason = "sdp error below orbital gradient";
+    }else if ( since >= orbopt_frequency_ ) {
+        reason = "ORBOPT_FREQUENCY reached";
+    }
+    if ( reason == NULL ) {
+        if ( LogHold(since) ) {
+            outfile->Printf("      schedule: iter %5i  no orbital step  sdp error = %9.3le  gradient = %9.3le  (waiting)\n",
+                oiter_,residual,gradient);
+        }
+        return false;
+    }
+
+    outfile->Printf("      schedule: iter %5i  orbital step  sdp error = %9.3le  gradient = %9.3le  (%s)\n",
+        oiter_,residual,gradient,reason);
+
+    last_orbopt_step_ = oiter_;
+    return true;
+}
+
+}}
@@ -121,5 +121,102 @@ void v2RDMSolver::ReadIntegrals(double * tei,long int nmo){
   iwl_buf_close(&Buf,1);
 }
 
+/**
+  * store (pq|rs) directly in the symmetry-blocked buffer tei.  gem[p*nmo+q]
+  * is the index of geminal pq within its irrep, gemsym[p*nmo+q], or -1 if
+  * the geminal involves a frozen virtual orbital.  off[h] is the start of
+  * the block for irrep h.
+  */
+void ReadAllIntegralsDirect(iwlbuf *Buf,double*tei,long int*gem,int*gemsym,long int*off,long int nmo) {
+
+  ULI lastbuf;
+  Label *lblptr;
+  Value *valptr;
+
+  ULI idx, p, q, r, s;
+
+  lblptr = Buf->labels;
+  valptr = Buf->values;
+  lastbuf = Buf->lastbuf;
+
+  outfile->Printf("\n");
+  outfile->Printf("        Read integrals (direct sort)......");
+  /**
+    * first buffer (read in when Buf was initialized)
+    */
+  for (idx=4*Buf->idx; Buf->idx<Buf->inbuf; Buf->idx++) {
+      p = (ULI) lblptr[idx++];
+      q = (ULI) lblptr[idx++];
+      r = (ULI) lblptr[idx++];
+      s = (ULI) lblptr[idx++];
+
+      long int pq = gem[p*nmo+q];
+      long int rs = gem[r*nmo+s];
+      if ( pq < 0 || rs < 0 ) continue;
+
+      tei[off[gemsym[p*nmo+q]] + INDEX(pq,rs)] = (double)valptr[Buf->idx];
+  }
+  /**
+    * now do the same for the rest of the buffers
+    */
+  while(!lastbuf){
+      iwl_buf_fetch(Buf);
+      lastbuf = Buf->lastbuf;
+      for (idx=4*Buf->idx; Buf->idx<Buf->inbuf; Buf->idx++) {
+
+          p = (ULI) lblptr[idx++];
+          q = (ULI) lblptr[idx++];
+          r = (ULI) lblptr[idx++];
+          s = (ULI) lblptr[idx++];
+
+          long int pq = gem[p*nmo+q];
+          long int rs = gem[r*nmo+s];
+          if ( pq < 0 || rs < 0 ) continue;
+
+          tei[off[gemsym[p*nmo+q]] + INDEX(pq,rs)] = (double)valptr[Buf->idx];
+
+      }
+
+  }
+  outfile->Printf("done.\n\n");
+}
+
+// read the two-electron integrals into tei_full_sym_ without the dense nmo^4 buffer
+void v2RDMSolver::ReadIntegralsDirect(){
+
+  long int nmo = nmo_;
+
+  // geminal maps for the layout used in GetTEIFromDisk
+  long int * gem    = (long int*)malloc(nmo*nmo*sizeof(long int));
+  int * gemsym      = (int*)malloc(nmo*nmo*sizeof(int));
+  long int * off    = (long int*)malloc(nirrep_*sizeof(long int));
+  for (long int pq = 0; pq < nmo*nmo; pq++) {
+      gem[pq]    = -1;
+      gemsym[pq] = 0;
+  }
+  long int offset = 0;
+  for (int h = 0; h < nirrep_; h++) {
+      off[h] = offset;
+      for (long int ij = 0; ij < gems_full[h]; ij++) {
+          long int i = bas_really_full_sym[h][ij][0];
+          long int j = bas_really_full_sym[h][ij][1];
+          gem[i*nmo+j]    = ij;
+          gem[j*nmo+i]    = ij;
+          gemsym[i*nmo+j] = h;
+          gemsym[j*nmo+i] = h;
+      }
+      offset += (long int)gems_full[h] * ( (long int)gems_full[h] + 1 ) / 2;
+  }
+
+  struct iwlbuf Buf;
+  iwl_buf_init(&Buf,PSIF_MO_TEI,0.0,1,1);
+  ReadAllIntegralsDirect(&Buf,tei_full_sym_,gem,gemsym,off,nmo);
+  iwl_buf_close(&Buf,1);
+
+  free(off);
+  free(gemsym);
+  free(gem);
+}
+
 
 }}
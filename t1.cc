@@ -56,7 +56,7 @@ using namespace fnocc;
 namespace psi{ namespace v2rdm_casscf{
 
 // T1 portion of A.u 
-void v2RDMSolver::T1_constraints_guess(SharedVector u){
+void v2RDMSolver::T1_constraints_guess(SharedSolverVector u){
 
     double * u_p = u->pointer();
 
@@ -432,70 +432,74 @@ void v2RDMSolver::T1_constraints_guess(SharedVector u){
 }
 
 // T1 portion of A.u 
-void v2RDMSolver::T1_constraints_Au(SharedVector A,SharedVector u){
+void v2RDMSolver::T1_constraints_Au(SharedSolverVector A,SharedSolverVector u){
 
-    double * A_p = A->pointer();
+    int offset = constraint_offset_[FAMILY_T1];
+
+    double * A_p = RowPointer(A);
     double * u_p = u->pointer();
 
     // T1aab
     for (int h = 0; h < nirrep_; h++) {
 
-        #pragma omp parallel for schedule (static)
-        for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
+        if ( RowsAreLocal(offset,trip_aab[h]*trip_aab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
 
-            int i = bas_aab_sym[h][ijk][0];
-            int j = bas_aab_sym[h][ijk][1];
-            int k = bas_aab_sym[h][ijk][2];
+                int i = bas_aab_sym[h][ijk][0];
+                int j = bas_aab_sym[h][ijk][1];
+                int k = bas_aab_sym[h][ijk][2];
 
-            for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
+                for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
 
-                int l = bas_aab_sym[h][lmn][0];
-                int m = bas_aab_sym[h][lmn][1];
-                int n = bas_aab_sym[h][lmn][2];
+                    int l = bas_aab_sym[h][lmn][0];
+                    int m = bas_aab_sym[h][lmn][1];
+                    int n = bas_aab_sym[h][lmn][2];
 
-                double dum = -u_p[t1aaboff[h] + ijk*trip_aab[h]+lmn]; // - T1(ijk,lmn)
+                    double dum = -u_p[t1aaboff[h] + ijk*trip_aab[h]+lmn]; // - T1(ijk,lmn)
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    dum += u_p[q2aaoff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
-                }
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        dum += u_p[q2aaoff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
+                    }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int nm = ibas_ab_sym[hki][m][n];
-                    int ki = ibas_ab_sym[hki][i][k];
-                    dum -= u_p[d2aboff[hki] + nm*gems_ab[hki] + ki];  // -D2(nm,ki) dlj
-                }
+                    if ( j == l ) {
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int nm = ibas_ab_sym[hki][m][n];
+                        int ki = ibas_ab_sym[hki][i][k];
+                        dum -= u_p[d2aboff[hki] + nm*gems_ab[hki] + ki];  // -D2(nm,ki) dlj
+                    }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int nm = ibas_ab_sym[hkj][m][n];
-                    int kj = ibas_ab_sym[hkj][j][k];
-                    dum += u_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj];  // D2(nm,kj) dli
-                }
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int nm = ibas_ab_sym[hkj][m][n];
+                        int kj = ibas_ab_sym[hkj][j][k];
+                        dum += u_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj];  // D2(nm,kj) dli
+                    }
 
-                if ( j == m ) {
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    dum -= u_p[g2baoff[hni] + ni*gems_ab[hni] + kl];  // -G2(ni,kl) djm
+                    if ( j == m ) {
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        dum -= u_p[g2baoff[hni] + ni*gems_ab[hni] + kl];  // -G2(ni,kl) djm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    dum += u_p[g2baoff[hkl] + nj*gems_ab[hkl] + kl];  // G2(nj,kl) dim
+                    if ( i == m ) {
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        dum += u_p[g2baoff[hkl] + nj*gems_ab[hkl] + kl];  // G2(nj,kl) dim
                     
-                }
+                    }
 
 
-                A_p[offset + ijk*trip_aab[h]+lmn] = dum;
+                    A_p[offset + ijk*trip_aab[h]+lmn] = dum;
 
 
+                }
             }
         }
         offset += trip_aab[h]*trip_aab[h];
@@ -504,62 +508,64 @@ void v2RDMSolver::T1_constraints_Au(SharedVector A,SharedVector u){
     // T1bba
     for (int h = 0; h < nirrep_; h++) {
 
-        #pragma omp parallel for schedule (static)
-        for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
+        if ( RowsAreLocal(offset,trip_aab[h]*trip_aab[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
 
-            int i = bas_aab_sym[h][ijk][0];
-            int j = bas_aab_sym[h][ijk][1];
-            int k = bas_aab_sym[h][ijk][2];
+                int i = bas_aab_sym[h][ijk][0];
+                int j = bas_aab_sym[h][ijk][1];
+                int k = bas_aab_sym[h][ijk][2];
 
-            for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
+                for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
 
-                int l = bas_aab_sym[h][lmn][0];
-                int m = bas_aab_sym[h][lmn][1];
-                int n = bas_aab_sym[h][lmn][2];
+                    int l = bas_aab_sym[h][lmn][0];
+                    int m = bas_aab_sym[h][lmn][1];
+                    int n = bas_aab_sym[h][lmn][2];
 
-                double dum = -u_p[t1bbaoff[h] + ijk*trip_aab[h]+lmn]; // - T1(ijk,lmn)
+                    double dum = -u_p[t1bbaoff[h] + ijk*trip_aab[h]+lmn]; // - T1(ijk,lmn)
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    dum += u_p[q2bboff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
-                }
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        dum += u_p[q2bboff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
+                    }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int nm = ibas_ab_sym[hki][n][m];
-                    int ki = ibas_ab_sym[hki][k][i];
-                    dum -= u_p[d2aboff[hki] + nm*gems_ab[hki] + ki];  // -D2(nm,ki) dlj
-                }
+                    if ( j == l ) {
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int nm = ibas_ab_sym[hki][n][m];
+                        int ki = ibas_ab_sym[hki][k][i];
+                        dum -= u_p[d2aboff[hki] + nm*gems_ab[hki] + ki];  // -D2(nm,ki) dlj
+                    }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int nm = ibas_ab_sym[hkj][n][m];
-                    int kj = ibas_ab_sym[hkj][k][j];
-                    dum += u_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj];  // D2(nm,kj) dli
-                }
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int nm = ibas_ab_sym[hkj][n][m];
+                        int kj = ibas_ab_sym[hkj][k][j];
+                        dum += u_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj];  // D2(nm,kj) dli
+                    }
 
-                if ( j == m ) {
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    dum -= u_p[g2aboff[hni] + ni*gems_ab[hni] + kl];  // -G2(ni,kl) djm
+                    if ( j == m ) {
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        dum -= u_p[g2aboff[hni] + ni*gems_ab[hni] + kl];  // -G2(ni,kl) djm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    dum += u_p[g2aboff[hkl] + nj*gems_ab[hkl] + kl];  // G2(nj,kl) dim
+                    if ( i == m ) {
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        dum += u_p[g2aboff[hkl] + nj*gems_ab[hkl] + kl];  // G2(nj,kl) dim
                     
-                }
+                    }
 
 
-                A_p[offset + ijk*trip_aab[h]+lmn] = dum;
+                    A_p[offset + ijk*trip_aab[h]+lmn] = dum;
 
 
+                }
             }
         }
         offset += trip_aab[h]*trip_aab[h];
@@ -568,119 +574,121 @@ void v2RDMSolver::T1_constraints_Au(SharedVector A,SharedVector u){
     // T1aaa
     for (int h = 0; h < nirrep_; h++) {
 
-        #pragma omp parallel for schedule (static)
-        for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
+        if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
 
-            int i = bas_aaa_sym[h][ijk][0];
-            int j = bas_aaa_sym[h][ijk][1];
-            int k = bas_aaa_sym[h][ijk][2];
+                int i = bas_aaa_sym[h][ijk][0];
+                int j = bas_aaa_sym[h][ijk][1];
+                int k = bas_aaa_sym[h][ijk][2];
 
-            for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
-
-                int l = bas_aaa_sym[h][lmn][0];
-                int m = bas_aaa_sym[h][lmn][1];
-                int n = bas_aaa_sym[h][lmn][2];
+                for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
 
-                double dum = -u_p[t1aaaoff[h] + ijk*trip_aaa[h]+lmn]; // - T1(ijk,lmn)
+                    int l = bas_aaa_sym[h][lmn][0];
+                    int m = bas_aaa_sym[h][lmn][1];
+                    int n = bas_aaa_sym[h][lmn][2];
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    dum += u_p[q2aaoff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
-                }
+                    double dum = -u_p[t1aaaoff[h] + ijk*trip_aaa[h]+lmn]; // - T1(ijk,lmn)
 
-                if ( j == n ) {
-                    int hik = SymmetryPair(symmetry[i],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hik == hlm ) {
-                        int ik = ibas_aa_sym[hik][i][k];
-                        int lm = ibas_aa_sym[hik][l][m];
-                        dum -= u_p[q2aaoff[hik] + ik*gems_aa[hik] + lm];  // -Q2(ik,lm) djn
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        dum += u_p[q2aaoff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
                     }
-                }
 
-                if ( i == n ) {
-                    int hjk = SymmetryPair(symmetry[j],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hjk == hlm ) {
-                        int jk = ibas_aa_sym[hjk][j][k];
-                        int lm = ibas_aa_sym[hjk][l][m];
-                        dum += u_p[q2aaoff[hjk] + jk*gems_aa[hjk] + lm];  // Q2(jk,lm) din
+                    if ( j == n ) {
+                        int hik = SymmetryPair(symmetry[i],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hik == hlm ) {
+                            int ik = ibas_aa_sym[hik][i][k];
+                            int lm = ibas_aa_sym[hik][l][m];
+                            dum -= u_p[q2aaoff[hik] + ik*gems_aa[hik] + lm];  // -Q2(ik,lm) djn
+                        }
                     }
-                }
-
 
-                if ( l == k ) {
-                    int hnm = SymmetryPair(symmetry[n],symmetry[m]);
-                    int hji = SymmetryPair(symmetry[j],symmetry[i]);
-                    if ( hji == hnm ) {
-                        int nm = ibas_aa_sym[hji][n][m];
-                        int ji = ibas_aa_sym[hji][j][i];
-                        dum += u_p[d2aaoff[hji] + nm*gems_aa[hji] + ji];  // D2(nm,ji) dlk
+                    if ( i == n ) {
+                        int hjk = SymmetryPair(symmetry[j],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hjk == hlm ) {
+                            int jk = ibas_aa_sym[hjk][j][k];
+                            int lm = ibas_aa_sym[hjk][l][m];
+                            dum += u_p[q2aaoff[hjk] + jk*gems_aa[hjk] + lm];  // Q2(jk,lm) din
+                        }
                     }
-                }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int nm = ibas_aa_sym[hki][n][m];
-                    int ki = ibas_aa_sym[hki][k][i];
-                    dum -= u_p[d2aaoff[hki] + nm*gems_aa[hki] + ki];  // -D2(nm,ki) dlj
-                }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int nm = ibas_aa_sym[hkj][n][m];
-                    int kj = ibas_aa_sym[hkj][k][j];
-                    dum += u_p[d2aaoff[hkj] + nm*gems_aa[hkj] + kj];  // D2(nm,kj) dli
-                }
+                    if ( l == k ) {
+                        int hnm = SymmetryPair(symmetry[n],symmetry[m]);
+                        int hji = SymmetryPair(symmetry[j],symmetry[i]);
+                        if ( hji == hnm ) {
+                            int nm = ibas_aa_sym[hji][n][m];
+                            int ji = ibas_aa_sym[hji][j][i];
+                            dum += u_p[d2aaoff[hji] + nm*gems_aa[hji] + ji];  // D2(nm,ji) dlk
+                        }
+                    }
 
-                if ( k == m ) {
                     if ( j == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        dum -= u_p[d1aoff[h2] + nn*amopi_[h2]+ii]; // - D1(n,i) djl dkm
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int nm = ibas_aa_sym[hki][n][m];
+                        int ki = ibas_aa_sym[hki][k][i];
+                        dum -= u_p[d2aaoff[hki] + nm*gems_aa[hki] + ki];  // -D2(nm,ki) dlj
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int jl = ibas_ab_sym[hni][j][l];
-                    dum += u_p[g2aaoff[hni] + ni*2*gems_ab[hni] + jl];  // G2(ni,jl) dkm
-                    
-                }
 
-                if ( j == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        dum += u_p[d1aoff[h2] + nn*amopi_[h2]+ii]; // D1(n,i) dkl djm
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int nm = ibas_aa_sym[hkj][n][m];
+                        int kj = ibas_aa_sym[hkj][k][j];
+                        dum += u_p[d2aaoff[hkj] + nm*gems_aa[hkj] + kj];  // D2(nm,kj) dli
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    dum -= u_p[g2aaoff[hni] + ni*2*gems_ab[hni] + kl];  // -G2(ni,kl) djm
+
+                    if ( k == m ) {
+                        if ( j == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            dum -= u_p[d1aoff[h2] + nn*amopi_[h2]+ii]; // - D1(n,i) djl dkm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int jl = ibas_ab_sym[hni][j][l];
+                        dum += u_p[g2aaoff[hni] + ni*2*gems_ab[hni] + jl];  // G2(ni,jl) dkm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int jj = j - pitzer_offset[h2];
-                        dum -= u_p[d1aoff[h2] + nn*amopi_[h2]+jj]; // - D1(n,j) dkl dim
+                    if ( j == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            dum += u_p[d1aoff[h2] + nn*amopi_[h2]+ii]; // D1(n,i) dkl djm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        dum -= u_p[g2aaoff[hni] + ni*2*gems_ab[hni] + kl];  // -G2(ni,kl) djm
+                    
                     }
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    dum += u_p[g2aaoff[hkl] + nj*2*gems_ab[hkl] + kl];  // G2(nj,kl) dim
+
+                    if ( i == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int jj = j - pitzer_offset[h2];
+                            dum -= u_p[d1aoff[h2] + nn*amopi_[h2]+jj]; // - D1(n,j) dkl dim
+                        }
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        dum += u_p[g2aaoff[hkl] + nj*2*gems_ab[hkl] + kl];  // G2(nj,kl) dim
                     
-                }
+                    }
 
 
-                A_p[offset + ijk*trip_aaa[h]+lmn] = dum;
+                    A_p[offset + ijk*trip_aaa[h]+lmn] = dum;
 
 
+                }
             }
         }
         offset += trip_aaa[h]*trip_aaa[h];
@@ -689,119 +697,121 @@ void v2RDMSolver::T1_constraints_Au(SharedVector A,SharedVector u){
     // T1bbb
     for (int h = 0; h < nirrep_; h++) {
 
-        #pragma omp parallel for schedule (static)
-        for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
+        if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+            #pragma omp parallel for schedule (static)
+            for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
 
-            int i = bas_aaa_sym[h][ijk][0];
-            int j = bas_aaa_sym[h][ijk][1];
-            int k = bas_aaa_sym[h][ijk][2];
+                int i = bas_aaa_sym[h][ijk][0];
+                int j = bas_aaa_sym[h][ijk][1];
+                int k = bas_aaa_sym[h][ijk][2];
 
-            for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
+                for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
 
-                int l = bas_aaa_sym[h][lmn][0];
-                int m = bas_aaa_sym[h][lmn][1];
-                int n = bas_aaa_sym[h][lmn][2];
+                    int l = bas_aaa_sym[h][lmn][0];
+                    int m = bas_aaa_sym[h][lmn][1];
+                    int n = bas_aaa_sym[h][lmn][2];
 
-                double dum = -u_p[t1bbboff[h] + ijk*trip_aaa[h]+lmn]; // - T1(ijk,lmn)
+                    double dum = -u_p[t1bbboff[h] + ijk*trip_aaa[h]+lmn]; // - T1(ijk,lmn)
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    dum += u_p[q2bboff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
-                }
-
-                if ( j == n ) {
-                    int hik = SymmetryPair(symmetry[i],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hik == hlm ) {
-                        int ik = ibas_aa_sym[hik][i][k];
-                        int lm = ibas_aa_sym[hik][l][m];
-                        dum -= u_p[q2bboff[hik] + ik*gems_aa[hik] + lm];  // -Q2(ik,lm) djn
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        dum += u_p[q2bboff[hij] + ij*gems_aa[hij] + lm];  // Q2(ij,lm) dkn
                     }
-                }
 
-                if ( i == n ) {
-                    int hjk = SymmetryPair(symmetry[j],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hjk == hlm ) {
-                        int jk = ibas_aa_sym[hjk][j][k];
-                        int lm = ibas_aa_sym[hjk][l][m];
-                        dum += u_p[q2bboff[hjk] + jk*gems_aa[hjk] + lm];  // Q2(jk,lm) din
+                    if ( j == n ) {
+                        int hik = SymmetryPair(symmetry[i],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hik == hlm ) {
+                            int ik = ibas_aa_sym[hik][i][k];
+                            int lm = ibas_aa_sym[hik][l][m];
+                            dum -= u_p[q2bboff[hik] + ik*gems_aa[hik] + lm];  // -Q2(ik,lm) djn
+                        }
                     }
-                }
-
 
-                if ( l == k ) {
-                    int hnm = SymmetryPair(symmetry[n],symmetry[m]);
-                    int hji = SymmetryPair(symmetry[j],symmetry[i]);
-                    if ( hji == hnm ) {
-                        int nm = ibas_aa_sym[hji][n][m];
-                        int ji = ibas_aa_sym[hji][j][i];
-                        dum += u_p[d2bboff[hji] + nm*gems_aa[hji] + ji];  // D2(nm,ji) dlk
+                    if ( i == n ) {
+                        int hjk = SymmetryPair(symmetry[j],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hjk == hlm ) {
+                            int jk = ibas_aa_sym[hjk][j][k];
+                            int lm = ibas_aa_sym[hjk][l][m];
+                            dum += u_p[q2bboff[hjk] + jk*gems_aa[hjk] + lm];  // Q2(jk,lm) din
+                        }
                     }
-                }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int nm = ibas_aa_sym[hki][n][m];
-                    int ki = ibas_aa_sym[hki][k][i];
-                    dum -= u_p[d2bboff[hki] + nm*gems_aa[hki] + ki];  // -D2(nm,ki) dlj
-                }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int nm = ibas_aa_sym[hkj][n][m];
-                    int kj = ibas_aa_sym[hkj][k][j];
-                    dum += u_p[d2bboff[hkj] + nm*gems_aa[hkj] + kj];  // D2(nm,kj) dli
-                }
+                    if ( l == k ) {
+                        int hnm = SymmetryPair(symmetry[n],symmetry[m]);
+                        int hji = SymmetryPair(symmetry[j],symmetry[i]);
+                        if ( hji == hnm ) {
+                            int nm = ibas_aa_sym[hji][n][m];
+                            int ji = ibas_aa_sym[hji][j][i];
+                            dum += u_p[d2bboff[hji] + nm*gems_aa[hji] + ji];  // D2(nm,ji) dlk
+                        }
+                    }
 
-                if ( k == m ) {
                     if ( j == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        dum -= u_p[d1boff[h2] + nn*amopi_[h2]+ii]; // - D1(n,i) djl dkm
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int nm = ibas_aa_sym[hki][n][m];
+                        int ki = ibas_aa_sym[hki][k][i];
+                        dum -= u_p[d2bboff[hki] + nm*gems_aa[hki] + ki];  // -D2(nm,ki) dlj
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int jl = ibas_ab_sym[hni][j][l];
-                    dum += u_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (jl+gems_ab[hni])];  // G2(ni,jl) dkm
-                    
-                }
 
-                if ( j == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        dum += u_p[d1boff[h2] + nn*amopi_[h2]+ii]; // D1(n,i) dkl djm
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int nm = ibas_aa_sym[hkj][n][m];
+                        int kj = ibas_aa_sym[hkj][k][j];
+                        dum += u_p[d2bboff[hkj] + nm*gems_aa[hkj] + kj];  // D2(nm,kj) dli
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    dum -= u_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (kl+gems_ab[hni])];  // -G2(ni,kl) djm
+
+                    if ( k == m ) {
+                        if ( j == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            dum -= u_p[d1boff[h2] + nn*amopi_[h2]+ii]; // - D1(n,i) djl dkm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int jl = ibas_ab_sym[hni][j][l];
+                        dum += u_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (jl+gems_ab[hni])];  // G2(ni,jl) dkm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int jj = j - pitzer_offset[h2];
-                        dum -= u_p[d1boff[h2] + nn*amopi_[h2]+jj]; // - D1(n,j) dkl dim
+                    if ( j == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            dum += u_p[d1boff[h2] + nn*amopi_[h2]+ii]; // D1(n,i) dkl djm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        dum -= u_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (kl+gems_ab[hni])];  // -G2(ni,kl) djm
+                    
                     }
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    dum += u_p[g2aaoff[hkl] + (nj+gems_ab[hkl])*2*gems_ab[hkl] + (kl+gems_ab[hkl])];  // G2(nj,kl) dim
+
+                    if ( i == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int jj = j - pitzer_offset[h2];
+                            dum -= u_p[d1boff[h2] + nn*amopi_[h2]+jj]; // - D1(n,j) dkl dim
+                        }
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        dum += u_p[g2aaoff[hkl] + (nj+gems_ab[hkl])*2*gems_ab[hkl] + (kl+gems_ab[hkl])];  // G2(nj,kl) dim
                     
-                }
+                    }
 
 
-                A_p[offset + ijk*trip_aaa[h]+lmn] = dum;
+                    A_p[offset + ijk*trip_aaa[h]+lmn] = dum;
 
 
+                }
             }
         }
         offset += trip_aaa[h]*trip_aaa[h];
@@ -811,65 +821,69 @@ void v2RDMSolver::T1_constraints_Au(SharedVector A,SharedVector u){
 }
 
 // T1 portion of A^T.y 
-void v2RDMSolver::T1_constraints_ATu(SharedVector A,SharedVector u){
+void v2RDMSolver::T1_constraints_ATu(SharedSolverVector A,SharedSolverVector u){
+
+    int offset = constraint_offset_[FAMILY_T1];
 
     double * A_p = A->pointer();
-    double * u_p = u->pointer();
+    double * u_p = RowPointer(u);
 
     // T1aab
     for (int h = 0; h < nirrep_; h++) {
 
-        for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
+        if ( RowsAreLocal(offset,trip_aab[h]*trip_aab[h]) ) {
+            for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
 
-            int i = bas_aab_sym[h][ijk][0];
-            int j = bas_aab_sym[h][ijk][1];
-            int k = bas_aab_sym[h][ijk][2];
+                int i = bas_aab_sym[h][ijk][0];
+                int j = bas_aab_sym[h][ijk][1];
+                int k = bas_aab_sym[h][ijk][2];
 
-            for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
+                for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
 
-                int l = bas_aab_sym[h][lmn][0];
-                int m = bas_aab_sym[h][lmn][1];
-                int n = bas_aab_sym[h][lmn][2];
+                    int l = bas_aab_sym[h][lmn][0];
+                    int m = bas_aab_sym[h][lmn][1];
+                    int n = bas_aab_sym[h][lmn][2];
 
-                double dum = u_p[offset + ijk*trip_aab[h]+lmn]; 
+                    double dum = u_p[offset + ijk*trip_aab[h]+lmn]; 
 
-                A_p[t1aaboff[h] + ijk*trip_aab[h]+lmn] -= dum; // - T1(ijk,lmn)
+                    A_p[t1aaboff[h] + ijk*trip_aab[h]+lmn] -= dum; // - T1(ijk,lmn)
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    A_p[q2aaoff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
-                }
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        A_p[q2aaoff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
+                    }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int nm = ibas_ab_sym[hki][m][n];
-                    int ki = ibas_ab_sym[hki][i][k];
-                    A_p[d2aboff[hki] + nm*gems_ab[hki] + ki] -= dum;  // -D2(nm,ki) dlj
-                }
+                    if ( j == l ) {
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int nm = ibas_ab_sym[hki][m][n];
+                        int ki = ibas_ab_sym[hki][i][k];
+                        A_p[d2aboff[hki] + nm*gems_ab[hki] + ki] -= dum;  // -D2(nm,ki) dlj
+                    }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int nm = ibas_ab_sym[hkj][m][n];
-                    int kj = ibas_ab_sym[hkj][j][k];
-                    A_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj] += dum;  // D2(nm,kj) dli
-                }
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int nm = ibas_ab_sym[hkj][m][n];
+                        int kj = ibas_ab_sym[hkj][j][k];
+                        A_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj] += dum;  // D2(nm,kj) dli
+                    }
 
-                if ( j == m ) {
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    A_p[g2baoff[hni] + ni*gems_ab[hni] + kl] -= dum;  // -G2(ni,kl) djm
+                    if ( j == m ) {
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        A_p[g2baoff[hni] + ni*gems_ab[hni] + kl] -= dum;  // -G2(ni,kl) djm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    A_p[g2baoff[hkl] + nj*gems_ab[hkl] + kl] += dum;  // G2(nj,kl) dim
+                    if ( i == m ) {
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        A_p[g2baoff[hkl] + nj*gems_ab[hkl] + kl] += dum;  // G2(nj,kl) dim
                     
+                    }
                 }
             }
         }
@@ -879,57 +893,59 @@ void v2RDMSolver::T1_constraints_ATu(SharedVector A,SharedVector u){
     // T1bba
     for (int h = 0; h < nirrep_; h++) {
 
-        for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
+        if ( RowsAreLocal(offset,trip_aab[h]*trip_aab[h]) ) {
+            for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
 
-            int i = bas_aab_sym[h][ijk][0];
-            int j = bas_aab_sym[h][ijk][1];
-            int k = bas_aab_sym[h][ijk][2];
+                int i = bas_aab_sym[h][ijk][0];
+                int j = bas_aab_sym[h][ijk][1];
+                int k = bas_aab_sym[h][ijk][2];
 
-            for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
+                for (int lmn = 0; lmn < trip_aab[h]; lmn++) {
 
-                int l = bas_aab_sym[h][lmn][0];
-                int m = bas_aab_sym[h][lmn][1];
-                int n = bas_aab_sym[h][lmn][2];
+                    int l = bas_aab_sym[h][lmn][0];
+                    int m = bas_aab_sym[h][lmn][1];
+                    int n = bas_aab_sym[h][lmn][2];
 
-                double dum = u_p[offset + ijk*trip_aab[h]+lmn]; 
+                    double dum = u_p[offset + ijk*trip_aab[h]+lmn]; 
 
-                A_p[t1bbaoff[h] + ijk*trip_aab[h]+lmn] -= dum; // - T1(ijk,lmn)
+                    A_p[t1bbaoff[h] + ijk*trip_aab[h]+lmn] -= dum; // - T1(ijk,lmn)
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    A_p[q2bboff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
-                }
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        A_p[q2bboff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
+                    }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int nm = ibas_ab_sym[hki][n][m];
-                    int ki = ibas_ab_sym[hki][k][i];
-                    A_p[d2aboff[hki] + nm*gems_ab[hki] + ki] -= dum;  // -D2(nm,ki) dlj
-                }
+                    if ( j == l ) {
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int nm = ibas_ab_sym[hki][n][m];
+                        int ki = ibas_ab_sym[hki][k][i];
+                        A_p[d2aboff[hki] + nm*gems_ab[hki] + ki] -= dum;  // -D2(nm,ki) dlj
+                    }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int nm = ibas_ab_sym[hkj][n][m];
-                    int kj = ibas_ab_sym[hkj][k][j];
-                    A_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj] += dum;  // D2(nm,kj) dli
-                }
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int nm = ibas_ab_sym[hkj][n][m];
+                        int kj = ibas_ab_sym[hkj][k][j];
+                        A_p[d2aboff[hkj] + nm*gems_ab[hkj] + kj] += dum;  // D2(nm,kj) dli
+                    }
 
-                if ( j == m ) {
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    A_p[g2aboff[hni] + ni*gems_ab[hni] + kl] -= dum;  // -G2(ni,kl) djm
+                    if ( j == m ) {
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        A_p[g2aboff[hni] + ni*gems_ab[hni] + kl] -= dum;  // -G2(ni,kl) djm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    A_p[g2aboff[hkl] + nj*gems_ab[hkl] + kl] += dum;  // G2(nj,kl) dim
+                    if ( i == m ) {
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        A_p[g2aboff[hkl] + nj*gems_ab[hkl] + kl] += dum;  // G2(nj,kl) dim
                     
+                    }
                 }
             }
         }
@@ -939,116 +955,118 @@ void v2RDMSolver::T1_constraints_ATu(SharedVector A,SharedVector u){
     // T1aaa
     for (int h = 0; h < nirrep_; h++) {
 
-        for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
-
-            int i = bas_aaa_sym[h][ijk][0];
-            int j = bas_aaa_sym[h][ijk][1];
-            int k = bas_aaa_sym[h][ijk][2];
+        if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+            for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
 
-            for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
+                int i = bas_aaa_sym[h][ijk][0];
+                int j = bas_aaa_sym[h][ijk][1];
+                int k = bas_aaa_sym[h][ijk][2];
 
-                int l = bas_aaa_sym[h][lmn][0];
-                int m = bas_aaa_sym[h][lmn][1];
-                int n = bas_aaa_sym[h][lmn][2];
+                for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
 
-                double dum = u_p[offset + ijk*trip_aaa[h] + lmn];
+                    int l = bas_aaa_sym[h][lmn][0];
+                    int m = bas_aaa_sym[h][lmn][1];
+                    int n = bas_aaa_sym[h][lmn][2];
 
-                A_p[t1aaaoff[h] + ijk*trip_aaa[h]+lmn] -= dum; // - T1(ijk,lmn)
+                    double dum = u_p[offset + ijk*trip_aaa[h] + lmn];
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    A_p[q2aaoff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
-                }
+                    A_p[t1aaaoff[h] + ijk*trip_aaa[h]+lmn] -= dum; // - T1(ijk,lmn)
 
-                if ( j == n ) {
-                    int hik = SymmetryPair(symmetry[i],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hik == hlm ) {
-                        int ik = ibas_aa_sym[hik][i][k];
-                        int lm = ibas_aa_sym[hik][l][m];
-                        A_p[q2aaoff[hik] + ik*gems_aa[hik] + lm] -= dum;  // -Q2(ik,lm) djn
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        A_p[q2aaoff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
                     }
-                }
 
-                if ( i == n ) {
-                    int hjk = SymmetryPair(symmetry[j],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hjk == hlm ) {
-                        int jk = ibas_aa_sym[hjk][j][k];
-                        int lm = ibas_aa_sym[hjk][l][m];
-                        A_p[q2aaoff[hjk] + jk*gems_aa[hjk] + lm] += dum;  // Q2(jk,lm) din
+                    if ( j == n ) {
+                        int hik = SymmetryPair(symmetry[i],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hik == hlm ) {
+                            int ik = ibas_aa_sym[hik][i][k];
+                            int lm = ibas_aa_sym[hik][l][m];
+                            A_p[q2aaoff[hik] + ik*gems_aa[hik] + lm] -= dum;  // -Q2(ik,lm) djn
+                        }
                     }
-                }
 
-
-                if ( l == k ) {
-                    int hji = SymmetryPair(symmetry[j],symmetry[i]);
-                    int hnm = SymmetryPair(symmetry[n],symmetry[m]);
-                    if ( hji == hnm ) {
-                        int ji = ibas_aa_sym[hji][j][i];
-                        int nm = ibas_aa_sym[hji][n][m];
-                        A_p[d2aaoff[hji] + nm*gems_aa[hji] + ji] += dum;  // D2(nm,ji) dlk
+                    if ( i == n ) {
+                        int hjk = SymmetryPair(symmetry[j],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hjk == hlm ) {
+                            int jk = ibas_aa_sym[hjk][j][k];
+                            int lm = ibas_aa_sym[hjk][l][m];
+                            A_p[q2aaoff[hjk] + jk*gems_aa[hjk] + lm] += dum;  // Q2(jk,lm) din
+                        }
                     }
-                }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int ki = ibas_aa_sym[hki][k][i];
-                    int nm = ibas_aa_sym[hki][n][m];
-                    A_p[d2aaoff[hki] + nm*gems_aa[hki] + ki] -= dum;  // -D2(nm,ki) dlj
-                }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int kj = ibas_aa_sym[hkj][k][j];
-                    int nm = ibas_aa_sym[hkj][n][m];
-                    A_p[d2aaoff[hkj] + nm*gems_aa[hkj] + kj] += dum;  // D2(nm,kj) dli
-                }
+                    if ( l == k ) {
+                        int hji = SymmetryPair(symmetry[j],symmetry[i]);
+                        int hnm = SymmetryPair(symmetry[n],symmetry[m]);
+                        if ( hji == hnm ) {
+                            int ji = ibas_aa_sym[hji][j][i];
+                            int nm = ibas_aa_sym[hji][n][m];
+                            A_p[d2aaoff[hji] + nm*gems_aa[hji] + ji] += dum;  // D2(nm,ji) dlk
+                        }
+                    }
 
-                if ( k == m ) {
                     if ( j == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        A_p[d1aoff[h2] + nn*amopi_[h2]+ii] -= dum; // - D1(n,i) djl dkm
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int ki = ibas_aa_sym[hki][k][i];
+                        int nm = ibas_aa_sym[hki][n][m];
+                        A_p[d2aaoff[hki] + nm*gems_aa[hki] + ki] -= dum;  // -D2(nm,ki) dlj
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int jl = ibas_ab_sym[hni][j][l];
-                    A_p[g2aaoff[hni] + ni*2*gems_ab[hni] + jl] += dum;  // G2(ni,jl) dkm
-                    
-                }
 
-                if ( j == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        A_p[d1aoff[h2] + nn*amopi_[h2]+ii] += dum; // D1(n,i) dkl djm
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int kj = ibas_aa_sym[hkj][k][j];
+                        int nm = ibas_aa_sym[hkj][n][m];
+                        A_p[d2aaoff[hkj] + nm*gems_aa[hkj] + kj] += dum;  // D2(nm,kj) dli
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    A_p[g2aaoff[hni] + ni*2*gems_ab[hni] + kl] -= dum;  // -G2(ni,kl) djm
+
+                    if ( k == m ) {
+                        if ( j == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            A_p[d1aoff[h2] + nn*amopi_[h2]+ii] -= dum; // - D1(n,i) djl dkm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int jl = ibas_ab_sym[hni][j][l];
+                        A_p[g2aaoff[hni] + ni*2*gems_ab[hni] + jl] += dum;  // G2(ni,jl) dkm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int jj = j - pitzer_offset[h2];
-                        A_p[d1aoff[h2] + nn*amopi_[h2]+jj] -= dum; // - D1(n,j) dkl dim
+                    if ( j == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            A_p[d1aoff[h2] + nn*amopi_[h2]+ii] += dum; // D1(n,i) dkl djm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        A_p[g2aaoff[hni] + ni*2*gems_ab[hni] + kl] -= dum;  // -G2(ni,kl) djm
+                    
                     }
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    A_p[g2aaoff[hkl] + nj*2*gems_ab[hkl] + kl] += dum;  // G2(nj,kl) dim
+
+                    if ( i == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int jj = j - pitzer_offset[h2];
+                            A_p[d1aoff[h2] + nn*amopi_[h2]+jj] -= dum; // - D1(n,j) dkl dim
+                        }
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        A_p[g2aaoff[hkl] + nj*2*gems_ab[hkl] + kl] += dum;  // G2(nj,kl) dim
                     
-                }
+                    }
 
+                }
             }
         }
         offset += trip_aaa[h]*trip_aaa[h];
@@ -1057,116 +1075,118 @@ void v2RDMSolver::T1_constraints_ATu(SharedVector A,SharedVector u){
     // T1bbb
     for (int h = 0; h < nirrep_; h++) {
 
-        for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
-
-            int i = bas_aaa_sym[h][ijk][0];
-            int j = bas_aaa_sym[h][ijk][1];
-            int k = bas_aaa_sym[h][ijk][2];
+        if ( RowsAreLocal(offset,trip_aaa[h]*trip_aaa[h]) ) {
+            for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
 
-            for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
+                int i = bas_aaa_sym[h][ijk][0];
+                int j = bas_aaa_sym[h][ijk][1];
+                int k = bas_aaa_sym[h][ijk][2];
 
-                int l = bas_aaa_sym[h][lmn][0];
-                int m = bas_aaa_sym[h][lmn][1];
-                int n = bas_aaa_sym[h][lmn][2];
+                for (int lmn = 0; lmn < trip_aaa[h]; lmn++) {
 
-                double dum = u_p[offset + ijk*trip_aaa[h] + lmn];
+                    int l = bas_aaa_sym[h][lmn][0];
+                    int m = bas_aaa_sym[h][lmn][1];
+                    int n = bas_aaa_sym[h][lmn][2];
 
-                A_p[t1bbboff[h] + ijk*trip_aaa[h]+lmn] -= dum; // - T1(ijk,lmn)
+                    double dum = u_p[offset + ijk*trip_aaa[h] + lmn];
 
-                if ( k == n ) {
-                    int hij = SymmetryPair(symmetry[i],symmetry[j]);
-                    int ij = ibas_aa_sym[hij][i][j];
-                    int lm = ibas_aa_sym[hij][l][m];
-                    A_p[q2bboff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
-                }
+                    A_p[t1bbboff[h] + ijk*trip_aaa[h]+lmn] -= dum; // - T1(ijk,lmn)
 
-                if ( j == n ) {
-                    int hik = SymmetryPair(symmetry[i],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hik == hlm ) {
-                        int ik = ibas_aa_sym[hik][i][k];
-                        int lm = ibas_aa_sym[hik][l][m];
-                        A_p[q2bboff[hik] + ik*gems_aa[hik] + lm] -= dum;  // -Q2(ik,lm) djn
+                    if ( k == n ) {
+                        int hij = SymmetryPair(symmetry[i],symmetry[j]);
+                        int ij = ibas_aa_sym[hij][i][j];
+                        int lm = ibas_aa_sym[hij][l][m];
+                        A_p[q2bboff[hij] + ij*gems_aa[hij] + lm] += dum;  // Q2(ij,lm) dkn
                     }
-                }
 
-                if ( i == n ) {
-                    int hjk = SymmetryPair(symmetry[j],symmetry[k]);
-                    int hlm = SymmetryPair(symmetry[l],symmetry[m]);
-                    if ( hjk == hlm ) {
-                        int jk = ibas_aa_sym[hjk][j][k];
-                        int lm = ibas_aa_sym[hjk][l][m];
-                        A_p[q2bboff[hjk] + jk*gems_aa[hjk] + lm] += dum;  // Q2(jk,lm) din
+                    if ( j == n ) {
+                        int hik = SymmetryPair(symmetry[i],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hik == hlm ) {
+                            int ik = ibas_aa_sym[hik][i][k];
+                            int lm = ibas_aa_sym[hik][l][m];
+                            A_p[q2bboff[hik] + ik*gems_aa[hik] + lm] -= dum;  // -Q2(ik,lm) djn
+                        }
                     }
-                }
 
-
-                if ( l == k ) {
-                    int hji = SymmetryPair(symmetry[j],symmetry[i]);
-                    int hnm = SymmetryPair(symmetry[n],symmetry[m]);
-                    if ( hji == hnm ) {
-                        int ji = ibas_aa_sym[hji][j][i];
-                        int nm = ibas_aa_sym[hji][n][m];
-                        A_p[d2bboff[hji] + nm*gems_aa[hji] + ji] += dum;  // D2(nm,ji) dlk
+                    if ( i == n ) {
+                        int hjk = SymmetryPair(symmetry[j],symmetry[k]);
+                        int hlm = SymmetryPair(symmetry[l],symmetry[m]);
+                        if ( hjk == hlm ) {
+                            int jk = ibas_aa_sym[hjk][j][k];
+                            int lm = ibas_aa_sym[hjk][l][m];
+                            A_p[q2bboff[hjk] + jk*gems_aa[hjk] + lm] += dum;  // Q2(jk,lm) din
+                        }
                     }
-                }
 
-                if ( j == l ) {
-                    int hki = SymmetryPair(symmetry[k],symmetry[i]);
-                    int ki = ibas_aa_sym[hki][k][i];
-                    int nm = ibas_aa_sym[hki][n][m];
-                    A_p[d2bboff[hki] + nm*gems_aa[hki] + ki] -= dum;  // -D2(nm,ki) dlj
-                }
 
-                if ( l == i ) {
-                    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
-                    int kj = ibas_aa_sym[hkj][k][j];
-                    int nm = ibas_aa_sym[hkj][n][m];
-                    A_p[d2bboff[hkj] + nm*gems_aa[hkj] + kj] += dum;  // D2(nm,kj) dli
-                }
+                    if ( l == k ) {
+                        int hji = SymmetryPair(symmetry[j],symmetry[i]);
+                        int hnm = SymmetryPair(symmetry[n],symmetry[m]);
+                        if ( hji == hnm ) {
+                            int ji = ibas_aa_sym[hji][j][i];
+                            int nm = ibas_aa_sym[hji][n][m];
+                            A_p[d2bboff[hji] + nm*gems_aa[hji] + ji] += dum;  // D2(nm,ji) dlk
+                        }
+                    }
 
-                if ( k == m ) {
                     if ( j == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        A_p[d1boff[h2] + nn*amopi_[h2]+ii] -= dum; // - D1(n,i) djl dkm
+                        int hki = SymmetryPair(symmetry[k],symmetry[i]);
+                        int ki = ibas_aa_sym[hki][k][i];
+                        int nm = ibas_aa_sym[hki][n][m];
+                        A_p[d2bboff[hki] + nm*gems_aa[hki] + ki] -= dum;  // -D2(nm,ki) dlj
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int jl = ibas_ab_sym[hni][j][l];
-                    A_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (jl+gems_ab[hni])] += dum;  // G2(ni,jl) dkm
-                    
-                }
 
-                if ( j == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int ii = i - pitzer_offset[h2];
-                        A_p[d1boff[h2] + nn*amopi_[h2]+ii] += dum; // D1(n,i) dkl djm
+                    if ( l == i ) {
+                        int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+                        int kj = ibas_aa_sym[hkj][k][j];
+                        int nm = ibas_aa_sym[hkj][n][m];
+                        A_p[d2bboff[hkj] + nm*gems_aa[hkj] + kj] += dum;  // D2(nm,kj) dli
                     }
-                    int hni = SymmetryPair(symmetry[n],symmetry[i]);
-                    int ni = ibas_ab_sym[hni][n][i];
-                    int kl = ibas_ab_sym[hni][k][l];
-                    A_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (kl+gems_ab[hni])] -= dum;  // -G2(ni,kl) djm
+
+                    if ( k == m ) {
+                        if ( j == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            A_p[d1boff[h2] + nn*amopi_[h2]+ii] -= dum; // - D1(n,i) djl dkm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int jl = ibas_ab_sym[hni][j][l];
+                        A_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (jl+gems_ab[hni])] += dum;  // G2(ni,jl) dkm
                     
-                }
+                    }
 
-                if ( i == m ) {
-                    if ( k == l ) {
-                        int h2 = symmetry[n];
-                        int nn = n - pitzer_offset[h2];
-                        int jj = j - pitzer_offset[h2];
-                        A_p[d1boff[h2] + nn*amopi_[h2]+jj] -= dum; // - D1(n,j) dkl dim
+                    if ( j == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int ii = i - pitzer_offset[h2];
+                            A_p[d1boff[h2] + nn*amopi_[h2]+ii] += dum; // D1(n,i) dkl djm
+                        }
+                        int hni = SymmetryPair(symmetry[n],symmetry[i]);
+                        int ni = ibas_ab_sym[hni][n][i];
+                        int kl = ibas_ab_sym[hni][k][l];
+                        A_p[g2aaoff[hni] + (ni+gems_ab[hni])*2*gems_ab[hni] + (kl+gems_ab[hni])] -= dum;  // -G2(ni,kl) djm
+                    
                     }
-                    int hkl = SymmetryPair(symmetry[k],symmetry[l]);
-                    int nj = ibas_ab_sym[hkl][n][j];
-                    int kl = ibas_ab_sym[hkl][k][l];
-                    A_p[g2aaoff[hkl] + (nj+gems_ab[hkl])*2*gems_ab[hkl] + (kl+gems_ab[hkl])] += dum;  // G2(nj,kl) dim
+
+                    if ( i == m ) {
+                        if ( k == l ) {
+                            int h2 = symmetry[n];
+                            int nn = n - pitzer_offset[h2];
+                            int jj = j - pitzer_offset[h2];
+                            A_p[d1boff[h2] + nn*amopi_[h2]+jj] -= dum; // - D1(n,j) dkl dim
+                        }
+                        int hkl = SymmetryPair(symmetry[k],symmetry[l]);
+                        int nj = ibas_ab_sym[hkl][n][j];
+                        int kl = ibas_ab_sym[hkl][k][l];
+                        A_p[g2aaoff[hkl] + (nj+gems_ab[hkl])*2*gems_ab[hkl] + (kl+gems_ab[hkl])] += dum;  // G2(nj,kl) dim
                     
-                }
+                    }
 
+                }
             }
         }
         offset += trip_aaa[h]*trip_aaa[h];
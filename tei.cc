@@ -78,15 +78,66 @@ void v2RDMSolver::GetIntegrals() {
             tei_full_dim_ += (long int)gems_full[h] * ( (long int)gems_full[h] + 1L ) / 2L;
         }
 
-        tei_full_sym_ = (double*)malloc(tei_full_dim_*sizeof(double));
-        memset((void*)tei_full_sym_,'\0',tei_full_dim_*sizeof(double));
+        // share the integrals of another state over the same orbitals if
+        // that state has already read them
+        if ( integral_donor_ && integral_donor_->tei_full_sym_ != NULL ) {
+            tei_buffer_   = integral_donor_->SharedIntegrals();
+            tei_full_sym_ = tei_buffer_.get();
+        }else {
+            tei_full_sym_ = (double*)malloc(tei_full_dim_*sizeof(double));
+            memset((void*)tei_full_sym_,'\0',tei_full_dim_*sizeof(double));
+        }
+
+    }
 
+    // active-space geminals (p >= q) in the order used by the orbital
+    // optimizer, grouped by irrep.  these maps drive the block-by-block
+    // packing of the density in PackDensityForOrbOpt / UnpackDensityPlusCore
+    active_gems_     = (int*)malloc(nirrep_*sizeof(int));
+    active_gem_bas_  = (int**)malloc(nirrep_*sizeof(int*));
+    orbopt_den_gem_  = (int*)malloc(amo_*amo_*sizeof(int));
+    orbopt_den_off_  = (long int*)malloc(nirrep_*sizeof(long int));
+    memset((void*)active_gems_,'\0',nirrep_*sizeof(int));
+    for (int h = 0; h < nirrep_; h++) {
+        active_gem_bas_[h] = (int*)malloc(amo_*(amo_+1)*sizeof(int));
+    }
+    for (int p = 0; p < amo_; p++) {
+        for (int q = 0; q <= p; q++) {
+            int hpq = SymmetryPair(symmetry[p],symmetry[q]);
+            orbopt_den_gem_[p*amo_+q] = active_gems_[hpq];
+            orbopt_den_gem_[q*amo_+p] = active_gems_[hpq];
+            active_gem_bas_[hpq][2*active_gems_[hpq]]   = p;
+            active_gem_bas_[hpq][2*active_gems_[hpq]+1] = q;
+            active_gems_[hpq]++;
+        }
+    }
+    long int orbopt_d2_dim = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        orbopt_den_off_[h] = orbopt_d2_dim;
+        orbopt_d2_dim += (long int)active_gems_[h] * ( (long int)active_gems_[h] + 1L ) / 2L;
     }
 
-    // size of d2, blocked by symmetry, including the core orbitals
-    d2_plus_core_dim_ = 0;
+    // the same geminals in the full (core plus active) layout
+    active_plus_core_gem_ = (int*)malloc(amo_*amo_*sizeof(int));
+    for (int p = 0; p < amo_; p++) {
+        for (int q = 0; q < amo_; q++) {
+            int hpq = SymmetryPair(symmetry[p],symmetry[q]);
+            active_plus_core_gem_[p*amo_+q] = ibas_full_sym[hpq][full_basis[p]][full_basis[q]];
+        }
+    }
+    d2_plus_core_off_ = (long int*)malloc(nirrep_*sizeof(long int));
+    long int plus_core_d2_dim = 0;
     for (int h = 0; h < nirrep_; h++) {
-        d2_plus_core_dim_ += (long int)gems_plus_core[h] * ( (long int)gems_plus_core[h] + 1L ) / 2L;
+        d2_plus_core_off_[h] = plus_core_d2_dim;
+        plus_core_d2_dim += (long int)gems_plus_core[h] * ( (long int)gems_plus_core[h] + 1L ) / 2L;
+    }
+
+    // size of d2, blocked by symmetry, including the core orbitals.  if
+    // the density is handed to the orbital optimizer in its own layout,
+    // only the active-space part is needed
+    d2_plus_core_dim_ = plus_core_d2_dim;
+    if ( options_.get_bool("ORBOPT_DIRECT_DENSITY") ) {
+        d2_plus_core_dim_ = orbopt_d2_dim;
     }
 
     d2_plus_core_sym_  = (double*)malloc(d2_plus_core_dim_*sizeof(double));
@@ -100,8 +151,12 @@ void v2RDMSolver::GetIntegrals() {
 
     // allocate memory for d1 tensor, blocked by symmetry, including the core orbitals
     d1_plus_core_dim_ = 0;
-    for ( int h = 0; h < nirrep_; h++) {
-        d1_plus_core_dim_ += (rstcpi_[h] + frzcpi_[h] + amopi_[h]) * ( rstcpi_[h] + frzcpi_[h] + amopi_[h] + 1 ) / 2;
+    if ( options_.get_bool("ORBOPT_DIRECT_DENSITY") ) {
+        d1_plus_core_dim_ = active_gems_[0];
+    }else {
+        for ( int h = 0; h < nirrep_; h++) {
+            d1_plus_core_dim_ += (rstcpi_[h] + frzcpi_[h] + amopi_[h]) * ( rstcpi_[h] + frzcpi_[h] + amopi_[h] + 1 ) / 2;
+        }
     }
 
     oei_full_sym_ = (double*)malloc(oei_full_dim_*sizeof(double));
@@ -120,7 +175,7 @@ void v2RDMSolver::GetIntegrals() {
         offset += ( nmopi_[h] - frzvpi_[h] ) * ( nmopi_[h] - frzvpi_[h] + 1 ) / 2;
     }
 
-    if ( !is_df_ ) {
+    if ( !is_df_ && !tei_buffer_ ) {
         // read tei's from disk
         GetTEIFromDisk();
     }
@@ -130,6 +185,19 @@ void v2RDMSolver::GetIntegrals() {
 
 void v2RDMSolver::GetTEIFromDisk() {
 
+    // (pq|rs) were read with the FCIDUMP file
+    if ( fcidump_ ) {
+        GetFCIDUMPTEI();
+        return;
+    }
+
+    // no room for the dense nmo^4 buffer (see PlanMemory):  place each
+    // integral directly into tei_full_sym_ as it is read
+    if ( !tei_sort_incore_ ) {
+        ReadIntegralsDirect();
+        return;
+    }
+
     double * temptei = (double*)malloc((long int)nmo_*(long int)nmo_*(long int)nmo_*(long int)nmo_*sizeof(double));
     memset((void*)temptei,'\0',(long int)nmo_*(long int)nmo_*(long int)nmo_*(long int)nmo_*sizeof(double));
 
@@ -212,12 +280,25 @@ void v2RDMSolver::RepackIntegrals(){
                 double dum1 = TEI(ii,kk,jj,ll,hik);
                 double dum2 = TEI(ii,ll,jj,kk,hil);
 
-                c_p[d2aaoff[h] + ij*gems_aa[h]+kl]    = dum1 - dum2;
-                c_p[d2bboff[h] + ij*gems_aa[h]+kl]    = dum1 - dum2;
+                if ( alias_beta_blocks_ ) {
+                    // D2bb is D2aa
+                    c_p[d2aaoff[h] + ij*gems_aa[h]+kl] = 2.0 * ( dum1 - dum2 );
+                }else {
+                    c_p[d2aaoff[h] + ij*gems_aa[h]+kl] = dum1 - dum2;
+                    c_p[d2bboff[h] + ij*gems_aa[h]+kl] = dum1 - dum2;
+                }
             }
         }
     }
 
+    // D2s and D2t of c from D2ab and D2aa
+    if ( spin_adapt_d2_ ) {
+        PackSpinAdaptedD2(c);
+    }
+
+    // anything built from c is stale
+    c_stamp_++;
+
 }
 void v2RDMSolver::FrozenCoreEnergy() {
 
@@ -283,10 +364,15 @@ void v2RDMSolver::FrozenCoreEnergy() {
                     }
                     offset2 += nmopi_[h2] - frzvpi_[h2];
                 }
-                c_p[d1aoff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] = oei_full_sym_[offset3+INDEX(i,j)];
-                c_p[d1boff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] = oei_full_sym_[offset3+INDEX(i,j)];
-                c_p[d1aoff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] += dum;
-                c_p[d1boff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] += dum;
+                if ( alias_beta_blocks_ ) {
+                    // D1b is D1a
+                    c_p[d1aoff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] = 2.0 * ( oei_full_sym_[offset3+INDEX(i,j)] + dum );
+                }else {
+                    c_p[d1aoff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] = oei_full_sym_[offset3+INDEX(i,j)];
+                    c_p[d1boff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] = oei_full_sym_[offset3+INDEX(i,j)];
+                    c_p[d1aoff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] += dum;
+                    c_p[d1boff[h] + (i-rstcpi_[h]-frzcpi_[h])*amopi_[h] + (j-rstcpi_[h]-frzcpi_[h])] += dum;
+                }
             }
         }
         offset += nmopi_[h] - frzvpi_[h];
@@ -0,0 +1,283 @@
+#
+#@BEGIN LICENSE
+#
+# v2rdm_casscf by Psi4 Developer, a plugin to:
+#
+# PSI4: an ab initio quantum chemistry software package
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+#@END LICENSE
+#
+
+"""
+Model hamiltonians for benchmarking v2rdm_casscf without an SCF.
+
+Each model returns a Hamiltonian: the core energy, h(pq), and (pq|rs) over
+orthonormal orbitals, plus the irrep of each orbital.  write_fcidump()
+writes it in the format read by the FCIDUMP_FILE option.
+
+    hubbard   Hubbard chain/ring (or nx x ny lattice), hopping t, on-site U
+    ppp       Pariser-Parr-Pople polyene with Ohno interactions
+    hchain    linear hydrogen chain, one s gaussian per atom, Lowdin orbitals
+
+symmetry='mirror' rotates the orbitals into combinations that are even or
+odd under the reflection that maps site i onto site n-1-i (two irreps);
+symmetry='none' keeps a single irrep.
+"""
+
+from __future__ import print_function
+
+import math
+import numpy as np
+
+# PPP parameters for carbon pi systems (eV, angstrom)
+EV_TO_HARTREE = 1.0 / 27.211386
+PPP_T         = -2.4
+PPP_U         = 11.13
+OHNO_E2       = 14.397
+
+class Hamiltonian(object):
+
+    def __init__(self, name, ecore, h, eri, nelec, orbsym=None):
+        self.name   = name
+        self.ecore  = ecore
+        self.h      = h
+        self.eri    = eri
+        self.nelec  = nelec
+        self.norb   = h.shape[0]
+        self.orbsym = orbsym if orbsym is not None else [0] * self.norb
+
+    def nirrep(self):
+        return max(self.orbsym) + 1
+
+    def orbitals_per_irrep(self):
+        return [self.orbsym.count(h) for h in range(self.nirrep())]
+
+    def ms2(self):
+        return self.nelec % 2
+
+    def occupations(self):
+        """ doubly and singly occupied orbitals per irrep: the lowest
+            eigenvalues of h in each irrep, filled across irreps (aufbau on
+            h alone) """
+        levels = []
+        for irrep in range(self.nirrep()):
+            idx = [p for p in range(self.norb) if self.orbsym[p] == irrep]
+            eps = np.linalg.eigvalsh(self.h[np.ix_(idx, idx)])
+            levels += [(e, irrep) for e in eps]
+        levels.sort()
+        docc = [0] * self.nirrep()
+        socc = [0] * self.nirrep()
+        for e, irrep in levels[:self.nelec // 2]:
+            docc[irrep] += 1
+        if self.nelec % 2 == 1:
+            socc[levels[self.nelec // 2][1]] += 1
+        return docc, socc
+
+def lattice_bonds(nx, ny, periodic):
+    """ nearest-neighbor pairs of an nx x ny lattice, sites numbered row by row """
+    bonds = set()
+    for y in range(ny):
+        for x in range(nx):
+            i = y * nx + x
+            if x + 1 < nx:
+                bonds.add((i, i + 1))
+            elif periodic and nx > 2:
+                bonds.add((y * nx, i))
+            if y + 1 < ny:
+                bonds.add((i, i + nx))
+            elif periodic and ny > 2:
+                bonds.add((x, i))
+    return sorted(bonds)
+
+def hubbard(nx, ny=1, t=1.0, U=4.0, periodic=False, nelec=None):
+    """ Hubbard model at half filling unless nelec is given """
+    n   = nx * ny
+    h   = np.zeros((n, n))
+    eri = np.zeros((n, n, n, n))
+    for i, j in lattice_bonds(nx, ny, periodic):
+        h[i, j] = h[j, i] = -t
+    for i in range(n):
+        eri[i, i, i, i] = U
+    name = 'hubbard-%ix%i' % (nx, ny) if ny > 1 else 'hubbard-%i' % nx
+    return Hamiltonian(name, 0.0, h, eri, n if nelec is None else nelec)
+
+def ppp(n, bond=1.40, alternation=0.0, t=PPP_T, U=PPP_U, periodic=False):
+    """ PPP model of a linear polyene (or a ring) with one pi electron per
+        carbon.  alternation lengthens every other bond by this much (angstrom)
+        and scales the hopping by bond/length. """
+    if periodic:
+        angle = [2.0 * math.pi * i / n for i in range(n)]
+        radius = bond / (2.0 * math.sin(math.pi / n))
+        xyz = [(radius * math.cos(a), radius * math.sin(a)) for a in angle]
+    else:
+        xyz = [(0.0, 0.0)]
+        for i in range(1, n):
+            length = bond + ( alternation if i % 2 == 0 else 0.0 )
+            xyz.append((xyz[-1][0] + length, 0.0))
+
+    # Ohno interaction between sites, in eV
+    V = np.zeros((n, n))
+    for i in range(n):
+        for j in range(n):
+            r = math.hypot(xyz[i][0] - xyz[j][0], xyz[i][1] - xyz[j][1])
+            V[i, j] = U / math.sqrt(1.0 + (U * r / OHNO_E2)**2)
+
+    h   = np.zeros((n, n))
+    eri = np.zeros((n, n, n, n))
+    for i, j in lattice_bonds(n, 1, periodic):
+        r = math.hypot(xyz[i][0] - xyz[j][0], xyz[i][1] - xyz[j][1])
+        h[i, j] = h[j, i] = t * bond / r
+    for i in range(n):
+        # each site sees the cores (charge +1) of all other sites
+        h[i, i] = -sum(V[i, j] for j in range(n) if j != i)
+        for j in range(n):
+            eri[i, i, j, j] = V[i, j]
+    ecore = 0.5 * sum(V[i, j] for i in range(n) for j in range(n) if j != i)
+
+    return Hamiltonian('ppp-%i' % n, ecore * EV_TO_HARTREE, h * EV_TO_HARTREE,
+                       eri * EV_TO_HARTREE, n)
+
+def boys0(t):
+    if t < 1e-12:
+        return 1.0 - t / 3.0
+    return 0.5 * math.sqrt(math.pi / t) * math.erf(math.sqrt(t))
+
+def hchain(n, spacing=1.8, alpha=0.4166):
+    """ n hydrogen atoms spaced by spacing (bohr), each carrying one
+        normalized s gaussian with exponent alpha """
+    z    = [i * spacing for i in range(n)]
+    norm = (2.0 * alpha / math.pi)**0.75
+
+    S = np.zeros((n, n))
+    T = np.zeros((n, n))
+    V = np.zeros((n, n))
+    p = 2.0 * alpha
+    mu = alpha * alpha / p
+    for a in range(n):
+        for b in range(n):
+            r2  = (z[a] - z[b])**2
+            P   = 0.5 * (z[a] + z[b])
+            Kab = norm * norm * math.exp(-mu * r2)
+            S[a, b] = Kab * (math.pi / p)**1.5
+            T[a, b] = mu * (3.0 - 2.0 * mu * r2) * S[a, b]
+            V[a, b] = -sum(2.0 * math.pi / p * Kab * boys0(p * (P - zc)**2) for zc in z)
+
+    # (ab|cd) over primitive s functions
+    K = np.zeros((n, n))
+    P = np.zeros((n, n))
+    for a in range(n):
+        for b in range(n):
+            K[a, b] = norm * norm * math.exp(-mu * (z[a] - z[b])**2)
+            P[a, b] = 0.5 * (z[a] + z[b])
+    pref = 2.0 * math.pi**2.5 / (p * p * math.sqrt(2.0 * p))
+    eri = np.zeros((n, n, n, n))
+    for a in range(n):
+        for b in range(a + 1):
+            for c in range(n):
+                for d in range(c + 1):
+                    val = pref * K[a, b] * K[c, d] * boys0(0.5 * p * (P[a, b] - P[c, d])**2)
+                    eri[a, b, c, d] = eri[b, a, c, d] = eri[a, b, d, c] = eri[b, a, d, c] = val
+
+    # symmetric (Lowdin) orthogonalization keeps the mirror symmetry of the sites
+    s, U = np.linalg.eigh(S)
+    X = np.dot(U * s**-0.5, U.T)
+    h, eri = transform(T + V, eri, X)
+
+    ecore = sum(1.0 / abs(z[i] - z[j]) for i in range(n) for j in range(i))
+    return Hamiltonian('hchain-%i' % n, ecore, h, eri, n)
+
+def transform(h, eri, C):
+    """ h and (pq|rs) in the orbitals given by the columns of C """
+    h   = np.dot(C.T, np.dot(h, C))
+    eri = np.tensordot(eri, C, axes=([0], [0]))
+    eri = np.tensordot(eri, C, axes=([0], [0]))
+    eri = np.tensordot(eri, C, axes=([0], [0]))
+    eri = np.tensordot(eri, C, axes=([0], [0]))
+    return h, eri
+
+def mirror_adapt(ham):
+    """ even and odd combinations of sites i and n-1-i.  valid for models
+        whose sites are numbered along a mirror-symmetric chain """
+    n = ham.norb
+    C = np.zeros((n, n))
+    orbsym = []
+    col = 0
+    for i in range(n // 2):
+        C[i, col] = C[n - 1 - i, col] = math.sqrt(0.5)
+        orbsym.append(0)
+        col += 1
+    if n % 2 == 1:
+        C[n // 2, col] = 1.0
+        orbsym.append(0)
+        col += 1
+    for i in range(n // 2):
+        C[i, col] = math.sqrt(0.5)
+        C[n - 1 - i, col] = -math.sqrt(0.5)
+        orbsym.append(1)
+        col += 1
+    h, eri = transform(ham.h, ham.eri, C)
+
+    # integrals that couple the irreps mean the model is not mirror symmetric
+    sym   = np.array(orbsym)
+    mixed = sym[:, None] != sym[None, :]
+    odd   = (sym[:, None, None, None] ^ sym[None, :, None, None] ^ sym[None, None, :, None] ^ sym[None, None, None, :]) != 0
+    if np.abs(h * mixed).max() > 1e-10 or np.abs(eri * odd).max() > 1e-10:
+        raise ValueError('%s is not mirror symmetric' % ham.name)
+
+    return Hamiltonian(ham.name, ham.ecore, h, eri, ham.nelec, orbsym)
+
+def build(model, size, symmetry='none', **params):
+    """ size is the number of sites (or 'NXxNY' for a 2d hubbard lattice) """
+    if model == 'hubbard':
+        dims = [int(d) for d in str(size).lower().split('x')]
+        ham = hubbard(dims[0], dims[1] if len(dims) > 1 else 1, **params)
+    elif model == 'ppp':
+        ham = ppp(int(size), **params)
+    elif model == 'hchain':
+        ham = hchain(int(size), **params)
+    else:
+        raise ValueError('unknown model: %s' % model)
+
+    if symmetry == 'mirror':
+        ham = mirror_adapt(ham)
+    elif symmetry != 'none':
+        raise ValueError('unknown symmetry: %s' % symmetry)
+    return ham
+
+def write_fcidump(ham, filename, tol=1e-12):
+    """ unique h(pq) and (pq|rs) above tol, 1-based indices """
+    n = ham.norb
+    with open(filename, 'w') as f:
+        f.write(' &FCI NORB=%i,NELEC=%i,MS2=%i,\n' % (n, ham.nelec, ham.ms2()))
+        f.write('  ORBSYM=%s,\n' % ','.join(str(s + 1) for s in ham.orbsym))
+        f.write('  ISYM=1,\n')
+        f.write(' &END\n')
+        for p in range(n):
+            for q in range(p + 1):
+                pq = p * (p + 1) // 2 + q
+                for r in range(n):
+                    for s in range(r + 1):
+                        if r * (r + 1) // 2 + s > pq:
+                            break
+                        val = ham.eri[p, q, r, s]
+                        if abs(val) > tol:
+                            f.write('%23.16E %4i %4i %4i %4i\n' % (val, p + 1, q + 1, r + 1, s + 1))
+        for p in range(n):
+            for q in range(p + 1):
+                if abs(ham.h[p, q]) > tol:
+                    f.write('%23.16E %4i %4i %4i %4i\n' % (ham.h[p, q], p + 1, q + 1, 0, 0))
+        f.write('%23.16E %4i %4i %4i %4i\n' % (ham.ecore, 0, 0, 0, 0))
@@ -0,0 +1,252 @@
+#
+#@BEGIN LICENSE
+#
+# v2rdm_casscf by Psi4 Developer, a plugin to:
+#
+# PSI4: an ab initio quantum chemistry software package
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+#@END LICENSE
+#
+
+"""
+End-to-end scaling benchmarks for v2rdm_casscf on model hamiltonians.
+
+For each model size, an FCIDUMP file is generated (see models.py) and the
+full BPSDP loop is run once per thread count, with psi4 in its own working
+directory.  One JSON record per run is appended to the output file:
+iterations, wall time per phase, planned and peak memory, the maximum
+resident set size of psi4, and the speedup over the smallest thread count.
+
+    python run_benchmarks.py --model hubbard --sizes 8 12 16 --threads 1 2 4
+    python run_benchmarks.py --model ppp --sizes 10 14 --symmetry mirror \\
+        --positivity dqgt2 --output ppp.jsonl
+
+The orbitals of a model hamiltonian are fixed, and all of them are active.
+"""
+
+from __future__ import print_function
+
+import argparse
+import datetime
+import json
+import os
+import re
+import socket
+import subprocess
+import sys
+import time
+
+import models
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+PLUGIN_ROOT = os.path.dirname(os.path.dirname(HERE))
+
+INPUT = """sys.path.insert(0, '{plugin_path}')
+import v2rdm_casscf
+
+# the hamiltonian comes from the FCIDUMP file.  psi4 needs an active
+# molecule, but it is not used.
+molecule placeholder {{
+He
+}}
+
+set {{
+  docc [ {docc} ]
+  socc [ {socc} ]
+}}
+set v2rdm_casscf {{
+  fcidump_file              {fcidump}
+  positivity                {positivity}
+  optimize_orbitals         false
+  semicanonicalize_orbitals false
+  r_convergence             {convergence}
+  e_convergence             {convergence}
+  maxiter                   {maxiter}
+}}
+
+energy('v2rdm-casscf')
+
+open('energy.dat', 'w').write('%20.12f\\n' % get_variable('CURRENT ENERGY'))
+"""
+
+# "label:   value [unit]" lines of the solver summaries (see FinalizeBPSDP)
+SUMMARY_LINE = re.compile(r'^\s+([A-Za-z][A-Za-z0-9 ./()^+,-]*?):\s+(-?[0-9.]+)\s*(s|MB|mb)?\s*$')
+
+SECTIONS = {
+    'Iteration count' : 'iterations',
+    'Wall time'       : 'time_s',
+    'Solver workspace': 'workspace',
+}
+
+def key(label):
+    return re.sub(r'[^a-z0-9]+', '_', label.lower()).strip('_')
+
+def parse_output(filename):
+    """ iteration counts, phase times, and memory from a psi4 output file """
+    result  = {'iterations': {}, 'time_s': {}, 'workspace': {}, 'memory_mb': {}}
+    section = None
+    with open(filename) as f:
+        for line in f:
+            header = re.match(r'^\s*==> (.*) <==', line)
+            if header:
+                section = SECTIONS.get(header.group(1).strip())
+                continue
+            match = SUMMARY_LINE.match(line)
+            if not match:
+                continue
+            label, value, unit = match.groups()
+            if section == 'iterations':
+                result[section][key(label)] = int(float(value))
+            elif section is not None:
+                result[section][key(label)] = float(value)
+            elif label.strip().startswith('Peak,') or label.strip() == 'Total memory requirements':
+                result['memory_mb'][key(label)] = float(value)
+            elif label.strip() in ('Total number of variables', 'Total number of constraints'):
+                result[key(label)] = int(float(value))
+    return result
+
+def git_revision():
+    try:
+        out = subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], cwd=PLUGIN_ROOT)
+        return out.decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+def run_psi4(psi4, workdir, nthreads):
+    """ run psi4 in workdir.  returns wall time, exit status, and max rss (MB) """
+    start = time.time()
+    with open(os.path.join(workdir, 'psi4.log'), 'w') as log:
+        proc = subprocess.Popen([psi4, '-n', str(nthreads), 'input.dat', 'output.dat'],
+                                cwd=workdir, stdout=log, stderr=subprocess.STDOUT)
+        # wait4 gives the resource usage of this child alone
+        pid, status, usage = os.wait4(proc.pid, 0)
+        status = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+        proc.returncode = status
+    wall = time.time() - start
+    # ru_maxrss is in kB on linux and bytes on macOS
+    scale = 1.0 / 1024.0 / 1024.0 if sys.platform == 'darwin' else 1.0 / 1024.0
+    return wall, status, usage.ru_maxrss * scale
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--model', choices=['hubbard', 'ppp', 'hchain'], default='hubbard')
+    parser.add_argument('--sizes', nargs='+', default=['8'],
+                        help='number of sites, or NXxNY for a 2d hubbard lattice')
+    parser.add_argument('--symmetry', choices=['none', 'mirror'], default='none')
+    parser.add_argument('--periodic', action='store_true', help='ring or torus (hubbard, ppp)')
+    parser.add_argument('--U', type=float, default=None, help='on-site repulsion (hubbard: units of t; ppp: eV)')
+    parser.add_argument('--spacing', type=float, default=None, help='H-H distance, bohr (hchain)')
+    parser.add_argument('--threads', type=int, nargs='+', default=[1])
+    parser.add_argument('--positivity', default='dqg')
+    parser.add_argument('--convergence', type=float, default=1e-4)
+    parser.add_argument('--maxiter', type=int, default=100000)
+    parser.add_argument('--psi4', default='psi4', help='psi4 executable')
+    parser.add_argument('--workdir', default='benchmark-runs')
+    parser.add_argument('--output', default='benchmarks.jsonl', help='JSON lines file (appended)')
+    args = parser.parse_args()
+
+    params = {}
+    if args.periodic:
+        if args.model == 'hchain':
+            parser.error('--periodic is not available for hchain')
+        params['periodic'] = True
+    if args.U is not None:
+        if args.model == 'hchain':
+            parser.error('--U is not available for hchain')
+        params['U'] = args.U
+    if args.spacing is not None:
+        if args.model != 'hchain':
+            parser.error('--spacing is only available for hchain')
+        params['spacing'] = args.spacing
+
+    revision = git_revision()
+    threads  = sorted(set(args.threads))
+
+    for size in args.sizes:
+        ham = models.build(args.model, size, args.symmetry, **params)
+        docc, socc = ham.occupations()
+
+        case = '%s-%s-%s' % (ham.name, args.symmetry, args.positivity.lower())
+        casedir = os.path.abspath(os.path.join(args.workdir, case))
+        if not os.path.isdir(casedir):
+            os.makedirs(casedir)
+        fcidump = os.path.join(casedir, 'FCIDUMP')
+        models.write_fcidump(ham, fcidump)
+
+        base_time = None
+        for nthreads in threads:
+            rundir = os.path.join(casedir, 'threads-%i' % nthreads)
+            if not os.path.isdir(rundir):
+                os.makedirs(rundir)
+            with open(os.path.join(rundir, 'input.dat'), 'w') as f:
+                f.write(INPUT.format(plugin_path=os.path.dirname(PLUGIN_ROOT),
+                                     docc=', '.join(str(d) for d in docc),
+                                     socc=', '.join(str(s) for s in socc),
+                                     fcidump=fcidump,
+                                     positivity=args.positivity,
+                                     convergence=args.convergence,
+                                     maxiter=args.maxiter))
+
+            print('%-36s threads %3i ... ' % (case, nthreads), end='')
+            sys.stdout.flush()
+            wall, status, maxrss = run_psi4(args.psi4, rundir, nthreads)
+
+            record = {
+                'date'        : datetime.datetime.now().isoformat(),
+                'host'        : socket.gethostname(),
+                'revision'    : revision,
+                'model'       : args.model,
+                'size'        : str(size),
+                'symmetry'    : args.symmetry,
+                'params'      : params,
+                'positivity'  : args.positivity.lower(),
+                'convergence' : args.convergence,
+                'norb'        : ham.norb,
+                'nelec'       : ham.nelec,
+                'orbitals_per_irrep': ham.orbitals_per_irrep(),
+                'threads'     : nthreads,
+                'status'      : status,
+                'wall_s'      : wall,
+                'max_rss_mb'  : maxrss,
+            }
+            output = os.path.join(rundir, 'output.dat')
+            if os.path.isfile(output):
+                record.update(parse_output(output))
+            energy = os.path.join(rundir, 'energy.dat')
+            if status == 0 and os.path.isfile(energy):
+                record['energy'] = float(open(energy).read())
+
+            # speedup over the smallest thread count, from the solver's own total
+            total = record['time_s'].get('total') if 'time_s' in record else None
+            if total and nthreads == threads[0]:
+                base_time = total
+            if total and base_time:
+                record['speedup'] = base_time / total
+
+            with open(args.output, 'a') as f:
+                f.write(json.dumps(record, sort_keys=True) + '\n')
+
+            if status != 0:
+                print('failed (see %s)' % os.path.join(rundir, 'psi4.log'))
+            else:
+                print('%10.2f s  %8i macroiterations  %14.8f' % (
+                    record.get('time_s', {}).get('total', wall),
+                    record.get('iterations', {}).get('macroiterations', 0),
+                    record.get('energy', float('nan'))))
+
+if __name__ == '__main__':
+    main()
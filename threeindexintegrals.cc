@@ -25,6 +25,8 @@
  *
  */
 
+#include<algorithm>
+
 #include"v2rdm_solver.h"
 
 #include <libmints/mints.h>
@@ -41,6 +43,52 @@ using namespace fnocc;
 
 namespace psi { namespace v2rdm_casscf {
 
+static bool LowerEnergy(const std::pair<double,int> & a, const std::pair<double,int> & b) {
+    return a.first < b.first;
+}
+
+SharedMatrix v2RDMSolver::CaSubsetAO(std::string subset) {
+
+    SharedMatrix aotoso = reference_wavefunction_->aotoso();
+    int nao = aotoso->rowspi()[0];
+
+    // (energy, position) of each orbital in the subset.  ties keep the
+    // pitzer order, as does the energy -> pitzer map in ThreeIndexIntegrals
+    std::vector< std::pair<double,int> > order;
+    std::vector<int> irrep;
+    std::vector<int> column;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < nmopi_[h]; i++) {
+            bool occ = ( i < nalphapi_[h] );
+            if ( subset == "OCC" && !occ ) continue;
+            if ( subset == "VIR" &&  occ ) continue;
+            order.push_back( std::make_pair(epsilon_a_->pointer(h)[i],(int)irrep.size()) );
+            irrep.push_back(h);
+            column.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(),order.end(),LowerEnergy);
+
+    int ncol = order.size();
+    SharedMatrix C (new Matrix("C (AO) " + subset,nao,ncol));
+    for (int k = 0; k < ncol; k++) {
+        int h   = irrep[order[k].second];
+        int i   = column[order[k].second];
+        int nso = aotoso->colspi()[h];
+        if ( nso == 0 ) continue;
+        C_DGEMV('n',nao,nso,1.0,aotoso->pointer(h)[0],nso,&(Ca_->pointer(h)[0][i]),nmopi_[h],0.0,&(C->pointer()[0][k]),ncol);
+    }
+    return C;
+}
+
+// as many auxiliary functions as fit, but at least one and at most all
+long int v2RDMSolver::DFBatchRows(long int rowlength, long int ndoubles) {
+    long int rowsize = ndoubles / rowlength;
+    if ( rowsize > nQ_ ) rowsize = nQ_;
+    if ( rowsize < 1 )   rowsize = 1;
+    return rowsize;
+}
+
 void v2RDMSolver::ThreeIndexIntegrals() {
 
     basisset_ = reference_wavefunction_->basisset();
@@ -64,10 +112,8 @@ void v2RDMSolver::ThreeIndexIntegrals() {
         Process::environment.globals["NAUX (SCF)"] = nQ_;
     }
 
-    // 100 mb extra to account for all mapping arrays already 
-    // allocated. this should be WAY more than necessary.
-    long int extra = 100 * 1024 * 1024;  
-    long int ndoubles = (memory_-extra) / 8;
+    // what PlanMemory left for the transformation
+    long int ndoubles = df_transform_doubles_;
 
     // orbitals will end up in energy order.  
     // we will want them in pitzer.  for sorting: 
@@ -102,18 +148,12 @@ void v2RDMSolver::ThreeIndexIntegrals() {
     }
 
     // how many rows of (Q|mn) can we read in at once?
-    if ( ndoubles < nso_*nso_ ) {
+    if ( ndoubles < 2L*nso_*nso_ ) {
         throw PsiException("holy moses, we can't fit nso^2 doubles in memory.  increase memory!",__FILE__,__LINE__);
     }
 
-    long int nrows = 1;
-    long int rowsize = nQ_;
-    while ( rowsize*nso_*nso_*2 > ndoubles ) {
-        nrows++;
-        rowsize = nQ_ / nrows;
-        if (nrows * rowsize < nQ_) rowsize++;
-        if (rowsize == 1) break;
-    }
+    long int rowsize = DFBatchRows(2L*nso_*nso_,ndoubles);
+    long int nrows   = ( nQ_ + rowsize - 1 ) / rowsize;
     long int lastrowsize = nQ_ - (nrows - 1L) * rowsize;
     long int * rowdims = new long int [nrows];
     for (int i = 0; i < nrows-1; i++) rowdims[i] = rowsize;
@@ -168,8 +208,9 @@ void v2RDMSolver::ThreeIndexIntegrals() {
     }
     psio->close(PSIF_DFSCF_BJ,1);
 
-    // AO->MO transformation matrix:
-    boost::shared_ptr<Matrix> myCa (new Matrix(reference_wavefunction_->Ca_subset("AO","ALL")));
+    // AO->MO transformation matrix (this solver's orbitals, which may differ
+    // from those of the reference)
+    boost::shared_ptr<Matrix> myCa = CaSubsetAO("ALL");
 
     // transform first index:
     addr  = PSIO_ZERO;
@@ -252,14 +293,8 @@ void v2RDMSolver::ThreeIndexIntegrals() {
     // with 3-index integrals in memory, how much else can we hold?
     ndoubles -= nn1fv*nQ_;
 
-    nrows = 1;
-    rowsize = nQ_;
-    while ( rowsize*nn1fv > ndoubles ) {
-        nrows++;
-        rowsize = nQ_ / nrows;
-        if (nrows * rowsize < nQ_) rowsize++;
-        if (rowsize == 1) break;
-    }
+    rowsize = DFBatchRows(nn1fv,ndoubles);
+    nrows   = ( nQ_ + rowsize - 1 ) / rowsize;
 
     lastrowsize = nQ_ - (nrows - 1L) * rowsize;
     long int * rowdims2 = new long int [nrows];
@@ -35,6 +35,12 @@
 #include <libpsio/psio.hpp>
 #include<libciomr/libciomr.h>
 
+#ifdef _OPENMP
+    #include<omp.h>
+#else
+    #define omp_get_max_threads() 1
+#endif
+
 INIT_PLUGIN
 
 using namespace boost;
@@ -59,6 +65,14 @@ int read_options(std::string name, Options& options)
         options.add_bool("TPDM_WRITE",false);
         /*- Do write the 3-RDM to disk? -*/
         options.add_bool("3PDM_WRITE",false);
+        /*- File format for the active 2-RDM and 3-RDM written by TPDM_WRITE
+        and 3PDM_WRITE.  COORDINATE writes one (indices, value) record per
+        element.  BLOCKED writes the dense symmetry-blocked geminal and
+        triplet matrices, preceded by the maps needed to interpret them. -*/
+        options.add_str("RDM_WRITE_FORMAT","COORDINATE","COORDINATE BLOCKED");
+        /*- Do read BLOCKED RDM files back after writing them and check their
+        traces (and, for the 2-RDM, the energy they give)? -*/
+        options.add_bool("RDM_WRITE_CHECK",false);
         /*- Do save progress in a checkpoint file? -*/
         options.add_bool("WRITE_CHECKPOINT_FILE",false);
         /*- Frequency of checkpoint file generation.  The checkpoint file is 
@@ -67,19 +81,86 @@ int read_options(std::string name, Options& options)
         options.add_int("CHECKPOINT_FREQUENCY",500);
         /*- File containing previous primal/dual solutions and integrals. -*/
         options.add_str("RESTART_FROM_CHECKPOINT_FILE","");
+        /*- Do start each point of a scan or optimization from the primal/dual
+        solutions, mu, and orbitals of the previous point? -*/
+        options.add_bool("SCAN_WARM_START",false);
+        /*- Smallest overlap of an active orbital with its counterpart from
+        the previous point of a scan for which the previous solution is
+        reused (SCAN_WARM_START) -*/
+        options.add_double("SCAN_MIN_OVERLAP",0.9);
         /*- Frequency with which the pentalty-parameter, mu, is updated. mu is
         updated every MU_UPDATE_FREQUENCY iterations.   -*/
         options.add_int("MU_UPDATE_FREQUENCY",500);
+        /*- Do update mu and take orbital steps when the residuals call for
+        them, rather than every MU_UPDATE_FREQUENCY and ORBOPT_FREQUENCY
+        iterations?  Every decision is printed. -*/
+        options.add_bool("ADAPTIVE_SCHEDULE",false);
+        /*- With ADAPTIVE_SCHEDULE, update mu once the primal and dual errors
+        differ by more than this factor -*/
+        options.add_double("ADAPTIVE_MU_RATIO",10.0);
+        /*- With ADAPTIVE_SCHEDULE, take an orbital step once the larger of
+        the primal and dual errors is below this fraction of the orbital
+        gradient norm left by the last orbital step -*/
+        options.add_double("ADAPTIVE_ORBOPT_FRACTION",0.1);
+        /*- With ADAPTIVE_SCHEDULE, the minimum number of iterations between
+        two mu updates or two orbital steps -*/
+        options.add_int("ADAPTIVE_MIN_INTERVAL",10);
         /*- The type of 2-positivity computation -*/
         options.add_str("POSITIVITY", "DQG", "DQG D DQ DG DQGT1 DQGT2 DQGT1T2");
         /*- Do constrain D3 to D2 mapping? -*/
         options.add_bool("CONSTRAIN_D3",false);
+        /*- Do converge the 2-positivity part of the problem (the D, Q, and G
+        conditions of POSITIVITY) first, to CONTINUATION_CONVERGENCE at fixed
+        orbitals, and start the T1/T2/D3 computation from its solution? -*/
+        options.add_bool("POSITIVITY_CONTINUATION",false);
+        /*- Convergence in the primal/dual errors and energy gap for the
+        2-positivity stage of POSITIVITY_CONTINUATION -*/
+        options.add_double("CONTINUATION_CONVERGENCE",1e-3);
+        /*- FCIDUMP file that defines the hamiltonian.  If set, no SCF is
+        run, and the orbitals are those of the file -*/
+        options.add_str_i("FCIDUMP_FILE","");
+        /*- Do compute only the smaller (positive or negative) side of the
+        spectrum of each block when updating the primal and dual solutions?
+        Each block is fully diagonalized once to establish its inertia. -*/
+        options.add_bool("PARTIAL_EIGENSOLVE", false);
+        /*- How the pages of the primal, dual, and constraint vectors are
+        placed on NUMA nodes.  NONE lets one thread touch every page;
+        FIRST_TOUCH puts each page on the node of the thread that works on
+        it (block by block for the primal-space vectors); INTERLEAVE
+        spreads the pages round-robin over all nodes. -*/
+        options.add_str("VECTOR_PLACEMENT","NONE","NONE FIRST_TOUCH INTERLEAVE");
+        /*- Do evaluate A.x (for the primal residual) and A(c-z) (for the
+        next conjugate gradient right-hand side) at the same time, each on
+        half of the threads? -*/
+        options.add_bool("CONCURRENT_RESIDUALS", false);
         /*- Do spin adapt G2 condition? -*/
         options.add_bool("SPIN_ADAPT_G2", false);
         /*- Do spin adapt Q2 condition? -*/
         options.add_bool("SPIN_ADAPT_Q2", false);
+        /*- Do store the beta-spin blocks (D1, Q1, D2, and Q2) as aliases of
+        the alpha-spin ones? Only valid for singlet states.  This is not a
+        singlet/triplet spin adaptation. -*/
+        options.add_bool("SINGLET_ALIAS_BETA_BLOCKS", false);
+        /*- Do store D2 of a singlet state as its singlet and triplet geminal
+        blocks?  Implies SINGLET_ALIAS_BETA_BLOCKS. -*/
+        options.add_bool("SPIN_ADAPT_D2", false);
         /*- Do constrain spin squared? -*/
         options.add_bool("CONSTRAIN_SPIN", true);
+        /*- Do drop the redundant D2 trace constraints and keep only the
+        unique (symmetric) rows of the D2 -> D1 contraction constraints? -*/
+        options.add_bool("REDUCED_CONSTRAINTS", false);
+
+        /*- SUBSECTION MULTISTATE -*/
+
+        /*- Multiplicities of the states in a multistate computation.  All
+        states share the reference orbitals and integrals. -*/
+        options.add_array("STATE_MULTIPLICITIES");
+        /*- Positivity conditions for the states in a multistate computation
+        (defaults to POSITIVITY) -*/
+        options.add_array("STATE_POSITIVITY");
+        /*- Do iterate the states of a multistate computation concurrently,
+        each on its share of the threads? -*/
+        options.add_bool("CONCURRENT_STATES", false);
         /*- convergence in the primal/dual energy gap -*/
         options.add_double("E_CONVERGENCE", 1e-4);
         /*- convergence in the primal error -*/
@@ -90,6 +171,12 @@ int read_options(std::string name, Options& options)
         options.add_int("MAXITER", 10000);
         /*- maximum number of conjugate gradient iterations -*/
         options.add_int("CG_MAXITER", 10000);
+        /*- Do adapt the conjugate gradient convergence to the progress in the
+        primal and dual errors? -*/
+        options.add_bool("CG_ADAPTIVE_CONVERGENCE", false);
+        /*- Number of conjugate gradient search directions recycled from one
+        outer iteration to deflate the next -*/
+        options.add_int("CG_RECYCLE_DIMENSION", 0);
         /*- maximum number of diis vectors -*/
         options.add_int("DIIS_MAX_VECS", 8);
         /*- Frequency of DIIS extrapolation steps -*/
@@ -104,6 +191,12 @@ int read_options(std::string name, Options& options)
         options.add_str("SCF_TYPE", "DF", "DF CD PK OUT_OF_CORE");
         /*- Tolerance for Cholesky decomposition of the ERI tensor -*/
         options.add_double("CHOLESKY_TOLERANCE",1e-4);
+        /*- Do replace the restricted virtual orbitals with DF-MP2 natural
+        orbitals and freeze those with small occupations? -*/
+        options.add_bool("FROZEN_NATURAL_ORBITALS",false);
+        /*- Restricted virtual natural orbitals with MP2 occupations below
+        this value are frozen when FROZEN_NATURAL_ORBITALS is true -*/
+        options.add_double("FNO_OCC_TOLERANCE",1e-6);
 
         /*- SUBSECTION ORBITAL OPTIMIZATION -*/
 
@@ -124,6 +217,20 @@ int read_options(std::string name, Options& options)
         options.add_int("ORBOPT_FREQUENCY",500);
         /*- maximum number of iterations for orbital optimization -*/
         options.add_int("ORBOPT_MAXITER",20);
+        /*- Do hand the active-space 1- and 2-RDM to the orbital optimizer in
+        its own storage order?  If false, the full density including the core
+        orbitals is built and then re-sorted by the optimizer (slower, more
+        memory). -*/
+        options.add_bool("ORBOPT_DIRECT_DENSITY",false);
+        /*- Do run one-step orbital optimization in a background thread while
+        the SDP iterations continue on the previous integrals?  The rotated
+        integrals are swapped in at the start of the next macroiteration after
+        the background step finishes. -*/
+        options.add_bool("ORBOPT_ASYNC",false);
+        /*- Number of threads given to background orbital optimization.  The
+        remaining threads are used by the SDP solver.  The default (0) splits
+        the available threads evenly. -*/
+        options.add_int("ORBOPT_ASYNC_THREADS",0);
         /*- Do write a MOLDEN output file?  If so, the filename will end in
         .molden, and the prefix is determined by |globals__writer_file_label|
         (if set), or else by the name of the output file plus the name of
@@ -143,15 +250,197 @@ int read_options(std::string name, Options& options)
     return true;
 }
 
+// a solver over the reference orbitals, or over the hamiltonian of FCIDUMP_FILE
+boost::shared_ptr<v2RDMSolver> NewSolver(SharedWavefunction ref_wfn, Options& options) {
+
+    // a single STATE_MULTIPLICITIES/STATE_POSITIVITY entry describes the one
+    // state to compute, as it would the first state of a multistate job
+    int multiplicity = 0;
+    std::string positivity = "";
+    if ( options["STATE_MULTIPLICITIES"].size() == 1 ) {
+        multiplicity = (int)options["STATE_MULTIPLICITIES"][0].to_double();
+    }
+    if ( options["STATE_POSITIVITY"].size() == 1 ) {
+        positivity = options["STATE_POSITIVITY"][0].to_string();
+    }
+
+    if ( options.get_str("FCIDUMP_FILE") != "" ) {
+        boost::shared_ptr<FCIDUMP> fcidump (new FCIDUMP(options.get_str("FCIDUMP_FILE")));
+        return boost::shared_ptr<v2RDMSolver>(new v2RDMSolver(fcidump,options,multiplicity,positivity));
+    }
+    if ( multiplicity == 0 && positivity == "" ) {
+        return boost::shared_ptr<v2RDMSolver>(new v2RDMSolver(ref_wfn,options));
+    }
+    return boost::shared_ptr<v2RDMSolver>(new v2RDMSolver(ref_wfn,options,multiplicity,positivity,boost::shared_ptr<v2RDMSolver>()));
+}
+
+// several v2RDM states (multiplicities/positivity conditions) over the same
+// orbitals.  the states are iterated in lock step: the numerical part of
+// each macroiteration may run concurrently, while printing, checkpointing,
+// and orbital optimization (which is not reentrant) are done state by state.
+double MultistateEnergy(SharedWavefunction ref_wfn, Options& options, int nstates) {
+
+    if ( options.get_bool("WRITE_CHECKPOINT_FILE") || options["RESTART_FROM_CHECKPOINT_FILE"].has_changed() ) {
+        throw PsiException("checkpoint files are not supported for multistate computations",__FILE__,__LINE__);
+    }
+    if ( options.get_bool("ORBOPT_ASYNC") ) {
+        throw PsiException("background orbital optimization is not supported for multistate computations",__FILE__,__LINE__);
+    }
+    if ( options.get_str("FCIDUMP_FILE") != "" ) {
+        throw PsiException("FCIDUMP_FILE is not supported for multistate computations",__FILE__,__LINE__);
+    }
+
+    std::vector<int> multiplicity;
+    std::vector<std::string> positivity;
+    std::vector< boost::shared_ptr<v2RDMSolver> > states;
+    for (int n = 0; n < nstates; n++) {
+
+        multiplicity.push_back( ref_wfn->molecule()->multiplicity() );
+        if ( n < options["STATE_MULTIPLICITIES"].size() ) {
+            multiplicity[n] = (int)options["STATE_MULTIPLICITIES"][n].to_double();
+        }
+        positivity.push_back( options.get_str("POSITIVITY") );
+        if ( n < options["STATE_POSITIVITY"].size() ) {
+            positivity[n] = options["STATE_POSITIVITY"][n].to_string();
+        }
+
+        outfile->Printf("\n");
+        outfile->Printf("  ==> Multistate v2RDM: state %i (multiplicity %i, %s) <==\n",n,multiplicity[n],positivity[n].c_str());
+
+        // the first state transforms the integrals; the others reuse them
+        boost::shared_ptr<v2RDMSolver> donor;
+        if ( n > 0 ) donor = states[0];
+        states.push_back( boost::shared_ptr<v2RDMSolver>(new v2RDMSolver(ref_wfn,options,multiplicity[n],positivity[n],donor)) );
+    }
+
+    for (int n = 0; n < nstates; n++) {
+        outfile->Printf("\n");
+        outfile->Printf("  ==> Multistate v2RDM: state %i iterations <==\n",n);
+        states[n]->InitializeBPSDP();
+    }
+
+    int nthread = omp_get_max_threads();
+    // not with MPI: the states' collectives would interleave differently on each rank
+    bool concurrent = options.get_bool("CONCURRENT_STATES") && DistributedSize() == 1;
+    #ifdef _OPENMP
+        if ( concurrent ) omp_set_nested(1);
+    #endif
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Multistate v2RDM: iterations <==\n");
+    outfile->Printf("\n");
+
+    std::vector<bool> converged(nstates,false);
+    std::vector<int> active;
+    for (int n = 0; n < nstates; n++) active.push_back(n);
+
+    do {
+
+        // partition the threads among the unconverged states
+        int nouter = concurrent ? active.size() : 1;
+        int ninner = nthread / nouter > 0 ? nthread / nouter : 1;
+
+        #pragma omp parallel for schedule (static,1) num_threads(nouter)
+        for (int k = 0; k < active.size(); k++) {
+            #ifdef _OPENMP
+                if ( concurrent ) omp_set_num_threads(ninner);
+            #endif
+            states[active[k]]->BPSDPIteration();
+        }
+
+        std::vector<int> still_active;
+        for (int k = 0; k < active.size(); k++) {
+            int n = active[k];
+            outfile->Printf("    [%i]",n);
+            converged[n] = states[n]->BPSDPBookkeeping();
+            if ( !converged[n] ) still_active.push_back(n);
+        }
+        active = still_active;
+
+    }while( active.size() > 0 );
+
+    #ifdef _OPENMP
+        if ( concurrent ) omp_set_nested(0);
+        omp_set_num_threads(nthread);
+    #endif
+
+    std::vector<double> energy;
+    for (int n = 0; n < nstates; n++) {
+        outfile->Printf("\n");
+        outfile->Printf("  ==> Multistate v2RDM: state %i results <==\n",n);
+        energy.push_back( states[n]->FinalizeBPSDP() );
+
+        char * label = (char*)malloc(100*sizeof(char));
+        sprintf(label,"v2RDM STATE %i TOTAL ENERGY",n);
+        Process::environment.globals[label] = energy[n];
+        free(label);
+    }
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Multistate v2RDM summary <==\n");
+    outfile->Printf("\n");
+    outfile->Printf("      state  multiplicity  positivity          total energy\n");
+    for (int n = 0; n < nstates; n++) {
+        outfile->Printf("      %5i  %12i  %10s  %20.12lf\n",n,multiplicity[n],positivity[n].c_str(),energy[n]);
+    }
+    outfile->Printf("\n");
+
+    Process::environment.globals["v2RDM TOTAL ENERGY"] = energy[0];
+
+    return energy[0];
+}
+
+// T1/T2/D3 computation started from a loosely converged solution with only
+// the D, Q, and G conditions of the target.  the stage reuses the integrals
+// of the full problem and keeps the orbitals
+// fixed, so its solution is expressed in the orbitals the full problem
+// starts from.
+double ContinuationEnergy(SharedWavefunction ref_wfn, Options& options) {
+
+    boost::shared_ptr<v2RDMSolver> v2rdm = NewSolver(ref_wfn,options);
+    if ( !v2rdm->ContinuationUseful() ) {
+        return v2rdm->compute_energy();
+    }
+
+    outfile->Printf("\n");
+    std::string positivity = v2rdm->ContinuationPositivity();
+    outfile->Printf("  ==> Positivity continuation: %s stage <==\n",positivity.c_str());
+
+    boost::shared_ptr<v2RDMSolver> stage (new v2RDMSolver(ref_wfn,options,0,positivity,v2rdm,true));
+    stage->InitializeBPSDP();
+    do {
+        stage->BPSDPIteration();
+    }while( !stage->BPSDPBookkeeping() );
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Positivity continuation: full problem <==\n");
+
+    v2rdm->SetContinuationSource(stage);
+    stage.reset();
+
+    return v2rdm->compute_energy();
+}
+
 extern "C" 
 SharedWavefunction v2rdm_casscf(SharedWavefunction ref_wfn, Options& options)
 {
 
     tstart();
 
-    boost::shared_ptr<v2RDMSolver > v2rdm (new v2RDMSolver(ref_wfn,options));
+    int nstates = options["STATE_MULTIPLICITIES"].size();
+    if ( options["STATE_POSITIVITY"].size() > nstates ) {
+        nstates = options["STATE_POSITIVITY"].size();
+    }
 
-    double energy = v2rdm->compute_energy();
+    double energy;
+    if ( nstates > 1 ) {
+        energy = MultistateEnergy(ref_wfn,options,nstates);
+    }else if ( options.get_bool("POSITIVITY_CONTINUATION") ) {
+        energy = ContinuationEnergy(ref_wfn,options);
+    }else {
+        boost::shared_ptr<v2RDMSolver > v2rdm = NewSolver(ref_wfn,options);
+        energy = v2rdm->compute_energy();
+    }
 
     Process::environment.globals["CURRENT ENERGY"] = energy;
 
@@ -28,6 +28,7 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<math.h>
+#include<algorithm>
 
 #include <libmints/writer.h>
 #include <libmints/writer_file_prefix.h>
@@ -65,6 +66,7 @@
 #else
     #define omp_get_wtime() ( (double)clock() / CLOCKS_PER_SEC )
     #define omp_get_max_threads() 1
+    #define omp_set_num_threads(n)
 #endif
 
 using namespace boost;
@@ -82,8 +84,8 @@ inline void DGEEV(char& JOBVL,char& JOBVR,long int& N,double* A,long int& LDA,do
 }
 
 
-// diagonalize real, nonsymmetric matrix
-void NonsymmetricEigenvalue(long int N, double * A, double * VL, double * VR, double * WR, double *WI){
+// diagonalize real, nonsymmetric matrix.  WORK must hold at least 4N doubles
+void NonsymmetricEigenvalue(long int N, double * A, double * VL, double * VR, double * WR, double *WI, double * WORK){
 
     char JOBVL = 'V';
     char JOBVR = 'V';
@@ -91,7 +93,6 @@ void NonsymmetricEigenvalue(long int N, double * A, double * VL, double * VR, do
     long int LDVL = N;
     long int LDVR = N;
     long int LWORK = 4*N;
-    double * WORK = (double*)malloc(LWORK*sizeof(double));
     long int INFO;
 
     DGEEV(JOBVL, JOBVR, N, A, LDA, WR, WI, VL, LDVL, VR, LDVR, WORK, LWORK, INFO);
@@ -103,11 +104,9 @@ void NonsymmetricEigenvalue(long int N, double * A, double * VL, double * VR, do
             WI[i] = 0.0;
         }
     }
-
-    free(WORK);
 }
 
-static void evaluate_Ap(long int n, SharedVector Ax, SharedVector x, void * data) {
+static void evaluate_Ap(long int n, SharedSolverVector Ax, SharedSolverVector x, void * data) {
   
     // reinterpret void * as an instance of v2RDMSolver
     v2rdm_casscf::v2RDMSolver* BPSDPcg = reinterpret_cast<v2rdm_casscf::v2RDMSolver*>(data);
@@ -120,15 +119,66 @@ namespace psi{ namespace v2rdm_casscf{
 v2RDMSolver::v2RDMSolver(boost::shared_ptr<Wavefunction> reference_wavefunction,Options & options):
     Wavefunction(options){
     reference_wavefunction_ = reference_wavefunction;
+    state_multiplicity_     = 0;
+    state_positivity_       = "";
+    continuation_stage_     = false;
+    common_init();
+}
+
+v2RDMSolver::v2RDMSolver(boost::shared_ptr<FCIDUMP> fcidump,Options & options,
+    int multiplicity, std::string positivity):
+    Wavefunction(options){
+    fcidump_                = fcidump;
+    state_multiplicity_     = multiplicity;
+    state_positivity_       = positivity;
+    continuation_stage_     = false;
+    common_init();
+}
+
+v2RDMSolver::v2RDMSolver(boost::shared_ptr<Wavefunction> reference_wavefunction,Options & options,
+    int multiplicity, std::string positivity, boost::shared_ptr<v2RDMSolver> integral_donor,
+    bool continuation_stage):
+    Wavefunction(options){
+    reference_wavefunction_ = reference_wavefunction;
+    state_multiplicity_     = multiplicity;
+    state_positivity_       = positivity;
+    integral_donor_         = integral_donor;
+    continuation_stage_     = continuation_stage;
     common_init();
 }
 
 v2RDMSolver::~v2RDMSolver()
 {
-    free(tei_full_sym_);
+    // never leave a background orbital step running
+    if ( orbopt_thread_ != NULL ) {
+        orbopt_thread_->join();
+        delete orbopt_thread_;
+    }
+    if ( orbopt_async_oei_ != NULL ) {
+        free(orbopt_async_oei_);
+        free(orbopt_async_tei_);
+        free(orbopt_async_transformation_matrix_);
+        free(orbopt_async_data_);
+        free(orbopt_async_d1_);
+        free(orbopt_async_d2_);
+    }
+
+    // a shared buffer is freed by its last user
+    if ( !tei_buffer_ ) {
+        free(tei_full_sym_);
+    }
     free(oei_full_sym_);
     free(d2_plus_core_sym_);
     free(d1_plus_core_sym_);
+    free(orbopt_den_gem_);
+    free(orbopt_den_off_);
+    free(active_gems_);
+    free(active_plus_core_gem_);
+    free(d2_plus_core_off_);
+    for (int h = 0; h < nirrep_; h++) {
+        free(active_gem_bas_[h]);
+    }
+    free(active_gem_bas_);
 
     free(amopi_);
     free(rstcpi_);
@@ -136,6 +186,8 @@ v2RDMSolver::~v2RDMSolver()
     free(d2aboff);
     free(d2aaoff);
     free(d2bboff);
+    free(d2soff);
+    free(d2toff);
     free(d1aoff);
     free(d1boff);
     free(q1aoff);
@@ -189,27 +241,36 @@ v2RDMSolver::~v2RDMSolver()
 
 void  v2RDMSolver::common_init(){
 
+    // the states of a multistate computation share one hamiltonian
+    if ( integral_donor_ && integral_donor_->fcidump_ ) {
+        fcidump_ = integral_donor_->fcidump_;
+    }
+
     is_df_ = false;
-    if ( options_.get_str("SCF_TYPE") == "DF" || options_.get_str("SCF_TYPE") == "CD" ) {
+    if ( !fcidump_ && ( options_.get_str("SCF_TYPE") == "DF" || options_.get_str("SCF_TYPE") == "CD" ) ) {
         is_df_ = true;
     }
 
-    enuc_     = reference_wavefunction_->molecule()->nuclear_repulsion_energy();
-    escf_     = reference_wavefunction_->reference_energy();
-    nalpha_   = reference_wavefunction_->nalpha();
-    nbeta_    = reference_wavefunction_->nbeta();
-    nalphapi_ = reference_wavefunction_->nalphapi();
-    nbetapi_  = reference_wavefunction_->nbetapi();
-    doccpi_   = reference_wavefunction_->doccpi();
-    soccpi_   = reference_wavefunction_->soccpi();
-    frzcpi_   = reference_wavefunction_->frzcpi();
-    frzvpi_   = reference_wavefunction_->frzvpi();
-    nmopi_    = reference_wavefunction_->nmopi();
-    nirrep_   = reference_wavefunction_->nirrep();
-    nso_      = reference_wavefunction_->nso();
-    nmo_      = reference_wavefunction_->nmo();
-    nsopi_    = reference_wavefunction_->nsopi();
-    molecule_ = reference_wavefunction_->molecule();
+    if ( fcidump_ ) {
+        InitializeFromFCIDUMP();
+    }else {
+        enuc_     = reference_wavefunction_->molecule()->nuclear_repulsion_energy();
+        escf_     = reference_wavefunction_->reference_energy();
+        nalpha_   = reference_wavefunction_->nalpha();
+        nbeta_    = reference_wavefunction_->nbeta();
+        nalphapi_ = reference_wavefunction_->nalphapi();
+        nbetapi_  = reference_wavefunction_->nbetapi();
+        doccpi_   = reference_wavefunction_->doccpi();
+        soccpi_   = reference_wavefunction_->soccpi();
+        frzcpi_   = reference_wavefunction_->frzcpi();
+        frzvpi_   = reference_wavefunction_->frzvpi();
+        nmopi_    = reference_wavefunction_->nmopi();
+        nirrep_   = reference_wavefunction_->nirrep();
+        nso_      = reference_wavefunction_->nso();
+        nmo_      = reference_wavefunction_->nmo();
+        nsopi_    = reference_wavefunction_->nsopi();
+        molecule_ = reference_wavefunction_->molecule();
+    }
 
     // restricted doubly occupied orbitals per irrep (optimized)
     rstcpi_   = (int*)malloc(nirrep_*sizeof(int));
@@ -224,7 +285,60 @@ void  v2RDMSolver::common_init(){
     memset((void*)amopi_,'\0',nirrep_*sizeof(int));
 
     // multiplicity:
-    multiplicity_ = reference_wavefunction_->molecule()->multiplicity();
+    if ( fcidump_ ) {
+        multiplicity_ = fcidump_->ms2() + 1;
+    }else {
+        multiplicity_ = reference_wavefunction_->molecule()->multiplicity();
+    }
+
+    // a continuation stage solves for the same state as the full problem
+    if ( continuation_stage_ ) {
+        state_multiplicity_ = integral_donor_->multiplicity_;
+    }
+
+    // a state in a multistate computation may differ in multiplicity from
+    // the reference.  keep the number of electrons and redistribute them.
+    if ( state_multiplicity_ > 0 && state_multiplicity_ != multiplicity_ ) {
+        int nelec = nalpha_ + nbeta_;
+        if ( ( nelec + state_multiplicity_ - 1 ) % 2 != 0 || state_multiplicity_ - 1 > nelec ) {
+            throw PsiException("state multiplicity is inconsistent with the number of electrons",__FILE__,__LINE__);
+        }
+        if ( options_.get_str("TPDM_GUESS") == "HF" ) {
+            throw PsiException("TPDM_GUESS HF requires the state multiplicity to match the reference",__FILE__,__LINE__);
+        }
+        multiplicity_ = state_multiplicity_;
+        nalpha_       = ( nelec + multiplicity_ - 1 ) / 2;
+        nbeta_        = nelec - nalpha_;
+
+        // aufbau occupation of the reference orbitals for the new spin state
+        // (FCIDUMP orbitals have no energies and are filled in file order)
+        std::vector< std::pair<double,int> > orbitals;
+        if ( fcidump_ ) {
+            const std::vector<int> & orbsym = fcidump_->orbital_symmetry();
+            for (int p = 0; p < nmo_; p++) {
+                orbitals.push_back( std::make_pair((double)p,orbsym[p]) );
+            }
+        }else {
+            for (int h = 0; h < nirrep_; h++) {
+                for (int i = 0; i < nmopi_[h]; i++) {
+                    orbitals.push_back( std::make_pair(reference_wavefunction_->epsilon_a()->pointer(h)[i],h) );
+                }
+            }
+        }
+        std::sort(orbitals.begin(),orbitals.end());
+        doccpi_ = Dimension(nirrep_);
+        soccpi_ = Dimension(nirrep_);
+        for (int p = 0; p < nalpha_; p++) {
+            if ( p < nbeta_ ) doccpi_[orbitals[p].second]++;
+            else              soccpi_[orbitals[p].second]++;
+        }
+        nalphapi_ = Dimension(nirrep_);
+        nbetapi_  = Dimension(nirrep_);
+        for (int h = 0; h < nirrep_; h++) {
+            nalphapi_[h] = doccpi_[h] + soccpi_[h];
+            nbetapi_[h]  = doccpi_[h];
+        }
+    }
 
     if (options_["FROZEN_DOCC"].has_changed()) {
         throw PsiException("FROZEN_DOCC is currently disabled.",__FILE__,__LINE__);
@@ -336,22 +450,57 @@ void  v2RDMSolver::common_init(){
     }
 
 
-    Ca_ = SharedMatrix(reference_wavefunction_->Ca());
-    Cb_ = SharedMatrix(reference_wavefunction_->Cb());
+    if ( fcidump_ ) {
+        FCIDUMPOrbitals();
+    }else {
+        Ca_ = SharedMatrix(reference_wavefunction_->Ca());
+        Cb_ = SharedMatrix(reference_wavefunction_->Cb());
+
+        // states that share a reference with another solver need their own
+        // orbitals, which are rotated independently.  they start from the
+        // orbitals the shared integrals were transformed with (which differ
+        // from the reference's after frozen natural orbital truncation)
+        if ( integral_donor_ ) {
+            Ca_ = integral_donor_->Ca_->clone();
+            Cb_ = integral_donor_->Cb_->clone();
+        }
 
-    S_  = SharedMatrix(reference_wavefunction_->S());
+        S_  = SharedMatrix(reference_wavefunction_->S());
 
-    Fa_ = SharedMatrix(reference_wavefunction_->Fa());
-    Fb_ = SharedMatrix(reference_wavefunction_->Fb());
+        Fa_ = SharedMatrix(reference_wavefunction_->Fa());
+        Fb_ = SharedMatrix(reference_wavefunction_->Fb());
 
-    Da_ = SharedMatrix(reference_wavefunction_->Da());
-    Db_ = SharedMatrix(reference_wavefunction_->Db());
-    
-    epsilon_a_= boost::shared_ptr<Vector>(new Vector(nirrep_, nmopi_));
-    epsilon_a_->copy(reference_wavefunction_->epsilon_a().get());
-    epsilon_b_= boost::shared_ptr<Vector>(new Vector(nirrep_, nmopi_));
-    epsilon_b_->copy(reference_wavefunction_->epsilon_b().get());
+        Da_ = SharedMatrix(reference_wavefunction_->Da());
+        Db_ = SharedMatrix(reference_wavefunction_->Db());
     
+        epsilon_a_= boost::shared_ptr<Vector>(new Vector(nirrep_, nmopi_));
+        epsilon_a_->copy(reference_wavefunction_->epsilon_a().get());
+        epsilon_b_= boost::shared_ptr<Vector>(new Vector(nirrep_, nmopi_));
+        epsilon_b_->copy(reference_wavefunction_->epsilon_b().get());
+        if ( integral_donor_ ) {
+            epsilon_a_->copy(integral_donor_->epsilon_a_.get());
+            epsilon_b_->copy(integral_donor_->epsilon_b_.get());
+        }
+    }
+
+    // truncate the restricted virtuals to frozen natural orbitals.  the
+    // other states of a multistate computation start from orbitals that
+    // have already been truncated
+    fno_peak_ = 0.0;
+    if ( options_.get_bool("FROZEN_NATURAL_ORBITALS") ) {
+        if ( fcidump_ ) {
+            throw PsiException("FROZEN_NATURAL_ORBITALS is not available with FCIDUMP_FILE",__FILE__,__LINE__);
+        }
+        if ( integral_donor_ ) {
+            for (int h = 0; h < nirrep_; h++) {
+                rstvpi_[h] = integral_donor_->rstvpi_[h];
+                frzvpi_[h] = integral_donor_->frzvpi_[h];
+            }
+        }else {
+            FrozenNaturalOrbitals();
+        }
+    }
+
     amo_      = 0;
     nfrzc_    = 0;
     nfrzv_    = 0;
@@ -412,42 +561,62 @@ void  v2RDMSolver::common_init(){
     constrain_t1_ = false;
     constrain_t2_ = false;
     constrain_d3_ = false;
-    if (options_.get_str("POSITIVITY")=="D") {
+    std::string positivity = options_.get_str("POSITIVITY");
+    if ( state_positivity_ != "" ) {
+        positivity = state_positivity_;
+    }
+    if (positivity=="D") {
         constrain_q2_ = false;
         constrain_g2_ = false;
-    }else if (options_.get_str("POSITIVITY")=="DQ") {
+    }else if (positivity=="DQ") {
         constrain_q2_ = true;
         constrain_g2_ = false;
-    }else if (options_.get_str("POSITIVITY")=="DG") {
+    }else if (positivity=="DG") {
         constrain_q2_ = false;
         constrain_g2_ = true;
-    }else if (options_.get_str("POSITIVITY")=="DQGT1") {
+    }else if (positivity=="DQGT1") {
         constrain_q2_ = true;
         constrain_g2_ = true;
         constrain_t1_ = true;
-    }else if (options_.get_str("POSITIVITY")=="DQGT2") {
+    }else if (positivity=="DQGT2") {
         constrain_q2_ = true;
         constrain_g2_ = true;
         constrain_t2_ = true;
-    }else if (options_.get_str("POSITIVITY")=="DQGT1T2") {
+    }else if (positivity=="DQGT1T2") {
         constrain_q2_ = true;
         constrain_g2_ = true;
         constrain_t1_ = true;
         constrain_t2_ = true;
-    }else if (options_.get_str("POSITIVITY")=="DQGT") {
+    }else if (positivity=="DQGT") {
         constrain_q2_ = true;
         constrain_g2_ = true;
         constrain_t1_ = true;
         constrain_t2_ = true;
     }
 
-    if ( options_.get_bool("CONSTRAIN_D3") ) {
+    if ( options_.get_bool("CONSTRAIN_D3") && !continuation_stage_ ) {
         constrain_d3_ = true;
     }
 
     spin_adapt_g2_  = options_.get_bool("SPIN_ADAPT_G2");
     spin_adapt_q2_  = options_.get_bool("SPIN_ADAPT_Q2");
     constrain_spin_ = options_.get_bool("CONSTRAIN_SPIN");
+    reduced_constraints_ = options_.get_bool("REDUCED_CONSTRAINTS");
+    alias_beta_blocks_  = options_.get_bool("SINGLET_ALIAS_BETA_BLOCKS");
+    spin_adapt_d2_      = options_.get_bool("SPIN_ADAPT_D2");
+
+    if ( spin_adapt_d2_ && nalpha_ != nbeta_ ) {
+        throw PsiException("SPIN_ADAPT_D2 is only available for singlet states.",__FILE__,__LINE__);
+    }
+
+    // D2aa = D2bb = D2t, so the beta-spin blocks are aliases
+    if ( spin_adapt_d2_ ) {
+        alias_beta_blocks_ = true;
+    }
+
+    if ( alias_beta_blocks_ && nalpha_ != nbeta_ ) {
+        throw PsiException("SINGLET_ALIAS_BETA_BLOCKS is only available for singlet states.",__FILE__,__LINE__);
+    }
 
     if ( constrain_t1_ || constrain_t2_ ) {
         if (spin_adapt_g2_) {
@@ -458,6 +627,13 @@ void  v2RDMSolver::common_init(){
         }
     }
 
+    // start from the orbitals of the previous point of a scan?
+    scan_warm_start_ = false;
+    Process::environment.globals["v2RDM SCAN WARM START"] = 0.0;
+    if ( options_.get_bool("SCAN_WARM_START") && !integral_donor_ && !fcidump_ ) {
+        ProjectScanOrbitals();
+    }
+
     // build mapping arrays and determine the number of geminals per block
     BuildBasis();
 
@@ -473,24 +649,39 @@ void  v2RDMSolver::common_init(){
 
     // dimension of variable buffer (x) 
     dimx_ = 0;
-    for ( int h = 0; h < nirrep_; h++) {
-        dimx_ += gems_ab[h]*gems_ab[h]; // D2ab
-    }
-    for ( int h = 0; h < nirrep_; h++) {
-        dimx_ += gems_aa[h]*gems_aa[h]; // D2aa
-    }
-    for ( int h = 0; h < nirrep_; h++) {
-        dimx_ += gems_aa[h]*gems_aa[h]; // D2bb
+    if ( spin_adapt_d2_ ) {
+        for ( int h = 0; h < nirrep_; h++) {
+            dimx_ += gems_00[h]*gems_00[h]; // D2s
+        }
+        for ( int h = 0; h < nirrep_; h++) {
+            dimx_ += gems_aa[h]*gems_aa[h]; // D2t
+        }
+    }else {
+        for ( int h = 0; h < nirrep_; h++) {
+            dimx_ += gems_ab[h]*gems_ab[h]; // D2ab
+        }
+        for ( int h = 0; h < nirrep_; h++) {
+            dimx_ += gems_aa[h]*gems_aa[h]; // D2aa
+        }
+        if ( !alias_beta_blocks_ ) {
+            for ( int h = 0; h < nirrep_; h++) {
+                dimx_ += gems_aa[h]*gems_aa[h]; // D2bb
+            }
+        }
     }
     for ( int h = 0; h < nirrep_; h++) {
         dimx_ += amopi_[h]*amopi_[h]; // D1a
-        dimx_ += amopi_[h]*amopi_[h]; // D1b
-        dimx_ += amopi_[h]*amopi_[h]; // Q1b
         dimx_ += amopi_[h]*amopi_[h]; // Q1a
+        if ( !alias_beta_blocks_ ) {
+            dimx_ += amopi_[h]*amopi_[h]; // D1b
+            dimx_ += amopi_[h]*amopi_[h]; // Q1b
+        }
     }
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        for ( int h = 0; h < nirrep_; h++) {
-            dimx_ += gems_ab[h] * gems_ab[h]; // D200
+        if ( !spin_adapt_d2_ ) {
+            for ( int h = 0; h < nirrep_; h++) {
+                dimx_ += gems_ab[h] * gems_ab[h]; // D200
+            }
         }
     }else if ( constrain_spin_ ) {
         for ( int h = 0; h < nirrep_; h++) {
@@ -505,8 +696,10 @@ void  v2RDMSolver::common_init(){
             for ( int h = 0; h < nirrep_; h++) {
                 dimx_ += gems_aa[h]*gems_aa[h]; // Q2aa
             }
-            for ( int h = 0; h < nirrep_; h++) {
-                dimx_ += gems_aa[h]*gems_aa[h]; // Q2bb
+            if ( !alias_beta_blocks_ ) {
+                for ( int h = 0; h < nirrep_; h++) {
+                    dimx_ += gems_aa[h]*gems_aa[h]; // Q2bb
+                }
             }
         }else {
             for ( int h = 0; h < nirrep_; h++) {
@@ -518,8 +711,10 @@ void  v2RDMSolver::common_init(){
             for ( int h = 0; h < nirrep_; h++) {
                 dimx_ += gems_aa[h]*gems_aa[h]; // Q2t_p1
             }
-            for ( int h = 0; h < nirrep_; h++) {
-                dimx_ += gems_aa[h]*gems_aa[h]; // Q2t_m1
+            if ( !alias_beta_blocks_ ) {
+                for ( int h = 0; h < nirrep_; h++) {
+                    dimx_ += gems_aa[h]*gems_aa[h]; // Q2t_m1
+                }
             }
         }
     }
@@ -605,18 +800,37 @@ void  v2RDMSolver::common_init(){
     d2aaoff = (int*)malloc(nirrep_*sizeof(int));
     d2bboff = (int*)malloc(nirrep_*sizeof(int));
     d200off = (int*)malloc(nirrep_*sizeof(int));
-    for (int h = 0; h < nirrep_; h++) {
-        d2aboff[h] = offset; offset += gems_ab[h]*gems_ab[h];
-    }
-    for (int h = 0; h < nirrep_; h++) {
-        d2aaoff[h] = offset; offset += gems_aa[h]*gems_aa[h];
-    }
-    for (int h = 0; h < nirrep_; h++) {
-        d2bboff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+    d2soff  = (int*)malloc(nirrep_*sizeof(int));
+    d2toff  = (int*)malloc(nirrep_*sizeof(int));
+    if ( spin_adapt_d2_ ) {
+        // D2ab and D2aa are placed after the last block (below)
+        for (int h = 0; h < nirrep_; h++) {
+            d2soff[h] = offset; offset += gems_00[h]*gems_00[h];
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            d2toff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+        }
+    }else {
+        for (int h = 0; h < nirrep_; h++) {
+            d2aboff[h] = offset; offset += gems_ab[h]*gems_ab[h];
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            d2aaoff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+        }
+        // with SINGLET_ALIAS_BETA_BLOCKS, the beta-spin blocks are the alpha-spin blocks
+        for (int h = 0; h < nirrep_; h++) {
+            if ( alias_beta_blocks_ ) {
+                d2bboff[h] = d2aaoff[h];
+            }else {
+                d2bboff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+            }
+        }
     }
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        for (int h = 0; h < nirrep_; h++) {
-            d200off[h] = offset; offset += gems_ab[h]*gems_ab[h];
+        if ( !spin_adapt_d2_ ) {
+            for (int h = 0; h < nirrep_; h++) {
+                d200off[h] = offset; offset += gems_ab[h]*gems_ab[h];
+            }
         }
     } else if ( constrain_spin_ ) {
         for (int h = 0; h < nirrep_; h++) {
@@ -632,13 +846,21 @@ void  v2RDMSolver::common_init(){
         d1aoff[h] = offset; offset += amopi_[h]*amopi_[h];
     }
     for (int h = 0; h < nirrep_; h++) {
-        d1boff[h] = offset; offset += amopi_[h]*amopi_[h];
+        if ( alias_beta_blocks_ ) {
+            d1boff[h] = d1aoff[h];
+        }else {
+            d1boff[h] = offset; offset += amopi_[h]*amopi_[h];
+        }
     }
     for (int h = 0; h < nirrep_; h++) {
         q1aoff[h] = offset; offset += amopi_[h]*amopi_[h];
     }
     for (int h = 0; h < nirrep_; h++) {
-        q1boff[h] = offset; offset += amopi_[h]*amopi_[h];
+        if ( alias_beta_blocks_ ) {
+            q1boff[h] = q1aoff[h];
+        }else {
+            q1boff[h] = offset; offset += amopi_[h]*amopi_[h];
+        }
     }
 
     if ( constrain_q2_ ) {
@@ -653,7 +875,11 @@ void  v2RDMSolver::common_init(){
                 q2aaoff[h] = offset; offset += gems_aa[h]*gems_aa[h];
             }
             for (int h = 0; h < nirrep_; h++) {
-                q2bboff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+                if ( alias_beta_blocks_ ) {
+                    q2bboff[h] = q2aaoff[h];
+                }else {
+                    q2bboff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+                }
             }
         }else {
             q2soff = (int*)malloc(nirrep_*sizeof(int));
@@ -670,7 +896,11 @@ void  v2RDMSolver::common_init(){
                 q2toff_p1[h] = offset; offset += gems_aa[h]*gems_aa[h];
             }
             for (int h = 0; h < nirrep_; h++) {
-                q2toff_m1[h] = offset; offset += gems_aa[h]*gems_aa[h];
+                if ( alias_beta_blocks_ ) {
+                    q2toff_m1[h] = q2toff_p1[h];
+                }else {
+                    q2toff_m1[h] = offset; offset += gems_aa[h]*gems_aa[h];
+                }
             }
         }
     }
@@ -772,15 +1002,54 @@ void  v2RDMSolver::common_init(){
             d3bbaoff[h] = offset; offset += trip_aab[h]*trip_aab[h]; // D3bba
         }
     }
+
+    // with SPIN_ADAPT_D2, the D2ab and D2aa blocks the kernels read and write
+    // follow the solver variables.  they are not part of dimx_, and Update_xz
+    // never sees them
+    dimx_unpacked_ = dimx_;
+    if ( spin_adapt_d2_ ) {
+        for (int h = 0; h < nirrep_; h++) {
+            d2aboff[h] = offset; offset += gems_ab[h]*gems_ab[h];
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            d2aaoff[h] = offset; offset += gems_aa[h]*gems_aa[h];
+            d2bboff[h] = d2aaoff[h];
+        }
+        dimx_unpacked_ = offset;
+    }
+
     // constraints:
     nconstraints_ = 0;
 
+    // each family of constraints (and its kernels) starts at a fixed row,
+    // so the kernels never depend on which family ran before them
+    constraint_offset_.assign(NFAMILIES,0);
+    constraint_offset_[FAMILY_D2] = nconstraints_;
+
     if ( constrain_spin_ ) {
         nconstraints_ += 1;               // spin
     }
+    // with reduced constraints, Tr(D2aa) follows from Tr(D2ab) and the
+    // D2ab -> D1a and D2aa -> D1a contractions (as long as nb > 0), and
+    // likewise for Tr(D2bb)
+    int na_act = nalpha_ - nrstc_ - nfrzc_;
+    int nb_act = nbeta_  - nrstc_ - nfrzc_;
+    constrain_trace_aa_ = !reduced_constraints_ || nb_act == 0;
+    constrain_trace_bb_ = !reduced_constraints_ || na_act == 0;
+
+    // with SINGLET_ALIAS_BETA_BLOCKS, every beta-spin constraint duplicates an
+    // alpha-spin one (and D1a = D1b, D2aa = D2bb hold trivially)
+    if ( alias_beta_blocks_ ) {
+        constrain_trace_bb_ = false;
+    }
+
     nconstraints_ += 1;                   // Tr(D2ab)
-    nconstraints_ += 1;                   // Tr(D2aa)
-    nconstraints_ += 1;                   // Tr(D2bb)
+    if ( constrain_trace_aa_ ) {
+        nconstraints_ += 1;               // Tr(D2aa)
+    }
+    if ( constrain_trace_bb_ ) {
+        nconstraints_ += 1;               // Tr(D2bb)
+    }
 
     //for ( int h = 0; h < nirrep_; h++) {
     //    nconstraints_ += gems_ab[h]*gems_ab[h]; // D2ab hermiticity
@@ -791,34 +1060,45 @@ void  v2RDMSolver::common_init(){
     for ( int h = 0; h < nirrep_; h++) {
         nconstraints_ += amopi_[h]*amopi_[h]; // D1a <-> Q1a
     }
-    for ( int h = 0; h < nirrep_; h++) {
-        nconstraints_ += amopi_[h]*amopi_[h]; // D1b <-> Q1b
+    if ( !alias_beta_blocks_ ) {
+        for ( int h = 0; h < nirrep_; h++) {
+            nconstraints_ += amopi_[h]*amopi_[h]; // D1b <-> Q1b
+        }
     }
     for ( int h = 0; h < nirrep_; h++) {
-        nconstraints_ += amopi_[h]*amopi_[h]; // contract D2ab        -> D1 a
+        nconstraints_ += D1ConstraintRows(h); // contract D2ab        -> D1 a
     }
     for ( int h = 0; h < nirrep_; h++) {
-        nconstraints_ += amopi_[h]*amopi_[h]; // contract D2ab        -> D1 b
+        nconstraints_ += D1ConstraintRows(h); // contract D2ab        -> D1 b
     }
     for ( int h = 0; h < nirrep_; h++) {
-        nconstraints_ += amopi_[h]*amopi_[h]; // contract D2aa        -> D1 a
+        nconstraints_ += D1ConstraintRows(h); // contract D2aa        -> D1 a
     }
-    // additional spin constraints for singlets:
+    // additional spin constraints for singlets (with SPIN_ADAPT_D2, D2s and
+    // D2t satisfy them by construction):
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        for ( int h = 0; h < nirrep_; h++) {
-            nconstraints_ += amopi_[h]*amopi_[h]; // D1a = D1b
-        }
-        for ( int h = 0; h < nirrep_; h++) {
-            nconstraints_ += gems_aa[h]*gems_aa[h]; // D2aa = D2bb
+        if ( !alias_beta_blocks_ ) {
+            for ( int h = 0; h < nirrep_; h++) {
+                nconstraints_ += amopi_[h]*amopi_[h]; // D1a = D1b
+            }
+            for ( int h = 0; h < nirrep_; h++) {
+                nconstraints_ += gems_aa[h]*gems_aa[h]; // D2aa = D2bb
+            }
         }
-        for ( int h = 0; h < nirrep_; h++) {
-            nconstraints_ += gems_aa[h]*gems_aa[h]; // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+        if ( !spin_adapt_d2_ ) {
+            for ( int h = 0; h < nirrep_; h++) {
+                nconstraints_ += gems_aa[h]*gems_aa[h]; // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+            }
         }
-        for ( int h = 0; h < nirrep_; h++) {
-            nconstraints_ += gems_aa[h]*gems_aa[h]; // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+        if ( !alias_beta_blocks_ ) {
+            for ( int h = 0; h < nirrep_; h++) {
+                nconstraints_ += gems_aa[h]*gems_aa[h]; // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
+            }
         }
-        for ( int h = 0; h < nirrep_; h++) {
-            nconstraints_ += gems_ab[h]*gems_ab[h];  // D200[pq][rs] = 1/(2 sqrt(1+dpq)sqrt(1+drs))(D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr])
+        if ( !spin_adapt_d2_ ) {
+            for ( int h = 0; h < nirrep_; h++) {
+                nconstraints_ += gems_ab[h]*gems_ab[h];  // D200[pq][rs] = 1/(2 sqrt(1+dpq)sqrt(1+drs))(D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr])
+            }
         }
     }else if ( constrain_spin_ ) { // nonsinglets
         for ( int h = 0; h < nirrep_; h++) {
@@ -826,9 +1106,12 @@ void  v2RDMSolver::common_init(){
         }
     }
 
-    for ( int h = 0; h < nirrep_; h++) {
-        nconstraints_ += amopi_[h]*amopi_[h]; // contract D2bb        -> D1 b
+    if ( !alias_beta_blocks_ ) {
+        for ( int h = 0; h < nirrep_; h++) {
+            nconstraints_ += D1ConstraintRows(h); // contract D2bb        -> D1 b
+        }
     }
+    constraint_offset_[FAMILY_Q2] = nconstraints_;
     if ( constrain_q2_ ) {
         if ( ! spin_adapt_q2_ ) {
             for ( int h = 0; h < nirrep_; h++) {
@@ -837,8 +1120,10 @@ void  v2RDMSolver::common_init(){
             for ( int h = 0; h < nirrep_; h++) {
                 nconstraints_ += gems_aa[h]*gems_aa[h]; // Q2aa
             }
-            for ( int h = 0; h < nirrep_; h++) {
-                nconstraints_ += gems_aa[h]*gems_aa[h]; // Q2bb
+            if ( !alias_beta_blocks_ ) {
+                for ( int h = 0; h < nirrep_; h++) {
+                    nconstraints_ += gems_aa[h]*gems_aa[h]; // Q2bb
+                }
             }
         }else {
             for ( int h = 0; h < nirrep_; h++) {
@@ -850,12 +1135,15 @@ void  v2RDMSolver::common_init(){
             for ( int h = 0; h < nirrep_; h++) {
                 nconstraints_ += gems_aa[h]*gems_aa[h]; // Q2t_p1
             }
-            for ( int h = 0; h < nirrep_; h++) {
-                nconstraints_ += gems_aa[h]*gems_aa[h]; // Q2t_m1
+            if ( !alias_beta_blocks_ ) {
+                for ( int h = 0; h < nirrep_; h++) {
+                    nconstraints_ += gems_aa[h]*gems_aa[h]; // Q2t_m1
+                }
             }
         }
         
     }
+    constraint_offset_[FAMILY_G2] = nconstraints_;
     if ( constrain_g2_ ) {
         if ( ! spin_adapt_g2_ ) {
             for ( int h = 0; h < nirrep_; h++) {
@@ -886,6 +1174,7 @@ void  v2RDMSolver::common_init(){
         //    nconstraints_ += gems_ab[0];
         //}
     }
+    constraint_offset_[FAMILY_T1] = nconstraints_;
     if ( constrain_t1_ ) {
         for (int h = 0; h < nirrep_; h++) {
             nconstraints_ += trip_aaa[h]*trip_aaa[h]; // T1aaa
@@ -900,6 +1189,7 @@ void  v2RDMSolver::common_init(){
             nconstraints_ += trip_aab[h]*trip_aab[h]; // T1bba
         }
     }
+    constraint_offset_[FAMILY_T2] = nconstraints_;
     if ( constrain_t2_ ) {
         for (int h = 0; h < nirrep_; h++) {
             nconstraints_ += (trip_aab[h]+trip_aba[h])*(trip_aab[h]+trip_aba[h]); // T2aaa
@@ -920,6 +1210,7 @@ void  v2RDMSolver::common_init(){
             nconstraints_ += trip_aba[h]*trip_aba[h]; // T2bab
         }
     }
+    constraint_offset_[FAMILY_D3] = nconstraints_;
     if ( constrain_d3_ ) {
         if ( nalpha_ - nrstc_ - nfrzc_ > 2 ) {
             for (int h = 0; h < nirrep_; h++) {
@@ -959,19 +1250,41 @@ void  v2RDMSolver::common_init(){
         }
     }
 
-    // list of dimensions_
-    for (int h = 0; h < nirrep_; h++) {
-        dimensions_.push_back(gems_ab[h]); // D2ab
-    }
-    for (int h = 0; h < nirrep_; h++) {
-        dimensions_.push_back(gems_aa[h]); // D2aa
+    // with MPI, each rank holds a share of the constraint rows (see DistributeRows)
+    DistributedInit();
+    rank_  = DistributedRank();
+    nproc_ = DistributedSize();
+    if ( !DistributedAgree(omp_get_max_threads()) ) {
+        // replicated work must round identically on every rank
+        throw PsiException("all MPI ranks must use the same number of threads",__FILE__,__LINE__);
     }
-    for (int h = 0; h < nirrep_; h++) {
-        dimensions_.push_back(gems_aa[h]); // D2bb
+
+    // list of dimensions_
+    if ( spin_adapt_d2_ ) {
+        for (int h = 0; h < nirrep_; h++) {
+            dimensions_.push_back(gems_00[h]); // D2s
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            dimensions_.push_back(gems_aa[h]); // D2t
+        }
+    }else {
+        for (int h = 0; h < nirrep_; h++) {
+            dimensions_.push_back(gems_ab[h]); // D2ab
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            dimensions_.push_back(gems_aa[h]); // D2aa
+        }
+        if ( !alias_beta_blocks_ ) {
+            for (int h = 0; h < nirrep_; h++) {
+                dimensions_.push_back(gems_aa[h]); // D2bb
+            }
+        }
     }
     if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        for (int h = 0; h < nirrep_; h++) {
-            dimensions_.push_back(gems_ab[h]); // D200
+        if ( !spin_adapt_d2_ ) {
+            for (int h = 0; h < nirrep_; h++) {
+                dimensions_.push_back(gems_ab[h]); // D200
+            }
         }
     }else if ( constrain_spin_ ) {
         for (int h = 0; h < nirrep_; h++) {
@@ -981,14 +1294,18 @@ void  v2RDMSolver::common_init(){
     for (int h = 0; h < nirrep_; h++) {
         dimensions_.push_back(amopi_[h]); // D1a
     }
-    for (int h = 0; h < nirrep_; h++) {
-        dimensions_.push_back(amopi_[h]); // D1b
+    if ( !alias_beta_blocks_ ) {
+        for (int h = 0; h < nirrep_; h++) {
+            dimensions_.push_back(amopi_[h]); // D1b
+        }
     }
     for (int h = 0; h < nirrep_; h++) {
         dimensions_.push_back(amopi_[h]); // Q1a
     }
-    for (int h = 0; h < nirrep_; h++) {
-        dimensions_.push_back(amopi_[h]); // Q1b
+    if ( !alias_beta_blocks_ ) {
+        for (int h = 0; h < nirrep_; h++) {
+            dimensions_.push_back(amopi_[h]); // Q1b
+        }
     }
     if ( constrain_q2_ ) {
         if ( !spin_adapt_q2_ ) {
@@ -998,8 +1315,10 @@ void  v2RDMSolver::common_init(){
             for (int h = 0; h < nirrep_; h++) {
                 dimensions_.push_back(gems_aa[h]); // Q2aa
             }
-            for (int h = 0; h < nirrep_; h++) {
-                dimensions_.push_back(gems_aa[h]); // Q2bb
+            if ( !alias_beta_blocks_ ) {
+                for (int h = 0; h < nirrep_; h++) {
+                    dimensions_.push_back(gems_aa[h]); // Q2bb
+                }
             }
         }else {
             for (int h = 0; h < nirrep_; h++) {
@@ -1011,8 +1330,10 @@ void  v2RDMSolver::common_init(){
             for (int h = 0; h < nirrep_; h++) {
                 dimensions_.push_back(gems_aa[h]); // Q2t_p1
             }
-            for (int h = 0; h < nirrep_; h++) {
-                dimensions_.push_back(gems_aa[h]); // Q2t_m1
+            if ( !alias_beta_blocks_ ) {
+                for (int h = 0; h < nirrep_; h++) {
+                    dimensions_.push_back(gems_aa[h]); // Q2t_m1
+                }
             }
         }
     }
@@ -1091,15 +1412,53 @@ void  v2RDMSolver::common_init(){
         }
     }
 
+    partial_eigensolve_ = options_.get_bool("PARTIAL_EIGENSOLVE");
+    block_npos_.assign(dimensions_.size(),-1);
+
+    // with MPI, the eigensolves are spread over the ranks by their n^3 cost
+    std::vector<double> block_cost;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        double n = dimensions_[i];
+        block_cost.push_back(n*n*n);
+    }
+    block_owner_ = DistributeByCost(block_cost,nproc_);
+
+    // and the rows of A are split into contiguous ranges
+    DistributeRows();
+
+    // size the scratch buffers for the largest block once, up front
+    long int maxblock = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        if ( dimensions_[i] > maxblock ) maxblock = dimensions_[i];
+    }
+    workspace_.reserve(WS_BLOCK_MAT,    maxblock*maxblock*sizeof(double));
+    workspace_.reserve(WS_BLOCK_EVEC,   maxblock*maxblock*sizeof(double));
+    workspace_.reserve(WS_BLOCK_EVEC2,  maxblock*maxblock*sizeof(double));
+    workspace_.reserve(WS_BLOCK_EVAL,   maxblock*sizeof(double));
+    workspace_.reserve(WS_LAPACK_WORK,  26*maxblock*sizeof(double));
+    if ( partial_eigensolve_ ) {
+        workspace_.reserve(WS_LAPACK_IWORK, 10*maxblock*sizeof(int));
+        workspace_.reserve(WS_LAPACK_ISUPPZ, 2*maxblock*sizeof(int));
+    }
+
     // v2rdm sdp convergence thresholds:
     r_convergence_  = options_.get_double("R_CONVERGENCE");
     e_convergence_  = options_.get_double("E_CONVERGENCE");
+    if ( continuation_stage_ ) {
+        r_convergence_ = options_.get_double("CONTINUATION_CONVERGENCE");
+        e_convergence_ = options_.get_double("CONTINUATION_CONVERGENCE");
+    }
     maxiter_        = options_.get_int("MAXITER");
     maxdiis_        = options_.get_int("DIIS_MAX_VECS");
 
     diisvec_   = (double*)malloc(sizeof(double)*(maxdiis_+1));
     memset((void*)diisvec_,'\0',(maxdiis_+1)*sizeof(double));
 
+    workspace_.reserve(WS_DIIS_A,   (maxdiis_+1)*(maxdiis_+1)*sizeof(double));
+    workspace_.reserve(WS_DIIS_B,   (maxdiis_+1)*sizeof(double));
+    workspace_.reserve(WS_DIIS_TEMP, maxdiis_*maxdiis_*sizeof(double));
+    workspace_.reserve(WS_DIIS_IPIV,(maxdiis_+1)*sizeof(long int));
+
     // conjugate gradient solver thresholds:
     cg_convergence_ = options_.get_double("CG_CONVERGENCE");
     cg_maxiter_     = options_.get_double("CG_MAXITER");
@@ -1142,6 +1501,8 @@ void  v2RDMSolver::common_init(){
     outfile->Printf("        cg_convergence:                     %5.3le\n",cg_convergence_);
     outfile->Printf("        maxiter:                             %8i\n",maxiter_);
     outfile->Printf("        cg_maxiter:                          %8i\n",cg_maxiter_);
+    outfile->Printf("        adaptive cg convergence:                %5s\n",options_.get_bool("CG_ADAPTIVE_CONVERGENCE") ? "yes" : "no");
+    outfile->Printf("        cg recycle dimension:                %8i\n",options_.get_int("CG_RECYCLE_DIMENSION"));
     outfile->Printf("\n");
 
     // print orbitals per irrep in each space
@@ -1156,10 +1517,15 @@ void  v2RDMSolver::common_init(){
     outfile->Printf("        Number of frozen virtual orbitals:      %5i\n",nfrzv_);
     outfile->Printf("\n");
 
-    char **labels = reference_wavefunction_->molecule()->irrep_labels();
+    // an FCIDUMP file numbers its irreps but does not name them
+    char **labels = fcidump_ ? NULL : reference_wavefunction_->molecule()->irrep_labels();
     outfile->Printf("        Irrep:           ");
     for (int h = 0; h < nirrep_; h++) {
-        outfile->Printf("%4s",labels[h]);
+        if ( fcidump_ ) {
+            outfile->Printf("%4i",h+1);
+        }else {
+            outfile->Printf("%4s",labels[h]);
+        }
         if ( h < nirrep_ - 1 ) {
             outfile->Printf(",");
         }
@@ -1222,139 +1588,32 @@ void  v2RDMSolver::common_init(){
     outfile->Printf("        number of DIIS vectors:             %5i\n",options_.get_int("ORBOPT_NUM_DIIS_VECTORS"));
     outfile->Printf("        print iteration info:               %5i\n",options_.get_int("ORBOPT_WRITE"));
 // gg
-    
-    outfile->Printf("\n");
-    outfile->Printf("  ==> Memory requirements <==\n");
-    outfile->Printf("\n");
-    int nd2   = 0;
-    int ng2    = 0;
-    int nt1    = 0;
-    int nt2    = 0;
-    int maxgem = 0;
-    for (int h = 0; h < nirrep_; h++) {
-        nd2 +=     gems_ab[h]*gems_ab[h];
-        nd2 += 2 * gems_aa[h]*gems_aa[h];
-
-        ng2 +=     gems_ab[h] * gems_ab[h]; // G2ab
-        ng2 +=     gems_ab[h] * gems_ab[h]; // G2ba
-        ng2 += 4 * gems_ab[h] * gems_ab[h]; // G2aa
-
-        if ( gems_ab[h] > maxgem ) {
-            maxgem = gems_ab[h];
-        }
-        if ( constrain_g2_ ) {
-            if ( 2*gems_ab[h] > maxgem ) {
-                maxgem = 2*gems_ab[h];
-            }
-        }
-
-        if ( constrain_t1_ ) {
-            nt1 += trip_aaa[h] * trip_aaa[h]; // T1aaa
-            nt1 += trip_aaa[h] * trip_aaa[h]; // T1bbb
-            nt1 += trip_aab[h] * trip_aab[h]; // T1aab
-            nt1 += trip_aab[h] * trip_aab[h]; // T1bba
-            if ( trip_aab[h] > maxgem ) {
-                maxgem = trip_aab[h];
-            }
-        }
-
-        if ( constrain_t2_ ) {
-            nt2 += (trip_aab[h]+trip_aba[h]) * (trip_aab[h]+trip_aba[h]); // T2aaa
-            nt2 += (trip_aab[h]+trip_aba[h]) * (trip_aab[h]+trip_aba[h]); // T2bbb
-            nt2 += trip_aab[h] * trip_aab[h]; // T2aab
-            nt2 += trip_aab[h] * trip_aab[h]; // T2bba
-            nt2 += trip_aba[h] * trip_aba[h]; // T2aba
-            nt2 += trip_aba[h] * trip_aba[h]; // T2bab
-
-            if ( trip_aab[h]+trip_aaa[h] > maxgem ) {
-                maxgem = trip_aab[h]+trip_aaa[h];
-            }
-        }
-
-    }
-
-    outfile->Printf("        D2:                       %7.2lf mb\n",nd2 * 8.0 / 1024.0 / 1024.0);
-    if ( constrain_q2_ ) {
-        outfile->Printf("        Q2:                       %7.2lf mb\n",nd2 * 8.0 / 1024.0 / 1024.0);
-    }
-    if ( constrain_g2_ ) {
-        outfile->Printf("        G2:                       %7.2lf mb\n",ng2 * 8.0 / 1024.0 / 1024.0);
-    }
-    if ( constrain_d3_ ) {
-        outfile->Printf("        D3:                       %7.2lf mb\n",nt1 * 8.0 / 1024.0 / 1024.0);
-    }
-    if ( constrain_t1_ ) {
-        outfile->Printf("        T1:                       %7.2lf mb\n",nt1 * 8.0 / 1024.0 / 1024.0);
-    }
-    if ( constrain_t2_ ) {
-        outfile->Printf("        T2:                       %7.2lf mb\n",nt2 * 8.0 / 1024.0 / 1024.0);
-    }
-    outfile->Printf("\n");
-
-    // we have 4 arrays the size of x and 4 the size of y
-    // in addition, we need to store 3 times whatever the largest 
-    // block of x is for the diagonalization step
-    // integrals:
-    //     K2a, K2b
-    // casscf:
-    //     4-index integrals (no permutational symmetry)
-    //     3-index integrals 
-
-    double tot = 4.0*dimx_ + 4.0*nconstraints_ + 3.0*maxgem*maxgem;
-    tot += nd2; // for K2a, K2b
-
-    // for casscf, need d2 and 3- or 4-index integrals
 
-    // storage requirements for full d2
-    for (int h = 0; h < nirrep_; h++) {
-        tot += gems_plus_core[h] * ( gems_plus_core[h] + 1 ) / 2;
-    }
-    if ( is_df_ ) {
-        // storage requirements for df integrals
-        nQ_ = Process::environment.globals["NAUX (SCF)"];
-        if ( options_.get_str("SCF_TYPE") == "DF" ) {
-            boost::shared_ptr<BasisSet> primary = BasisSet::pyconstruct_orbital(molecule_,
-                "BASIS", options_.get_str("BASIS"));
-
-            boost::shared_ptr<BasisSet> auxiliary = BasisSet::pyconstruct_auxiliary(molecule_,
-                "DF_BASIS_SCF", options_.get_str("DF_BASIS_SCF"), "JKFIT",
-                options_.get_str("BASIS"), primary->has_puream());
+    // the background orbital optimizer needs its own copy of the
+    // integrals, so the memory planner may turn it off
+    orbopt_async_ = options_.get_bool("ORBOPT_ASYNC");
 
-            nQ_ = auxiliary->nbf();
-            Process::environment.globals["NAUX (SCF)"] = nQ_;
-        }
-        tot += (long int)nQ_*(long int)nmo_*((long int)nmo_+1)/2;
-    }else {
-        // storage requirements for four-index integrals
-        for (int h = 0; h < nirrep_; h++) {
-            tot += (long int)gems_full[h] * ( (long int)gems_full[h] + 1L ) / 2L;
-        }
-        // for four-index integrals stored stupidly 
-        tot += (long int)nmo_*(long int)nmo_*(long int)nmo_*(long int)nmo_; 
-    }
-    
-    outfile->Printf("        Total number of variables:     %10i\n",dimx_);
-    outfile->Printf("        Total number of constraints:   %10i\n",nconstraints_);
-    outfile->Printf("        Total memory requirements:     %7.2lf mb\n",tot * 8.0 / 1024.0 / 1024.0);
-    outfile->Printf("\n");
+    // a background step finishes at a different iteration on each rank,
+    // and a continuation stage keeps the orbitals fixed
+    if ( nproc_ > 1 || continuation_stage_ ) orbopt_async_ = false;
 
-    if ( tot * 8.0 > (double)memory_ ) {
-        outfile->Printf("\n");
-        outfile->Printf("        Not enough memory!\n");
-        outfile->Printf("\n");
-        if ( !is_df_ ) {
-            outfile->Printf("        Either increase the available memory by %7.2lf mb\n",(8.0 * tot - memory_)/1024.0/1024.0);
-            outfile->Printf("        or try scf_type = df or scf_type = cd\n");
-        
-        }else {
-            outfile->Printf("        Increase the available memory by %7.2lf mb.\n",(8.0 * tot - memory_)/1024.0/1024.0);
-        }
-        outfile->Printf("\n");
-        throw PsiException("Not enough memory",__FILE__,__LINE__);
-    }
+    // size every phase of the computation and choose in-core or
+    // batched algorithms before anything large is allocated
+    PlanMemory();
 
     // if using 3-index integrals, transform them before allocating any memory integrals, transform 
-    if ( is_df_ ) {
+    tei_full_sym_ = NULL;
+    if ( integral_donor_ ) {
+        // the integrals were transformed for another state over the same
+        // orbitals.  3-index integrals are shared with it (see GetIntegrals
+        // for 4-index integrals) until either solver rotates its orbitals.
+        if ( is_df_ ) {
+            tei_buffer_ = integral_donor_->SharedIntegrals();
+            Qmo_        = tei_buffer_.get();
+        }
+    } else if ( fcidump_ ) {
+        // the integrals are already in the orbital basis
+    } else if ( is_df_ ) {
         outfile->Printf("    ==> Transform three-electron integrals <==\n");
         outfile->Printf("\n");
 
@@ -1379,6 +1638,9 @@ void  v2RDMSolver::common_init(){
         ints->set_keep_iwl_so_ints(true);
         ints->set_keep_dpd_so_ints(true);
         ints->initialize();
+        // the orbitals of this solver (after a scan projection or frozen
+        // natural orbital truncation) rather than those of the reference
+        ints->set_orbitals(Ca_);
         ints->transform_tei(MOSpace::all, MOSpace::all, MOSpace::all, MOSpace::all);
         double end = omp_get_wtime();
         outfile->Printf("\n");
@@ -1387,20 +1649,65 @@ void  v2RDMSolver::common_init(){
     
     }
 
-    // allocate vectors
-    Ax     = SharedVector(new Vector("A . x",nconstraints_));
-    ATy    = SharedVector(new Vector("A^T . y",dimx_));
-    x      = SharedVector(new Vector("primal solution",dimx_));
-    c      = SharedVector(new Vector("OEI and TEI",dimx_));
-    y      = SharedVector(new Vector("dual solution",nconstraints_));
-    z      = SharedVector(new Vector("dual solution 2",dimx_));
-    b      = SharedVector(new Vector("constraints",nconstraints_));
+    // allocate vectors.  the row-space vectors (A.x, y, b) hold only this
+    // rank's rows; the primal-space vectors are replicated
+    Ax     = SharedSolverVector(new SolverVector("A . x",nrow_local_));
+    ATy    = SharedSolverVector(new SolverVector("A^T . y",dimx_unpacked_));
+    x      = SharedSolverVector(new SolverVector("primal solution",dimx_unpacked_));
+    c      = SharedSolverVector(new SolverVector("OEI and TEI",dimx_unpacked_));
+    y      = SharedSolverVector(new SolverVector("dual solution",nrow_local_));
+    z      = SharedSolverVector(new SolverVector("dual solution 2",dimx_unpacked_));
+    b      = SharedSolverVector(new SolverVector("constraints",nrow_local_));
+
+    // none of the pages has been touched yet.  place them before the
+    // threaded kernels do: the primal-space vectors block by block, as the
+    // constraint kernels loop over them, and the row-space vectors as one
+    // range
+    std::vector<int> primal_blocks = dimensions_;
+    if ( spin_adapt_d2_ ) {
+        for (int h = 0; h < nirrep_; h++) {
+            primal_blocks.push_back(gems_ab[h]); // D2ab (unpacked)
+        }
+        for (int h = 0; h < nirrep_; h++) {
+            primal_blocks.push_back(gems_aa[h]); // D2aa (unpacked)
+        }
+    }
+    vector_placement_ = VectorPlacementFromString(options_.get_str("VECTOR_PLACEMENT"));
+    Ax->Place(vector_placement_);
+    ATy->Place(vector_placement_,primal_blocks);
+    x->Place(vector_placement_,primal_blocks);
+    c->Place(vector_placement_,primal_blocks);
+    y->Place(vector_placement_);
+    z->Place(vector_placement_,primal_blocks);
+    b->Place(vector_placement_);
+
+    // last A.x and A^T.y, reused while x and y are unchanged
+    Ax_cache_  = SharedSolverVector(new SolverVector("A . x (cached)",nrow_local_));
+    ATy_cache_ = SharedSolverVector(new SolverVector("A^T . y (cached)",dimx_unpacked_));
+    Ax_cache_->Place(vector_placement_);
+    ATy_cache_->Place(vector_placement_,primal_blocks);
+    x_stamp_         = 0;
+    y_stamp_         = 0;
+    c_stamp_         = 0;
+    Ax_cache_stamp_  = -1;
+    ATy_cache_stamp_ = -1;
+
+    // A(c-z), evaluated alongside A.x at the end of each iteration
+    // not with MPI: the ranks would see the collectives of the two products in any order
+    concurrent_residuals_ = options_.get_bool("CONCURRENT_RESIDUALS") && nproc_ == 1;
+    Acz_cache_x_stamp_    = -1;
+    Acz_cache_c_stamp_    = -1;
+    if ( concurrent_residuals_ ) {
+        Acz_cache_ = SharedSolverVector(new SolverVector("A . (c - z) (cached)",nrow_local_));
+        Acz_cache_->Place(vector_placement_);
+    }
+    operator_reuse_total_ = 0;
 
     // DIIS stuff
-    //rx       = SharedVector(new Vector("diis x",dimx_));
-    //rz       = SharedVector(new Vector("diis z",dimx_));
-    //rx_error = SharedVector(new Vector("diis error x",dimx_));
-    //rz_error = SharedVector(new Vector("diis error z",dimx_));
+    //rx       = SharedSolverVector(new SolverVector("diis x",dimx_));
+    //rz       = SharedSolverVector(new SolverVector("diis z",dimx_));
+    //rx_error = SharedSolverVector(new SolverVector("diis error x",dimx_));
+    //rz_error = SharedSolverVector(new SolverVector("diis error z",dimx_));
     //junk1    = (double*)malloc(2 * dimx_*sizeof(double));
     //junk2    = (double*)malloc(2 * dimx_*sizeof(double));
 
@@ -1412,7 +1719,7 @@ void  v2RDMSolver::common_init(){
         nthread = omp_get_max_threads();
     #endif
 
-    orbopt_data_    = (double*)malloc(14*sizeof(double));
+    orbopt_data_    = (double*)malloc(15*sizeof(double));
     orbopt_data_[0] = (double)nthread;
     orbopt_data_[1] = (double)options_.get_bool("ORBOPT_ACTIVE_ACTIVE_ROTATIONS");
     orbopt_data_[2] = (double)nfrzc_; //(double)options_.get_int("ORBOPT_FROZEN_CORE");
@@ -1430,8 +1737,28 @@ void  v2RDMSolver::common_init(){
     orbopt_data_[11] = 0.0;  // gradient norm (output)
     orbopt_data_[12] = 0.0;  // change in energy (output)
     orbopt_data_[13] = 0.0;  // converged?
+    orbopt_data_[14] = (double)options_.get_bool("ORBOPT_DIRECT_DENSITY"); // density already in optimizer order?
     orbopt_converged_ = false;
 
+    // background orbital optimization.  by default, split the threads evenly
+    // between the orbital optimizer and the SDP solver
+    orbopt_async_threads_ = options_.get_int("ORBOPT_ASYNC_THREADS");
+    if ( orbopt_async_threads_ < 1 ) {
+        orbopt_async_threads_ = ( nthread > 1 ) ? nthread / 2 : 1;
+    }
+    orbopt_sdp_threads_   = ( nthread - orbopt_async_threads_ > 1 ) ? nthread - orbopt_async_threads_ : 1;
+    orbopt_thread_        = NULL;
+    orbopt_async_done_    = false;
+    orbopt_async_oei_     = NULL;
+    orbopt_async_tei_     = NULL;
+    orbopt_async_transformation_matrix_ = NULL;
+    orbopt_async_data_    = NULL;
+    orbopt_async_d1_      = NULL;
+    orbopt_async_d2_      = NULL;
+    orbopt_async_start_iter_    = 0;
+    orbopt_async_time_          = 0.0;
+    orbopt_async_overlap_total_ = 0;
+
     orbopt_transformation_matrix_ = (double*)malloc((nmo_-nfrzc_-nfrzv_)*(nmo_-nfrzc_-nfrzv_)*sizeof(double));
     memset((void*)orbopt_transformation_matrix_,'\0',(nmo_-nfrzc_-nfrzv_)*(nmo_-nfrzc_-nfrzv_)*sizeof(double));
     for (int i = 0; i < nmo_-nfrzc_-nfrzv_; i++) {
@@ -1440,7 +1767,8 @@ void  v2RDMSolver::common_init(){
 
     // don't change the length of this filename
     orbopt_outfile_ = (char*)malloc(120*sizeof(char));
-    std::string filename = get_writer_file_prefix(reference_wavefunction_->molecule()->name()) + ".orbopt";
+    std::string prefix = fcidump_ ? std::string("fcidump") : get_writer_file_prefix(reference_wavefunction_->molecule()->name());
+    std::string filename = prefix + ".orbopt";
     strcpy(orbopt_outfile_,filename.c_str());
     if ( options_.get_bool("ORBOPT_WRITE") ) { 
         FILE * fp = fopen(orbopt_outfile_,"w");
@@ -1456,19 +1784,29 @@ void  v2RDMSolver::common_init(){
     oiter_time_        = 0.0;
     orbopt_time_       = 0.0;
 
-}
+    continuation_oiter_ = 0;
+    continuation_iiter_ = 0;
+    continuation_time_  = 0.0;
 
-int v2RDMSolver::SymmetryPair(int i,int j) {
-    return table[i*8+j];
-}
-int v2RDMSolver::TotalSym(int i,int j,int k, int l) {
-    return SymmetryPair(SymmetryPair(symmetry[i],symmetry[j]),SymmetryPair(symmetry[k],symmetry[l]));
 }
 
 // compute the energy!
 double v2RDMSolver::compute_energy() {
 
-    double start_total_time = omp_get_wtime();
+    InitializeBPSDP();
+
+    do {
+
+        BPSDPIteration();
+
+    }while( !BPSDPBookkeeping() );
+
+    return FinalizeBPSDP();
+}
+
+void v2RDMSolver::InitializeBPSDP() {
+
+    start_total_time_ = omp_get_wtime();
 
     // hartree-fock guess
     Guess();
@@ -1481,19 +1819,35 @@ double v2RDMSolver::compute_energy() {
 
     // AATy = A(c-z)+tu(b-Ax) rearange w.r.t cg solver
     // Ax   = AATy and b=A(c-z)+tu(b-Ax)
-    SharedVector B   = SharedVector(new Vector("compound B",nconstraints_));
+    B_ = SharedSolverVector(new SolverVector("compound B",nrow_local_));
+    B_->Place(vector_placement_);
 
     tau = 1.6;
     mu  = 1.0;
 
-    // congugate gradient solver
-    long int N = nconstraints_;
-    shared_ptr<CGSolver> cg (new CGSolver(N));
-    cg->set_max_iter(cg_maxiter_);
-    cg->set_convergence(cg_convergence_);
+    // primal/dual solutions and mu from the previous point of a scan
+    ReadScanSolution();
+
+    // or from a converged 2-positivity stage
+    ReadContinuationSolution();
+
+    // congugate gradient solver (on this rank's rows)
+    long int N = nrow_local_;
+    cg_ = boost::shared_ptr<CGSolver>(new CGSolver(N));
+    cg_->set_max_iter(cg_maxiter_);
+    cg_->set_convergence(cg_convergence_);
+    cg_->set_recycle_dimension(options_.get_int("CG_RECYCLE_DIMENSION"));
+
+    // forcing term for the inexact inner solves: || AATy - B || < cg_eta * min(ep,ed)
+    adaptive_cg_    = options_.get_bool("CG_ADAPTIVE_CONVERGENCE");
+    cg_eta_         = 0.01;
+    last_residual_  = 0.0;
+    average_iiter_  = 0.0;
 
     // checkpoint file
-    if ( options_["RESTART_FROM_CHECKPOINT_FILE"].has_changed() ) {
+    if ( continuation_stage_ ) {
+        // the checkpoint file belongs to the full problem
+    } else if ( options_["RESTART_FROM_CHECKPOINT_FILE"].has_changed() ) {
         outfile->Printf("\n");
         outfile->Printf("    ==> Restarting from checkpoint file <==\n");
         ReadFromCheckpointFile();
@@ -1501,13 +1855,17 @@ double v2RDMSolver::compute_energy() {
         InitializeCheckpointFile();
     }
 
+    // x and y come from the guess, a previous scan point, or a checkpoint
+    x_stamp_++;
+    y_stamp_++;
+
     // evaluate guess energy (c.x):
-    double energy_primal = C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
+    energy_primal_ = PrimalEnergy();
 
     outfile->Printf("\n");
     outfile->Printf("    reference energy:     %20.12lf\n",escf_);
     outfile->Printf("    frozen core energy:   %20.12lf\n",efzc_);
-    outfile->Printf("    initial 2-RDM energy: %20.12lf\n",energy_primal + enuc_ + efzc_);
+    outfile->Printf("    initial 2-RDM energy: %20.12lf\n",energy_primal_ + enuc_ + efzc_);
     outfile->Printf("\n");
     outfile->Printf("      oiter");
     outfile->Printf(" iiter");
@@ -1518,149 +1876,286 @@ double v2RDMSolver::compute_energy() {
     outfile->Printf("     eps(p)");
     outfile->Printf("     eps(d)\n");
 
-    double energy_dual,egap;
-    double denergy_primal = fabs(energy_primal);
+    denergy_primal_ = fabs(energy_primal_);
 
-    int checkpoint_frequency = options_.get_int("ORBOPT_FREQUENCY");
+    checkpoint_frequency_ = options_.get_int("ORBOPT_FREQUENCY");
     if ( options_["CHECKPOINT_FREQUENCY"].has_changed() ) {
-        checkpoint_frequency = options_.get_int("CHECKPOINT_FREQUENCY");
+        checkpoint_frequency_ = options_.get_int("CHECKPOINT_FREQUENCY");
     }
-    int mu_update_frequency  = options_.get_int("MU_UPDATE_FREQUENCY");
-    int orbopt_frequency     = options_.get_int("ORBOPT_FREQUENCY");
-    int orbopt_one_step      = options_.get_int("ORBOPT_ONE_STEP");
+    mu_update_frequency_  = options_.get_int("MU_UPDATE_FREQUENCY");
+    orbopt_frequency_     = options_.get_int("ORBOPT_FREQUENCY");
+    orbopt_one_step_      = options_.get_int("ORBOPT_ONE_STEP");
 
-    int oiter=0;
+    adaptive_schedule_        = options_.get_bool("ADAPTIVE_SCHEDULE");
+    adaptive_mu_ratio_        = options_.get_double("ADAPTIVE_MU_RATIO");
+    adaptive_orbopt_fraction_ = options_.get_double("ADAPTIVE_ORBOPT_FRACTION");
+    adaptive_min_interval_    = options_.get_int("ADAPTIVE_MIN_INTERVAL");
+    last_mu_update_           = 0;
+    last_orbopt_step_         = 0;
 
-    diis_oiter_           = 0;
-    int diis_iter         = 0;
-    int replace_diis_iter = 1;
+    oiter_ = 0;
 
-    do {
+    diis_oiter_        = 0;
+    diis_iter_         = 0;
+    replace_diis_iter_ = 1;
+}
 
-        double start = omp_get_wtime();
+void v2RDMSolver::BPSDPIteration() {
 
-        // evaluate tau * mu * (b - Ax) for CG
-        bpsdp_Au(Ax, x);
-        Ax->subtract(b);
-        Ax->scale(-tau*mu);
-        
-        // evaluate A(c-z) ( but don't overwrite c! )
+    long int N = nrow_local_;
+
+    double start = omp_get_wtime();
+
+    // evaluate tau * mu * (b - Ax) for CG.  A.x is left over from the
+    // residual at the end of the last iteration
+    bpsdp_Ax(Ax);
+    Ax->subtract(b);
+    Ax->scale(-tau*mu);
+    
+    // evaluate A(c-z) ( but don't overwrite c! ).  with CONCURRENT_RESIDUALS,
+    // it was evaluated alongside A.x at the end of the last iteration
+    if ( Acz_cache_x_stamp_ == x_stamp_ && Acz_cache_c_stamp_ == c_stamp_ ) {
+        C_DCOPY(nrow_local_,Acz_cache_->pointer(),1,B_->pointer(),1);
+    }else {
         z->scale(-1.0);
         z->add(c);
-        bpsdp_Au(B,z);
-        
-        // add tau*mu*(b-Ax) to A(c-z) and put result in B
-        B->add(Ax);
-        // solve CG problem (step 1 in table 1 of PRL 106 083001)
-        if (oiter == 0) cg->set_convergence(0.01);
-        else            cg->set_convergence( ( ep > ed ) ? 0.01 * ed : 0.01 * ep);
-        cg->solve(N,Ax,y,B,evaluate_Ap,(void*)this);
-        int iiter = cg->total_iterations();
+        bpsdp_Au(B_,z);
+    }
+    
+    // add tau*mu*(b-Ax) to A(c-z) and put result in B
+    B_->add(Ax);
+    // solve CG problem (step 1 in table 1 of PRL 106 083001)
+    if (oiter_ == 0) cg_->set_convergence(0.01);
+    else             cg_->set_convergence( ( ep > ed ) ? cg_eta_ * ed : cg_eta_ * ep);
+    if ( adaptive_cg_ && oiter_ > 0 ) cg_->set_max_iter( InnerIterationBound() );
+    cg_->solve(N,Ax,y,B_,evaluate_Ap,(void*)this);
+    iiter_ = cg_->total_iterations();
+    y_stamp_++;
 
-        double end = omp_get_wtime();
+    double end = omp_get_wtime();
 
-        iiter_time_  += end - start;
-        iiter_total_ += iiter;
+    iiter_time_  += end - start;
+    iiter_total_ += iiter_;
 
-        start = omp_get_wtime();
+    start = omp_get_wtime();
 
-        // update primal and dual solutions
-        Update_xz();
+    // update primal and dual solutions
+    Update_xz();
+    x_stamp_++;
 
-        end = omp_get_wtime();
+    end = omp_get_wtime();
 
-        oiter_time_ += end - start;
-        oiter_total_++;
+    oiter_time_ += end - start;
+    oiter_total_++;
 
-        // update mu (step 3)
+    // update mu (step 3)
 
-        // evaluate || A^T y - c + z||
-        bpsdp_ATu(ATy, y);
-        ATy->add(z);
-        ATy->subtract(c);
-        ed = sqrt(ATy->norm());
-        
-        // evaluate || Ax - b ||
-        bpsdp_Au(Ax, x);
-        Ax->subtract(b);
-        ep = sqrt(Ax->norm());
+    // evaluate || A^T y - c + z||.  A^T.y was already built in Update_xz
+    // with MPI, each rank holds the finished blocks it diagonalized
+    bpsdp_ATy(ATy);
+    ATy->add(z);
+    ATy->subtract(c);
+    double * ATy_p = ATy->pointer();
+    double ed2 = 0.0;
+    long int myoffset = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        long int n2 = (long int)dimensions_[i] * dimensions_[i];
+        if ( block_owner_[i] == rank_ ) {
+            ed2 += C_DDOT(n2,ATy_p+myoffset,1,ATy_p+myoffset,1);
+        }
+        myoffset += n2;
+    }
+    DistributedSum(&ed2,1);
+    ed = sqrt(ed2);
+    
+    // A.x and A(c-z) for the next iteration only depend on the new x and z
+    // (and c, which may still change with the orbitals), so they can be
+    // evaluated at the same time.  ATy is free as scratch for c-z
+    if ( concurrent_residuals_ ) {
+        C_DCOPY(dimx_,c->pointer(),1,ATy->pointer(),1);
+        C_DAXPY(dimx_,-1.0,z->pointer(),1,ATy->pointer(),1);
+
+        std::vector<SharedSolverVector> A;
+        std::vector<SharedSolverVector> u;
+        A.push_back(Ax_cache_);
+        A.push_back(Acz_cache_);
+        u.push_back(x);
+        u.push_back(ATy);
+        bpsdp_Au_concurrent(A,u);
+
+        Ax_cache_stamp_    = x_stamp_;
+        Acz_cache_x_stamp_ = x_stamp_;
+        Acz_cache_c_stamp_ = c_stamp_;
+    }
+
+    // evaluate || Ax - b ||
+    bpsdp_Ax(Ax);
+    Ax->subtract(b);
+    double ep2 = C_DDOT(nrow_local_,Ax->pointer(),1,Ax->pointer(),1);
+    DistributedSum(&ep2,1);
+    ep = sqrt(ep2);
+}
 
-        // don't update mu every iteration
-        if ( oiter % mu_update_frequency == 0 && oiter > 0) {
-            mu = mu*ep/ed;
+// with CG_ADAPTIVE_CONVERGENCE, the forcing term also bounds the work of an
+// inner solve.  a solve may take twice the recent average number of cg
+// iterations, scaled by the number of digits the forcing term asks for
+// relative to its starting value (0.01), and never more than CG_MAXITER.
+// a solve cut short leaves a larger residual, which shows up as poor
+// progress in the outer iterations, tightens the forcing term, and so
+// raises the bound again
+int v2RDMSolver::InnerIterationBound() {
+    double digits = log(cg_eta_) / log(0.01);
+    int bound = (int)ceil(2.0 * average_iiter_ * digits);
+    if ( bound < 20 ) bound = 20;
+    return ( bound < cg_maxiter_ ) ? bound : cg_maxiter_;
+}
 
-            // reset DIIS
-            diis_oiter_       = 0;
-            diis_iter         = 0;
-            replace_diis_iter = 1;
+// c.x.  with MPI, each rank holds up-to-date blocks of x only for the blocks
+// it diagonalizes, so the dot product is summed over those
+double v2RDMSolver::PrimalEnergy() {
+    if ( nproc_ == 1 ) {
+        return C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
+    }
+    double * c_p = c->pointer();
+    double * x_p = x->pointer();
+    double energy = 0.0;
+    long int myoffset = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        long int n2 = (long int)dimensions_[i] * dimensions_[i];
+        if ( block_owner_[i] == rank_ ) {
+            energy += C_DDOT(n2,c_p+myoffset,1,x_p+myoffset,1);
+        }
+        myoffset += n2;
+    }
+    DistributedSum(&energy,1);
+    return energy;
+}
 
+bool v2RDMSolver::BPSDPBookkeeping() {
+
+    // safe point: pick up the integrals from a finished background orbital step
+    if ( orbopt_async_ && FinishAsyncRotateOrbitals(false) ) {
+        // reset DIIS
+        diis_oiter_        = 0;
+        diis_iter_         = 0;
+        replace_diis_iter_ = 1;
+    }
+
+    // adapt the forcing term to the ratio of cg work to primal/dual progress
+    double residual = ( ep > ed ) ? ep : ed;
+    if ( adaptive_cg_ && oiter_ > 0 && oiter_ - last_mu_update_ != 1 ) {
+        double progress = last_residual_ / residual;
+        if ( progress < 1.0 ) {
+            // residuals grew: the inner solves are too loose
+            cg_eta_ = ( 0.5 * cg_eta_ > 1e-4 ) ? 0.5 * cg_eta_ : 1e-4;
+        }else if ( iiter_ > 2.0 * average_iiter_ && progress < 1.1 ) {
+            // lots of cg work for little progress: the inner solves are too tight
+            cg_eta_ = ( 2.0 * cg_eta_ < 0.1 ) ? 2.0 * cg_eta_ : 0.1;
         }
+    }
+    last_residual_ = residual;
+    average_iiter_ = ( oiter_ == 0 ) ? iiter_ : 0.9 * average_iiter_ + 0.1 * iiter_;
 
-        // compute current primal and dual energies
-        double current_energy = C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
-        energy_dual   = C_DDOT(nconstraints_,b->pointer(),1,y->pointer(),1);
+    // don't update mu every iteration
+    if ( MuUpdateDue() ) {
+        mu = mu*ep/ed;
 
-        if ( options_.get_bool("OPTIMIZE_ORBITALS") ) {
-            if ( orbopt_one_step == 1 && oiter % orbopt_frequency == 0 && oiter > 0 && current_energy+enuc_+efzc_ < escf_ ) {
+        // reset DIIS
+        diis_oiter_        = 0;
+        diis_iter_         = 0;
+        replace_diis_iter_ = 1;
 
-                start = omp_get_wtime();
-                RotateOrbitals();
-                end = omp_get_wtime();
+    }
 
-                orbopt_time_      += end - start;
-                orbopt_iter_total_++;
+    // compute current primal and dual energies
+    double current_energy = PrimalEnergy();
+    energy_dual_  = C_DDOT(nrow_local_,b->pointer(),1,y->pointer(),1);
+    DistributedSum(&energy_dual_,1);
 
-                // reset DIIS
-                diis_oiter_       = 0;
-                diis_iter         = 0;
-                replace_diis_iter = 1;
+    if ( options_.get_bool("OPTIMIZE_ORBITALS") && !continuation_stage_ ) {
+        if ( orbopt_one_step_ == 1 && orbopt_async_ && OrbitalStepDue(current_energy) ) {
 
-                // compute current primal and dual energies
-                current_energy = C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
-                energy_dual   = C_DDOT(nconstraints_,b->pointer(),1,y->pointer(),1);
-            }
-        }else {
-            orbopt_converged_ = true;
-        }
+            // leave the SDP running on the current integrals
+            StartAsyncRotateOrbitals();
 
+        }else if ( orbopt_one_step_ == 1 && !orbopt_async_ && OrbitalStepDue(current_energy) ) {
 
-        //energy_primal = C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
+            double start = omp_get_wtime();
+            RotateOrbitals();
+            double end = omp_get_wtime();
 
+            orbopt_time_      += end - start;
+            orbopt_iter_total_++;
+
+            // reset DIIS
+            diis_oiter_        = 0;
+            diis_iter_         = 0;
+            replace_diis_iter_ = 1;
+
+            // compute current primal and dual energies
+            current_energy = PrimalEnergy();
+            energy_dual_  = C_DDOT(nrow_local_,b->pointer(),1,y->pointer(),1);
+            DistributedSum(&energy_dual_,1);
+        }
+    }else {
+        orbopt_converged_ = true;
+    }
 
-        outfile->Printf("      %5i %5i %11.6lf %11.6lf %11.6lf %7.3lf %10.5lf %10.5lf\n",
-                    oiter,iiter,current_energy+enuc_+efzc_,energy_dual+efzc_+enuc_,fabs(current_energy-energy_dual),mu,ep,ed);
-        oiter++;
-    
-        if (oiter == maxiter_) break;
 
-        egap = fabs(current_energy-energy_dual);
-        denergy_primal = fabs(energy_primal - current_energy);
-        energy_primal = current_energy;
+    //energy_primal = C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
 
-        if ( options_.get_bool("OPTIMIZE_ORBITALS") ) {
-            if ( ep < r_convergence_ && ed < r_convergence_ && egap < e_convergence_ ) {
 
-                start = omp_get_wtime();
-                RotateOrbitals();
-                end = omp_get_wtime();
+    outfile->Printf("      %5i %5i %11.6lf %11.6lf %11.6lf %7.3lf %10.5lf %10.5lf\n",
+                oiter_,iiter_,current_energy+enuc_+efzc_,energy_dual_+efzc_+enuc_,fabs(current_energy-energy_dual_),mu,ep,ed);
+    oiter_++;
 
-                orbopt_time_      += end - start;
-                orbopt_iter_total_++;
+    if (oiter_ == maxiter_) {
+        throw PsiException("v2RDM did not converge.",__FILE__,__LINE__);
+    }
+
+    egap_ = fabs(current_energy-energy_dual_);
+    denergy_primal_ = fabs(energy_primal_ - current_energy);
+    energy_primal_ = current_energy;
+
+    if ( options_.get_bool("OPTIMIZE_ORBITALS") && !continuation_stage_ ) {
+        if ( ep < r_convergence_ && ed < r_convergence_ && egap_ < e_convergence_ ) {
 
-                energy_primal = C_DDOT(dimx_,c->pointer(),1,x->pointer(),1);
+            // the final orbital step must see the converged density
+            if ( orbopt_async_ ) {
+                FinishAsyncRotateOrbitals(true);
             }
-        }else {
-            orbopt_converged_ = true;
-        }
 
-        if ( options_.get_bool("WRITE_CHECKPOINT_FILE") && oiter % options_.get_int("CHECKPOINT_FREQUENCY") == 0 && oiter > 0) {
-            WriteCheckpointFile();
+            double start = omp_get_wtime();
+            RotateOrbitals();
+            double end = omp_get_wtime();
+
+            orbopt_time_      += end - start;
+            orbopt_iter_total_++;
+
+            energy_primal_ = PrimalEnergy();
         }
+    }else {
+        orbopt_converged_ = true;
+    }
+
+    if ( options_.get_bool("WRITE_CHECKPOINT_FILE") && !continuation_stage_ && oiter_ % options_.get_int("CHECKPOINT_FREQUENCY") == 0 && oiter_ > 0) {
+        WriteCheckpointFile();
+    }
 
-    }while( ep > r_convergence_ || ed > r_convergence_  || egap > e_convergence_ || !orbopt_converged_);
+    bool converged = !( ep > r_convergence_ || ed > r_convergence_  || egap_ > e_convergence_ || !orbopt_converged_ );
 
-    if ( oiter == maxiter_ ) {
-        throw PsiException("v2RDM did not converge.",__FILE__,__LINE__);
+    // whoever picks up the solution (the analysis, a later continuation
+    // stage) reads all of x and z
+    if ( converged ) {
+        BroadcastBlocksFromOwners();
+    }
+    return converged;
+}
+
+double v2RDMSolver::FinalizeBPSDP() {
+
+    if ( orbopt_async_ ) {
+        FinishAsyncRotateOrbitals(true);
     }
 
     outfile->Printf("\n");
@@ -1682,14 +2177,23 @@ double v2RDMSolver::compute_energy() {
     int nb = nbeta_ - nfrzc_ - nrstc_;
     int ms = (multiplicity_ - 1)/2;
     outfile->Printf("      v2RDM total spin [S(S+1)]: %20.6lf\n", 0.5 * (na + nb) + ms*ms - s2);
-    outfile->Printf("    * v2RDM total energy:        %20.12lf\n",energy_primal+enuc_+efzc_);
+    outfile->Printf("    * v2RDM total energy:        %20.12lf\n",energy_primal_+enuc_+efzc_);
     outfile->Printf("\n");
 
-    Process::environment.globals["CURRENT ENERGY"]     = energy_primal+enuc_+efzc_;
-    Process::environment.globals["v2RDM TOTAL ENERGY"] = energy_primal+enuc_+efzc_;
+    Process::environment.globals["CURRENT ENERGY"]     = energy_primal_+enuc_+efzc_;
+    Process::environment.globals["v2RDM TOTAL ENERGY"] = energy_primal_+enuc_+efzc_;
+    Process::environment.globals["v2RDM MICROITERATIONS"] = (double)iiter_total_;
+    Process::environment.globals["v2RDM MACROITERATIONS"] = (double)oiter_total_;
+    Process::environment.globals["v2RDM CONSTRAINTS"]     = (double)nconstraints_;
+
+    // keep this solution to start the next point of a scan
+    if ( options_.get_bool("SCAN_WARM_START") && !integral_donor_ && !fcidump_ ) {
+        SaveScanState();
+    }
 
     // push final transformation matrix onto Ca_ and Cb_
-    if ( options_.get_bool("SEMICANONICALIZE_ORBITALS") ) {
+    // (the orbitals of an FCIDUMP hamiltonian are left as given)
+    if ( options_.get_bool("SEMICANONICALIZE_ORBITALS") && !fcidump_ ) {
         orbopt_data_[8] = -1.0;
         RotateOrbitals();
     }
@@ -1697,14 +2201,28 @@ double v2RDMSolver::compute_energy() {
 
     // write tpdm to disk?
     if ( options_.get_bool("TPDM_WRITE") ) {
-        WriteActiveTPDM();
+        if ( options_.get_str("RDM_WRITE_FORMAT") == "BLOCKED" ) {
+            WriteBlockedTPDM();
+            if ( options_.get_bool("RDM_WRITE_CHECK") ) {
+                CheckBlockedTPDM();
+            }
+        }else {
+            WriteActiveTPDM();
+        }
     }
     if ( options_.get_bool("TPDM_WRITE_FULL") ) {
         WriteTPDM();
     }
     // write 3-particle density matrix to disk?
     if ( options_.get_bool("3PDM_WRITE") && options_.get_bool("CONSTRAIN_D3")) {
-        WriteActive3PDM();
+        if ( options_.get_str("RDM_WRITE_FORMAT") == "BLOCKED" ) {
+            WriteBlocked3PDM();
+            if ( options_.get_bool("RDM_WRITE_CHECK") ) {
+                CheckBlocked3PDM();
+            }
+        }else {
+            WriteActive3PDM();
+        }
         //Read3PDM();
     }
 
@@ -1720,18 +2238,37 @@ double v2RDMSolver::compute_energy() {
     outfile->Printf("      Microiterations:            %12li\n",iiter_total_);
     outfile->Printf("      Macroiterations:            %12li\n",oiter_total_);
     outfile->Printf("      Orbital optimization steps: %12li\n",orbopt_iter_total_);
+    if ( orbopt_async_ ) {
+        outfile->Printf("      Overlapped macroiterations: %12li\n",orbopt_async_overlap_total_);
+    }
+    outfile->Printf("      Reused A.x / A^T.y products: %11li\n",operator_reuse_total_);
+    if ( continuation_oiter_ > 0 ) {
+        outfile->Printf("      Warm start macroiterations: %12li\n",continuation_oiter_);
+        outfile->Printf("      Warm start microiterations: %12li\n",continuation_iiter_);
+    }
     outfile->Printf("\n");
     outfile->Printf("  ==> Wall time <==\n");
     outfile->Printf("\n");
     outfile->Printf("      Microiterations:            %12.2lf s\n",iiter_time_);
     outfile->Printf("      Macroiterations:            %12.2lf s\n",oiter_time_);
     outfile->Printf("      Orbital optimization:       %12.2lf s\n",orbopt_time_);
-    outfile->Printf("      Total:                      %12.2lf s\n",end_total_time - start_total_time);
+    if ( orbopt_async_ ) {
+        outfile->Printf("      Orbital optimization (bg):  %12.2lf s\n",orbopt_async_time_);
+    }
+    if ( continuation_oiter_ > 0 ) {
+        outfile->Printf("      2-positivity warm start:    %12.2lf s\n",continuation_time_);
+    }
+    outfile->Printf("      Total:                      %12.2lf s\n",end_total_time - start_total_time_);
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Solver workspace <==\n");
+    outfile->Printf("\n");
+    outfile->Printf("      Peak scratch memory:        %12.2lf MB\n",(double)workspace_.peak_bytes() / 1024.0 / 1024.0);
+    outfile->Printf("      Buffer reallocations:       %12li\n",workspace_.reallocations());
     outfile->Printf("\n");
 
     //CheckSpinStructure();
 
-    return energy_primal + enuc_ + efzc_;
+    return energy_primal_ + enuc_ + efzc_;
 }
 
 void v2RDMSolver::CheckSpinStructure() {
@@ -1961,8 +2498,8 @@ void v2RDMSolver::Guess(){
     double* x_p = x->pointer();
     double* z_p = z->pointer();
 
-    memset((void*)x_p,'\0',dimx_*sizeof(double));
-    memset((void*)z_p,'\0',dimx_*sizeof(double));
+    memset((void*)x_p,'\0',dimx_unpacked_*sizeof(double));
+    memset((void*)z_p,'\0',dimx_unpacked_*sizeof(double));
 
     if ( options_.get_str("TPDM_GUESS") == "HF" ) {
 
@@ -2056,6 +2593,14 @@ void v2RDMSolver::Guess(){
 
     }
 
+    // the guesses for Q2, G2, T1, and T2 are built from D2ab and D2aa
+    if ( spin_adapt_d2_ ) {
+        if ( options_.get_str("TPDM_GUESS") == "HF" ) {
+            FitSpinAdaptedD2(x);
+        }
+        UnpackSpinAdaptedD2(x);
+    }
+
     if ( constrain_q2_ ) {
         if ( !spin_adapt_q2_) {
             Q2_constraints_guess(x);
@@ -2093,520 +2638,345 @@ void v2RDMSolver::BuildConstraints(){
     double trdaa  = na*(na-1.0);
     double trdbb  = nb*(nb-1.0);
 
+    // b is sliced like the other row vectors: this rank holds rows
+    // [row_begin_, row_end_) only
     b->zero();
-    double* b_p = b->pointer();
+    double* b_p = RowPointer(b);
 
     offset = 0;
 
     // funny ab trace with spin: N/2 + Ms^2 - S(S+1)
     if ( constrain_spin_ ) {
         double ms = (multiplicity_-1.0)/2.0;
-        b_p[offset++] = (0.5 * (na + nb) + ms*ms - ms*(ms+1.0));
+        if ( RowsAreLocal(offset,1) ) {
+            b_p[offset] = (0.5 * (na + nb) + ms*ms - ms*(ms+1.0));
+        }
+        offset++;
     }
 
     ///Trace of D2(s=0,ms=0) and D2(s=1,ms=0)
-    b_p[offset++] = trdab;   
-    b_p[offset++] = trdaa;
-    b_p[offset++] = trdbb;
+    if ( RowsAreLocal(offset,1) ) {
+        b_p[offset] = trdab;
+    }
+    offset++;
+    if ( constrain_trace_aa_ ) {
+        if ( RowsAreLocal(offset,1) ) {
+            b_p[offset] = trdaa;
+        }
+        offset++;
+    }
+    if ( constrain_trace_bb_ ) {
+        if ( RowsAreLocal(offset,1) ) {
+            b_p[offset] = trdbb;
+        }
+        offset++;
+    }
 
 
     // d1 / q1 a
     for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                b_p[offset + i*amopi_[h]+j] = (double)(i==j);
+        if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+            for(int i = 0; i < amopi_[h]; i++){
+                b_p[offset + i*amopi_[h]+i] = 1.0;
             }
         }
         offset += amopi_[h]*amopi_[h];
     }
 
-    // d1 / q1 b
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                b_p[offset + i*amopi_[h]+j] = (double)(i==j);
+    if ( !alias_beta_blocks_ ) {
+        // d1 / q1 b
+        for (int h = 0; h < nirrep_; h++) {
+            if ( RowsAreLocal(offset,amopi_[h]*amopi_[h]) ) {
+                for(int i = 0; i < amopi_[h]; i++){
+                    b_p[offset + i*amopi_[h]+i] = 1.0;
+                }
             }
+            offset += amopi_[h]*amopi_[h];
         }
-        offset += amopi_[h]*amopi_[h];
     }
 
-    //contract D2ab -> D1a
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                b_p[offset + i*amopi_[h]+j] = 0.0;
-            }
-        }
-        offset += amopi_[h]*amopi_[h];
+    // every remaining row (the D2 -> D1 contractions, the spin constraints,
+    // and the Q2, G2, T1, T2, and D3 mappings) has b = 0
+
+}
+
+// split the rows of A into one contiguous range per rank.  a range may only
+// end where a block of rows in the Au/ATu kernels ends, so the blocks are
+// found with a dry run of the kernels first
+void v2RDMSolver::DistributeRows() {
+
+    row_survey_ = false;
+    row_begin_  = 0;
+    row_end_    = nconstraints_;
+    nrow_local_ = nconstraints_;
+    if ( nproc_ == 1 ) return;
+
+    // with row_survey_ set, RowsAreLocal records every block and skips it,
+    // so the kernels touch neither vector
+    SharedSolverVector xdum (new SolverVector("row survey (primal)",dimx_unpacked_));
+    SharedSolverVector rdum (new SolverVector("row survey (rows)",1));
+    nrow_local_ = 0;
+    row_survey_ = true;
+    row_blocks_.clear();
+    bpsdp_Au(rdum,xdum);
+    std::vector< std::pair<long int,long int> > au_blocks = row_blocks_;
+    row_blocks_.clear();
+    bpsdp_ATu_rows(xdum,rdum);
+    row_survey_ = false;
+
+    if ( au_blocks != row_blocks_ ) {
+        throw PsiException("the Au and ATu kernels disagree on the blocks of constraint rows",__FILE__,__LINE__);
+    }
+    std::vector<long int> starts;
+    long int next = 0;
+    for (int i = 0; i < row_blocks_.size(); i++) {
+        if ( row_blocks_[i].first != next ) {
+            throw PsiException("the constraint kernels skip or repeat rows",__FILE__,__LINE__);
+        }
+        starts.push_back(next);
+        next += row_blocks_[i].second;
+    }
+    if ( next != nconstraints_ ) {
+        throw PsiException("the constraint kernels do not cover every row",__FILE__,__LINE__);
+    }
+    starts.push_back(nconstraints_);
+    row_blocks_.clear();
+
+    // cut at the block boundary nearest to an even split
+    std::vector<long int> cut(nproc_+1);
+    cut[0]      = 0;
+    cut[nproc_] = nconstraints_;
+    int k = 0;
+    for (int r = 1; r < nproc_; r++) {
+        double target = (double)r * nconstraints_ / nproc_;
+        while ( k + 1 < starts.size() && fabs(starts[k+1] - target) <= fabs(starts[k] - target) ) k++;
+        cut[r] = ( starts[k] > cut[r-1] ) ? starts[k] : cut[r-1];
+    }
+    row_begin_  = cut[rank_];
+    row_end_    = cut[rank_+1];
+    nrow_local_ = row_end_ - row_begin_;
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Distributed constraints <==\n");
+    outfile->Printf("\n");
+    outfile->Printf("        number of MPI ranks:                %5i\n",nproc_);
+    outfile->Printf("        this rank:                          %5i\n",rank_);
+    outfile->Printf("\n");
+    for (int r = 0; r < nproc_; r++) {
+        outfile->Printf("        rank %5i rows: %12li to %12li\n",r,cut[r],cut[r+1]-1);
     }
 
-    //contract D2ab -> D1b
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                b_p[offset + i*amopi_[h]+j] = 0.0;
-            }
-        }
-        offset += amopi_[h]*amopi_[h];
+    FindBlockReaders();
+
+    int nshared = 0;
+    long int shared_size = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        if ( block_readers_[i].size() < 2 ) continue;
+        nshared++;
+        shared_size += (long int)dimensions_[i] * dimensions_[i];
     }
+    outfile->Printf("\n");
+    outfile->Printf("        blocks read by more than one rank:  %5i of %5i\n",nshared,(int)dimensions_.size());
+    outfile->Printf("        elements exchanged in A^T.u: %12li of %12li\n",shared_size,dimx_);
+}
 
-    //contract D2aa -> D1a
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                b_p[offset + i*amopi_[h]+j] = 0.0;
-            }
-        }
-        offset += amopi_[h]*amopi_[h];
+// the ranks whose rows read each block of the primal vectors.  A^T.u from
+// random values on this rank's rows is nonzero exactly on the blocks they
+// read (Au reads the same elements ATu writes)
+void v2RDMSolver::FindBlockReaders() {
+
+    int nblock = dimensions_.size();
+    block_readers_.assign(nblock,std::vector<int>());
+
+    SharedSolverVector u    (new SolverVector("block survey (rows)",nrow_local_));
+    SharedSolverVector xdum (new SolverVector("block survey (primal)",dimx_unpacked_));
+    double * u_p = u->pointer();
+    unsigned long int seed = 1;
+    for (long int i = 0; i < nrow_local_; i++) {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        u_p[i] = 1.0 + (double)(seed >> 11) / 9007199254740992.0;
     }
-    //contract D2bb -> D1b
-    for (int h = 0; h < nirrep_; h++) {
-        for(int i = 0; i < amopi_[h]; i++){
-            for(int j = 0; j < amopi_[h]; j++){
-                b_p[offset + i*amopi_[h]+j] = 0.0;
+    bpsdp_ATu_rows(xdum,u);
+
+    std::vector<double> reads((long int)nproc_ * nblock,0.0);
+    double * x_p = xdum->pointer();
+    long int myoffset = 0;
+    for (int i = 0; i < nblock; i++) {
+        long int n2 = (long int)dimensions_[i] * dimensions_[i];
+        for (long int k = 0; k < n2; k++) {
+            if ( x_p[myoffset + k] != 0.0 ) {
+                reads[(long int)rank_ * nblock + i] = 1.0;
+                break;
             }
         }
-        offset += amopi_[h]*amopi_[h];
+        myoffset += n2;
     }
-    // additional spin constraints for singlets:
-    if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-        for ( int h = 0; h < nirrep_; h++) {
-            offset += amopi_[h]*amopi_[h]; // D1a = D1b
-        }
-        for ( int h = 0; h < nirrep_; h++) {
-            offset += gems_aa[h]*gems_aa[h]; // D2aa = D2bb
-        }
-        for ( int h = 0; h < nirrep_; h++) {
-            offset += gems_aa[h]*gems_aa[h]; // D2aa[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr])
-        }
-        for ( int h = 0; h < nirrep_; h++) {
-            offset += gems_aa[h]*gems_aa[h]; // D2bb[pq][rs] = 1/2(D2ab[pq][rs] - D2ab[pq][sr] - D2ab[qp][rs] + D2ab[qp][sr]))
+    DistributedSum(&reads[0],(long int)nproc_ * nblock);
+
+    for (int i = 0; i < nblock; i++) {
+        for (int r = 0; r < nproc_; r++) {
+            if ( reads[(long int)r * nblock + i] > 0.5 ) block_readers_[i].push_back(r);
         }
-        for ( int h = 0; h < nirrep_; h++) {
-            offset += gems_ab[h]*gems_ab[h]; // D200[pq][rs] = 1/(sqrt(1+dpq)sqrt(1+drs))(D2ab[pq][rs] + D2ab[pq][sr] + D2ab[qp][rs] + D2ab[qp][sr])
+    }
+}
+
+// sum A^T.u over the ranks, but only on the blocks more than one rank reads.
+// the other blocks are already complete on the one rank that reads them
+void v2RDMSolver::SumSharedBlocks(SharedSolverVector A) {
+    if ( nproc_ == 1 ) return;
+    double * A_p = A->pointer();
+    long int myoffset = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        long int n2 = (long int)dimensions_[i] * dimensions_[i];
+        const std::vector<int> & readers = block_readers_[i];
+        if ( std::find(readers.begin(),readers.end(),rank_) != readers.end() ) {
+            DistributedSumAmong(A_p+myoffset,n2,readers);
         }
-    }else if ( constrain_spin_ ) { // nonsinglets
-        for ( int h = 0; h < nirrep_; h++) {
-            offset += 4*gems_ab[h]*gems_ab[h]; // D200_0, D210_0, D201_0, D211_0
+        myoffset += n2;
+    }
+}
+
+bool v2RDMSolver::RowsAreLocal(long int first, long int n) {
+    if ( n == 0 ) return false;
+    if ( row_survey_ ) {
+        row_blocks_.push_back(std::make_pair(first,n));
+        return false;
+    }
+    if ( first < row_begin_ || first >= row_end_ ) return false;
+    if ( first + n > row_end_ ) {
+        throw PsiException("a block of constraint rows is split between MPI ranks",__FILE__,__LINE__);
+    }
+    return true;
+}
+
+SharedSolverVector v2RDMSolver::GatherRows(SharedSolverVector v) {
+    SharedSolverVector full (new SolverVector("gathered rows",nconstraints_));
+    C_DCOPY(nrow_local_,v->pointer(),1,full->pointer()+row_begin_,1);
+    DistributedSum(full->pointer(),nconstraints_);
+    return full;
+}
+
+void v2RDMSolver::KeepLocalRows(SharedSolverVector full, SharedSolverVector v) {
+    C_DCOPY(nrow_local_,full->pointer()+row_begin_,1,v->pointer(),1);
+}
+
+///Build A dot u where u =[z,c]
+void v2RDMSolver::bpsdp_Au(SharedSolverVector A, SharedSolverVector u){
+
+    std::vector<SharedSolverVector> Ab(1,A);
+    std::vector<SharedSolverVector> ub(1,u);
+    std::vector<v2RDMSolver*> states(1,this);
+    bpsdp_Au_block(Ab,ub,states);
+
+} // end Au
+
+void v2RDMSolver::bpsdp_Au_slow(SharedSolverVector A, SharedSolverVector u){
+    bpsdp_Au(A,u);
+} // end Au
+
+// A.u for several vectors at once.  the D2, Q2, and G2 kernels walk their
+// index maps once for all of the vectors; the rest go one vector at a time
+void v2RDMSolver::bpsdp_Au_block(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u,
+    std::vector<v2RDMSolver*> & states){
+
+    int nvec = u.size();
+
+    for (int v = 0; v < nvec; v++) {
+        //A[v]->zero();
+        memset((void*)A[v]->pointer(),'\0',nrow_local_*sizeof(double));
+
+        // the kernels read D2ab and D2aa
+        if ( spin_adapt_d2_ ) {
+            UnpackSpinAdaptedD2(u[v]);
         }
     }
 
+    D2_constraints_Au(A,u,states);
+
     if ( constrain_q2_ ) {
         if ( !spin_adapt_q2_ ) {
-            // map d2ab to q2ab
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h]; 
-            }
-
-            // map d2aa to q2aa
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h];
-            }
-
-            // map d2bb to q2bb
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h]; 
-            }
+            Q2_constraints_Au(A,u);
         }else {
-            // map d2ab to q2s
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_00[h]; i++){
-                    for(int j = 0; j < gems_00[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_00[h]*gems_00[h];
-            }
-            // map d2ab to q2t
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h];
-            }
-            // map d2aa to q2t_p1
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h];
-            }
-            // map d2bb to q2t_m1
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + INDEX(i,j)] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h];
-            }
+            Q2_constraints_Au_spin_adapted(A,u);
         }
     }
 
     if ( constrain_g2_ ) {
         if ( ! spin_adapt_g2_ ) {
-            // map d2 and d1 to g2ab
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h];
-            }
-
-            // map d2 and d1 to g2ba
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h];
-            }
-
-            // map d2 and d1 to g2aa
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < 2*gems_ab[h]; i++){
-                    for(int j = 0; j < 2*gems_ab[h]; j++){
-                        b_p[offset + i*2*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += 2*gems_ab[h]*2*gems_ab[h]; 
-            }
+            G2_constraints_Au(A,u);
         }else {
-            // map d2 and d1 to g2s
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h]; 
-            }
-            // map d2 and d1 to g2t
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h]; 
-            }
-            // map d2 and d1 to g2t_p1
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h]; 
-            }
-            // map d2 and d1 to g2t_m1
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h]; 
-            }
+            G2_constraints_Au_spin_adapted(A,u);
         }
-        //if ( constrain_spin_ ) {
-        //    offset += gems_ab[0];
-        //    offset += gems_ab[0];
-        //}
     }
 
-    if ( constrain_t1_ ) {
-        // T1aaa
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aaa[h]; i++){
-                for(int j = 0; j < trip_aaa[h]; j++){
-                    b_p[offset + i*trip_aaa[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aaa[h]*trip_aaa[h];
-        }
-        // T1bbb
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aaa[h]; i++){
-                for(int j = 0; j < trip_aaa[h]; j++){
-                    b_p[offset + i*trip_aaa[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aaa[h]*trip_aaa[h];
+    for (int v = 0; v < nvec; v++) {
+
+        if ( constrain_t1_ ) {
+            states[v]->T1_constraints_Au(A[v],u[v]);
         }
-        // T1aab
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aab[h]; i++){
-                for(int j = 0; j < trip_aab[h]; j++){
-                    b_p[offset + i*trip_aab[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aab[h]*trip_aab[h];
+
+        if ( constrain_t2_ ) {
+            //states[v]->T2_constraints_Au(A[v],u[v]);
+            states[v]->T2_constraints_Au_slow(A[v],u[v]);
         }
-        // T1bba
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aab[h]; i++){
-                for(int j = 0; j < trip_aab[h]; j++){
-                    b_p[offset + i*trip_aab[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aab[h]*trip_aab[h];
+
+        if ( constrain_d3_ ) {
+            states[v]->D3_constraints_Au(A[v],u[v]);
         }
     }
 
-    if ( constrain_t2_ ) {
-        // T2aaa
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aba[h]+trip_aab[h]; i++){
-                for(int j = 0; j < trip_aba[h] + trip_aab[h]; j++){
-                    b_p[offset + i*(trip_aab[h]+trip_aba[h])+j] = 0.0;
-                }
-            }
-            offset += (trip_aba[h]+trip_aab[h])*(trip_aba[h]+trip_aab[h]);
-            //for(int i = 0; i < trip_aab[h]; i++){
-            //    for(int j = 0; j < trip_aab[h]; j++){
-            //        b_p[offset + i*trip_aab[h]+j] = 0.0;
-            //    }
-            //}
-            //offset += trip_aab[h]*trip_aab[h];
-        }
-        // T2bbb
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aba[h]+trip_aab[h]; i++){
-                for(int j = 0; j < trip_aba[h] + trip_aab[h]; j++){
-                    b_p[offset + i*(trip_aab[h]+trip_aba[h])+j] = 0.0;
-                }
-            }
-            offset += (trip_aba[h]+trip_aab[h])*(trip_aba[h]+trip_aab[h]);
-            //for(int i = 0; i < trip_aaa[h]; i++){
-            //    for(int j = 0; j < trip_aaa[h]; j++){
-            //        b_p[offset + i*trip_aaa[h]+j] = 0.0;
-            //    }
-            //}
-            //offset += trip_aaa[h]*trip_aaa[h];
-        }
-        // T2aab
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aab[h]; i++){
-                for(int j = 0; j < trip_aab[h]; j++){
-                    b_p[offset + i*trip_aab[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aab[h]*trip_aab[h];
-        }
-        // T2bba
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aab[h]; i++){
-                for(int j = 0; j < trip_aab[h]; j++){
-                    b_p[offset + i*trip_aab[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aab[h]*trip_aab[h];
-        }
-        // T2aba
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aba[h]; i++){
-                for(int j = 0; j < trip_aba[h]; j++){
-                    b_p[offset + i*trip_aba[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aba[h]*trip_aba[h];
-        }
-        // T2bab
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < trip_aba[h]; i++){
-                for(int j = 0; j < trip_aba[h]; j++){
-                    b_p[offset + i*trip_aba[h]+j] = 0.0;
-                }
-            }
-            offset += trip_aba[h]*trip_aba[h];
-        }
-    }
-    if ( constrain_d3_ ) {
-        if (  nalpha_ - nrstc_ - nfrzc_ > 2 ) {
-            // D3aaa -> D2aa
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + i*gems_aa[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h];
-            }
-        }
-        if (  nbeta_ - nrstc_ - nfrzc_ > 2 ) {
-            // D3bbb -> D2bb
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_aa[h]; i++){
-                    for(int j = 0; j < gems_aa[h]; j++){
-                        b_p[offset + i*gems_aa[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_aa[h]*gems_aa[h];
-            }
-        }
-        // D3aab -> D2aa
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < gems_aa[h]; i++){
-                for(int j = 0; j < gems_aa[h]; j++){
-                    b_p[offset + i*gems_aa[h]+j] = 0.0;
-                }
-            }
-            offset += gems_aa[h]*gems_aa[h];
-        }
-        // D3bba -> D2bb
-        for (int h = 0; h < nirrep_; h++) {
-            for(int i = 0; i < gems_aa[h]; i++){
-                for(int j = 0; j < gems_aa[h]; j++){
-                    b_p[offset + i*gems_aa[h]+j] = 0.0;
-                }
-            }
-            offset += gems_aa[h]*gems_aa[h];
-        }
-        if (  nalpha_ - nrstc_ - nfrzc_ > 1 ) {
-            // D3aab -> D2ab
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h];
-            }
-        }
-        if (  nbeta_ - nrstc_ - nfrzc_ > 1 ) {
-            // D3bba -> D2ab
-            for (int h = 0; h < nirrep_; h++) {
-                for(int i = 0; i < gems_ab[h]; i++){
-                    for(int j = 0; j < gems_ab[h]; j++){
-                        b_p[offset + i*gems_ab[h]+j] = 0.0;
-                    }
-                }
-                offset += gems_ab[h]*gems_ab[h];
-            }
-        }
-        // additional spin constraints for singlets:
-        if ( constrain_spin_ && nalpha_ == nbeta_ ) {
-            for (int h = 0; h < nirrep_; h++) {
-                offset += trip_aab[h]*trip_aab[h]; // D3aab = D3bba 
-            }
-            for (int h = 0; h < nirrep_; h++) {
-                offset += trip_aaa[h]*trip_aaa[h]; // D3aab -> D3aaa 
-                offset += trip_aaa[h]*trip_aaa[h]; // D3bba -> D3bbb
-            }
-        }
-    }
-
-}
-
-///Build A dot u where u =[z,c]
-void v2RDMSolver::bpsdp_Au(SharedVector A, SharedVector u){
+    // each rank fills only its own rows, so there is nothing to sum
 
-    //A->zero();  
-    memset((void*)A->pointer(),'\0',nconstraints_*sizeof(double));
+} // end Au_block
 
-    offset = 0;
-    D2_constraints_Au(A,u);
-
-    if ( constrain_q2_ ) {
-        if ( !spin_adapt_q2_ ) {
-            Q2_constraints_Au(A,u);
-        }else {
-            Q2_constraints_Au_spin_adapted(A,u);
-        }
-    }
-
-    if ( constrain_g2_ ) {
-        if ( ! spin_adapt_g2_ ) {
-            G2_constraints_Au(A,u);
-        }else {
-            G2_constraints_Au_spin_adapted(A,u);
-        }
-    }
+///Build AT dot u where u =[z,c]
+void v2RDMSolver::bpsdp_ATu(SharedSolverVector A, SharedSolverVector u){
 
-    if ( constrain_t1_ ) {
-        T1_constraints_Au(A,u);
-    }
+    bpsdp_ATu_rows(A,u);
 
-    if ( constrain_t2_ ) {
-        //T2_constraints_Au(A,u);
-        T2_constraints_Au_slow(A,u);
-    }
+    // a block of A^T.u is only complete on the ranks that read it, which is
+    // all Au needs when this is the inner product of the cg solve
+    SumSharedBlocks(A);
 
-    if ( constrain_d3_ ) {
-        D3_constraints_Au(A,u);
-    }
+}//end ATu
 
-} // end Au
+// the rows of this rank's share of A^T.u, not summed over the ranks
+void v2RDMSolver::bpsdp_ATu_rows(SharedSolverVector A, SharedSolverVector u){
 
-void v2RDMSolver::bpsdp_Au_slow(SharedVector A, SharedVector u){
+    std::vector<SharedSolverVector> Ab(1,A);
+    std::vector<SharedSolverVector> ub(1,u);
+    std::vector<v2RDMSolver*> states(1,this);
+    bpsdp_ATu_rows_block(Ab,ub,states);
 
-    //A->zero();  
-    memset((void*)A->pointer(),'\0',nconstraints_*sizeof(double));
+}//end ATu_rows
 
-    offset = 0;
-    D2_constraints_Au(A,u);
+void v2RDMSolver::bpsdp_ATu_slow(SharedSolverVector A, SharedSolverVector u){
+    bpsdp_ATu(A,u);
+}//end ATu
 
-    if ( constrain_q2_ ) {
-        if ( !spin_adapt_q2_ ) {
-            Q2_constraints_Au(A,u);
-        }else {
-            Q2_constraints_Au_spin_adapted(A,u);
-        }
-    }
+void v2RDMSolver::bpsdp_ATu_block(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u,
+    std::vector<v2RDMSolver*> & states){
 
-    if ( constrain_g2_ ) {
-        if ( ! spin_adapt_g2_ ) {
-            G2_constraints_Au(A,u);
-        }else {
-            G2_constraints_Au_spin_adapted(A,u);
-        }
-    }
+    bpsdp_ATu_rows_block(A,u,states);
 
-    if ( constrain_t1_ ) {
-        T1_constraints_Au(A,u);
+    for (int v = 0; v < (int)u.size(); v++) {
+        SumSharedBlocks(A[v]);
     }
 
-    if ( constrain_t2_ ) {
-        //T2_constraints_Au(A,u);
-        T2_constraints_Au_slow(A,u);
-    }
-    if ( constrain_d3_ ) {
-        D3_constraints_Au(A,u);
-    }
+}//end ATu_block
 
-} // end Au
+// the rows of this rank's share of A^T.u for several vectors at once
+void v2RDMSolver::bpsdp_ATu_rows_block(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u,
+    std::vector<v2RDMSolver*> & states){
 
-///Build AT dot u where u =[z,c]
-void v2RDMSolver::bpsdp_ATu(SharedVector A, SharedVector u){
+    int nvec = u.size();
 
-    //A->zero();
-    memset((void*)A->pointer(),'\0',dimx_*sizeof(double));
+    for (int v = 0; v < nvec; v++) {
+        //A[v]->zero();
+        memset((void*)A[v]->pointer(),'\0',dimx_unpacked_*sizeof(double));
+    }
 
-    offset = 0;
-    D2_constraints_ATu(A,u);
+    D2_constraints_ATu(A,u,states);
 
     if ( constrain_q2_ ) {
         if ( !spin_adapt_q2_ ) {
@@ -2624,60 +2994,63 @@ void v2RDMSolver::bpsdp_ATu(SharedVector A, SharedVector u){
         }
     }
 
-    if ( constrain_t1_ ) {
-        T1_constraints_ATu(A,u);
-    }
+    for (int v = 0; v < nvec; v++) {
 
-    if ( constrain_t2_ ) {
-        //T2_constraints_ATu(A,u);
-        T2_constraints_ATu_slow(A,u);
-    }
-    if ( constrain_d3_ ) {
-        D3_constraints_ATu(A,u);
-    }
-
-}//end ATu
-
-void v2RDMSolver::bpsdp_ATu_slow(SharedVector A, SharedVector u){
-
-    //A->zero();
-    memset((void*)A->pointer(),'\0',dimx_*sizeof(double));
+        if ( constrain_t1_ ) {
+            states[v]->T1_constraints_ATu(A[v],u[v]);
+        }
 
-    offset = 0;
-    D2_constraints_ATu(A,u);
+        if ( constrain_t2_ ) {
+            //states[v]->T2_constraints_ATu(A[v],u[v]);
+            states[v]->T2_constraints_ATu_slow(A[v],u[v]);
+        }
 
-    if ( constrain_q2_ ) {
-        if ( !spin_adapt_q2_ ) {
-            Q2_constraints_ATu(A,u);
-        }else {
-            Q2_constraints_ATu_spin_adapted(A,u);
+        if ( constrain_d3_ ) {
+            states[v]->D3_constraints_ATu(A[v],u[v]);
         }
-    }
 
-    if ( constrain_g2_ ) {
-        if ( ! spin_adapt_g2_ ) {
-            G2_constraints_ATu(A,u);
-        }else {
-            G2_constraints_ATu_spin_adapted(A,u);
+        // fold the D2ab and D2aa parts into D2s and D2t
+        if ( spin_adapt_d2_ ) {
+            PackSpinAdaptedD2(A[v]);
         }
     }
 
-    if ( constrain_t1_ ) {
-        T1_constraints_ATu(A,u);
-    }
+}//end ATu_rows_block
 
-    if ( constrain_t2_ ) {
-        //T2_constraints_ATu(A,u);
-        T2_constraints_ATu_slow(A,u);
+// A.x, computed only if x has changed since the last call
+void v2RDMSolver::bpsdp_Ax(SharedSolverVector A){
+    if ( Ax_cache_stamp_ != x_stamp_ ) {
+        bpsdp_Au(Ax_cache_,x);
+        Ax_cache_stamp_ = x_stamp_;
+    }else {
+        operator_reuse_total_++;
     }
+    C_DCOPY(nrow_local_,Ax_cache_->pointer(),1,A->pointer(),1);
+}
 
-    if ( constrain_d3_ ) {
-        D3_constraints_ATu(A,u);
+// A^T.y, computed only if y has changed since the last call.  with MPI, each
+// block is summed only on the rank that diagonalizes it in Update_xz, from
+// the ranks whose rows read it; the other blocks hold just this rank's share
+void v2RDMSolver::bpsdp_ATy(SharedSolverVector A){
+    if ( ATy_cache_stamp_ != y_stamp_ ) {
+        bpsdp_ATu_rows(ATy_cache_,y);
+        double * A_p = ATy_cache_->pointer();
+        long int myoffset = 0;
+        for (int i = 0; i < dimensions_.size(); i++) {
+            long int n = dimensions_[i];
+            if ( nproc_ > 1 && BlockIsMine(i) ) {
+                DistributedReduceAmong(A_p+myoffset,n*n,block_readers_[i],block_owner_[i]);
+            }
+            myoffset += n*n;
+        }
+        ATy_cache_stamp_ = y_stamp_;
+    }else {
+        operator_reuse_total_++;
     }
+    C_DCOPY(dimx_,ATy_cache_->pointer(),1,A->pointer(),1);
+}
 
-}//end ATu
-
-void v2RDMSolver::cg_Ax(long int N,SharedVector A,SharedVector ux){
+void v2RDMSolver::cg_Ax(long int N,SharedSolverVector A,SharedSolverVector ux){
 
     A->zero();
     bpsdp_ATu(ATy,ux);
@@ -2685,81 +3058,267 @@ void v2RDMSolver::cg_Ax(long int N,SharedVector A,SharedVector ux){
 
 }//end cg_Ax
 
+// A.u for several vectors at once, each on its share of the threads.  the
+// constraint kernels only read the solver state, so the products are independent
+void v2RDMSolver::bpsdp_Au_concurrent(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u){
+
+    int nvec    = u.size();
+    int nthread = omp_get_max_threads();
+    int ninner  = nthread / nvec > 0 ? nthread / nvec : 1;
+
+    #ifdef _OPENMP
+        int nested = omp_get_nested();
+        omp_set_nested(1);
+    #endif
+
+    #pragma omp parallel for schedule (static,1) num_threads(nvec)
+    for (int k = 0; k < nvec; k++) {
+        #ifdef _OPENMP
+            omp_set_num_threads(ninner);
+        #endif
+        bpsdp_Au(A[k],u[k]);
+    }
+
+    #ifdef _OPENMP
+        omp_set_nested(nested);
+    #endif
+}
+
 // update x and z
 void v2RDMSolver::Update_xz() {
 
     // evaluate M(mu*x + ATy - c)
-    bpsdp_ATu(ATy,y);
-    ATy->subtract(c);
-    x->scale(mu);
-    ATy->add(x);
+    bpsdp_ATy(ATy);
+    BuildUpdateMatrix();
 
-    // loop over each block of x/z
+    // loop over the blocks of x/z this rank owns
     for (int i = 0; i < dimensions_.size(); i++) {
         if ( dimensions_[i] == 0 ) continue;
+        if ( block_owner_[i] != rank_ ) continue;
         int myoffset = 0;
         for (int j = 0; j < i; j++) {
             myoffset += dimensions_[j] * dimensions_[j];
         }
 
-        boost::shared_ptr<Matrix> mat     (new Matrix(dimensions_[i],dimensions_[i]));
-        boost::shared_ptr<Matrix> eigvec  (new Matrix(dimensions_[i],dimensions_[i]));
-        boost::shared_ptr<Matrix> eigvec2 (new Matrix(dimensions_[i],dimensions_[i]));
-        boost::shared_ptr<Vector> eigval  (new Vector(dimensions_[i]));
+        // once the inertia of a block is known, only compute the smaller
+        // side (unless it is no longer the smaller side)
+        if ( partial_eigensolve_ && block_npos_[i] >= 0 ) {
+            if ( Update_xz_block_partial(dimensions_[i],myoffset,block_npos_[i]) ) continue;
+        }
+
+        long int n = dimensions_[i];
+
+        // scratch from the solver workspace (sized for the largest block)
+        double * mat_p   = workspace_.doubles(WS_BLOCK_MAT,n*n);
+        double * evec_p  = workspace_.doubles(WS_BLOCK_EVEC,n*n);
+        double * evec2_p = workspace_.doubles(WS_BLOCK_EVEC2,n*n);
+        double * eval_p  = workspace_.doubles(WS_BLOCK_EVAL,n);
+        double * work    = workspace_.doubles(WS_LAPACK_WORK,3*n);
 
-        double ** mat_p = mat->pointer();
         double * A_p    = ATy->pointer();
 
-        for (int p = 0; p < dimensions_[i]; p++) {
-            for (int q = p; q < dimensions_[i]; q++) {
-                double dum = 0.5 * ( A_p[myoffset + p * dimensions_[i] + q] +
-                                     A_p[myoffset + q * dimensions_[i] + p] );
-                mat_p[p][q] = mat_p[q][p] = dum;
+        for (int p = 0; p < n; p++) {
+            for (int q = p; q < n; q++) {
+                double dum = 0.5 * ( A_p[myoffset + p * n + q] +
+                                     A_p[myoffset + q * n + p] );
+                evec_p[p*n+q] = evec_p[q*n+p] = dum;
                  
             }
         }
 
-        mat->diagonalize(eigvec,eigval);
-        //for (int p = 0; p < dimensions_[i]; p++) {
-        //    if ( fabs(eigval->pointer()[p]) < r_convergence_*0.1 ) eigval->pointer()[p] = 0.0;
+        // on exit, row j of evec_p is the eigenvector for eval_p[j] (ascending)
+        int info = C_DSYEV('V','U',n,evec_p,n,eval_p,work,3*n);
+        if ( info != 0 ) {
+            throw PsiException("DSYEV failed in Update_xz",__FILE__,__LINE__);
+        }
+        //for (int p = 0; p < n; p++) {
+        //    if ( fabs(eval_p[p]) < r_convergence_*0.1 ) eval_p[p] = 0.0;
         //}
 
         // separate U+ and U-, transform back to nondiagonal basis
 
-        double * eval_p   = eigval->pointer();
-        double ** evec_p  = eigvec->pointer();
-        double ** evec2_p = eigvec2->pointer();
-
         double * x_p      = x->pointer();
         double * z_p      = z->pointer();
 
         // (+) part
         long int mydim = 0;
-        for (long int j = 0; j < dimensions_[i]; j++) {
+        for (long int j = 0; j < n; j++) {
             if ( eval_p[j] > 0.0 ) {
-                for (long int q = 0; q < dimensions_[i]; q++) {
-                    mat_p[q][mydim]   = evec_p[q][j] * eval_p[j]/mu;
-                    evec2_p[q][mydim] = evec_p[q][j];
+                for (long int q = 0; q < n; q++) {
+                    mat_p[q*n+mydim]   = evec_p[j*n+q] * eval_p[j]/mu;
+                    evec2_p[q*n+mydim] = evec_p[j*n+q];
                 }
                 mydim++;
             }
         }
-        F_DGEMM('t','n',dimensions_[i],dimensions_[i],mydim,1.0,&mat_p[0][0],dimensions_[i],&evec2_p[0][0],dimensions_[i],0.0,x_p+myoffset,dimensions_[i]);
+        F_DGEMM('t','n',n,n,mydim,1.0,mat_p,n,evec2_p,n,0.0,x_p+myoffset,n);
+        block_npos_[i] = mydim;
 
         // (-) part
         mydim = 0;
-        for (long int j = 0; j < dimensions_[i]; j++) {
+        for (long int j = 0; j < n; j++) {
             if ( eval_p[j] < 0.0 ) {
-                for (long int q = 0; q < dimensions_[i]; q++) {
-                    mat_p[q][mydim]   = -evec_p[q][j] * eval_p[j];
-                    evec2_p[q][mydim] =  evec_p[q][j];
+                for (long int q = 0; q < n; q++) {
+                    mat_p[q*n+mydim]   = -evec_p[j*n+q] * eval_p[j];
+                    evec2_p[q*n+mydim] =  evec_p[j*n+q];
                 }
                 mydim++;
             }
         }
-        F_DGEMM('t','n',dimensions_[i],dimensions_[i],mydim,1.0,&mat_p[0][0],dimensions_[i],&evec2_p[0][0],dimensions_[i],0.0,z_p+myoffset,dimensions_[i]);
+        F_DGEMM('t','n',n,n,mydim,1.0,mat_p,n,evec2_p,n,0.0,z_p+myoffset,n);
+
+    }
+
+    // pass the new blocks to the ranks whose rows read them
+    SendBlocksToReaders();
+}
+
+// M = mu*x + ATy - c, in ATy, on the blocks this rank diagonalizes.  with
+// MPI, the other blocks of x and ATy are not up to date here
+void v2RDMSolver::BuildUpdateMatrix() {
+    double * A_p = ATy->pointer();
+    double * c_p = c->pointer();
+    double * x_p = x->pointer();
+    long int myoffset = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        long int n2 = (long int)dimensions_[i] * dimensions_[i];
+        if ( block_owner_[i] == rank_ ) {
+            for (long int k = myoffset; k < myoffset + n2; k++) {
+                A_p[k] -= c_p[k];
+                A_p[k] += mu * x_p[k];
+            }
+        }
+        myoffset += n2;
+    }
+}
+
+// does this rank diagonalize block i, or do its rows read it?
+bool v2RDMSolver::BlockIsMine(int i) {
+    if ( block_owner_[i] == rank_ ) return true;
+    const std::vector<int> & readers = block_readers_[i];
+    return std::find(readers.begin(),readers.end(),rank_) != readers.end();
+}
+
+// with more than one rank, each rank builds only its own blocks of x and z
+// in Update_xz.  the cg solve and the residuals only need them on the ranks
+// whose rows read them
+void v2RDMSolver::SendBlocksToReaders() {
+    if ( nproc_ == 1 ) return;
+    double * x_p = x->pointer();
+    double * z_p = z->pointer();
+    long int myoffset = 0;
+    for (int i = 0; i < dimensions_.size(); i++) {
+        long int n = dimensions_[i];
+        if ( BlockIsMine(i) ) {
+            DistributedBroadcastAmong(x_p+myoffset,n*n,block_readers_[i],block_owner_[i]);
+            DistributedBroadcastAmong(z_p+myoffset,n*n,block_readers_[i],block_owner_[i]);
+        }
+        myoffset += n*n;
+    }
+}
+
+// copy every block of x and z from its owner to all other ranks, for the
+// few places that need all of x (orbital steps, checkpoints, and the final
+// analysis).  with SPIN_ADAPT_D2, D2ab and D2aa are unpacked there, too
+void v2RDMSolver::BroadcastBlocksFromOwners() {
+
+    if ( nproc_ > 1 ) {
+        double * x_p = x->pointer();
+        double * z_p = z->pointer();
+        long int myoffset = 0;
+        for (int i = 0; i < dimensions_.size(); i++) {
+            long int n = dimensions_[i];
+            DistributedBroadcast(x_p+myoffset,n*n,block_owner_[i]);
+            DistributedBroadcast(z_p+myoffset,n*n,block_owner_[i]);
+            myoffset += n*n;
+        }
+    }
+
+    // the analysis reads D2ab and D2aa
+    if ( spin_adapt_d2_ ) {
+        UnpackSpinAdaptedD2(x);
+    }
+}
+
+// update one block of x and z using only the eigenpairs of M on one side of
+// the spectrum.  with M = U+ - U-, x = U+/mu and z = U-, so either part
+// determines the other: z = mu x - M, or x = (M + z)/mu.  the side with
+// fewer eigenvalues at the last update is the one computed (with DSYEVR),
+// which is the cheap side for the low-rank blocks near convergence.
+bool v2RDMSolver::Update_xz_block_partial(int n, long int myoffset, int & npos) {
+
+    double * A_p = ATy->pointer();
+    double * x_p = x->pointer();
+    double * z_p = z->pointer();
+
+    // symmetrized M and a Gershgorin bound on its spectrum
+    double * mat = workspace_.doubles(WS_BLOCK_MAT,(long int)n*n);
+    double bound = 0.0;
+    for (int p = 0; p < n; p++) {
+        double row = 0.0;
+        for (int q = 0; q < n; q++) {
+            double dum = 0.5 * ( A_p[myoffset + p * n + q] + A_p[myoffset + q * n + p] );
+            mat[p*n+q] = dum;
+            row += fabs(dum);
+        }
+        if ( row > bound ) bound = row;
+    }
+    bound += 1.0;
+
+    bool positive = ( 2 * npos <= n );
+    double vl = positive ? 0.0   : -bound;
+    double vu = positive ? bound : 0.0;
+
+    int m      = 0;
+    int lwork  = 26 * n;
+    int liwork = 10 * n;
+    double * eval   = workspace_.doubles(WS_BLOCK_EVAL,n);
+    double * evec   = workspace_.doubles(WS_BLOCK_EVEC,(long int)n*n);
+    double * work   = workspace_.doubles(WS_LAPACK_WORK,lwork);
+    int * iwork     = workspace_.ints(WS_LAPACK_IWORK,liwork);
+    int * isuppz    = workspace_.ints(WS_LAPACK_ISUPPZ,2*n);
+
+    int info = C_DSYEVR('V','V','U',n,mat,n,vl,vu,0,0,0.0,&m,eval,evec,n,isuppz,work,lwork,iwork,liwork);
+    if ( info != 0 ) {
+        throw PsiException("DSYEVR failed in Update_xz",__FILE__,__LINE__);
+    }
+
+    // the inertia has shifted and the computed side is now the larger one.
+    // the full diagonalization is cheaper from here and re-establishes npos
+    if ( 2 * m > n ) {
+        return false;
+    }
+
+    // eigenvectors scaled by their eigenvalues (mat is no longer needed)
+    for (int j = 0; j < m; j++) {
+        for (int q = 0; q < n; q++) {
+            mat[j*n+q] = evec[j*n+q] * eval[j];
+        }
+    }
 
+    // the computed part: x = U+/mu or z = U-
+    double * part = positive ? x_p + myoffset : z_p + myoffset;
+    double fac    = positive ? 1.0 / mu : -1.0;
+    if ( m > 0 ) {
+        F_DGEMM('n','t',n,n,m,fac,mat,n,evec,n,0.0,part,n);
+    }else {
+        memset((void*)part,'\0',n*n*sizeof(double));
     }
+
+    // the other part from the identity M = mu x - z
+    for (int p = 0; p < n; p++) {
+        for (int q = 0; q < n; q++) {
+            double dum = 0.5 * ( A_p[myoffset + p * n + q] + A_p[myoffset + q * n + p] );
+            if ( positive ) {
+                z_p[myoffset + p * n + q] = mu * x_p[myoffset + p * n + q] - dum;
+            }else {
+                x_p[myoffset + p * n + q] = ( dum + z_p[myoffset + p * n + q] ) / mu;
+            }
+        }
+    }
+
+    npos = positive ? m : n - m;
+    return true;
 }
 
 // update x and z.  This version does not symmetrize the matrix M(mu*x+ATy-c) 
@@ -2767,28 +3326,27 @@ void v2RDMSolver::Update_xz() {
 void v2RDMSolver::Update_xz_nonsymmetric() {
 
     // evaluate M(mu*x + ATy - c)
-    bpsdp_ATu(ATy,y);
-    ATy->subtract(c);
-    x->scale(mu);
-    ATy->add(x);
+    bpsdp_ATy(ATy);
+    BuildUpdateMatrix();
 
-    // loop over each block of x/z
+    // loop over the blocks of x/z this rank owns
     for (int i = 0; i < dimensions_.size(); i++) {
         if ( dimensions_[i] == 0 ) continue;
+        if ( block_owner_[i] != rank_ ) continue;
         int myoffset = 0;
         for (int j = 0; j < i; j++) {
             myoffset += dimensions_[j] * dimensions_[j];
         }
 
-        boost::shared_ptr<Vector> Up     (new Vector(dimensions_[i]));
-        boost::shared_ptr<Vector> Um     (new Vector(dimensions_[i]));
         double * A_p   = ATy->pointer();
 
-        double * myA = (double*)malloc(dimensions_[i]*dimensions_[i]*sizeof(double));
-        double * VL  = (double*)malloc(dimensions_[i]*dimensions_[i]*sizeof(double));
-        double * VR  = (double*)malloc(dimensions_[i]*dimensions_[i]*sizeof(double));
-        double * WR  = (double*)malloc(dimensions_[i]*sizeof(double));
-        double * WI  = (double*)malloc(dimensions_[i]*sizeof(double));
+        long int n   = dimensions_[i];
+        double * myA = workspace_.doubles(WS_BLOCK_MAT,n*n);
+        double * VL  = workspace_.doubles(WS_BLOCK_EVEC,n*n);
+        double * VR  = workspace_.doubles(WS_BLOCK_EVEC2,n*n);
+        double * WR  = workspace_.doubles(WS_BLOCK_EVAL,n);
+        double * WI  = workspace_.doubles(WS_BLOCK_EVAL2,n);
+        double * WK  = workspace_.doubles(WS_LAPACK_WORK,4*n);
 
         C_DCOPY(dimensions_[i]*dimensions_[i],&A_p[myoffset],1,myA,1);
 
@@ -2797,11 +3355,11 @@ void v2RDMSolver::Update_xz_nonsymmetric() {
         memset((void*)WR,'\0',dimensions_[i]*sizeof(double));
         memset((void*)WI,'\0',dimensions_[i]*sizeof(double));
 
-        NonsymmetricEigenvalue(dimensions_[i],myA,VL,VR,WR,WI);
+        NonsymmetricEigenvalue(dimensions_[i],myA,VL,VR,WR,WI,WK);
 
-        // separate U+ and U-
-        double * u_p    = Up->pointer();
-        double * u_m    = Um->pointer();
+        // separate U+ and U- (the LAPACK work array is free again)
+        double * u_p    = WK;
+        double * u_m    = WK + n;
         double * eval_p = WR;//eigval->pointer();
         for (int p = 0; p < dimensions_[i]; p++) {
             if ( eval_p[p] < 0.0 ) {
@@ -2850,233 +3408,206 @@ void v2RDMSolver::Update_xz_nonsymmetric() {
         //        z_p[myoffset+p*dimensions_[i]+q] = 0.5 * dumz;
         //    }
         //}
-
-        free(VL);
-        free(VR);
-        free(WR);
-        free(WI);
     }
+
+    // pass the new blocks to the ranks whose rows read them
+    SendBlocksToReaders();
 }
 
 // TODO: update remaining functions to use restricted vs frozen orbitals
-void v2RDMSolver::UnpackDensityPlusCore() {
+// spin-summed, symmetrized active-space D2 element with geminals (ik) and (jl),
+// in the form expected by the orbital optimizer (before geminal scaling)
+double v2RDMSolver::ActiveD2Element(double * x_p, int i, int j, int k, int l) {
+
+    int h   = SymmetryPair(symmetry[i],symmetry[j]);
+    int hkj = SymmetryPair(symmetry[k],symmetry[j]);
+
+    int ij_ab = ibas_ab_sym[h][i][j];
+    int ji_ab = ibas_ab_sym[h][j][i];
+    int kl_ab = ibas_ab_sym[h][k][l];
+    int lk_ab = ibas_ab_sym[h][l][k];
+
+    int kj_ab = ibas_ab_sym[hkj][k][j];
+    int il_ab = ibas_ab_sym[hkj][i][l];
+    int jk_ab = ibas_ab_sym[hkj][j][k];
+    int li_ab = ibas_ab_sym[hkj][l][i];
+
+    double val = 0.0;
+
+    val += 0.5 * x_p[d2aboff[h]   + ij_ab*gems_ab[h]  + kl_ab];
+    val += 0.5 * x_p[d2aboff[hkj] + kj_ab*gems_ab[hkj]+ il_ab] * (1.0 - (double)(l==j));
+    val += 0.5 * x_p[d2aboff[hkj] + il_ab*gems_ab[hkj]+ kj_ab] * (1.0 - (double)(i==k));
+    val += 0.5 * x_p[d2aboff[h]   + kl_ab*gems_ab[h]  + ij_ab] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
+
+    val += 0.5 * x_p[d2aboff[h]   + ji_ab*gems_ab[h]  + lk_ab];
+    val += 0.5 * x_p[d2aboff[hkj] + jk_ab*gems_ab[hkj]+ li_ab] * (1.0 - (double)(l==j));
+    val += 0.5 * x_p[d2aboff[hkj] + li_ab*gems_ab[hkj]+ jk_ab] * (1.0 - (double)(i==k));
+    val += 0.5 * x_p[d2aboff[h]   + lk_ab*gems_ab[h]  + ji_ab] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
+
+    // aa / bb
+    if ( i != j && k != l ) {
+        int ij_aa = ibas_aa_sym[h][i][j];
+        int kl_aa = ibas_aa_sym[h][k][l];
+        int sij = ( i < j ? 1 : -1 );
+        int skl = ( k < l ? 1 : -1 );
+        val += 0.5 * sij * skl * x_p[d2aaoff[h]   + ij_aa*gems_aa[h]  + kl_aa];
+        val += 0.5 * sij * skl * x_p[d2aaoff[h]   + kl_aa*gems_aa[h]  + ij_aa] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
+        val += 0.5 * sij * skl * x_p[d2bboff[h]   + ij_aa*gems_aa[h]  + kl_aa];
+        val += 0.5 * sij * skl * x_p[d2bboff[h]   + kl_aa*gems_aa[h]  + ij_aa] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
+    }
+    if ( k != j && i != l ) {
+        int kj_aa = ibas_aa_sym[hkj][k][j];
+        int il_aa = ibas_aa_sym[hkj][i][l];
+        int skj = ( k < j ? 1 : -1 );
+        int sil = ( i < l ? 1 : -1 );
+        val += 0.5 * skj * sil * x_p[d2aaoff[hkj] + kj_aa*gems_aa[hkj]+ il_aa] * (1.0 - (double)(l==j));
+        val += 0.5 * skj * sil * x_p[d2aaoff[hkj] + il_aa*gems_aa[hkj]+ kj_aa] * (1.0 - (double)(i==k));
+        val += 0.5 * skj * sil * x_p[d2bboff[hkj] + kj_aa*gems_aa[hkj]+ il_aa] * (1.0 - (double)(l==j));
+        val += 0.5 * skj * sil * x_p[d2bboff[hkj] + il_aa*gems_aa[hkj]+ kj_aa] * (1.0 - (double)(i==k));
+    }
+
+    return val;
+}
 
-    memset((void*)d2_plus_core_sym_,'\0',d2_plus_core_dim_*sizeof(double));
+// pack the active-space D1 and D2 directly into the layout that the orbital
+// optimizer works in (focas_interface, "class" order): active orbitals in
+// pitzer order, geminals (p >= q) numbered within each irrep in the order
+// they are encountered, D2 stored as the lower triangle of each geminal
+// block.  the core contributions are implicit in the optimizer, so nothing
+// outside of the active space is built and no re-sort is needed.
+void v2RDMSolver::PackDensityForOrbOpt() {
 
-    // D2 first
     double * x_p = x->pointer();
-    // active active; active active
-    int offset = 0;
-    for (int h = 0; h < nirrep_; h++) {
-        for (int ij = 0; ij < gems_ab[h]; ij++) {
-            int i            = bas_ab_sym[h][ij][0];
-            int j            = bas_ab_sym[h][ij][1];
-            int hi           = symmetry[i];
-            int hj           = symmetry[j];
-            int ifull        = full_basis[i];
-            int jfull        = full_basis[j];
-            int ij_ab        = ibas_ab_sym[h][i][j];
-            int ji_ab        = ibas_ab_sym[h][j][i];
-            int ij_aa        = ibas_aa_sym[h][i][j];
-
-            for (int kl = 0; kl < gems_ab[h]; kl++) {
-                int k          = bas_ab_sym[h][kl][0];
-                int l          = bas_ab_sym[h][kl][1];
-                int hk         = symmetry[k];
-                int hl         = symmetry[l];
-                int kfull      = full_basis[k];
-                int lfull      = full_basis[l];
-                int kl_ab      = ibas_ab_sym[h][k][l];
-                int lk_ab      = ibas_ab_sym[h][l][k];
-                int kl_aa      = ibas_aa_sym[h][k][l];
-
-                //if ( i > k ) continue;
-                //if ( j > l ) continue;
-
-                int hik = SymmetryPair(hi,hk);
-
-                int ik_full      = ibas_full_sym[hik][ifull][kfull];
-                int jl_full      = ibas_full_sym[hik][jfull][lfull];
-
-                //if ( ik_plus_core > jl_plus_core ) continue;
-
-                int hkj = SymmetryPair(hk,hj);
-
-                int kj_ab = ibas_ab_sym[hkj][k][j];
-                int il_ab = ibas_ab_sym[hkj][i][l];
-
-                int jk_ab = ibas_ab_sym[hkj][j][k];
-                int li_ab = ibas_ab_sym[hkj][l][i];
-
-                int kj_aa = ibas_aa_sym[hkj][k][j];
-                int il_aa = ibas_aa_sym[hkj][i][l];
-
-                offset = 0;
-                for (int myh = 0; myh < hik; myh++) {
-                    offset += gems_plus_core[myh] * ( gems_plus_core[myh] + 1 ) / 2;
-                }
-                int id = offset + INDEX(ik_full,jl_full);
-
-                double val = 0.0;
-
-                val += 0.5 * x_p[d2aboff[h]   + ij_ab*gems_ab[h]  + kl_ab];
-                val += 0.5 * x_p[d2aboff[hkj] + kj_ab*gems_ab[hkj]+ il_ab] * (1.0 - (double)(l==j));
-                val += 0.5 * x_p[d2aboff[hkj] + il_ab*gems_ab[hkj]+ kj_ab] * (1.0 - (double)(i==k));
-                val += 0.5 * x_p[d2aboff[h]   + kl_ab*gems_ab[h]  + ij_ab] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
-
-                val += 0.5 * x_p[d2aboff[h]   + ji_ab*gems_ab[h]  + lk_ab];
-                val += 0.5 * x_p[d2aboff[hkj] + jk_ab*gems_ab[hkj]+ li_ab] * (1.0 - (double)(l==j));
-                val += 0.5 * x_p[d2aboff[hkj] + li_ab*gems_ab[hkj]+ jk_ab] * (1.0 - (double)(i==k));
-                val += 0.5 * x_p[d2aboff[h]   + lk_ab*gems_ab[h]  + ji_ab] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
-
-                // aa / bb
-                if ( i != j && k != l ) {
-                    int sij = ( i < j ? 1 : -1 );
-                    int skl = ( k < l ? 1 : -1 );
-                    val += 0.5 * sij * skl * x_p[d2aaoff[h]   + ij_aa*gems_aa[h]  + kl_aa];
-                    val += 0.5 * sij * skl * x_p[d2aaoff[h]   + kl_aa*gems_aa[h]  + ij_aa] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
-                    val += 0.5 * sij * skl * x_p[d2bboff[h]   + ij_aa*gems_aa[h]  + kl_aa];
-                    val += 0.5 * sij * skl * x_p[d2bboff[h]   + kl_aa*gems_aa[h]  + ij_aa] * (1.0 - (double)(l==j))*(1.0-(double)(i==k));
-                }
-                if ( k != j && i != l ) {
-                    int skj = ( k < j ? 1 : -1 );
-                    int sil = ( i < l ? 1 : -1 );
-                    val += 0.5 * skj * sil * x_p[d2aaoff[hkj] + kj_aa*gems_aa[hkj]+ il_aa] * (1.0 - (double)(l==j));
-                    val += 0.5 * skj * sil * x_p[d2aaoff[hkj] + il_aa*gems_aa[hkj]+ kj_aa] * (1.0 - (double)(i==k));
-                    val += 0.5 * skj * sil * x_p[d2bboff[hkj] + kj_aa*gems_aa[hkj]+ il_aa] * (1.0 - (double)(l==j));
-                    val += 0.5 * skj * sil * x_p[d2bboff[hkj] + il_aa*gems_aa[hkj]+ kj_aa] * (1.0 - (double)(i==k));
-                }
 
-                // scale the off-diagonal elements
-                if ( ik_full != jl_full ) {
-                    val *= 2.0;
-                }
-                d2_plus_core_sym_[id] = val;
+    // D1: totally symmetric geminals, spin summed
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < amopi_[h]; i++) {
+            int ia = i + pitzer_offset[h];
+            for (int j = 0; j <= i; j++) {
+                int ja = j + pitzer_offset[h];
+                int ij = orbopt_den_gem_[ia*amo_+ja];
+                d1_plus_core_sym_[ij]  = x_p[d1aoff[h] + i * amopi_[h] + j];
+                d1_plus_core_sym_[ij] += x_p[d1boff[h] + i * amopi_[h] + j];
             }
         }
     }
 
-    // core core; core core
-    double en = 0.0;
-    for (int hi = 0; hi < nirrep_; hi++) {
-        for (int i = 0; i < rstcpi_[hi] + frzcpi_[hi]; i++) {
-
-            int ifull      = i + pitzer_offset_full[hi];
-
-            for (int hj = 0; hj < nirrep_; hj++) {
-                for (int j = 0; j < rstcpi_[hj] + frzcpi_[hj]; j++) {
-
-                    int jfull      = j + pitzer_offset_full[hj];
-                    int hij = SymmetryPair(hi,hj);
-
-                    if ( ifull == jfull ) {
-
-                        int iifull = ibas_full_sym[0][ifull][ifull];
-                        int jjfull = ibas_full_sym[0][jfull][jfull];
-
-                        d2_plus_core_sym_[INDEX(iifull,jjfull)] =  1.0;
+    // D2: (pq|rs) with pq >= rs in each geminal block.  every element is
+    // written exactly once, so the rows of each block can go to different threads
+    for (int h = 0; h < nirrep_; h++) {
+        double * d2_p = d2_plus_core_sym_ + orbopt_den_off_[h];
+        int * bas     = active_gem_bas_[h];
+        #pragma omp parallel for schedule (dynamic)
+        for (int pq = 0; pq < active_gems_[h]; pq++) {
+            int p = bas[2*pq];
+            int q = bas[2*pq+1];
+            double fpq = ( p == q ) ? 2.0 : 1.0;
+            for (int rs = 0; rs <= pq; rs++) {
+                int r = bas[2*rs];
+                int s = bas[2*rs+1];
+                double frs = ( r == s ) ? 1.0 : 0.5;
+                d2_p[INDEX(pq,rs)] = fpq * frs * ActiveD2Element(x_p,p,r,q,s);
+            }
+        }
+    }
+}
 
-                    }else {
+void v2RDMSolver::UnpackDensityPlusCore() {
 
-                        int iifull = ibas_full_sym[0][ifull][ifull];
-                        int jjfull = ibas_full_sym[0][jfull][jfull];
+    memset((void*)d2_plus_core_sym_,'\0',d2_plus_core_dim_*sizeof(double));
 
-                        d2_plus_core_sym_[INDEX(iifull,jjfull)] =  4.0;
+    // D2 first
+    double * x_p = x->pointer();
 
-                        offset = 0;
-                        for (int myh = 0; myh < hij; myh++) {
-                            offset += gems_plus_core[myh] * ( gems_plus_core[myh] + 1 ) / 2;
-                        }
+    // active active; active active.  scatter each unique element (pq|rs)
+    // of the active blocks once; rows go to different threads.
+    for (int h = 0; h < nirrep_; h++) {
+        double * d2_p = d2_plus_core_sym_ + d2_plus_core_off_[h];
+        int * bas     = active_gem_bas_[h];
+        #pragma omp parallel for schedule (dynamic)
+        for (int pq = 0; pq < active_gems_[h]; pq++) {
+            int p = bas[2*pq];
+            int q = bas[2*pq+1];
+            int pq_full = active_plus_core_gem_[p*amo_+q];
+            for (int rs = 0; rs <= pq; rs++) {
+                int r = bas[2*rs];
+                int s = bas[2*rs+1];
+                int rs_full = active_plus_core_gem_[r*amo_+s];
 
-                        int ijfull = ibas_full_sym[hij][ifull][jfull];
+                double val = ActiveD2Element(x_p,p,r,q,s);
 
-                        d2_plus_core_sym_[offset + INDEX(ijfull,ijfull)] = -2.0;
-                    }
+                // scale the off-diagonal elements
+                if ( pq_full != rs_full ) {
+                    val *= 2.0;
                 }
+                d2_p[INDEX(pq_full,rs_full)] = val;
             }
         }
     }
 
-    // core active; core active
-    for (int hi = 0; hi < nirrep_; hi++) {
-        for (int i = 0; i < rstcpi_[hi] + frzcpi_[hi]; i++) {
-            int ifull      = i + pitzer_offset_full[hi];
-            int iifull     = ibas_full_sym[0][ifull][ifull];
-
-            // D2(il; ij) ab, ba, aa, bb
-            for (int hj = 0; hj < nirrep_; hj++) {
-                for (int j = 0; j < amopi_[hj]; j++) {
-
-                    //int jfull      = full_basis[j];
-                    int jfull      = full_basis[j+pitzer_offset[hj]];
-
-                    for (int l = j; l < amopi_[hj]; l++) {
-
-                        //int lfull      = full_basis[l];
-                        int lfull      = full_basis[l+pitzer_offset[hj]];
-
-                        int jlfull = ibas_full_sym[0][jfull][lfull];
-
-                        int id = INDEX(iifull,jlfull);
-
-                        double val = 0.0;
-
-                        // aa and bb pieces
-                        if ( j == l ) {
-                            val += 1.0 * x_p[d1aoff[hj]+j*amopi_[hj]+l];
-                            val += 1.0 * x_p[d1boff[hj]+j*amopi_[hj]+l];
-                        }else {
-                            val += 2.0 * x_p[d1aoff[hj]+j*amopi_[hj]+l];
-                            val += 2.0 * x_p[d1boff[hj]+j*amopi_[hj]+l];
-                        }
-
-                        // ab and ba pieces
-                        if ( j == l ) {
-                            val += 1.0 * x_p[d1aoff[hj]+j*amopi_[hj]+l];
-                            val += 1.0 * x_p[d1boff[hj]+j*amopi_[hj]+l];
-                        }else {
-                            val += 2.0 * x_p[d1aoff[hj]+j*amopi_[hj]+l];
-                            val += 2.0 * x_p[d1boff[hj]+j*amopi_[hj]+l];
-                        }
-
-                        d2_plus_core_sym_[id] = val;
-
-                        // also (il|ji) with a minus sign
-                        int hil = SymmetryPair(symmetry_full[ifull],symmetry_full[lfull]);
-                        int hji = SymmetryPair(symmetry_full[ifull],symmetry_full[jfull]);
-
-                        int ilfull = ibas_full_sym[hil][ifull][lfull];
-                        int jifull = ibas_full_sym[hji][jfull][ifull];
-
-                        //if ( il > ji ) continue;
+    // core orbitals in pitzer order
+    int ncore = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        ncore += rstcpi_[h] + frzcpi_[h];
+    }
+    int * core = (int*)malloc((ncore > 0 ? ncore : 1)*sizeof(int));
+    ncore = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < rstcpi_[h] + frzcpi_[h]; i++) {
+            core[ncore++] = i + pitzer_offset_full[h];
+        }
+    }
 
-                        val = 0.0;
+    // core core; core core:  D2(ii|jj) = 4 (1 for i = j), D2(ij|ji) = -2
+    #pragma omp parallel for schedule (static)
+    for (int ic = 0; ic < ncore; ic++) {
+        int ifull  = core[ic];
+        int iifull = ibas_full_sym[0][ifull][ifull];
+        for (int jc = 0; jc <= ic; jc++) {
+            int jfull  = core[jc];
+            int jjfull = ibas_full_sym[0][jfull][jfull];
+            if ( ifull == jfull ) {
+                d2_plus_core_sym_[INDEX(iifull,jjfull)] = 1.0;
+            }else {
+                d2_plus_core_sym_[INDEX(iifull,jjfull)] = 4.0;
+                int hij    = SymmetryPair(symmetry_full[ifull],symmetry_full[jfull]);
+                int ijfull = ibas_full_sym[hij][ifull][jfull];
+                d2_plus_core_sym_[d2_plus_core_off_[hij] + INDEX(ijfull,ijfull)] = -2.0;
+            }
+        }
+    }
 
-                        // aa and bb pieces
-                        if ( j == l ) {
-                            val -= 1.0 * x_p[d1aoff[hj]+j*amopi_[hj]+l];
-                            val -= 1.0 * x_p[d1boff[hj]+j*amopi_[hj]+l];
-                        }else {
-                            val -= 2.0 * x_p[d1aoff[hj]+j*amopi_[hj]+l];
-                            val -= 2.0 * x_p[d1boff[hj]+j*amopi_[hj]+l];
-                        }
+    // core active; core active:  D2(ii|jl) = 2 D1(jl), D2(il|ji) = -D1(jl),
+    // with D1 spin summed and the off-diagonal geminal scaling folded in
+    #pragma omp parallel for schedule (static)
+    for (int ic = 0; ic < ncore; ic++) {
+        int ifull      = core[ic];
+        int iifull     = ibas_full_sym[0][ifull][ifull];
+        for (int hj = 0; hj < nirrep_; hj++) {
+            for (int j = 0; j < amopi_[hj]; j++) {
+                int jfull      = full_basis[j+pitzer_offset[hj]];
+                for (int l = j; l < amopi_[hj]; l++) {
+                    int lfull      = full_basis[l+pitzer_offset[hj]];
 
-                        offset = 0;
-                        for (int myh = 0; myh < hil; myh++) {
-                            offset += gems_plus_core[myh] * ( gems_plus_core[myh] + 1 ) / 2;
-                        }
+                    double d1  = x_p[d1aoff[hj]+j*amopi_[hj]+l] + x_p[d1boff[hj]+j*amopi_[hj]+l];
+                    double fac = ( j == l ) ? 1.0 : 2.0;
 
-                        d2_plus_core_sym_[offset + INDEX(ilfull,jifull)] = val;
+                    int jlfull = ibas_full_sym[0][jfull][lfull];
+                    d2_plus_core_sym_[INDEX(iifull,jlfull)] = 2.0 * fac * d1;
 
-                    }
+                    int hil    = SymmetryPair(symmetry_full[ifull],symmetry_full[lfull]);
+                    int ilfull = ibas_full_sym[hil][ifull][lfull];
+                    int jifull = ibas_full_sym[hil][jfull][ifull];
+                    d2_plus_core_sym_[d2_plus_core_off_[hil] + INDEX(ilfull,jifull)] = -fac * d1;
                 }
             }
         }
     }
+    free(core);
 
     // now D1
     // active; active
-    offset = 0;
+    int offset = 0;
     for (int h = 0; h < nirrep_; h++) {
         for (int i = 0; i < amopi_[h]; i++) {
 
@@ -3114,11 +3645,17 @@ void v2RDMSolver::UnpackDensityPlusCore() {
 void v2RDMSolver::FinalTransformationMatrix() {
 
     // update so/mo coefficient matrix (only need Ca_):
+    TransformOrbitals(Ca_,Cb_);
+
+}
+
+void v2RDMSolver::TransformOrbitals(SharedMatrix Ca, SharedMatrix Cb) {
+
     for (int h = 0; h < nirrep_; h++) {
-        double **ca_p = Ca_->pointer(h);
-        double **cb_p = Cb_->pointer(h);
+        double **ca_p = Ca->pointer(h);
+        double **cb_p = Cb->pointer(h);
+        double * temp = workspace_.doubles(WS_MO_ROW,nmopi_[h]);
         for (int mu = 0; mu < nsopi_[h]; mu++) {
-            double * temp = (double*)malloc(nmopi_[h] * sizeof(double));
 
             // new basis function i in energy order
             for (int ieo = nfrzc_; ieo < nmo_-nfrzv_; ieo++) {
@@ -3145,7 +3682,6 @@ void v2RDMSolver::FinalTransformationMatrix() {
                 ca_p[mu][i] = temp[i];
                 cb_p[mu][i] = temp[i];
             }
-            free(temp);
         }
     }
 
@@ -3184,9 +3720,43 @@ void v2RDMSolver::FinalTransformationMatrix() {
 
 }
 
+boost::shared_ptr<double> v2RDMSolver::SharedIntegrals(){
+    if ( !tei_buffer_ ) {
+        tei_buffer_ = boost::shared_ptr<double>( is_df_ ? Qmo_ : tei_full_sym_, free );
+    }
+    return tei_buffer_;
+}
+
+void v2RDMSolver::PrivatizeIntegrals(){
+
+    if ( !tei_buffer_ ) return;
+
+    // the other users keep the unrotated integrals
+    double * tmp = (double*)malloc(tei_full_dim_*sizeof(double));
+    C_DCOPY(tei_full_dim_,tei_full_sym_,1,tmp,1);
+    tei_full_sym_ = tmp;
+    if ( is_df_ ) {
+        Qmo_ = tei_full_sym_;
+    }
+    tei_buffer_.reset();
+}
+
 void v2RDMSolver::RotateOrbitals(){
 
-    UnpackDensityPlusCore();
+    // the densities are read from all of x
+    BroadcastBlocksFromOwners();
+
+    // the integrals are rotated in place.  once nobody else reads them
+    // (e.g., after a continuation stage) they need not be copied first
+    if ( !tei_buffer_.unique() ) {
+        PrivatizeIntegrals();
+    }
+
+    if ( orbopt_data_[14] > 0.0 ) {
+        PackDensityForOrbOpt();
+    }else {
+        UnpackDensityPlusCore();
+    }
 
     if ( orbopt_data_[8] > 0 ) {
         outfile->Printf("\n");
@@ -3233,4 +3803,123 @@ void v2RDMSolver::RotateOrbitals(){
     }
 }
 
+void v2RDMSolver::StartAsyncRotateOrbitals(){
+
+    // the densities are read from all of x
+    BroadcastBlocksFromOwners();
+
+    // the rotated integrals are swapped in when the step is finished
+    PrivatizeIntegrals();
+
+    if ( orbopt_data_[14] > 0.0 ) {
+        PackDensityForOrbOpt();
+    }else {
+        UnpackDensityPlusCore();
+    }
+
+    long int nmo_no_fz = nmo_ - nfrzc_ - nfrzv_;
+    if ( orbopt_async_oei_ == NULL ) {
+        orbopt_async_oei_  = (double*)malloc(oei_full_dim_*sizeof(double));
+        orbopt_async_tei_  = (double*)malloc(tei_full_dim_*sizeof(double));
+        orbopt_async_transformation_matrix_ = (double*)malloc(nmo_no_fz*nmo_no_fz*sizeof(double));
+        orbopt_async_data_ = (double*)malloc(15*sizeof(double));
+        orbopt_async_d1_   = (double*)malloc(d1_plus_core_dim_*sizeof(double));
+        orbopt_async_d2_   = (double*)malloc(d2_plus_core_dim_*sizeof(double));
+    }
+
+    // snapshot of the densities, the current integrals, and the
+    // transformation.  the SDP keeps working with the originals while the
+    // copies are rotated, and nothing the background step reads is shared
+    // with the main thread.
+    C_DCOPY(d1_plus_core_dim_,d1_plus_core_sym_,1,orbopt_async_d1_,1);
+    C_DCOPY(d2_plus_core_dim_,d2_plus_core_sym_,1,orbopt_async_d2_,1);
+    C_DCOPY(oei_full_dim_,oei_full_sym_,1,orbopt_async_oei_,1);
+    C_DCOPY(tei_full_dim_,tei_full_sym_,1,orbopt_async_tei_,1);
+    C_DCOPY(nmo_no_fz*nmo_no_fz,orbopt_transformation_matrix_,1,orbopt_async_transformation_matrix_,1);
+    for (int i = 0; i < 15; i++) {
+        orbopt_async_data_[i] = orbopt_data_[i];
+    }
+    orbopt_async_data_[0] = (double)orbopt_async_threads_;
+
+    // the remaining threads keep iterating on the SDP
+    omp_set_num_threads(orbopt_sdp_threads_);
+
+    orbopt_async_start_iter_ = oiter_;
+    orbopt_async_done_       = false;
+    orbopt_thread_           = new std::thread(&v2RDMSolver::AsyncOrbOpt,this);
+}
+
+void v2RDMSolver::AsyncOrbOpt(){
+
+    double start = omp_get_wtime();
+
+    // no output from here.  OrbOpt is not reentrant, so there is only ever
+    // one background step, and the main thread never calls OrbOpt while it
+    // runs.  every array passed here is private to the background step.
+    OrbOpt(orbopt_async_transformation_matrix_,
+          orbopt_async_oei_,oei_full_dim_,orbopt_async_tei_,tei_full_dim_,
+          orbopt_async_d1_,d1_plus_core_dim_,orbopt_async_d2_,d2_plus_core_dim_,
+          symmetry_energy_order,nrstc_,amo_,nrstv_,nirrep_,
+          orbopt_async_data_,orbopt_outfile_);
+
+    double end = omp_get_wtime();
+
+    orbopt_async_time_ += end - start;
+    orbopt_async_done_ = true;
+}
+
+bool v2RDMSolver::FinishAsyncRotateOrbitals(bool wait){
+
+    if ( orbopt_thread_ == NULL ) return false;
+    if ( !wait && !orbopt_async_done_ ) return false;
+
+    orbopt_thread_->join();
+    delete orbopt_thread_;
+    orbopt_thread_ = NULL;
+
+    omp_set_num_threads((int)orbopt_data_[0]);
+
+    // swap the rotated integrals and transformation in
+    double * tmp;
+    tmp = oei_full_sym_;
+    oei_full_sym_ = orbopt_async_oei_;
+    orbopt_async_oei_ = tmp;
+
+    tmp = tei_full_sym_;
+    tei_full_sym_ = orbopt_async_tei_;
+    orbopt_async_tei_ = tmp;
+    if ( is_df_ ) {
+        Qmo_ = tei_full_sym_;
+    }
+
+    tmp = orbopt_transformation_matrix_;
+    orbopt_transformation_matrix_ = orbopt_async_transformation_matrix_;
+    orbopt_async_transformation_matrix_ = tmp;
+
+    for (int i = 10; i < 14; i++) {
+        orbopt_data_[i] = orbopt_async_data_[i];
+    }
+
+    int overlap = oiter_ - orbopt_async_start_iter_;
+    orbopt_async_overlap_total_ += overlap;
+    orbopt_iter_total_++;
+
+    outfile->Printf("\n");
+    outfile->Printf("        ==> Orbital Optimization (background) <==\n");
+    outfile->Printf("\n");
+    outfile->Printf("            Orbital Optimization %s in %3i iterations \n",(int)orbopt_data_[13] ? "converged" : "did not converge",(int)orbopt_data_[10]);
+    outfile->Printf("            Total energy change: %11.6le\n",orbopt_data_[12]);
+    outfile->Printf("            Final gradient norm: %11.6le\n",orbopt_data_[11]);
+    outfile->Printf("            Density snapshot age: %3i SDP iterations\n",overlap);
+    outfile->Printf("\n");
+
+    if ( fabs(orbopt_data_[12]) < orbopt_data_[4] ) {
+        orbopt_converged_ = true;
+    }
+
+    RepackIntegrals();
+
+    return true;
+}
+
 }} //end namespaces
@@ -31,6 +31,8 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<math.h>
+#include<thread>
+#include<atomic>
 
 #include <libplugin/plugin.h>
 #include <psi4-dec.h>
@@ -48,6 +50,11 @@
 
 // greg
 #include"fortran.h"
+#include"cg_solver.h"
+#include"workspace.h"
+#include"placement.h"
+#include"distributed.h"
+#include"fcidump.h"
 
 // TODO: move to psifiles.h
 #define PSIF_DCC_QMO          268
@@ -59,6 +66,11 @@
 #define PSIF_V2RDM_D3AAB      274
 #define PSIF_V2RDM_D3BBA      275
 #define PSIF_V2RDM_D3BBB      276
+#define PSIF_V2RDM_D2_BLOCKED 277
+#define PSIF_V2RDM_D3_BLOCKED 278
+
+// most vectors the block Au/ATu kernels take at once
+#define MAX_BLOCK_VECTORS 8
 
 namespace boost {
   template<class T> class shared_ptr;
@@ -68,14 +80,52 @@ namespace psi{ namespace v2rdm_casscf{
 class v2RDMSolver: public Wavefunction{
   public: 
     v2RDMSolver(boost::shared_ptr<psi::Wavefunction> reference_wavefunction,Options & options);
+
+    /// a fixed hamiltonian from an FCIDUMP file, with no reference wavefunction.
+    /// multiplicity and positivity as for a state of a multistate computation
+    v2RDMSolver(boost::shared_ptr<FCIDUMP> fcidump,Options & options,
+                int multiplicity = 0, std::string positivity = "");
+
+    /// one state of a multistate computation.  multiplicity and positivity
+    /// override the reference/options (0 and "" keep them), and the
+    /// integrals are taken from integral_donor rather than transformed again.
+    /// a continuation_stage solver is the loose, fixed-orbital 2-positivity
+    /// warm start for integral_donor (POSITIVITY_CONTINUATION)
+    v2RDMSolver(boost::shared_ptr<psi::Wavefunction> reference_wavefunction,Options & options,
+                int multiplicity, std::string positivity, boost::shared_ptr<v2RDMSolver> integral_donor,
+                bool continuation_stage = false);
     ~v2RDMSolver();
     void common_init();
     double compute_energy();
+
+    /// guess, integrals, and constraints.  prepares the bpsdp iterations
+    void InitializeBPSDP();
+
+    /// one bpsdp macroiteration: dual cg solve, primal/dual update, errors
+    void BPSDPIteration();
+
+    /// mu update, orbital optimization, and printing.  returns true once converged
+    bool BPSDPBookkeeping();
+
+    /// analysis of the converged solution.  returns the total energy
+    double FinalizeBPSDP();
+
+    /// would a 2-positivity warm start help?  (T1, T2, or D3 constraints,
+    /// and no solution from a checkpoint file or the previous point of a scan)
+    bool ContinuationUseful();
+
+    /// the D, Q, and G conditions of this solver ("D", "DQ", "DG", or "DQG"),
+    /// which make up the continuation stage
+    std::string ContinuationPositivity();
+
+    /// lift the converged solution of a continuation stage into this
+    /// solver's primal/dual space during InitializeBPSDP
+    void SetContinuationSource(boost::shared_ptr<v2RDMSolver> source);
     virtual bool same_a_b_orbs() const { return false; }
     virtual bool same_a_b_dens() const { return false; } 
 
     // public methods
-    void cg_Ax(long int n,SharedVector A, SharedVector u);
+    void cg_Ax(long int n,SharedSolverVector A, SharedSolverVector u);
 
   protected:
 
@@ -103,14 +153,109 @@ class v2RDMSolver: public Wavefunction{
     /// constrain spin?
     bool constrain_spin_;
 
-    /// symmetry product table:
-    int * table;
+    /// for singlets, store only the alpha-spin D1, Q1, D2 (and Q2) blocks
+    /// and let the beta-spin offsets point at them?
+    bool alias_beta_blocks_;
+
+    /// for singlets, store D2 as singlet (D2s) and triplet (D2t) geminal
+    /// blocks?  the kernels still see D2ab and D2aa, which are unpacked from
+    /// D2s and D2t past the end of the solver variables (see dimx_unpacked_)
+    bool spin_adapt_d2_;
+
+    /// drop redundant trace rows and keep only the unique (i <= j) rows
+    /// of the D1-shaped constraints (D1 + Q1 = I, D2 -> D1)?
+    bool reduced_constraints_;
+
+    /// keep the explicit Tr(D2aa) and Tr(D2bb) rows?  with reduced
+    /// constraints, these follow from Tr(D2ab) and the contractions
+    bool constrain_trace_aa_;
+    bool constrain_trace_bb_;
+
+    /// number of rows in a D2 -> D1 contraction block of irrep h.  the
+    /// D1 + Q1 = I rows always keep both (i,j) and (j,i): the Q2 and G2
+    /// maps mix D1 and Q1 elements, and with only the symmetric rows the
+    /// open-shell DQG iterations stall at a finite primal error
+    int D1ConstraintRows(int h) {
+        return reduced_constraints_ ? amopi_[h]*(amopi_[h]+1)/2 : amopi_[h]*amopi_[h];
+    }
+
+    /// row of element (i,j) within a D2 -> D1 contraction block of irrep h
+    int D1ConstraintRow(int h, int i, int j) {
+        return reduced_constraints_ ? (int)INDEX(i,j) : i*amopi_[h]+j;
+    }
+
+    /// weight of element (i,j) in its row.  with reduced constraints, the
+    /// (i,j) and (j,i) rows are merged as (row_ij + row_ji) / sqrt(2)
+    double D1ConstraintScale(int i, int j) {
+        return ( reduced_constraints_ && i != j ) ? M_SQRT1_2 : 1.0;
+    }
+
+    /// multiplicity and positivity conditions for this state (multistate computations)
+    int state_multiplicity_;
+    std::string state_positivity_;
+
+    /// solver whose transformed integrals this state reuses
+    boost::shared_ptr<v2RDMSolver> integral_donor_;
+
+    /// hamiltonian from FCIDUMP_FILE (null for an SCF reference)
+    boost::shared_ptr<FCIDUMP> fcidump_;
+
+    /// orbital spaces, occupations, and reference energy from fcidump_
+    void InitializeFromFCIDUMP();
+
+    /// identity orbitals and h(pp) orbital energies for fcidump_
+    void FCIDUMPOrbitals();
+
+    /// h(pq) from fcidump_, blocked by irrep
+    boost::shared_ptr<Matrix> GetFCIDUMPOEI();
+
+    /// (pq|rs) from fcidump_ into tei_full_sym_
+    void GetFCIDUMPTEI();
+
+    /// did we start from the orbitals of the previous point of a scan?
+    bool scan_warm_start_;
+
+    /// orbitals per irrep in each space (to match points of a scan)
+    std::vector<int> ScanSpaces();
+
+    /// molecule, basis, and constraints (to tell scans apart)
+    std::string ScanKey();
 
-    /// returns symmetry product for two orbitals
-    int SymmetryPair(int i, int j);
+    /// project the orbitals of the previous point onto the current mo space
+    void ProjectScanOrbitals();
+
+    /// copy x, y, z, and mu from the previous point
+    void ReadScanSolution();
+
+    /// keep x, y, z, mu, and the optimized orbitals for the next point
+    void SaveScanState();
+
+    /// is this solver the 2-positivity warm start of a POSITIVITY_CONTINUATION run?
+    bool continuation_stage_;
+
+    /// converged 2-positivity stage to start from (released once lifted)
+    boost::shared_ptr<v2RDMSolver> continuation_source_;
+
+    /// macroiterations, microiterations, and wall time of the 2-positivity stage
+    long int continuation_oiter_;
+    long int continuation_iiter_;
+    double continuation_time_;
+
+    /// copy the D2, Q2, and G2 blocks of x and z, their rows of y, and mu from the
+    /// stage, and rebuild T1/T2 from the lifted D2
+    void ReadContinuationSolution();
+
+    /// returns symmetry product for two irreps.  psi4 only uses D2h and its
+    /// subgroups (in Cotton order), for which the product table is XOR.
+    /// defined here so the constraint kernels can inline it.  the kernels
+    /// loop over irreps (h < nirrep_) and pair them with orbital irreps,
+    /// e.g. SymmetryPair(h,symmetry[k]); nirrep_ stays a run-time bound
+    int SymmetryPair(int i, int j) { return i ^ j; }
 
     /// returns symmetry product for four orbitals
-    int TotalSym(int i, int j,int k, int l);
+    int TotalSym(int i, int j,int k, int l) {
+        return symmetry[i] ^ symmetry[j] ^ symmetry[k] ^ symmetry[l];
+    }
 
     int * symmetry;
     int * symmetry_full;
@@ -154,12 +299,21 @@ class v2RDMSolver: public Wavefunction{
     /// total number of variables (dimension of primal solution vector)
     long int dimx_;  
 
+    /// length of the primal vectors: dimx_, plus the unpacked D2ab and D2aa
+    /// blocks with SPIN_ADAPT_D2
+    long int dimx_unpacked_;
+
     /// number of auxilliary basis functions
     int nQ_;
 
     /// read three-index integrals and transform them to MO basis
     void ThreeIndexIntegrals(); 
 
+    /// Ca_ in the AO basis, columns sorted by epsilon_a_.  the layout of
+    /// Wavefunction::Ca_subset ("ALL", "OCC", or "VIR"), but for the
+    /// orbitals of this solver rather than those of the reference
+    SharedMatrix CaSubsetAO(std::string subset);
+
     /// three-index integral buffer
     double * Qmo_;
 
@@ -187,6 +341,8 @@ class v2RDMSolver: public Wavefunction{
     int * d2aaoff; 
     int * d2bboff; 
     int * d200off; 
+    int * d2soff;
+    int * d2toff;
     int * q2aboff; 
     int * q2aaoff; 
     int * q2bboff; 
@@ -234,10 +390,49 @@ class v2RDMSolver: public Wavefunction{
     /// standard vector of dimensions of each block of primal solution vector
     std::vector<int> dimensions_;
 
+    /// scratch buffers borrowed by Update_xz, DIIS, etc.
+    Workspace workspace_;
+
+    /// NUMA placement of the large solver vectors (VECTOR_PLACEMENT)
+    VectorPlacement vector_placement_;
+
+    /// compute only one side of the spectrum of each block in Update_xz?
+    bool partial_eigensolve_;
+
+    /// number of positive eigenvalues of each block at the last Update_xz
+    /// (-1 until the block has been fully diagonalized once)
+    std::vector<int> block_npos_;
+
+    /// rank that diagonalizes each block in Update_xz
+    std::vector<int> block_owner_;
+
+    /// copy each block of x and z from the rank that diagonalized it to
+    /// every other rank
+    void BroadcastBlocksFromOwners();
+
+    /// copy each block of x and z from the rank that diagonalized it to the
+    /// ranks whose rows read it
+    void SendBlocksToReaders();
+
+    /// does this rank diagonalize block i, or do its rows read it?
+    bool BlockIsMine(int i);
+
+    /// M = mu*x + ATy - c (in ATy) on the blocks this rank diagonalizes
+    void BuildUpdateMatrix();
+
+    /// c.x, summed over the ranks
+    double PrimalEnergy();
+
     int offset;
 
     // mapping arrays with abelian symmetry
     void BuildBasis();
+
+    /// point the mapping arrays at those of donor (same orbitals)
+    void ShareBasis(boost::shared_ptr<v2RDMSolver> donor);
+
+    /// triplet mapping arrays (T1, T2, and D3)
+    void BuildTripletBasis();
     int * full_basis;
 
     /// mapping arrays with symmetry:
@@ -276,44 +471,181 @@ class v2RDMSolver: public Wavefunction{
     /// read two-electron integrals from disk
     void GetTEIFromDisk();
 
+    /// read two-electron integrals from disk straight into tei_full_sym_
+    void ReadIntegralsDirect();
+
+    /// replace the restricted virtuals with MP2 natural orbitals and freeze
+    /// those below FNO_OCC_TOLERANCE
+    void FrozenNaturalOrbitals();
+
+    /// sort the two-electron integrals through a dense nmo^4 buffer? (set by PlanMemory)
+    bool tei_sort_incore_;
+
+    /// print the footprint of each phase and pick in-core or batched algorithms
+    void PlanMemory();
+
+    /// doubles held from the start of the sdp to the end of the run (set by PlanMemory)
+    double memory_resident_;
+
+    /// doubles held by this solver and by the states that take their
+    /// integrals from it and have been planned so far (set by PlanMemory)
+    double memory_states_;
+
+    /// doubles ThreeIndexIntegrals may use for (Q|mn) and its buffers (set by PlanMemory)
+    long int df_transform_doubles_;
+
+    /// auxiliary functions per ThreeIndexIntegrals batch of rows of the given
+    /// length, so that one batch fits within ndoubles
+    long int DFBatchRows(long int rowlength, long int ndoubles);
+
+    /// peak doubles held by FrozenNaturalOrbitals (0 if it did not run)
+    double fno_peak_;
+
+    /// doubles held by the solution kept from the previous point of a scan
+    double ScanStateDoubles();
+
     /// grab a specific two-electron integral
     double TEI(int i, int j, int k, int l, int h);
 
     void BuildConstraints();
 
     void Guess();
-    void T1_constraints_guess(SharedVector u);
-    void T2_constraints_guess(SharedVector u);
-    void Q2_constraints_guess(SharedVector u);
-    void Q2_constraints_guess_spin_adapted(SharedVector u);
-    void G2_constraints_guess(SharedVector u);
-    void G2_constraints_guess_spin_adapted(SharedVector u);
-
-    void bpsdp_Au(SharedVector A, SharedVector u);
-    void bpsdp_Au_slow(SharedVector A, SharedVector u);
-    void D2_constraints_Au(SharedVector A,SharedVector u);
-    void Q2_constraints_Au(SharedVector A,SharedVector u);
-    void Q2_constraints_Au_spin_adapted(SharedVector A,SharedVector u);
-    void G2_constraints_Au(SharedVector A,SharedVector u);
-    void G2_constraints_Au_spin_adapted(SharedVector A,SharedVector u);
-    void T1_constraints_Au(SharedVector A,SharedVector u);
-    void T2_constraints_Au(SharedVector A,SharedVector u);
-    void T2_constraints_Au_slow(SharedVector A,SharedVector u);
-    void T2_tilde_constraints_Au(SharedVector A,SharedVector u);
-    void D3_constraints_Au(SharedVector A,SharedVector u);
-
-    void bpsdp_ATu(SharedVector A, SharedVector u);
-    void bpsdp_ATu_slow(SharedVector A, SharedVector u);
-    void D2_constraints_ATu(SharedVector A,SharedVector u);
-    void Q2_constraints_ATu(SharedVector A,SharedVector u);
-    void Q2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u);
-    void G2_constraints_ATu(SharedVector A,SharedVector u);
-    void G2_constraints_ATu_spin_adapted(SharedVector A,SharedVector u);
-    void T1_constraints_ATu(SharedVector A,SharedVector u);
-    void T2_constraints_ATu(SharedVector A,SharedVector u);
-    void T2_constraints_ATu_slow(SharedVector A,SharedVector u);
-    void T2_tilde_constraints_ATu(SharedVector A,SharedVector u);
-    void D3_constraints_ATu(SharedVector A,SharedVector u);
+    void T1_constraints_guess(SharedSolverVector u);
+    void T2_constraints_guess(SharedSolverVector u);
+    void Q2_constraints_guess(SharedSolverVector u);
+    void Q2_constraints_guess_spin_adapted(SharedSolverVector u);
+    void G2_constraints_guess(SharedSolverVector u);
+    void G2_constraints_guess_spin_adapted(SharedSolverVector u);
+
+    void bpsdp_Au(SharedSolverVector A, SharedSolverVector u);
+    void bpsdp_Au_slow(SharedSolverVector A, SharedSolverVector u);
+
+    /// A.u for up to MAX_BLOCK_VECTORS vectors in one pass over the index
+    /// maps.  u[v] belongs to states[v], which must share this state's
+    /// constraint layout (SharesConstraintLayout)
+    void bpsdp_Au_block(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u,
+        std::vector<v2RDMSolver*> & states);
+
+    void D2_constraints_Au(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u,std::vector<v2RDMSolver*> & states);
+    void Q2_constraints_Au(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void Q2_constraints_Au_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void G2_constraints_Au(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void G2_constraints_Au_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void T1_constraints_Au(SharedSolverVector A,SharedSolverVector u);
+    void T2_constraints_Au(SharedSolverVector A,SharedSolverVector u);
+    void T2_constraints_Au_slow(SharedSolverVector A,SharedSolverVector u);
+    void T2_tilde_constraints_Au(SharedSolverVector A,SharedSolverVector u);
+    void D3_constraints_Au(SharedSolverVector A,SharedSolverVector u);
+
+    void bpsdp_ATu(SharedSolverVector A, SharedSolverVector u);
+    void bpsdp_ATu_slow(SharedSolverVector A, SharedSolverVector u);
+
+    /// this rank's rows' share of A^T.u, not summed over the ranks
+    void bpsdp_ATu_rows(SharedSolverVector A, SharedSolverVector u);
+
+    /// A^T.u for up to MAX_BLOCK_VECTORS vectors in one pass over the index
+    /// maps (see bpsdp_Au_block)
+    void bpsdp_ATu_block(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u,
+        std::vector<v2RDMSolver*> & states);
+    void bpsdp_ATu_rows_block(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u,
+        std::vector<v2RDMSolver*> & states);
+
+    /// A.x and A^T.y for the current x and y, reusing the cached products
+    void bpsdp_Ax(SharedSolverVector A);
+    void bpsdp_ATy(SharedSolverVector A);
+
+    /// modification stamps of x (and z), y, and c.  bump them whenever
+    /// the vector changes
+    long int x_stamp_;
+    long int y_stamp_;
+    long int c_stamp_;
+
+    /// last A.x and A^T.y, and the stamps of x and y they were built from
+    SharedSolverVector Ax_cache_;
+    SharedSolverVector ATy_cache_;
+    long int Ax_cache_stamp_;
+    long int ATy_cache_stamp_;
+
+    /// number of operator applications saved by the cache
+    long int operator_reuse_total_;
+
+    /// evaluate A.x and the next A(c-z) concurrently? (CONCURRENT_RESIDUALS)
+    bool concurrent_residuals_;
+
+    /// A(c-z), and the stamps of x/z and c it was built from
+    SharedSolverVector Acz_cache_;
+    long int Acz_cache_x_stamp_;
+    long int Acz_cache_c_stamp_;
+
+    /// A.u for several vectors at once, each on its share of the threads
+    void bpsdp_Au_concurrent(std::vector<SharedSolverVector> & A, std::vector<SharedSolverVector> & u);
+
+    /// families of constraints, in the order of the rows of A
+    enum ConstraintFamily { FAMILY_D2, FAMILY_Q2, FAMILY_G2, FAMILY_T1, FAMILY_T2, FAMILY_D3, NFAMILIES };
+
+    /// first row of each family of constraints.  the Au/ATu kernels start
+    /// from here rather than from the shared offset, so they are reentrant
+    std::vector<int> constraint_offset_;
+
+    /// MPI rank of this process and number of ranks (1 without MPI)
+    int rank_;
+    int nproc_;
+
+    /// rows of A held by this rank, [row_begin_, row_end_).  the row-space
+    /// vectors (y, b, A.x, ...) have only these nrow_local_ elements
+    long int row_begin_;
+    long int row_end_;
+    long int nrow_local_;
+
+    /// split the rows over the ranks, at boundaries of the row blocks of
+    /// the Au/ATu kernels
+    void DistributeRows();
+
+    /// while true, RowsAreLocal records the row blocks in row_blocks_
+    bool row_survey_;
+    std::vector< std::pair<long int,long int> > row_blocks_;
+
+    /// D2ab = D2s (+) D2t, and D2aa = D2t, in the unpacked blocks of u
+    void UnpackSpinAdaptedD2(SharedSolverVector u);
+
+    /// the adjoint of UnpackSpinAdaptedD2: D2s and D2t of A from the unpacked
+    /// blocks of A
+    void PackSpinAdaptedD2(SharedSolverVector A);
+
+    /// D2s and D2t of x closest to the unpacked blocks of x (for the guess)
+    void FitSpinAdaptedD2(SharedSolverVector x);
+
+    /// ranks whose rows read each block of the primal vectors, in
+    /// increasing order
+    std::vector< std::vector<int> > block_readers_;
+    void FindBlockReaders();
+
+    /// sum the blocks of A^T.u that more than one rank reads over those ranks
+    void SumSharedBlocks(SharedSolverVector A);
+
+    /// does this rank hold the block of n rows starting at row first?
+    /// the kernels skip the blocks held by other ranks
+    bool RowsAreLocal(long int first, long int n);
+
+    /// pointer to a row-space vector that can be indexed by global row
+    double * RowPointer(SharedSolverVector v) { return v->pointer() - row_begin_; }
+
+    /// all nconstraints_ rows of a row-space vector, on every rank
+    SharedSolverVector GatherRows(SharedSolverVector v);
+
+    /// copy this rank's rows of the full-length vector full into v
+    void KeepLocalRows(SharedSolverVector full, SharedSolverVector v);
+
+    void D2_constraints_ATu(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u,std::vector<v2RDMSolver*> & states);
+    void Q2_constraints_ATu(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void Q2_constraints_ATu_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void G2_constraints_ATu(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void G2_constraints_ATu_spin_adapted(std::vector<SharedSolverVector> & A,std::vector<SharedSolverVector> & u);
+    void T1_constraints_ATu(SharedSolverVector A,SharedSolverVector u);
+    void T2_constraints_ATu(SharedSolverVector A,SharedSolverVector u);
+    void T2_constraints_ATu_slow(SharedSolverVector A,SharedSolverVector u);
+    void T2_tilde_constraints_ATu(SharedSolverVector A,SharedSolverVector u);
+    void D3_constraints_ATu(SharedSolverVector A,SharedSolverVector u);
 
     /// SCF energy
     double escf_; 
@@ -323,26 +655,97 @@ class v2RDMSolver: public Wavefunction{
 
     double tau, mu, ed, ep;
 
+    /// conjugate gradient solver for the dual problem
+    boost::shared_ptr<CGSolver> cg_;
+
+    /// compound right-hand side for the cg solves, A(c-z) + tau mu (b-Ax)
+    SharedSolverVector B_;
+
+    /// current macroiteration and number of cg iterations it took
+    int oiter_;
+    int iiter_;
+
+    /// primal and dual energies and the gap between them
+    double energy_primal_;
+    double energy_dual_;
+    double denergy_primal_;
+    double egap_;
+
+    /// iteration schedules
+    int checkpoint_frequency_;
+    int mu_update_frequency_;
+    int orbopt_frequency_;
+    int orbopt_one_step_;
+
+    /// diis bookkeeping
+    int diis_iter_;
+    int replace_diis_iter_;
+
+    /// adaptive mu/orbital-step schedule (ADAPTIVE_SCHEDULE)
+    bool adaptive_schedule_;
+    double adaptive_mu_ratio_;
+    double adaptive_orbopt_fraction_;
+    int adaptive_min_interval_;
+
+    /// macroiterations of the last mu update and of the last orbital step
+    int last_mu_update_;
+    int last_orbopt_step_;
+
+    /// is a mu update due this macroiteration?  fixed (every
+    /// MU_UPDATE_FREQUENCY) or adaptive (residual balancing); logs the decision
+    bool MuUpdateDue();
+
+    /// is an orbital step due this macroiteration?  fixed (every
+    /// ORBOPT_FREQUENCY) or adaptive (sdp residuals small next to the
+    /// orbital gradient); never while a background step is running.  logs
+    /// the decision
+    bool OrbitalStepDue(double energy);
+
+    /// should a decision to wait, made since iterations after the last
+    /// update of its kind, be logged?  once per ADAPTIVE_MIN_INTERVAL
+    bool LogHold(int since);
+
+    /// adaptive cg convergence (forcing term and progress history)
+    bool adaptive_cg_;
+
+    /// cg iterations allowed in the next inner solve (CG_ADAPTIVE_CONVERGENCE)
+    int InnerIterationBound();
+    double cg_eta_;
+    double last_residual_;
+    double average_iiter_;
+
+    /// wall time at the start of compute_energy
+    double start_total_time_;
+
     //vectors
-    SharedVector Ax;     // vector to hold A . x
-    SharedVector ATy;    // vector to hold A^T . y
-    SharedVector c;      // 1ei and 2ei of bpsdp
-    SharedVector y;      // dual solution
-    SharedVector b;      // constraint vector
-    SharedVector x;      // primal solution
-    SharedVector z;      // second dual solution
-    SharedVector rx;       // square root of x (for diis)
-    SharedVector rz;       // square root of z (for diis)
-    SharedVector rx_error; // error vector for x (for diis)
-    SharedVector rz_error; // error vector for z (for diis)
+    SharedSolverVector Ax;     // vector to hold A . x
+    SharedSolverVector ATy;    // vector to hold A^T . y
+    SharedSolverVector c;      // 1ei and 2ei of bpsdp
+    SharedSolverVector y;      // dual solution
+    SharedSolverVector b;      // constraint vector
+    SharedSolverVector x;      // primal solution
+    SharedSolverVector z;      // second dual solution
+    SharedSolverVector rx;       // square root of x (for diis)
+    SharedSolverVector rz;       // square root of z (for diis)
+    SharedSolverVector rx_error; // error vector for x (for diis)
+    SharedSolverVector rz_error; // error vector for z (for diis)
     
     void Update_xz();
     void Update_xz_nonsymmetric();
 
+    /// update one block of x and z from the eigenpairs on the smaller side
+    /// (positive or negative) of the spectrum of M.  npos is updated.
+    /// returns false, leaving x and z untouched, if that side has grown past
+    /// half of the block (the caller then diagonalizes the block fully)
+    bool Update_xz_block_partial(int n, long int myoffset, int & npos);
+
     void NaturalOrbitals();
     void MullikenPopulations();
     void FinalTransformationMatrix();
 
+    /// apply the accumulated orbital transformation to Ca and Cb
+    void TransformOrbitals(SharedMatrix Ca, SharedMatrix Cb);
+
     // read teis from disk:
     void ReadIntegrals(double * tei,long int nmo);
 
@@ -351,22 +754,56 @@ class v2RDMSolver: public Wavefunction{
 
     /// full space of integrals for MO gradient / Hessian, blocked by symmetry
     double * tei_full_sym_;
+    /// set when tei_full_sym_ (Qmo_ for DF) is shared with other solvers over
+    /// the same orbitals.  the last user frees the buffer.
+    boost::shared_ptr<double> tei_buffer_;
+    /// hand the integral buffer to another solver over the same orbitals
+    boost::shared_ptr<double> SharedIntegrals();
+    /// give this solver its own copy of a shared integral buffer before the
+    /// orbitals (and so the integrals) are rotated in place
+    void PrivatizeIntegrals();
     double * oei_full_sym_;
     // gidofalvi -- modified the type of tei_full_dim_ so that it is correct for large bases 
     long int tei_full_dim_;
     int oei_full_dim_;
 
-    /// full space D2, blocked by symmetry
+    /// full space D2, blocked by symmetry (active-space D2 in the orbital
+    /// optimizer's order if ORBOPT_DIRECT_DENSITY)
     double * d2_plus_core_sym_;
     int d2_plus_core_dim_;
 
-    /// full space D1, blocked by symmetry
+    /// full space D1, blocked by symmetry (active-space D1 in the orbital
+    /// optimizer's order if ORBOPT_DIRECT_DENSITY)
     double * d1_plus_core_sym_;
     int d1_plus_core_dim_;
 
     /// unpack active-space density into full-space density
     void UnpackDensityPlusCore();
 
+    /// pack active-space density directly into the orbital optimizer's layout
+    void PackDensityForOrbOpt();
+
+    /// spin-summed active D2 element (ik|jl) as seen by the orbital optimizer
+    double ActiveD2Element(double * x_p, int i, int j, int k, int l);
+
+    /// geminal index of active pair (p,q) within its irrep, orbital optimizer order
+    int * orbopt_den_gem_;
+
+    /// number of active geminals (p >= q) in each irrep
+    int * active_gems_;
+
+    /// active geminals (p >= q) of each irrep as (p,q) pairs, orbital optimizer order
+    int ** active_gem_bas_;
+
+    /// geminal index of active pair (p,q) in the full (core plus active) layout
+    int * active_plus_core_gem_;
+
+    /// offset of each irrep's block of the full (core plus active) D2
+    long int * d2_plus_core_off_;
+
+    /// offset of each irrep's D2 block, orbital optimizer order
+    long int * orbopt_den_off_;
+
     /// repack rotated full-space integrals into active-space integrals 
     void RepackIntegrals();
     void RepackIntegralsDF();
@@ -382,6 +819,50 @@ class v2RDMSolver: public Wavefunction{
     char * orbopt_outfile_;
     bool orbopt_converged_;
 
+    /// run orbital optimization in a background thread while SDP iterations continue?
+    bool orbopt_async_;
+
+    /// number of threads given to the background orbital optimization
+    int orbopt_async_threads_;
+
+    /// number of threads available to the SDP while an orbital step is in flight
+    int orbopt_sdp_threads_;
+
+    /// background orbital optimization thread (null when idle)
+    std::thread * orbopt_thread_;
+
+    /// set by the background thread when its orbital step is finished
+    std::atomic<bool> orbopt_async_done_;
+
+    /// private copies of the integrals, transformation matrix, and parameters rotated in the background
+    double * orbopt_async_oei_;
+    double * orbopt_async_tei_;
+    double * orbopt_async_transformation_matrix_;
+    double * orbopt_async_data_;
+
+    /// snapshot of d1/d2_plus_core_sym_ read by the background step, so the
+    /// main thread may repack the densities while it runs
+    double * orbopt_async_d1_;
+    double * orbopt_async_d2_;
+
+    /// macroiteration at which the current background step was launched
+    int orbopt_async_start_iter_;
+
+    /// wall time spent by background orbital steps
+    double orbopt_async_time_;
+
+    /// total number of macroiterations that overlapped background orbital steps
+    long int orbopt_async_overlap_total_;
+
+    /// launch an orbital step on a snapshot of the current density
+    void StartAsyncRotateOrbitals();
+
+    /// body of the background orbital step
+    void AsyncOrbOpt();
+
+    /// swap in the result of a background orbital step.  returns true if integrals changed
+    bool FinishAsyncRotateOrbitals(bool wait);
+
     /// are we using 3-index integrals?
     bool is_df_;
 
@@ -418,12 +899,27 @@ class v2RDMSolver: public Wavefunction{
     /// write active-active-active-active 2RDM to disk
     void WriteActiveTPDM();
 
+    /// write active 2RDM to disk as dense symmetry-blocked geminal matrices
+    void WriteBlockedTPDM();
+
     /// read 2RDM from disk
     void ReadTPDM();
 
     /// write active 3RDM to disk
     void WriteActive3PDM();
 
+    /// write active 3RDM to disk as dense symmetry-blocked triplet matrices
+    void WriteBlocked3PDM();
+
+    /// write the active orbital and irrep maps that describe a blocked RDM file
+    void WriteBlockedRDMHeader(boost::shared_ptr<PSIO> psio, int filenum);
+
+    /// read the blocked 2RDM file back and check its traces and energy
+    void CheckBlockedTPDM();
+
+    /// read the blocked 3RDM file back and check its traces
+    void CheckBlocked3PDM();
+
     /// read 3RDM from disk
     void Read3PDM();
 
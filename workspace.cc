@@ -0,0 +1,69 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#include<stdlib.h>
+#include<string.h>
+
+#include <psi4-dec.h>
+
+#include "workspace.h"
+
+namespace psi{ namespace v2rdm_casscf{
+
+Workspace::Workspace() {
+    buffers_.assign(WS_NSLOTS,(void*)NULL);
+    sizes_.assign(WS_NSLOTS,0);
+    current_       = 0;
+    peak_          = 0;
+    reallocations_ = 0;
+}
+
+Workspace::~Workspace() {
+    for (int i = 0; i < WS_NSLOTS; i++) {
+        free(buffers_[i]);
+    }
+}
+
+void Workspace::reserve(int slot, size_t bytes) {
+    if ( slot < 0 || slot >= WS_NSLOTS ) {
+        throw PsiException("invalid workspace slot",__FILE__,__LINE__);
+    }
+    if ( bytes <= sizes_[slot] ) return;
+
+    // the old contents are scratch, so there is nothing to copy
+    free(buffers_[slot]);
+    buffers_[slot] = malloc(bytes);
+    if ( buffers_[slot] == NULL ) {
+        throw PsiException("could not allocate solver workspace",__FILE__,__LINE__);
+    }
+
+    current_ += bytes - sizes_[slot];
+    sizes_[slot] = bytes;
+    if ( current_ > peak_ ) peak_ = current_;
+}
+
+}}
@@ -0,0 +1,107 @@
+/*
+ *@BEGIN LICENSE
+ *
+ * v2RDM-CASSCF, a plugin to:
+ *
+ * PSI4: an ab initio quantum chemistry software package
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (c) 2014, The Florida State University. All rights reserved.
+ *
+ *@END LICENSE
+ *
+ */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include<stdlib.h>
+#include<vector>
+
+namespace psi{ namespace v2rdm_casscf{
+
+/// scratch buffers used by the hot routines of the solver
+enum WorkspaceSlot {
+    WS_BLOCK_MAT,    ///< n x n block of M
+    WS_BLOCK_EVEC,   ///< n x n eigenvectors
+    WS_BLOCK_EVEC2,  ///< n x n selected eigenvectors
+    WS_BLOCK_EVAL,   ///< n eigenvalues
+    WS_BLOCK_EVAL2,  ///< n eigenvalues (imaginary parts / second set)
+    WS_LAPACK_WORK,  ///< LAPACK double work array
+    WS_LAPACK_IWORK, ///< LAPACK integer work array
+    WS_LAPACK_ISUPPZ,///< DSYEVR support array
+    WS_DIIS_A,       ///< DIIS B matrix
+    WS_DIIS_B,       ///< DIIS right-hand side
+    WS_DIIS_TEMP,    ///< DIIS error matrix from disk
+    WS_DIIS_IPIV,    ///< DIIS pivots
+    WS_MO_ROW,       ///< one row of MO coefficients
+    WS_NSLOTS
+};
+
+/// a set of scratch buffers owned by the solver.  buffers are sized once
+/// (see reserve) and then borrowed by the routines that used to malloc and
+/// free temporaries every iteration.  a buffer is only reallocated if a
+/// caller asks for more than it holds, and the contents of a borrowed
+/// buffer are undefined.  not thread safe: borrow outside parallel regions.
+class Workspace {
+public:
+
+    Workspace();
+    ~Workspace();
+
+    /// make sure slot holds at least bytes bytes
+    void reserve(int slot, size_t bytes);
+
+    /// borrow slot as an array of at least n elements
+    double * doubles(int slot, long int n) {
+        return (double*)borrow(slot,n*sizeof(double));
+    }
+    int * ints(int slot, long int n) {
+        return (int*)borrow(slot,n*sizeof(int));
+    }
+    long int * longs(int slot, long int n) {
+        return (long int*)borrow(slot,n*sizeof(long int));
+    }
+
+    /// bytes currently held by all slots
+    size_t current_bytes() { return current_; }
+
+    /// largest number of bytes held at any one time
+    size_t peak_bytes() { return peak_; }
+
+    /// number of times a slot had to grow after it was first sized
+    long int reallocations() { return reallocations_; }
+
+private:
+
+    void * borrow(int slot, size_t bytes) {
+        if ( bytes > sizes_[slot] ) {
+            if ( sizes_[slot] > 0 ) reallocations_++;
+            reserve(slot,bytes);
+        }
+        return buffers_[slot];
+    }
+
+    std::vector<void*> buffers_;
+    std::vector<size_t> sizes_;
+    size_t current_;
+    size_t peak_;
+    long int reallocations_;
+};
+
+}}
+
+#endif
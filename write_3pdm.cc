@@ -32,21 +32,12 @@
 #include <libtrans/integraltransform.h>
 
 #include "v2rdm_solver.h"
+#include "rdm_stream.h"
 
 using namespace psi;
 
 namespace psi{namespace v2rdm_casscf{
 
-struct dm3 {
-    int i;
-    int j;
-    int k;
-    int l;
-    int m;
-    int n;
-    double val;
-};
-
 
 void v2RDMSolver::WriteActive3PDM(){
 
@@ -206,148 +197,266 @@ void v2RDMSolver::WriteActive3PDM(){
 
 }
 
-void v2RDMSolver::Read3PDM(){
+void v2RDMSolver::WriteBlocked3PDM(){
+
+    double * x_p = x->pointer();
 
     boost::shared_ptr<PSIO> psio (new PSIO());
 
-    if ( !psio->exists(PSIF_V2RDM_D3AAA) ) return;
-    if ( !psio->exists(PSIF_V2RDM_D3AAB) ) return;
-    if ( !psio->exists(PSIF_V2RDM_D3AAB) ) return;
-    if ( !psio->exists(PSIF_V2RDM_D3BBB) ) return;
+    psio->open(PSIF_V2RDM_D3_BLOCKED,PSIO_OPEN_NEW);
 
-    //Ca_->print();
+    WriteBlockedRDMHeader(psio,PSIF_V2RDM_D3_BLOCKED);
 
-    double * D3aaa = (double*)malloc(nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D3aab = (double*)malloc(nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D3bba = (double*)malloc(nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D3bbb = (double*)malloc(nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
+    psio->write_entry(PSIF_V2RDM_D3_BLOCKED,"trip_aab",(char*)trip_aab,nirrep_*sizeof(int));
+    psio->write_entry(PSIF_V2RDM_D3_BLOCKED,"trip_aaa",(char*)trip_aaa,nirrep_*sizeof(int));
 
-    memset((void*)D3aaa,'\0',nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D3aab,'\0',nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D3bba,'\0',nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D3bbb,'\0',nmo_*nmo_*nmo_*nmo_*nmo_*nmo_*sizeof(double));
+    // triplet maps: (i,j,k) active-index triples for each triplet, irrep by
+    // irrep.  aab triplets have i < j; aaa triplets have i < j < k
+    long int naab = 0;
+    long int naaa = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        naab += trip_aab[h];
+        naaa += trip_aaa[h];
+    }
+    int * bas_aab = (int*)malloc(3*naab*sizeof(int));
+    int * bas_aaa = (int*)malloc(3*naaa*sizeof(int));
+    naab = 0;
+    naaa = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int ijk = 0; ijk < trip_aab[h]; ijk++) {
+            bas_aab[naab++] = bas_aab_sym[h][ijk][0];
+            bas_aab[naab++] = bas_aab_sym[h][ijk][1];
+            bas_aab[naab++] = bas_aab_sym[h][ijk][2];
+        }
+        for (int ijk = 0; ijk < trip_aaa[h]; ijk++) {
+            bas_aaa[naaa++] = bas_aaa_sym[h][ijk][0];
+            bas_aaa[naaa++] = bas_aaa_sym[h][ijk][1];
+            bas_aaa[naaa++] = bas_aaa_sym[h][ijk][2];
+        }
+    }
+    psio->write_entry(PSIF_V2RDM_D3_BLOCKED,"bas_aab",(char*)bas_aab,naab*sizeof(int));
+    psio->write_entry(PSIF_V2RDM_D3_BLOCKED,"bas_aaa",(char*)bas_aaa,naaa*sizeof(int));
+    free(bas_aab);
+    free(bas_aaa);
+
+    // dense trip x trip blocks, one per irrep, straight out of x
+    psio_address addr_d3aaa = PSIO_ZERO;
+    psio_address addr_d3aab = PSIO_ZERO;
+    psio_address addr_d3bba = PSIO_ZERO;
+    psio_address addr_d3bbb = PSIO_ZERO;
+    for (int h = 0; h < nirrep_; h++) {
+        psio->write(PSIF_V2RDM_D3_BLOCKED,"D3aaa",(char*)(x_p + d3aaaoff[h]),trip_aaa[h]*trip_aaa[h]*sizeof(double),addr_d3aaa,&addr_d3aaa);
+        psio->write(PSIF_V2RDM_D3_BLOCKED,"D3aab",(char*)(x_p + d3aaboff[h]),trip_aab[h]*trip_aab[h]*sizeof(double),addr_d3aab,&addr_d3aab);
+        psio->write(PSIF_V2RDM_D3_BLOCKED,"D3bba",(char*)(x_p + d3bbaoff[h]),trip_aab[h]*trip_aab[h]*sizeof(double),addr_d3bba,&addr_d3bba);
+        psio->write(PSIF_V2RDM_D3_BLOCKED,"D3bbb",(char*)(x_p + d3bbboff[h]),trip_aaa[h]*trip_aaa[h]*sizeof(double),addr_d3bbb,&addr_d3bbb);
+    }
 
-    psio_address addr_aaa = PSIO_ZERO;
-    psio_address addr_bbb = PSIO_ZERO;
-    psio_address addr_aab = PSIO_ZERO;
-    psio_address addr_bba = PSIO_ZERO;
+    psio->close(PSIF_V2RDM_D3_BLOCKED,1);
+}
 
-    // aab
-    psio->open(PSIF_V2RDM_D3AAB,PSIO_OPEN_OLD);
+// read the BLOCKED 3-RDM file back through BlockedRDM and check the traces
+// of its four spin blocks
+void v2RDMSolver::CheckBlocked3PDM(){
+
+    boost::shared_ptr<PSIO> psio (new PSIO());
+    psio->open(PSIF_V2RDM_D3_BLOCKED,PSIO_OPEN_OLD);
 
-    long int naab;
-    psio->read_entry(PSIF_V2RDM_D3AAB,"length",(char*)&naab,sizeof(long int));
-
-    for (int count = 0; count < naab; count++) {
-        dm3 d3;
-        psio->read(PSIF_V2RDM_D3AAB,"D3aab",(char*)&d3,sizeof(dm3),addr_aab,&addr_aab);
-        int i = d3.i;
-        int j = d3.j;
-        int k = d3.k;
-        int l = d3.l;
-        int m = d3.m;
-        int n = d3.n;
-        long int id = i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n;
-        D3aab[id] = d3.val;
+    BlockedRDM d3(psio,PSIF_V2RDM_D3_BLOCKED,3);
+    if ( d3.nirrep() != nirrep_ || d3.amo() != amo_ || d3.nmo() != nmo_ ) {
+        throw PsiException("blocked 3-RDM file does not match this computation",__FILE__,__LINE__);
     }
-    psio->close(PSIF_V2RDM_D3AAB,1);
 
-    // bba
-    psio->open(PSIF_V2RDM_D3BBA,PSIO_OPEN_OLD);
+    double na = nalpha_ - nrstc_ - nfrzc_;
+    double nb = nbeta_ - nrstc_ - nfrzc_;
 
-    long int nbba;
-    psio->read_entry(PSIF_V2RDM_D3BBA,"length",(char*)&nbba,sizeof(long int));
-
-    for (int count = 0; count < nbba; count++) {
-        dm3 d3;
-        psio->read(PSIF_V2RDM_D3BBA,"D3bba",(char*)&d3,sizeof(dm3),addr_bba,&addr_bba);
-        int i = d3.i;
-        int j = d3.j;
-        int k = d3.k;
-        int l = d3.l;
-        int m = d3.m;
-        int n = d3.n;
-        long int id = i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n;
-        D3bba[id] = d3.val;
+    // D3aaa, D3aab, D3bba, D3bbb
+    const char * label[4] = {"D3aaa","D3aab","D3bba","D3bbb"};
+    double expected[4] = { na*(na-1)*(na-2)/6.0, 0.5*na*(na-1)*nb, 0.5*nb*(nb-1)*na, nb*(nb-1)*(nb-2)/6.0 };
+    double trace[4] = {0.0,0.0,0.0,0.0};
+
+    for (int h = 0; h < nirrep_; h++) {
+        long int nmixed = d3.dim_mixed(h);
+        long int nsame  = d3.dim_same(h);
+        double * block = (double*)malloc((nmixed*nmixed > nsame*nsame ? nmixed*nmixed : nsame*nsame)*sizeof(double));
+        for (int s = 0; s < 4; s++) {
+            bool same = ( s == 0 || s == 3 );
+            long int n = same ? nsame : nmixed;
+            if ( same ) d3.read_same(label[s],h,block);
+            else        d3.read_mixed(label[s],h,block);
+            for (long int ijk = 0; ijk < n; ijk++) {
+                trace[s] += block[ijk*n+ijk];
+            }
+        }
+        free(block);
     }
-    psio->close(PSIF_V2RDM_D3BBA,1);
+    psio->close(PSIF_V2RDM_D3_BLOCKED,1);
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Blocked 3-RDM file check <==\n");
+    outfile->Printf("\n");
+    for (int s = 0; s < 4; s++) {
+        outfile->Printf("        Tr(%s):          %20.12lf (expected %20.12lf)\n",label[s],trace[s],expected[s]);
+
+        char * name = (char*)malloc(100*sizeof(char));
+        sprintf(name,"v2RDM BLOCKED %s TRACE",label[s]);
+        for (char * p = name; *p; p++) *p = toupper(*p);
+        Process::environment.globals[name] = trace[s];
+        free(name);
+    }
+    outfile->Printf("\n");
+}
+
+void v2RDMSolver::Read3PDM(){
+
+    boost::shared_ptr<PSIO> psio (new PSIO());
+
+    if ( !psio->exists(PSIF_V2RDM_D3AAA) ) return;
+    if ( !psio->exists(PSIF_V2RDM_D3AAB) ) return;
+    if ( !psio->exists(PSIF_V2RDM_D3BBA) ) return;
+    if ( !psio->exists(PSIF_V2RDM_D3BBB) ) return;
+
+    // check that 3-RDM contracts properly to 2-RDM.  the files are streamed
+    // in large chunks, and the partial traces are accumulated record by
+    // record into active-space (amo^4) buffers, so the full nmo^6 3-RDM is
+    // never held in memory.
+
+    // map full-space orbital index to active-space index (-1 if inactive)
+    int * active = (int*)malloc(nmo_*sizeof(int));
+    for (int p = 0; p < nmo_; p++) {
+        active[p] = -1;
+    }
+    for (int p = 0; p < amo_; p++) {
+        active[full_basis[p]] = p;
+    }
+
+    long int a1 = amo_;
+    long int a2 = a1 * amo_;
+    long int a3 = a2 * amo_;
+    long int a4 = a3 * amo_;
+
+    // D2aa / D2bb from each of the four spin blocks:  sum_q D3(ijq;klq)
+    double * D2aa_aaa = (double*)malloc(a4*sizeof(double));
+    double * D2aa_aab = (double*)malloc(a4*sizeof(double));
+    double * D2bb_bba = (double*)malloc(a4*sizeof(double));
+    double * D2bb_bbb = (double*)malloc(a4*sizeof(double));
+
+    // D2ab from aab and bba, summing over the first or second index
+    double * D2ab_aab_1 = (double*)malloc(a4*sizeof(double));
+    double * D2ab_bba_1 = (double*)malloc(a4*sizeof(double));
+    double * D2ab_aab_2 = (double*)malloc(a4*sizeof(double));
+    double * D2ab_bba_2 = (double*)malloc(a4*sizeof(double));
+
+    memset((void*)D2aa_aaa,'\0',a4*sizeof(double));
+    memset((void*)D2aa_aab,'\0',a4*sizeof(double));
+    memset((void*)D2bb_bba,'\0',a4*sizeof(double));
+    memset((void*)D2bb_bbb,'\0',a4*sizeof(double));
+    memset((void*)D2ab_aab_1,'\0',a4*sizeof(double));
+    memset((void*)D2ab_bba_1,'\0',a4*sizeof(double));
+    memset((void*)D2ab_aab_2,'\0',a4*sizeof(double));
+    memset((void*)D2ab_bba_2,'\0',a4*sizeof(double));
 
     // aaa
     psio->open(PSIF_V2RDM_D3AAA,PSIO_OPEN_OLD);
-
-    long int naaa;
-    psio->read_entry(PSIF_V2RDM_D3AAA,"length",(char*)&naaa,sizeof(long int));
-
-    for (int count = 0; count < naaa; count++) {
-        dm3 d3;
-        psio->read(PSIF_V2RDM_D3AAA,"D3aaa",(char*)&d3,sizeof(dm3),addr_aaa,&addr_aaa);
-        int i = d3.i;
-        int j = d3.j;
-        int k = d3.k;
-        int l = d3.l;
-        int m = d3.m;
-        int n = d3.n;
-        long int id = i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n;
-        D3aaa[id] = d3.val;
+    {
+        RDMStream<dm3> d3(psio,PSIF_V2RDM_D3AAA,"D3aaa");
+        while ( long int nrec = d3.next() ) {
+            dm3 * rec = d3.records();
+            for (long int p = 0; p < nrec; p++) {
+                if ( rec[p].k != rec[p].n ) continue;
+                int i = active[rec[p].i];
+                int j = active[rec[p].j];
+                int l = active[rec[p].l];
+                int m = active[rec[p].m];
+                if ( i < 0 || j < 0 || l < 0 || m < 0 ) continue;
+                D2aa_aaa[i*a3+j*a2+l*a1+m] += rec[p].val;
+            }
+        }
     }
     psio->close(PSIF_V2RDM_D3AAA,1);
 
     // bbb
     psio->open(PSIF_V2RDM_D3BBB,PSIO_OPEN_OLD);
-
-    long int nbbb;
-    psio->read_entry(PSIF_V2RDM_D3BBB,"length",(char*)&nbbb,sizeof(long int));
-
-    for (int count = 0; count < nbbb; count++) {
-        dm3 d3;
-        psio->read(PSIF_V2RDM_D3BBB,"D3bbb",(char*)&d3,sizeof(dm3),addr_bbb,&addr_bbb);
-        int i = d3.i;
-        int j = d3.j;
-        int k = d3.k;
-        int l = d3.l;
-        int m = d3.m;
-        int n = d3.n;
-        long int id = i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n;
-        D3bbb[id] = d3.val;
+    {
+        RDMStream<dm3> d3(psio,PSIF_V2RDM_D3BBB,"D3bbb");
+        while ( long int nrec = d3.next() ) {
+            dm3 * rec = d3.records();
+            for (long int p = 0; p < nrec; p++) {
+                if ( rec[p].k != rec[p].n ) continue;
+                int i = active[rec[p].i];
+                int j = active[rec[p].j];
+                int l = active[rec[p].l];
+                int m = active[rec[p].m];
+                if ( i < 0 || j < 0 || l < 0 || m < 0 ) continue;
+                D2bb_bbb[i*a3+j*a2+l*a1+m] += rec[p].val;
+            }
+        }
     }
     psio->close(PSIF_V2RDM_D3BBB,1);
 
-    // check traces:
-    /*double traaa = 0.0;
-    double trbbb = 0.0;
-    double traab = 0.0;
-    double trbba = 0.0;
-    for (int i = 0; i < nmo_; i++) {
-        for (int j = 0; j < nmo_; j++) {
-            for (int k = 0; k < nmo_; k++) {
-                traaa += D3aaa[i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n];
-                traab += D3aab[i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n];
-                trbba += D3bba[i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n];
-                trbbb += D3bbb[i*nmo_*nmo_*nmo_*nmo_*nmo_ + j*nmo_*nmo_*nmo_*nmo_ + k*nmo_*nmo_*nmo_ + l*nmo_*nmo_ + m*nmo_ + n];
+    // aab and bba are written with identical index sequences, so stream
+    // them together to check that D3aab = D3bba along the way
+    psio->open(PSIF_V2RDM_D3AAB,PSIO_OPEN_OLD);
+    psio->open(PSIF_V2RDM_D3BBA,PSIO_OPEN_OLD);
+
+    double diff_aab_bba = 0.0;
+    bool same_order = true;
+    {
+        RDMStream<dm3> d3aab(psio,PSIF_V2RDM_D3AAB,"D3aab");
+        RDMStream<dm3> d3bba(psio,PSIF_V2RDM_D3BBA,"D3bba");
+        if ( d3aab.length() != d3bba.length() ) {
+            throw PsiException("D3aab and D3bba files have different lengths",__FILE__,__LINE__);
+        }
+
+        while ( long int nrec = d3aab.next() ) {
+            d3bba.next();
+            dm3 * rec_aab = d3aab.records();
+            dm3 * rec_bba = d3bba.records();
+            for (long int p = 0; p < nrec; p++) {
+
+                if ( same_order ) {
+                    if ( rec_aab[p].i != rec_bba[p].i || rec_aab[p].j != rec_bba[p].j || rec_aab[p].k != rec_bba[p].k
+                      || rec_aab[p].l != rec_bba[p].l || rec_aab[p].m != rec_bba[p].m || rec_aab[p].n != rec_bba[p].n ) {
+                        same_order = false;
+                    }else {
+                        double dum = rec_aab[p].val - rec_bba[p].val;
+                        diff_aab_bba += dum * dum;
+                    }
+                }
+
+                for (int spin = 0; spin < 2; spin++) {
+
+                    dm3 * rec = ( spin == 0 ) ? rec_aab + p : rec_bba + p;
+
+                    int i = active[rec->i];
+                    int j = active[rec->j];
+                    int k = active[rec->k];
+                    int l = active[rec->l];
+                    int m = active[rec->m];
+                    int n = active[rec->n];
+                    double val = rec->val;
+
+                    // sum_q D3(ijq;lmq)
+                    if ( rec->k == rec->n && i >= 0 && j >= 0 && l >= 0 && m >= 0 ) {
+                        if ( spin == 0 ) D2aa_aab[i*a3+j*a2+l*a1+m] += val;
+                        else             D2bb_bba[i*a3+j*a2+l*a1+m] += val;
+                    }
+                    // sum_q D3(iqk;lqn)
+                    if ( rec->j == rec->m && i >= 0 && k >= 0 && l >= 0 && n >= 0 ) {
+                        if ( spin == 0 ) D2ab_aab_1[i*a3+k*a2+l*a1+n] += val;
+                        else             D2ab_bba_1[k*a3+i*a2+n*a1+l] += val;
+                    }
+                    // sum_q D3(qjk;qmn)
+                    if ( rec->i == rec->l && j >= 0 && k >= 0 && m >= 0 && n >= 0 ) {
+                        if ( spin == 0 ) D2ab_aab_2[j*a3+k*a2+m*a1+n] += val;
+                        else             D2ab_bba_2[k*a3+j*a2+n*a1+m] += val;
+                    }
+                }
             }
         }
     }
-    printf("  tr(d3aaa) = %20.12lf\n",traaa);
-    printf("  tr(d3aab) = %20.12lf\n",traab);
-    printf("  tr(d3bba) = %20.12lf\n",trbba);
-    printf("  tr(d3bbb) = %20.12lf\n",trbbb);*/
-
-    // check that 3-RDM contracts properly to 2-RDM:
-
-    double * D2aa = (double*)malloc(nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D2bb = (double*)malloc(nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D2ab = (double*)malloc(nmo_*nmo_*nmo_*nmo_*sizeof(double));
-
-    memset((void*)D2aa,'\0',nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D2bb,'\0',nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D2ab,'\0',nmo_*nmo_*nmo_*nmo_*sizeof(double));
-
-    double en2 = 0.0;
-    int n1 = nmo_;
-    int n2 = n1 * nmo_;
-    int n3 = n2 * nmo_;
-    int n4 = n3 * nmo_;
-    int n5 = n4 * nmo_;
+    psio->close(PSIF_V2RDM_D3AAB,1);
+    psio->close(PSIF_V2RDM_D3BBA,1);
+
     double * x_p = x->pointer();
 
     int na = nalpha_ - nrstc_ - nfrzc_;
@@ -359,32 +468,14 @@ void v2RDMSolver::Read3PDM(){
             int i = bas_aa_sym[h][ij][0];
             int j = bas_aa_sym[h][ij][1];
 
-            int ifull  = full_basis[i];
-            int jfull  = full_basis[j];
-
             for (int kl = 0; kl < gems_aa[h]; kl++) {
                 int k = bas_aa_sym[h][kl][0];
                 int l = bas_aa_sym[h][kl][1];
 
-                int kfull  = full_basis[k];
-                int lfull  = full_basis[l];
-
-                double d2aa_aaa = 0.0;
-                double d2aa_aab = 0.0;
-                double d2bb_bba = 0.0;
-                double d2bb_bbb = 0.0;
-
-                for (int q = 0; q < nmo_; q++) {
-                    d2aa_aaa += D3aaa[ifull*n5 + jfull * n4 + q * n3 + kfull * n2 + lfull * n1 + q];
-                    d2aa_aab += D3aab[ifull*n5 + jfull * n4 + q * n3 + kfull * n2 + lfull * n1 + q];
-                    d2bb_bbb += D3bbb[ifull*n5 + jfull * n4 + q * n3 + kfull * n2 + lfull * n1 + q];
-                    d2bb_bba += D3bba[ifull*n5 + jfull * n4 + q * n3 + kfull * n2 + lfull * n1 + q];
-                }
-
-                d2aa_aaa /= (na - 2.0);
-                d2aa_aab /= nb;
-                d2bb_bbb /= (nb - 2.0);
-                d2bb_bba /= na;
+                double d2aa_aaa = D2aa_aaa[i*a3+j*a2+k*a1+l] / (na - 2.0);
+                double d2aa_aab = D2aa_aab[i*a3+j*a2+k*a1+l] / nb;
+                double d2bb_bbb = D2bb_bbb[i*a3+j*a2+k*a1+l] / (nb - 2.0);
+                double d2bb_bba = D2bb_bba[i*a3+j*a2+k*a1+l] / na;
 
                 double dum = d2aa_aaa - x_p[d2aaoff[h] + ij*gems_aa[h] + kl];
                 error_aa += dum*dum;
@@ -397,22 +488,10 @@ void v2RDMSolver::Read3PDM(){
 
                 // again, with other indices
 
-                d2aa_aaa = 0.0;
-                d2aa_aab = 0.0;
-                d2bb_bba = 0.0;
-                d2bb_bbb = 0.0;
-
-                for (int q = 0; q < nmo_; q++) {
-                    d2aa_aaa += D3aaa[jfull*n5 + ifull * n4 + q * n3 + lfull * n2 + kfull * n1 + q];
-                    d2aa_aab += D3aab[jfull*n5 + ifull * n4 + q * n3 + lfull * n2 + kfull * n1 + q];
-                    d2bb_bbb += D3bbb[jfull*n5 + ifull * n4 + q * n3 + lfull * n2 + kfull * n1 + q];
-                    d2bb_bba += D3bba[jfull*n5 + ifull * n4 + q * n3 + lfull * n2 + kfull * n1 + q];
-                }
-
-                d2aa_aaa /= (na - 2.0);
-                d2aa_aab /= nb;
-                d2bb_bbb /= (nb - 2.0);
-                d2bb_bba /= na;
+                d2aa_aaa = D2aa_aaa[j*a3+i*a2+l*a1+k] / (na - 2.0);
+                d2aa_aab = D2aa_aab[j*a3+i*a2+l*a1+k] / nb;
+                d2bb_bbb = D2bb_bbb[j*a3+i*a2+l*a1+k] / (nb - 2.0);
+                d2bb_bba = D2bb_bba[j*a3+i*a2+l*a1+k] / na;
 
                 dum = d2aa_aaa - x_p[d2aaoff[h] + ij*gems_aa[h] + kl];
                 error_aa += dum*dum;
@@ -422,8 +501,6 @@ void v2RDMSolver::Read3PDM(){
                 error_aa += dum*dum;
                 dum = d2bb_bba - x_p[d2bboff[h] + ij*gems_aa[h] + kl];
                 error_aa += dum*dum;
-
-                //printf("%20.12lf %20.12lf %20.12lf\n",d2aa_aaa,d2aa_aab,x_p[d2aaoff[h] + ij*gems_aa[h] + kl]);
             }
         }
     }
@@ -436,26 +513,12 @@ void v2RDMSolver::Read3PDM(){
             int i = bas_ab_sym[h][ij][0];
             int j = bas_ab_sym[h][ij][1];
 
-            int ifull  = full_basis[i];
-            int jfull  = full_basis[j];
-
             for (int kl = 0; kl < gems_ab[h]; kl++) {
                 int k = bas_ab_sym[h][kl][0];
                 int l = bas_ab_sym[h][kl][1];
 
-                int kfull  = full_basis[k];
-                int lfull  = full_basis[l];
-
-                double d2ab_aab = 0.0;
-                double d2ab_bba = 0.0;
-
-                for (int q = 0; q < nmo_; q++) {
-                    d2ab_aab += D3aab[ifull*n5 + q * n4 + jfull * n3 + kfull * n2 + q * n1 + lfull];
-                    d2ab_bba += D3bba[jfull*n5 + q * n4 + ifull * n3 + lfull * n2 + q * n1 + kfull];
-                }
-
-                d2ab_aab /= (na - 1.0);
-                d2ab_bba /= (nb - 1.0);
+                double d2ab_aab = D2ab_aab_1[i*a3+j*a2+k*a1+l] / (na - 1.0);
+                double d2ab_bba = D2ab_bba_1[i*a3+j*a2+k*a1+l] / (nb - 1.0);
 
                 double dum = d2ab_aab - x_p[d2aboff[h] + ij*gems_ab[h] + kl];
                 error_ab += dum*dum;
@@ -464,16 +527,8 @@ void v2RDMSolver::Read3PDM(){
 
                 // again, with a different summation index
 
-                d2ab_aab = 0.0;
-                d2ab_bba = 0.0;
-
-                for (int q = 0; q < nmo_; q++) {
-                    d2ab_aab += D3aab[q*n5 + ifull * n4 + jfull * n3 + q * n2 + kfull * n1 + lfull];
-                    d2ab_bba += D3bba[q*n5 + jfull * n4 + ifull * n3 + q * n2 + lfull * n1 + kfull];
-                }
-
-                d2ab_aab /= (na - 1.0);
-                d2ab_bba /= (nb - 1.0);
+                d2ab_aab = D2ab_aab_2[i*a3+j*a2+k*a1+l] / (na - 1.0);
+                d2ab_bba = D2ab_bba_2[i*a3+j*a2+k*a1+l] / (nb - 1.0);
 
                 dum = d2ab_aab - x_p[d2aboff[h] + ij*gems_ab[h] + kl];
                 error_ab += dum*dum;
@@ -484,17 +539,19 @@ void v2RDMSolver::Read3PDM(){
     }
     printf("norm of error in ab 2-RDM contracted from 3-RDM:    %20.12lf\n",sqrt(error_ab));
 
-    free(D2aa);
-    free(D2bb);
-    free(D2ab);
-
-    C_DAXPY(n5*nmo_,-1.0,D3bba,1,D3aab,1);
-    printf("d3aab=d3bba %20.12lf\n",C_DNRM2(n5*nmo_,D3aab,1));
+    if ( same_order ) {
+        printf("d3aab=d3bba %20.12lf\n",sqrt(diff_aab_bba));
+    }
 
-    free(D3aaa);
-    free(D3aab);
-    free(D3bba);
-    free(D3bbb);
+    free(active);
+    free(D2aa_aaa);
+    free(D2aa_aab);
+    free(D2bb_bba);
+    free(D2bb_bbb);
+    free(D2ab_aab_1);
+    free(D2ab_bba_1);
+    free(D2ab_aab_2);
+    free(D2ab_bba_2);
 }
 
 
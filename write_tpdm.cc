@@ -32,19 +32,12 @@
 #include <libtrans/integraltransform.h>
 
 #include "v2rdm_solver.h"
+#include "rdm_stream.h"
 
 using namespace psi;
 
 namespace psi{namespace v2rdm_casscf{
 
-struct tpdm {
-    int i;
-    int j;
-    int k;
-    int l;
-    double val;
-};
-
 
 void v2RDMSolver::WriteTPDM(){
 
@@ -364,6 +357,185 @@ void v2RDMSolver::WriteActiveTPDM(){
 
 }
 
+void v2RDMSolver::WriteBlockedRDMHeader(boost::shared_ptr<PSIO> psio, int filenum){
+
+    // format version, number of irreps, active orbitals, all orbitals
+    int header[4];
+    header[0] = 1;
+    header[1] = nirrep_;
+    header[2] = amo_;
+    header[3] = nmo_;
+    psio->write_entry(filenum,"header",(char*)header,4*sizeof(int));
+
+    // active orbitals per irrep, irrep of each active orbital, and the
+    // full-space (pitzer) index of each active orbital
+    psio->write_entry(filenum,"amopi",(char*)amopi_,nirrep_*sizeof(int));
+    psio->write_entry(filenum,"symmetry",(char*)symmetry,amo_*sizeof(int));
+    psio->write_entry(filenum,"full_basis",(char*)full_basis,amo_*sizeof(int));
+}
+
+void v2RDMSolver::WriteBlockedTPDM(){
+
+    double * x_p = x->pointer();
+
+    boost::shared_ptr<PSIO> psio (new PSIO());
+
+    psio->open(PSIF_V2RDM_D2_BLOCKED,PSIO_OPEN_NEW);
+
+    WriteBlockedRDMHeader(psio,PSIF_V2RDM_D2_BLOCKED);
+
+    psio->write_entry(PSIF_V2RDM_D2_BLOCKED,"gems_ab",(char*)gems_ab,nirrep_*sizeof(int));
+    psio->write_entry(PSIF_V2RDM_D2_BLOCKED,"gems_aa",(char*)gems_aa,nirrep_*sizeof(int));
+
+    // geminal maps: (i,j) active-index pairs for each geminal, irrep by irrep.
+    // ab geminals include all i,j; aa geminals only i < j
+    long int nab = 0;
+    long int naa = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        nab += gems_ab[h];
+        naa += gems_aa[h];
+    }
+    int * bas_ab = (int*)malloc(2*nab*sizeof(int));
+    int * bas_aa = (int*)malloc(2*naa*sizeof(int));
+    nab = 0;
+    naa = 0;
+    for (int h = 0; h < nirrep_; h++) {
+        for (int ij = 0; ij < gems_ab[h]; ij++) {
+            bas_ab[nab++] = bas_ab_sym[h][ij][0];
+            bas_ab[nab++] = bas_ab_sym[h][ij][1];
+        }
+        for (int ij = 0; ij < gems_aa[h]; ij++) {
+            bas_aa[naa++] = bas_aa_sym[h][ij][0];
+            bas_aa[naa++] = bas_aa_sym[h][ij][1];
+        }
+    }
+    psio->write_entry(PSIF_V2RDM_D2_BLOCKED,"bas_ab",(char*)bas_ab,nab*sizeof(int));
+    psio->write_entry(PSIF_V2RDM_D2_BLOCKED,"bas_aa",(char*)bas_aa,naa*sizeof(int));
+    free(bas_ab);
+    free(bas_aa);
+
+    // dense gems x gems blocks, one per irrep, straight out of x
+    psio_address addr_d2ab = PSIO_ZERO;
+    psio_address addr_d2aa = PSIO_ZERO;
+    psio_address addr_d2bb = PSIO_ZERO;
+    for (int h = 0; h < nirrep_; h++) {
+        psio->write(PSIF_V2RDM_D2_BLOCKED,"D2ab",(char*)(x_p + d2aboff[h]),gems_ab[h]*gems_ab[h]*sizeof(double),addr_d2ab,&addr_d2ab);
+        psio->write(PSIF_V2RDM_D2_BLOCKED,"D2aa",(char*)(x_p + d2aaoff[h]),gems_aa[h]*gems_aa[h]*sizeof(double),addr_d2aa,&addr_d2aa);
+        psio->write(PSIF_V2RDM_D2_BLOCKED,"D2bb",(char*)(x_p + d2bboff[h]),gems_aa[h]*gems_aa[h]*sizeof(double),addr_d2bb,&addr_d2bb);
+    }
+
+    psio->close(PSIF_V2RDM_D2_BLOCKED,1);
+}
+
+// read the BLOCKED 2-RDM file back through BlockedRDM and check it against
+// the solution it came from: the traces of the three spin blocks, and the
+// energy evaluated from the file's blocks and index maps alone (the 1-RDM
+// is the partial trace of D2ab)
+void v2RDMSolver::CheckBlockedTPDM(){
+
+    boost::shared_ptr<PSIO> psio (new PSIO());
+    psio->open(PSIF_V2RDM_D2_BLOCKED,PSIO_OPEN_OLD);
+
+    BlockedRDM d2(psio,PSIF_V2RDM_D2_BLOCKED,2);
+    if ( d2.nirrep() != nirrep_ || d2.amo() != amo_ || d2.nmo() != nmo_ ) {
+        throw PsiException("blocked 2-RDM file does not match this computation",__FILE__,__LINE__);
+    }
+
+    int na = nalpha_ - nrstc_ - nfrzc_;
+    int nb = nbeta_ - nrstc_ - nfrzc_;
+
+    const std::vector<int> & sym  = d2.symmetry();
+    const std::vector<int> & full = d2.full_basis();
+
+    double * Da = (double*)malloc(amo_*amo_*sizeof(double));
+    double * Db = (double*)malloc(amo_*amo_*sizeof(double));
+    memset((void*)Da,'\0',amo_*amo_*sizeof(double));
+    memset((void*)Db,'\0',amo_*amo_*sizeof(double));
+
+    double trab = 0.0;
+    double traa = 0.0;
+    double trbb = 0.0;
+    double en2  = 0.0;
+
+    for (int h = 0; h < nirrep_; h++) {
+
+        long int nab = d2.dim_mixed(h);
+        long int naa = d2.dim_same(h);
+
+        double * block = (double*)malloc((nab*nab > naa*naa ? nab*nab : naa*naa)*sizeof(double));
+
+        d2.read_mixed("D2ab",h,block);
+        for (long int ij = 0; ij < nab; ij++) {
+            int i = d2.mixed(h,ij)[0];
+            int j = d2.mixed(h,ij)[1];
+            for (long int kl = 0; kl < nab; kl++) {
+                int k = d2.mixed(h,kl)[0];
+                int l = d2.mixed(h,kl)[1];
+                double val = block[ij*nab+kl];
+                if ( ij == kl ) trab += val;
+                if ( j == l ) Da[i*amo_+k] += val;
+                if ( i == k ) Db[j*amo_+l] += val;
+                en2 += val * TEI(full[i],full[k],full[j],full[l],SymmetryPair(sym[i],sym[k]));
+            }
+        }
+
+        for (int spin = 0; spin < 2; spin++) {
+            d2.read_same(spin == 0 ? "D2aa" : "D2bb",h,block);
+            for (long int ij = 0; ij < naa; ij++) {
+                int i = d2.same(h,ij)[0];
+                int j = d2.same(h,ij)[1];
+                for (long int kl = 0; kl < naa; kl++) {
+                    int k = d2.same(h,kl)[0];
+                    int l = d2.same(h,kl)[1];
+                    double val = block[ij*naa+kl];
+                    if ( ij == kl ) {
+                        if ( spin == 0 ) traa += val;
+                        else             trbb += val;
+                    }
+                    en2 += val * ( TEI(full[i],full[k],full[j],full[l],SymmetryPair(sym[i],sym[k]))
+                                 - TEI(full[i],full[l],full[j],full[k],SymmetryPair(sym[i],sym[l])) );
+                }
+            }
+        }
+        free(block);
+    }
+    psio->close(PSIF_V2RDM_D2_BLOCKED,1);
+
+    // one-electron energy from the partial traces, with the coefficients
+    // (core fock matrix included) that the solver uses for D1
+    double en1 = 0.0;
+    double * c_p = c->pointer();
+    for (int h = 0; h < nirrep_; h++) {
+        for (int i = 0; i < amopi_[h]; i++) {
+            int ii = i + pitzer_offset[h];
+            for (int k = 0; k < amopi_[h]; k++) {
+                int kk = k + pitzer_offset[h];
+                if ( nb > 0 ) en1 += c_p[d1aoff[h] + i*amopi_[h] + k] * Da[ii*amo_+kk] / nb;
+                if ( na > 0 && !alias_beta_blocks_ ) en1 += c_p[d1boff[h] + i*amopi_[h] + k] * Db[ii*amo_+kk] / na;
+            }
+        }
+    }
+    free(Da);
+    free(Db);
+
+    double energy = en1 + en2 + enuc_ + efzc_;
+
+    outfile->Printf("\n");
+    outfile->Printf("  ==> Blocked 2-RDM file check <==\n");
+    outfile->Printf("\n");
+    outfile->Printf("        Tr(D2ab):           %20.12lf (expected %20.12lf)\n",trab,(double)na*nb);
+    outfile->Printf("        Tr(D2aa):           %20.12lf (expected %20.12lf)\n",traa,0.5*na*(na-1));
+    outfile->Printf("        Tr(D2bb):           %20.12lf (expected %20.12lf)\n",trbb,0.5*nb*(nb-1));
+    outfile->Printf("        Energy from file:   %20.12lf\n",energy);
+    outfile->Printf("        v2RDM total energy: %20.12lf\n",energy_primal_+enuc_+efzc_);
+    outfile->Printf("\n");
+
+    Process::environment.globals["v2RDM BLOCKED D2AB TRACE"]    = trab;
+    Process::environment.globals["v2RDM BLOCKED D2AA TRACE"]    = traa;
+    Process::environment.globals["v2RDM BLOCKED D2BB TRACE"]    = trbb;
+    Process::environment.globals["v2RDM BLOCKED 2-RDM ENERGY"]  = energy;
+}
+
 void v2RDMSolver::ReadTPDM(){
 
     boost::shared_ptr<PSIO> psio (new PSIO());
@@ -374,117 +546,106 @@ void v2RDMSolver::ReadTPDM(){
 
     //Ca_->print();
 
-    double * D2aa = (double*)malloc(nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D2bb = (double*)malloc(nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    double * D2ab = (double*)malloc(nmo_*nmo_*nmo_*nmo_*sizeof(double));
+    // the files are streamed in large chunks, and the traces, 1-RDMs, and
+    // two-electron energy are accumulated record by record, so nothing
+    // larger than nmo^2 is ever held in memory.
 
-    memset((void*)D2aa,'\0',nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D2bb,'\0',nmo_*nmo_*nmo_*nmo_*sizeof(double));
-    memset((void*)D2ab,'\0',nmo_*nmo_*nmo_*nmo_*sizeof(double));
+    double * Da = (double*)malloc(nmo_*nmo_*sizeof(double));
+    double * Db = (double*)malloc(nmo_*nmo_*sizeof(double));
 
-    psio_address addr_aa = PSIO_ZERO;
-    psio_address addr_bb = PSIO_ZERO;
-    psio_address addr_ab = PSIO_ZERO;
+    memset((void*)Da,'\0',nmo_*nmo_*sizeof(double));
+    memset((void*)Db,'\0',nmo_*nmo_*sizeof(double));
+
+    double traa = 0.0;
+    double trbb = 0.0;
+    double trab = 0.0;
+
+    double en2 = 0.0;
 
     // ab
     psio->open(PSIF_V2RDM_D2AB,PSIO_OPEN_OLD);
-
-    long int nab;
-    psio->read_entry(PSIF_V2RDM_D2AB,"length",(char*)&nab,sizeof(long int));
-
-    for (int n = 0; n < nab; n++) {
-        tpdm d2;
-        psio->read(PSIF_V2RDM_D2AB,"D2ab",(char*)&d2,sizeof(tpdm),addr_ab,&addr_ab);
-        int i = d2.i;
-        int j = d2.j;
-        int k = d2.k;
-        int l = d2.l;
-        long int id = i*nmo_*nmo_*nmo_+j*nmo_*nmo_+k*nmo_+l;
-        D2ab[id] = d2.val;
+    {
+        RDMStream<tpdm> d2(psio,PSIF_V2RDM_D2AB,"D2ab");
+        while ( long int nrec = d2.next() ) {
+            tpdm * rec = d2.records();
+            for (long int n = 0; n < nrec; n++) {
+                int i = rec[n].i;
+                int j = rec[n].j;
+                int k = rec[n].k;
+                int l = rec[n].l;
+                double val = rec[n].val;
+
+                if ( i == k && j == l ) trab += val;
+
+                // D1a(i,k) = sum_j D2ab(ij;kj), D1b(j,l) = sum_i D2ab(ij;il)
+                if ( j == l ) Da[i*nmo_+k] += val;
+                if ( i == k ) Db[j*nmo_+l] += val;
+
+                double eri = C_DDOT(nQ_,Qmo_ + nQ_*INDEX(i,k),1,Qmo_+nQ_*INDEX(j,l),1);
+                en2 += eri * val;
+            }
+        }
     }
     psio->close(PSIF_V2RDM_D2AB,1);
 
     // aa
     psio->open(PSIF_V2RDM_D2AA,PSIO_OPEN_OLD);
-
-    long int naa;
-    psio->read_entry(PSIF_V2RDM_D2AA,"length",(char*)&naa,sizeof(long int));
-
-    for (int n = 0; n < naa; n++) {
-        tpdm d2;
-        psio->read(PSIF_V2RDM_D2AA,"D2aa",(char*)&d2,sizeof(tpdm),addr_aa,&addr_aa);
-        int i = d2.i;
-        int j = d2.j;
-        int k = d2.k;
-        int l = d2.l;
-        long int id = i*nmo_*nmo_*nmo_+j*nmo_*nmo_+k*nmo_+l;
-        D2aa[id] = d2.val;
+    {
+        RDMStream<tpdm> d2(psio,PSIF_V2RDM_D2AA,"D2aa");
+        while ( long int nrec = d2.next() ) {
+            tpdm * rec = d2.records();
+            for (long int n = 0; n < nrec; n++) {
+                int i = rec[n].i;
+                int j = rec[n].j;
+                int k = rec[n].k;
+                int l = rec[n].l;
+                double val = rec[n].val;
+
+                if ( i == k && j == l ) traa += val;
+                if ( j == l ) Da[i*nmo_+k] += val;
+
+                double eri = C_DDOT(nQ_,Qmo_ + nQ_*INDEX(i,k),1,Qmo_+nQ_*INDEX(j,l),1);
+                en2 += 0.5 * eri * val;
+            }
+        }
     }
     psio->close(PSIF_V2RDM_D2AA,1);
 
     // bb
     psio->open(PSIF_V2RDM_D2BB,PSIO_OPEN_OLD);
-
-    long int nbb;
-    psio->read_entry(PSIF_V2RDM_D2BB,"length",(char*)&nbb,sizeof(long int));
-
-    for (int n = 0; n < nbb; n++) {
-        tpdm d2;
-        psio->read(PSIF_V2RDM_D2BB,"D2bb",(char*)&d2,sizeof(tpdm),addr_bb,&addr_bb);
-        int i = d2.i;
-        int j = d2.j;
-        int k = d2.k;
-        int l = d2.l;
-        long int id = i*nmo_*nmo_*nmo_+j*nmo_*nmo_+k*nmo_+l;
-        D2bb[id] = d2.val;
+    {
+        RDMStream<tpdm> d2(psio,PSIF_V2RDM_D2BB,"D2bb");
+        while ( long int nrec = d2.next() ) {
+            tpdm * rec = d2.records();
+            for (long int n = 0; n < nrec; n++) {
+                int i = rec[n].i;
+                int j = rec[n].j;
+                int k = rec[n].k;
+                int l = rec[n].l;
+                double val = rec[n].val;
+
+                if ( i == k && j == l ) trbb += val;
+                if ( j == l ) Db[i*nmo_+k] += val;
+
+                double eri = C_DDOT(nQ_,Qmo_ + nQ_*INDEX(i,k),1,Qmo_+nQ_*INDEX(j,l),1);
+                en2 += 0.5 * eri * val;
+            }
+        }
     }
     psio->close(PSIF_V2RDM_D2BB,1);
 
-    // check traces:
-    double traa = 0.0;
-    double trbb = 0.0;
-    double trab = 0.0;
-    for (int i = 0; i < nmo_; i++) {
-        for (int j = 0; j < nmo_; j++) {
-            traa += D2aa[i*nmo_*nmo_*nmo_+j*nmo_*nmo_+i*nmo_+j];
-            trbb += D2bb[i*nmo_*nmo_*nmo_+j*nmo_*nmo_+i*nmo_+j];
-            trab += D2ab[i*nmo_*nmo_*nmo_+j*nmo_*nmo_+i*nmo_+j];
-        }
-    }
     //printf("  tr(d2aa) = %20.12lf\n",traa);
     //printf("  tr(d2bb) = %20.12lf\n",trbb);
     //printf("  tr(d2ab) = %20.12lf\n",trab);
 
-    double * Da = (double*)malloc(nmo_*nmo_*sizeof(double));
-    double * Db = (double*)malloc(nmo_*nmo_*sizeof(double));
-
-    memset((void*)Da,'\0',nmo_*nmo_*sizeof(double));
-    memset((void*)Db,'\0',nmo_*nmo_*sizeof(double));
-
     double tra = 0.0;
     double trb = 0.0;
 
+    C_DSCAL(nmo_*nmo_,1.0/(nalpha_+nbeta_-1.0),Da,1);
+    C_DSCAL(nmo_*nmo_,1.0/(nalpha_+nbeta_-1.0),Db,1);
     for (int i = 0; i < nmo_; i++) {
-        for (int j = 0; j < nmo_; j++) {
-
-            double duma = 0.0;
-            double dumb = 0.0;
-            for (int k = 0; k < nmo_; k++) {
-                duma += D2ab[i*nmo_*nmo_*nmo_+k*nmo_*nmo_+j*nmo_+k];
-                duma += D2aa[i*nmo_*nmo_*nmo_+k*nmo_*nmo_+j*nmo_+k];
-
-                dumb += D2ab[k*nmo_*nmo_*nmo_+i*nmo_*nmo_+k*nmo_+j];
-                dumb += D2bb[i*nmo_*nmo_*nmo_+k*nmo_*nmo_+j*nmo_+k];
-            }
-            Da[i*nmo_+j] = 1.0/(nalpha_+nbeta_-1.0) * duma;
-            Db[i*nmo_+j] = 1.0/(nalpha_+nbeta_-1.0) * dumb;
-
-            if ( i == j ) {
-                tra += Da[i*nmo_+j];
-                trb += Da[i*nmo_+j];
-            }
-
-        }
+        tra += Da[i*nmo_+i];
+        trb += Db[i*nmo_+i];
     }
 
     //printf("  tr(da) = %20.12lf\n",tra);
@@ -492,28 +653,6 @@ void v2RDMSolver::ReadTPDM(){
 
     // check energy:
 
-    double en2 = 0.0;
-    for (int i = 0; i < nmo_; i++) {
-        for (int j = 0; j < nmo_; j++) {
-            for (int k = 0; k < nmo_; k++) {
-                for (int l = 0; l < nmo_; l++) {
-
-                    double eri = C_DDOT(nQ_,Qmo_ + nQ_*INDEX(i,k),1,Qmo_+nQ_*INDEX(j,l),1);
-                    
-                    en2 +=       eri * D2ab[i*nmo_*nmo_*nmo_+j*nmo_*nmo_+k*nmo_+l];
-                    en2 += 0.5 * eri * D2aa[i*nmo_*nmo_*nmo_+j*nmo_*nmo_+k*nmo_+l];
-                    en2 += 0.5 * eri * D2bb[i*nmo_*nmo_*nmo_+j*nmo_*nmo_+k*nmo_+l];
-
-                }
-            }
-        }
-    }
-
-    boost::shared_ptr<MintsHelper> mints(new MintsHelper(reference_wavefunction_));
-    boost::shared_ptr<Matrix> K1 (new Matrix(mints->so_potential()));
-    K1->add(mints->so_kinetic());
-    K1->transform(Ca_);
-
     double en1 = 0.0;
 
     long int offset = 0;
@@ -531,8 +670,6 @@ void v2RDMSolver::ReadTPDM(){
 
                 en1 += oei_full_sym_[offset2 + INDEX(i,j)] * Da[ifull*nmo_+jfull];
                 en1 += oei_full_sym_[offset2 + INDEX(i,j)] * Db[ifull*nmo_+jfull];
-                //en1 += K1->pointer(h)[i][j] * Da[ifull*nmo_+jfull];
-                //en1 += K1->pointer(h)[i][j] * Db[ifull*nmo_+jfull];
             }
         }
 
@@ -543,9 +680,6 @@ void v2RDMSolver::ReadTPDM(){
 
     printf("%20.12lf %20.12lf %20.12lf %20.12lf\n",en1,en2,enuc_,en1+en2+enuc_);
 
-    free(D2aa);
-    free(D2bb);
-    free(D2ab);
     free(Da);
     free(Db);
 }